@@ -33,6 +33,14 @@ INCLUDEPATH += ../../ext/OpenSSL-1.0.1/include
 
 SOURCES += ../../src/main.cpp \
     ../../src/common/fragmentInfo.cpp \
+    ../../src/common/segmentTimeline.cpp \
+    ../../src/common/sampleIndex.cpp \
+    ../../src/common/queueBudget.cpp \
+    ../../src/common/decodePool.cpp \
+    ../../src/common/fileView.cpp \
+    ../../src/common/readAhead.cpp \
+    ../../src/common/activityCurve.cpp \
+    ../../src/common/mosaicLayout.cpp \
     ../../src/parser/basic/box.cpp \
     ../../src/parser/basic/mandatoryBox.cpp \
     ../../src/parser/basic/unknownBox.cpp \
@@ -42,35 +50,49 @@ SOURCES += ../../src/main.cpp \
     ../../src/parser/fourcc.cpp \
     ../../src/parser/fragmentExtractor.cpp \
     ../../src/parser/mediaParser.cpp \
+    ../../src/parser/parseIndex.cpp \
+    ../../src/parser/parseSession.cpp \
     ../../src/parser/oxfverifier.cpp \
     ../../src/parser/signatureExtractor.cpp \
+    ../../src/parser/sampleIndexExtractor.cpp \
     ../../src/parser/validatorISO.cpp \
     ../../src/parser/validatorOXF.cpp \
     ../../src/parser/validatorSurveillance.cpp \
+    ../../src/parserUI/boxTreeModel.cpp \
     ../../src/parserUI/certificateStorageDialog.cpp \
     ../../src/parserUI/parserWidget.cpp \
     ../../src/parserUI/verifyerdialog.cpp \
     ../../src/player/audioContext.cpp \
     ../../src/player/audioPlayback.cpp \
     ../../src/player/avFrameWrapper.cpp \
+    ../../src/player/clipExporter.cpp \
+    ../../src/player/thumbnailCache.cpp \
+    ../../src/player/thumbnailExtractor.cpp \
     ../../src/player/controller.cpp \
     ../../src/player/engine.cpp \
     ../../src/player/mainContext.cpp \
+    ../../src/player/mosaicPlayback.cpp \
     ../../src/player/nonqueuedAudioDecoder.cpp \
     ../../src/player/nonqueuedVideoDecoder.cpp \
+    ../../src/player/pipelineStatistics.cpp \
     ../../src/player/portAudioPlayback.cpp \
     ../../src/player/portAudioThread.cpp \
     ../../src/player/queuedAudioDecoder.cpp \
     ../../src/player/queuedVideoDecoder.cpp \
+    ../../src/player/stallWatchdog.cpp \
     ../../src/player/syncThread.cpp \ 
+    ../../src/player/traceRecorder.cpp \
     ../../src/player/videoContext.cpp \
     ../../src/player/videoPlayback.cpp \
+    ../../src/playerUI/activityBar.cpp \
     ../../src/playerUI/clickableSlider.cpp \
     ../../src/playerUI/controlsWidget.cpp \
     ../../src/playerUI/fragmentListWidget.cpp \
     ../../src/playerUI/fullscreenPlayerWidget.cpp \
+    ../../src/playerUI/mosaicWidget.cpp \
     ../../src/playerUI/movingOutArea.cpp \
     ../../src/playerUI/playerWidget.cpp \
+    ../../src/playerUI/thumbnailStrip.cpp \
     ../../src/playerUI/videoFrameWidget.cpp
 
 HEADERS  += \
@@ -80,8 +102,16 @@ HEADERS  += \
     ../../src/common/enums.h \
     ../../src/common/ffmpeg.h \
     ../../src/common/segmentInfo.h \
+    ../../src/common/segmentTimeline.h \
+    ../../src/common/sampleIndex.h \
     ../../src/common/ONVIFSignInfo.h \
     ../../src/common/queue.h \
+    ../../src/common/queueBudget.h \
+    ../../src/common/decodePool.h \
+    ../../src/common/fileView.h \
+    ../../src/common/readAhead.h \
+    ../../src/common/activityCurve.h \
+    ../../src/common/mosaicLayout.h \
     ../../src/common/signingInformation.h \
     ../../src/common/types.h \
     ../../src/parser/additionalUserInformation.hpp \
@@ -117,6 +147,8 @@ HEADERS  += \
     ../../src/parser/helpers/uint24.hpp \
     ../../src/parser/mediaHeaderBox.hpp \
     ../../src/parser/mediaParser.h \
+    ../../src/parser/parseIndex.h \
+    ../../src/parser/parseSession.h \
     ../../src/parser/movieExtendsHeaderBox.hpp \
     ../../src/parser/movieHeaderBox.hpp \
     ../../src/parser/oxfverifier.h \
@@ -125,6 +157,7 @@ HEADERS  += \
     ../../src/parser/signatureBox.hpp \
     ../../src/parser/signatureConfigurationBox.hpp \
     ../../src/parser/signatureExtractor.h \
+    ../../src/parser/sampleIndexExtractor.h \
     ../../src/parser/surveillanceExportBox.hpp \
     ../../src/parser/surveillanceMetadataSampleConfigBox.hpp \
     ../../src/parser/surveillanceMetadataSampleEntryBox.hpp \
@@ -140,6 +173,7 @@ HEADERS  += \
     ../../src/parser/validatorISO.h \
     ../../src/parser/validatorOXF.h \
     ../../src/parser/validatorSurveillance.h \
+    ../../src/parserUI/boxTreeModel.h \
     ../../src/parserUI/certificateStorageDialog.h \
     ../../src/parserUI/parserWidget.h \
     ../../src/parserUI/verifyerdialog.h \
@@ -147,28 +181,38 @@ HEADERS  += \
     ../../src/player/audioPlayback.h \
     ../../src/player/avFrameWrapper.h \
     ../../src/player/basePlayback.h \
+    ../../src/player/clipExporter.h \
+    ../../src/player/thumbnailCache.h \
+    ../../src/player/thumbnailExtractor.h \
     ../../src/player/controller.h \
     ../../src/player/decoder.h \
     ../../src/player/engine.h \
     ../../src/player/mainContext.h \
+    ../../src/player/mosaicPlayback.h \
     ../../src/player/nonqueuedAudioDecoder.h \
     ../../src/player/nonqueuedDecoder.h \
     ../../src/player/nonqueuedVideoDecoder.h \
+    ../../src/player/pipelineStatistics.h \
     ../../src/player/portAudioPlayback.h \
     ../../src/player/portAudioThread.h \
     ../../src/player/queuedAudioDecoder.h \
     ../../src/player/queuedDecoder.h \
     ../../src/player/queuedVideoDecoder.h \
+    ../../src/player/stallWatchdog.h \
     ../../src/player/syncThread.h \ 
+    ../../src/player/traceRecorder.h \
     ../../src/player/videoContext.h \
     ../../src/player/videoPlayback.h \
+    ../../src/playerUI/activityBar.h \
     ../../src/playerUI/clickableSlider.h \
     ../../src/playerUI/controlsWidget.h \
     ../../src/playerUI/fragmentListWidget.h \
     ../../src/playerUI/fullscreenPlayerWidget.h \
+    ../../src/playerUI/mosaicWidget.h \
     ../../src/playerUI/movingOutArea.h \
     ../../src/playerUI/playerWidget.h \
     ../../src/playerUI/playerWidgetInterface.h \
+    ../../src/playerUI/thumbnailStrip.h \
     ../../src/playerUI/videoFrameWidget.h
 
 FORMS    += \
@@ -0,0 +1,195 @@
+#-------------------------------------------------
+#
+# Benchmarks of the parser and the player, reporting in JSON
+#
+#-------------------------------------------------
+
+QT       += core gui widgets multimedia network
+
+TARGET = benchmarks
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+QMAKE_CXXFLAGS += -std=c++11
+
+INCLUDEPATH +=  ../../src \
+                ../../src/common \
+                ../../src/player \
+                ../../src/playerUI \
+                ../../src/parser \
+                ../../src/tests \
+                ../../src/benchmarks
+				
+DEFINES += DECODE_USING_QUEUE
+#DEFINES += DECODE_WITHOUT_QUEUE
+
+#DEFINES += MEMORY_INFO
+
+INCLUDEPATH += ../../ext/FFMPEG-1.2/include
+INCLUDEPATH += ../../ext/PortAudio/include
+INCLUDEPATH += ../../ext/OpenSSL-1.0.1/include
+
+SOURCES += main.cpp \
+    ../../src/common/segmentInfo.cpp \
+    ../../src/common/segmentTimeline.cpp \
+    ../../src/common/sampleIndex.cpp \
+    ../../src/common/queueBudget.cpp \
+    ../../src/common/decodePool.cpp \
+    ../../src/common/fileView.cpp \
+    ../../src/common/readAhead.cpp \
+    ../../src/parser/basic/box.cpp \
+    ../../src/parser/basic/mandatoryBox.cpp \
+    ../../src/parser/basic/unknownBox.cpp \
+    ../../src/parser/boxFactory.cpp \
+    ../../src/parser/certificateStorage.cpp \
+    ../../src/parser/consistencyChecker.cpp \
+    ../../src/parser/fourcc.cpp \
+    ../../src/parser/segmentExtractor.cpp \
+    ../../src/parser/mediaParser.cpp \
+    ../../src/parser/parseIndex.cpp \
+    ../../src/parser/parseSession.cpp \
+    ../../src/parser/oxfverifier.cpp \
+    ../../src/parser/signatureExtractor.cpp \
+    ../../src/parser/sampleIndexExtractor.cpp \
+    ../../src/parser/validatorISO.cpp \
+    ../../src/parser/validatorOXF.cpp \
+    ../../src/parser/validatorSurveillance.cpp \
+    ../../src/player/audioContext.cpp \
+    ../../src/player/audioPlayback.cpp \
+    ../../src/player/avFrameWrapper.cpp \
+    ../../src/player/clipExporter.cpp \
+    ../../src/player/engine.cpp \
+    ../../src/player/pipelineStatistics.cpp \
+    ../../src/player/portAudioPlayback.cpp \
+    ../../src/player/portAudioThread.cpp \
+    ../../src/player/queuedAudioDecoder.cpp \
+    ../../src/player/queuedMetadataDecoder.cpp \
+    ../../src/player/stallWatchdog.cpp \
+    ../../src/player/streamReader.cpp \
+    ../../src/player/syncThread.cpp \
+    ../../src/player/traceRecorder.cpp \
+    ../../src/player/videoContext.cpp \
+    ../../src/player/videoPlayback.cpp \
+    ../../src/player/queuedVideoDecoder.cpp \
+    ../../src/playerUI/videoFrameWidget.cpp \
+    ../../src/tests/syntheticFileGenerator.cpp \
+    ../../src/benchmarks/benchmarkCommon.cpp \
+    ../../src/benchmarks/clipGenerator.cpp \
+    ../../src/benchmarks/decodeBenchmark.cpp \
+    ../../src/benchmarks/exportBenchmark.cpp \
+    ../../src/benchmarks/parserBenchmark.cpp
+
+HEADERS  += \
+    ../../src/common/crosscompilation_cxx11.h \
+    ../../src/common/crosscompilation_inttypes.h \
+    ../../src/common/defines.h \
+    ../../src/common/enums.h \
+    ../../src/common/ffmpeg.h \
+    ../../src/common/segmentInfo.h \
+    ../../src/common/segmentTimeline.h \
+    ../../src/common/sampleIndex.h \
+    ../../src/common/ONVIFSignInfo.h \
+    ../../src/common/queue.h \
+    ../../src/common/queueBudget.h \
+    ../../src/common/decodePool.h \
+    ../../src/common/fileView.h \
+    ../../src/common/readAhead.h \
+    ../../src/common/signingInformation.h \
+    ../../src/common/types.h \
+    ../../src/parser/additionalUserInformation.hpp \
+    ../../src/parser/afIdentificationBox.hpp \
+    ../../src/parser/basic/box.h \
+    ../../src/parser/basic/contentBox.hpp \
+    ../../src/parser/basic/dataBox.hpp \
+    ../../src/parser/basic/fileBox.hpp \
+    ../../src/parser/basic/fullBox.hpp \
+    ../../src/parser/basic/mandatoryBox.h \
+    ../../src/parser/basic/mixin/children.hpp \
+    ../../src/parser/basic/mixin/data.hpp \
+    ../../src/parser/basic/mixin/table.hpp \
+    ../../src/parser/basic/superBox.hpp \
+    ../../src/parser/basic/superFullBox.hpp \
+    ../../src/parser/basic/tableBox.hpp \
+    ../../src/parser/basic/unknownBox.h \
+    ../../src/parser/boxFactory.h \
+    ../../src/parser/cameraMicrophoneIdentificationBox.hpp \
+    ../../src/parser/certificateBox.hpp \
+    ../../src/parser/certificateStorage.h \
+    ../../src/parser/compactSampleSizeBox.hpp \
+    ../../src/parser/consistencyChecker.h \
+    ../../src/parser/editListBox.hpp \
+    ../../src/parser/fileTypeBox.hpp \
+    ../../src/parser/fourcc.h \
+    ../../src/parser/segmentExtractor.h \
+    ../../src/parser/helpers/endian.hpp \
+    ../../src/parser/helpers/is_a.hpp \
+    ../../src/parser/helpers/istream.hpp \
+    ../../src/parser/helpers/optional.hpp \
+    ../../src/parser/helpers/property.hpp \
+    ../../src/parser/helpers/uint24.hpp \
+    ../../src/parser/mediaHeaderBox.hpp \
+    ../../src/parser/mediaParser.h \
+    ../../src/parser/parseIndex.h \
+    ../../src/parser/parseSession.h \
+    ../../src/parser/movieExtendsHeaderBox.hpp \
+    ../../src/parser/movieHeaderBox.hpp \
+    ../../src/parser/oxfverifier.h \
+    ../../src/parser/sampleDependencyTypeBox.hpp \
+    ../../src/parser/sampleSizeBox.hpp \
+    ../../src/parser/signatureBox.hpp \
+    ../../src/parser/signatureConfigurationBox.hpp \
+    ../../src/parser/signatureExtractor.h \
+    ../../src/parser/sampleIndexExtractor.h \
+    ../../src/parser/surveillanceExportBox.hpp \
+    ../../src/parser/surveillanceMetadataSampleConfigBox.hpp \
+    ../../src/parser/surveillanceMetadataSampleEntryBox.hpp \
+    ../../src/parser/templateContentBoxes.hpp \
+    ../../src/parser/templateFullBoxes.hpp \
+    ../../src/parser/templateSuperBoxes.hpp \
+    ../../src/parser/templateSuperFullBoxes.hpp \
+    ../../src/parser/templateTableBoxes.hpp \
+    ../../src/parser/trackFragmentHeaderBox.hpp \
+    ../../src/parser/trackFragmentRandomAccessBox.hpp \
+    ../../src/parser/trackHeaderBox.hpp \
+    ../../src/parser/trackRunBox.hpp \
+    ../../src/parser/validatorISO.h \
+    ../../src/parser/validatorOXF.h \
+    ../../src/parser/validatorSurveillance.h \
+    ../../src/player/audioContext.h \
+    ../../src/player/audioPlayback.h \
+    ../../src/player/avFrameWrapper.h \
+    ../../src/player/basePlayback.h \
+    ../../src/player/clipExporter.h \
+    ../../src/player/decoder.h \
+    ../../src/player/engine.h \
+    ../../src/player/pipelineStatistics.h \
+    ../../src/player/portAudioPlayback.h \
+    ../../src/player/portAudioThread.h \
+    ../../src/player/queuedAudioDecoder.h \
+    ../../src/player/queuedDecoder.h \
+    ../../src/player/queuedMetadataDecoder.h \
+    ../../src/player/queuedVideoDecoder.h \
+    ../../src/player/stallWatchdog.h \
+    ../../src/player/streamReader.h \
+    ../../src/player/syncThread.h \
+    ../../src/player/traceRecorder.h \
+    ../../src/player/videoContext.h \
+    ../../src/player/videoPlayback.h \
+    ../../src/tests/ostream.hpp \
+    ../../src/playerUI/videoFrameWidget.h \
+    ../../src/tests/syntheticFileGenerator.h \
+    ../../src/benchmarks/benchmarkCommon.h \
+    ../../src/benchmarks/clipGenerator.h \
+    ../../src/benchmarks/decodeBenchmark.h \
+    ../../src/benchmarks/exportBenchmark.h \
+    ../../src/benchmarks/parserBenchmark.h
+
+win32:LIBS += -L../../ext/FFMPEG-1.2/lib/Windows -L../../ext/PortAudio/lib/Windows -L../../ext/OpenSSL-1.0.1/lib
+unix:LIBS += -L../../ext/FFMPEG-1.2/lib/Unix -L../../ext/PortAudio/lib/Unix -L/usr/lib/i386-linux-gnu
+
+LIBS += -lavcodec -lavdevice -lavfilter -lavformat -lavutil -lswresample -lswscale -lssl -lcrypto -lpugixml
+
+win32:LIBS += -lportaudio.dll -lpsapi
+unix:LIBS += -lportaudio
@@ -0,0 +1,137 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QtDebug>
+
+#include "benchmarkCommon.h"
+#include "decodeBenchmark.h"
+#include "exportBenchmark.h"
+#include "parserBenchmark.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    application.setApplicationName("benchmarks");
+
+    QCommandLineParser command_line;
+    command_line.setApplicationDescription("Measures the parser and the player performance and reports it in JSON.");
+    command_line.addHelpOption();
+    QCommandLineOption suite_option("suite", "Suite to run: parser, decode, export or all.", "suite", "all");
+    QCommandLineOption iterations_option("iterations", "Count of the measurements of each case.", "count", "5");
+    QCommandLineOption output_option("output", "File to write the report to, the standard output by default.", "file");
+    QCommandLineOption baseline_option("baseline", "Report of a previous run to compare the results with.", "file");
+    QCommandLineOption tolerance_option("tolerance", "Allowed slowdown against the baseline in percent.", "percent", "20");
+    QCommandLineOption targets_option("check-targets", "Fails if a result misses its target, e.g. the time to the first frame.");
+    command_line.addOption(suite_option);
+    command_line.addOption(iterations_option);
+    command_line.addOption(output_option);
+    command_line.addOption(baseline_option);
+    command_line.addOption(tolerance_option);
+    command_line.addOption(targets_option);
+    command_line.process(application);
+
+    QString suite = command_line.value(suite_option);
+    int iterations = command_line.value(iterations_option).toInt();
+
+    QTemporaryDir work_folder;
+    if(!work_folder.isValid())
+    {
+        qWarning() << "Failed to create a folder for the benchmark files";
+        return 1;
+    }
+
+    QJsonArray results;
+    if(suite == "parser" || suite == "all")
+    {
+        ParserBenchmark benchmark(work_folder.path(), iterations);
+        QJsonArray parser_results = benchmark.run(ParserBenchmark::getDefaultCases());
+        for(auto it = parser_results.begin(), end = parser_results.end(); it != end; ++it)
+            results.append(*it);
+    }
+    if(suite == "decode" || suite == "all")
+    {
+        DecodeBenchmark benchmark(work_folder.path(), iterations);
+        QJsonArray decode_results = benchmark.run(DecodeBenchmark::getDefaultCases());
+        for(auto it = decode_results.begin(), end = decode_results.end(); it != end; ++it)
+            results.append(*it);
+    }
+    if(suite == "export" || suite == "all")
+    {
+        ExportBenchmark benchmark(work_folder.path(), iterations);
+        QJsonArray export_results = benchmark.run(ExportBenchmark::getDefaultCases());
+        for(auto it = export_results.begin(), end = export_results.end(); it != end; ++it)
+            results.append(*it);
+    }
+
+    QByteArray report = QJsonDocument(BenchmarkCommon::makeReport(suite, results)).toJson();
+    if(command_line.isSet(output_option))
+    {
+        QFile output(command_line.value(output_option));
+        if(!output.open(QIODevice::WriteOnly) || (output.write(report) != report.size()))
+        {
+            qWarning() << "Failed to write" << output.fileName();
+            return 1;
+        }
+    }
+    else
+    {
+        QTextStream(stdout) << report;
+    }
+
+    int exit_code = 0;
+    if(command_line.isSet(targets_option))
+    {
+        QStringList missed = BenchmarkCommon::findMissedTargets(results);
+        for(auto it = missed.begin(), end = missed.end(); it != end; ++it)
+            qWarning().noquote() << "Missed target:" << *it;
+        if(!missed.isEmpty())
+            exit_code = 3;
+    }
+
+    if(command_line.isSet(baseline_option))
+    {
+        QFile baseline_file(command_line.value(baseline_option));
+        if(!baseline_file.open(QIODevice::ReadOnly))
+        {
+            qWarning() << "Failed to read" << baseline_file.fileName();
+            return 1;
+        }
+        QJsonObject baseline = QJsonDocument::fromJson(baseline_file.readAll()).object();
+        QStringList regressions = BenchmarkCommon::findRegressions(results, baseline, command_line.value(tolerance_option).toDouble());
+        for(auto it = regressions.begin(), end = regressions.end(); it != end; ++it)
+            qWarning().noquote() << "Regression:" << *it;
+        return regressions.isEmpty() ? exit_code : 2;
+    }
+
+    return exit_code;
+}
@@ -47,6 +47,17 @@
 #include "trackHeaderBoxTest.h"
 #include "trackRunBoxTest.h"
 #include "certificateSSLTest.h"
+#include "segmentTimelineTest.h"
+#include "sampleIndexTest.h"
+#include "syntheticFileTest.h"
+#include "queueTest.h"
+#include "mosaicLayoutTest.h"
+#include "decodePoolTest.h"
+#include "fileViewTest.h"
+#include "readAheadTest.h"
+#include "activityCurveTest.h"
+#include "thumbnailCacheTest.h"
+#include "clipExporterTest.h"
 
 int main(int argc, char *argv[])
 {
@@ -152,6 +163,50 @@ int main(int argc, char *argv[])
         SurveillanceMetadataSampleEntryBoxTest tc;
         result += QTest::qExec(&tc, argc, argv);
     }
+    {
+        SegmentTimelineTest tc;
+        result += QTest::qExec(&tc, argc, argv);
+    }
+    {
+        SampleIndexTest tc;
+        result += QTest::qExec(&tc, argc, argv);
+    }
+    {
+        SyntheticFileTest tc;
+        result += QTest::qExec(&tc, argc, argv);
+    }
+    {
+        QueueTest tc;
+        result += QTest::qExec(&tc, argc, argv);
+    }
+    {
+        MosaicLayoutTest tc;
+        result += QTest::qExec(&tc, argc, argv);
+    }
+    {
+        DecodePoolTest tc;
+        result += QTest::qExec(&tc, argc, argv);
+    }
+    {
+        FileViewTest tc;
+        result += QTest::qExec(&tc, argc, argv);
+    }
+    {
+        ReadAheadTest tc;
+        result += QTest::qExec(&tc, argc, argv);
+    }
+    {
+        ActivityCurveTest tc;
+        result += QTest::qExec(&tc, argc, argv);
+    }
+    {
+        ThumbnailCacheTest tc;
+        result += QTest::qExec(&tc, argc, argv);
+    }
+    {
+        ClipExporterTest tc;
+        result += QTest::qExec(&tc, argc, argv);
+    }
 
     return result;
 }
@@ -18,6 +18,7 @@ INCLUDEPATH +=  ../../src \
                 ../../src/common \
                 ../../src/player \
                 ../../src/parser \
+                ../../src/benchmarks \
                 ../../src/tests
 				
 DEFINES += DECODE_USING_QUEUE
@@ -30,7 +31,19 @@ INCLUDEPATH += ../../ext/PortAudio/include
 INCLUDEPATH += ../../ext/OpenSSL-1.0.1/include
 
 SOURCES += main.cpp \
-    ../../src/common/fragmentInfo.cpp \
+    ../../src/common/segmentInfo.cpp \
+    ../../src/common/segmentTimeline.cpp \
+    ../../src/common/sampleIndex.cpp \
+    ../../src/common/queueBudget.cpp \
+    ../../src/common/decodePool.cpp \
+    ../../src/common/fileView.cpp \
+    ../../src/common/readAhead.cpp \
+    ../../src/common/activityCurve.cpp \
+    ../../src/common/mosaicLayout.cpp \
+    ../../src/player/clipExporter.cpp \
+    ../../src/player/streamReader.cpp \
+    ../../src/player/thumbnailCache.cpp \
+    ../../src/benchmarks/clipGenerator.cpp \
     ../../src/parser/basic/box.cpp \
     ../../src/parser/basic/mandatoryBox.cpp \
     ../../src/parser/basic/unknownBox.cpp \
@@ -38,10 +51,13 @@ SOURCES += main.cpp \
     ../../src/parser/certificateStorage.cpp \
     ../../src/parser/consistencyChecker.cpp \
     ../../src/parser/fourcc.cpp \
-    ../../src/parser/fragmentExtractor.cpp \
+    ../../src/parser/segmentExtractor.cpp \
     ../../src/parser/mediaParser.cpp \
+    ../../src/parser/parseIndex.cpp \
+    ../../src/parser/parseSession.cpp \
     ../../src/parser/oxfverifier.cpp \
     ../../src/parser/signatureExtractor.cpp \
+    ../../src/parser/sampleIndexExtractor.cpp \
     ../../src/parser/validatorISO.cpp \
     ../../src/parser/validatorOXF.cpp \
     ../../src/parser/validatorSurveillance.cpp \
@@ -65,6 +81,18 @@ SOURCES += main.cpp \
     ../../src/tests/trackFragmentRandomAccessBoxTest.cpp \
     ../../src/tests/trackHeaderBoxTest.cpp \
     ../../src/tests/trackRunBoxTest.cpp \
+    ../../src/tests/segmentTimelineTest.cpp \
+    ../../src/tests/sampleIndexTest.cpp \
+    ../../src/tests/syntheticFileGenerator.cpp \
+    ../../src/tests/syntheticFileTest.cpp \
+    ../../src/tests/queueTest.cpp \
+    ../../src/tests/mosaicLayoutTest.cpp \
+    ../../src/tests/decodePoolTest.cpp \
+    ../../src/tests/fileViewTest.cpp \
+    ../../src/tests/readAheadTest.cpp \
+    ../../src/tests/activityCurveTest.cpp \
+    ../../src/tests/thumbnailCacheTest.cpp \
+    ../../src/tests/clipExporterTest.cpp \
     ../../src/tests/certificateSSLTest.cpp \
     ../../src/tests/surveillanceMetadataSampleEntryBoxTest.cpp
 
@@ -75,10 +103,22 @@ HEADERS  += \
     ../../src/common/enums.h \
     ../../src/common/ffmpeg.h \
     ../../src/common/segmentInfo.h \
+    ../../src/common/segmentTimeline.h \
+    ../../src/common/sampleIndex.h \
     ../../src/common/ONVIFSignInfo.h \
     ../../src/common/queue.h \
+    ../../src/common/queueBudget.h \
+    ../../src/common/decodePool.h \
+    ../../src/common/fileView.h \
+    ../../src/common/readAhead.h \
+    ../../src/common/activityCurve.h \
+    ../../src/common/mosaicLayout.h \
     ../../src/common/signingInformation.h \
     ../../src/common/types.h \
+    ../../src/player/clipExporter.h \
+    ../../src/player/streamReader.h \
+    ../../src/player/thumbnailCache.h \
+    ../../src/benchmarks/clipGenerator.h \
     ../../src/parser/additionalUserInformation.hpp \
     ../../src/parser/afIdentificationBox.hpp \
     ../../src/parser/basic/box.h \
@@ -103,7 +143,7 @@ HEADERS  += \
     ../../src/parser/editListBox.hpp \
     ../../src/parser/fileTypeBox.hpp \
     ../../src/parser/fourcc.h \
-    ../../src/parser/fragmentExtractor.h \
+    ../../src/parser/segmentExtractor.h \
     ../../src/parser/helpers/endian.hpp \
     ../../src/parser/helpers/is_a.hpp \
     ../../src/parser/helpers/istream.hpp \
@@ -112,6 +152,8 @@ HEADERS  += \
     ../../src/parser/helpers/uint24.hpp \
     ../../src/parser/mediaHeaderBox.hpp \
     ../../src/parser/mediaParser.h \
+    ../../src/parser/parseIndex.h \
+    ../../src/parser/parseSession.h \
     ../../src/parser/movieExtendsHeaderBox.hpp \
     ../../src/parser/movieHeaderBox.hpp \
     ../../src/parser/oxfverifier.h \
@@ -120,6 +162,7 @@ HEADERS  += \
     ../../src/parser/signatureBox.hpp \
     ../../src/parser/signatureConfigurationBox.hpp \
     ../../src/parser/signatureExtractor.h \
+    ../../src/parser/sampleIndexExtractor.h \
     ../../src/parser/surveillanceExportBox.hpp \
     ../../src/parser/surveillanceMetadataSampleConfigBox.hpp \
     ../../src/parser/surveillanceMetadataSampleEntryBox.hpp \
@@ -157,6 +200,18 @@ HEADERS  += \
     ../../src/tests/trackFragmentRandomAccessBoxTest.h \
     ../../src/tests/trackHeaderBoxTest.h \
     ../../src/tests/trackRunBoxTest.h \
+    ../../src/tests/segmentTimelineTest.h \
+    ../../src/tests/sampleIndexTest.h \
+    ../../src/tests/syntheticFileGenerator.h \
+    ../../src/tests/syntheticFileTest.h \
+    ../../src/tests/queueTest.h \
+    ../../src/tests/mosaicLayoutTest.h \
+    ../../src/tests/decodePoolTest.h \
+    ../../src/tests/fileViewTest.h \
+    ../../src/tests/readAheadTest.h \
+    ../../src/tests/activityCurveTest.h \
+    ../../src/tests/thumbnailCacheTest.h \
+    ../../src/tests/clipExporterTest.h \
     ../../src/tests/certificateSSLTest.h \
     ../../src/tests/surveillanceMetadataSampleEntryBoxTest.h
 
@@ -0,0 +1,198 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "benchmarkCommon.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QStringList>
+#include <QSysInfo>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <Psapi.h>
+#endif
+
+#include "defines.h"
+
+namespace
+{
+    //! Count of the heap allocations made through operator new.
+    std::atomic<quint64> s_allocation_count(0);
+}
+
+// the benchmarks replace the global allocation functions to count the allocations
+void * operator new(std::size_t size)
+{
+    ++s_allocation_count;
+    void * pointer = std::malloc(size ? size : 1);
+    if(pointer == nullptr)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void operator delete(void * pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void * pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace BenchmarkCommon
+{
+
+void resetPeakMemory()
+{
+#ifdef __linux__
+    // writing 5 resets the peak resident set size reported as VmHWM
+    QFile clear_refs("/proc/self/clear_refs");
+    if(clear_refs.open(QIODevice::WriteOnly))
+        clear_refs.write("5");
+#endif
+}
+
+qint64 getPeakMemory()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return qint64(counters.PeakWorkingSetSize / 1024);
+#elif defined(__linux__)
+    QFile status("/proc/self/status");
+    if(status.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        QList<QByteArray> lines = status.readAll().split('\n');
+        for(auto it = lines.begin(), end = lines.end(); it != end; ++it)
+        {
+            if(it->startsWith("VmHWM:"))
+                return it->mid(6).trimmed().split(' ').front().toLongLong();
+        }
+    }
+#endif
+    return -1;
+}
+
+quint64 getAllocationCount()
+{
+    return s_allocation_count;
+}
+
+double median(QList<double> values)
+{
+    if(values.isEmpty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    int middle = values.size() / 2;
+    return (values.size() % 2) ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+double percentile(QList<double> values, double percent)
+{
+    if(values.isEmpty())
+        return 0;
+    std::sort(values.begin(), values.end());
+    int rank = (int)std::ceil(percent / 100 * values.size());
+    return values[std::min(std::max(rank, 1), int(values.size())) - 1];
+}
+
+QJsonObject makeReport(const QString & suite, const QJsonArray & results)
+{
+    QJsonObject report;
+    report["suite"] = suite;
+    report["product"] = QString(PRODUCT_NAME);
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["platform"] = QSysInfo::prettyProductName() + " " + QSysInfo::currentCpuArchitecture();
+    report["results"] = results;
+    return report;
+}
+
+QStringList findRegressions(const QJsonArray & results, const QJsonObject & baseline, double tolerance)
+{
+    QStringList regressions;
+    QJsonArray baseline_results = baseline["results"].toArray();
+    for(auto it = results.begin(), end = results.end(); it != end; ++it)
+    {
+        QJsonObject result = it->toObject();
+        for(auto baseline_it = baseline_results.begin(), baseline_end = baseline_results.end(); baseline_it != baseline_end; ++baseline_it)
+        {
+            QJsonObject baseline_result = baseline_it->toObject();
+            if((baseline_result["case"] != result["case"]) || (baseline_result["mode"] != result["mode"]))
+                continue;
+
+            double time = result["time_ms"].toDouble();
+            double baseline_time = baseline_result["time_ms"].toDouble();
+            if((baseline_time > 0) && (time > baseline_time * (1 + tolerance / 100)))
+            {
+                regressions.append(QString("%1 (%2): %3 ms, was %4 ms")
+                                   .arg(result["case"].toString(), result["mode"].toString())
+                                   .arg(time, 0, 'f', 2).arg(baseline_time, 0, 'f', 2));
+            }
+            break;
+        }
+    }
+    return regressions;
+}
+
+QStringList findMissedTargets(const QJsonArray & results)
+{
+    QStringList missed;
+    for(auto it = results.begin(), end = results.end(); it != end; ++it)
+    {
+        QJsonObject result = it->toObject();
+        int start_failures = result["start_failures"].toInt();
+        if(start_failures > 0)
+        {
+            missed.append(QString("%1 (%2): %3 starts of the playback failed")
+                          .arg(result["case"].toString(), result["mode"].toString())
+                          .arg(start_failures));
+        }
+
+        if(!result.contains("first_frame_target_ms"))
+            continue;
+
+        double time = result["time_to_first_frame_ms"].toDouble();
+        double target = result["first_frame_target_ms"].toDouble();
+        if(time > target)
+        {
+            missed.append(QString("%1 (%2): first frame after %3 ms, target %4 ms")
+                          .arg(result["case"].toString(), result["mode"].toString())
+                          .arg(time, 0, 'f', 2).arg(target, 0, 'f', 2));
+        }
+    }
+    return missed;
+}
+
+}
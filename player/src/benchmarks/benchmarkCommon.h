@@ -0,0 +1,76 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef BENCHMARKCOMMON_H
+#define BENCHMARKCOMMON_H
+
+#include "crosscompilation_inttypes.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+//! Helpers shared by the benchmark suites.
+namespace BenchmarkCommon
+{
+    //! Resets the peak memory usage of the process, where the platform allows it.
+    void resetPeakMemory();
+
+    //! Returns the peak resident memory of the process in kilobytes, or -1 if it is not known.
+    qint64 getPeakMemory();
+
+    //! Returns the count of the heap allocations made through operator new since the start of the process.
+    quint64 getAllocationCount();
+
+    //! Returns the median of the values.
+    double median(QList<double> values);
+
+    //! Returns the percentile of the values, using the nearest rank.
+    double percentile(QList<double> values, double percent);
+
+    //! Creates a report of the results of a suite.
+    QJsonObject makeReport(const QString & suite, const QJsonArray & results);
+
+    //! Compares the results with the ones of a previous report.
+    /*!
+     * Results are matched by their "case" and "mode" values, the lower "time_ms" values are the better ones.
+     * \param results results of the current run
+     * \param baseline report of a previous run
+     * \param tolerance allowed slowdown in percent
+     * \return descriptions of the results, which are slower than allowed
+     */
+    QStringList findRegressions(const QJsonArray & results, const QJsonObject & baseline, double tolerance);
+
+    //! Checks the results having a "first_frame_target_ms" value against it, and the starts of the playback.
+    /*!
+     * \return descriptions of the results, whose "time_to_first_frame_ms" is above the target or with "start_failures"
+     */
+    QStringList findMissedTargets(const QJsonArray & results);
+}
+
+#endif // BENCHMARKCOMMON_H
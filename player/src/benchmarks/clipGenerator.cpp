@@ -0,0 +1,213 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "clipGenerator.h"
+
+#include <QByteArray>
+#include <QtDebug>
+
+#include <cstring>
+
+#include "ffmpeg.h"
+
+extern "C"
+{
+#include <libavutil/pixdesc.h>
+}
+
+namespace
+{
+    //! Fills the frame with a gradient moving with the frame number.
+    void fillFrame(AVFrame * frame, int number)
+    {
+        const AVPixFmtDescriptor * descriptor = av_pix_fmt_desc_get((AVPixelFormat)frame->format);
+        for(int y = 0; y < frame->height; ++y)
+        {
+            uint8_t * line = frame->data[0] + y * frame->linesize[0];
+            for(int x = 0; x < frame->width; ++x)
+                line[x] = uint8_t(x + y + number * 3);
+        }
+
+        int chroma_width = AV_CEIL_RSHIFT(frame->width, descriptor->log2_chroma_w);
+        int chroma_height = AV_CEIL_RSHIFT(frame->height, descriptor->log2_chroma_h);
+        for(int y = 0; y < chroma_height; ++y)
+        {
+            uint8_t * u_line = frame->data[1] + y * frame->linesize[1];
+            uint8_t * v_line = frame->data[2] + y * frame->linesize[2];
+            for(int x = 0; x < chroma_width; ++x)
+            {
+                u_line[x] = uint8_t(128 + y + number * 2);
+                v_line[x] = uint8_t(64 + x + number * 5);
+            }
+        }
+    }
+
+    //! Sample entry of the ONVIF metadata tracks.
+    const uint32_t sc_metadata_tag = MKTAG('m', 'e', 't', 'x');
+
+    //! Writes the metadata sample of a second at a time in ms, describing an object of the second.
+    bool writeMetadata(AVFormatContext * format_context, AVStream * stream, int second, int time_ms, AVPacket * packet)
+    {
+        QByteArray sample = QString("<tt:MetadataStream><tt:VideoAnalytics><tt:Frame>"
+                                    "<tt:Object ObjectId=\"%1\"/>"
+                                    "</tt:Frame></tt:VideoAnalytics></tt:MetadataStream>").arg(second).toUtf8();
+        if(av_new_packet(packet, sample.size()) < 0)
+            return false;
+        memcpy(packet->data, sample.constData(), sample.size());
+        packet->pts = packet->dts = av_rescale_q(time_ms, AVRational{ 1, 1000 }, stream->time_base);
+        packet->duration = av_rescale_q(1, AVRational{ 1, 1 }, stream->time_base);
+        packet->flags |= AV_PKT_FLAG_KEY;
+        packet->stream_index = stream->index;
+        int result = av_interleaved_write_frame(format_context, packet);
+        av_packet_unref(packet);
+        return result >= 0;
+    }
+
+    //! Sends a frame to the encoder and writes the packets it returns, nullptr flushes the encoder.
+    bool encodeFrame(AVFormatContext * format_context, AVCodecContext * codec_context, AVStream * stream, AVFrame * frame, AVPacket * packet)
+    {
+        if(avcodec_send_frame(codec_context, frame) < 0)
+            return false;
+
+        for(;;)
+        {
+            int result = avcodec_receive_packet(codec_context, packet);
+            if(result == AVERROR(EAGAIN) || result == AVERROR_EOF)
+                return true;
+            if(result < 0)
+                return false;
+
+            av_packet_rescale_ts(packet, codec_context->time_base, stream->time_base);
+            packet->stream_index = stream->index;
+            result = av_interleaved_write_frame(format_context, packet);
+            av_packet_unref(packet);
+            if(result < 0)
+                return false;
+        }
+    }
+}
+
+bool ClipGenerator::isAvailable(const QString & codec)
+{
+    return avcodec_find_encoder_by_name(codec.toLatin1().constData()) != nullptr;
+}
+
+bool ClipGenerator::generate(const QString & path, const Options & options)
+{
+    const AVCodec * codec = avcodec_find_encoder_by_name(options.m_codec.toLatin1().constData());
+    if(codec == nullptr)
+    {
+        qWarning() << "Encoder" << options.m_codec << "is not available";
+        return false;
+    }
+
+    QByteArray file_name = path.toUtf8();
+    AVFormatContext * format_context = nullptr;
+    if(avformat_alloc_output_context2(&format_context, nullptr, "mp4", file_name.constData()) < 0)
+        return false;
+
+    AVStream * stream = avformat_new_stream(format_context, nullptr);
+    AVStream * metadata_stream = nullptr;
+    if(options.m_with_metadata)
+    {
+        // the sample entry is not in the codec tables of the muxer
+        format_context->strict_std_compliance = FF_COMPLIANCE_UNOFFICIAL;
+        metadata_stream = avformat_new_stream(format_context, nullptr);
+        if(metadata_stream != nullptr)
+        {
+            metadata_stream->codecpar->codec_type = AVMEDIA_TYPE_DATA;
+            metadata_stream->codecpar->codec_tag = sc_metadata_tag;
+            metadata_stream->time_base = AVRational{ 1, 1000 };
+        }
+    }
+    AVCodecContext * codec_context = avcodec_alloc_context3(codec);
+    AVFrame * frame = av_frame_alloc();
+    AVPacket * packet = av_packet_alloc();
+
+    codec_context->width = options.m_width;
+    codec_context->height = options.m_height;
+    codec_context->time_base = AVRational{ 1, options.m_fps };
+    codec_context->framerate = AVRational{ options.m_fps, 1 };
+    codec_context->gop_size = options.m_gop_size;
+    codec_context->max_b_frames = 0;
+    codec_context->bit_rate = (int64_t)options.m_width * options.m_height * options.m_fps / 8;
+    codec_context->pix_fmt = (codec->pix_fmts != nullptr) ? codec->pix_fmts[0] : AV_PIX_FMT_YUV420P;
+    if(format_context->oformat->flags & AVFMT_GLOBALHEADER)
+        codec_context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+    bool result = (stream != nullptr) && (!options.m_with_metadata || metadata_stream != nullptr) && (codec_context != nullptr) && (frame != nullptr) && (packet != nullptr);
+    result = result && (avcodec_open2(codec_context, codec, nullptr) == 0);
+    result = result && (avcodec_parameters_from_context(stream->codecpar, codec_context) >= 0);
+    if(result)
+        stream->time_base = codec_context->time_base;
+    result = result && (avio_open(&format_context->pb, file_name.constData(), AVIO_FLAG_WRITE) >= 0);
+
+    if(result)
+    {
+        // a fragment per group of pictures, as in the recorded segments
+        AVDictionary * muxer_options = nullptr;
+        av_dict_set(&muxer_options, "movflags", "frag_keyframe+empty_moov+default_base_moof", 0);
+        result = (avformat_write_header(format_context, &muxer_options) >= 0);
+        av_dict_free(&muxer_options);
+    }
+
+    if(result)
+    {
+        frame->width = options.m_width;
+        frame->height = options.m_height;
+        frame->format = codec_context->pix_fmt;
+        result = (av_frame_get_buffer(frame, 0) >= 0);
+    }
+
+    for(int i = 0; result && i < options.m_frame_count; ++i)
+    {
+        result = (av_frame_make_writable(frame) >= 0);
+        // in the middle of the second, so the samples are not at the boundaries of the groups of pictures
+        if(result && metadata_stream != nullptr && i % options.m_fps == options.m_fps / 2)
+            result = writeMetadata(format_context, metadata_stream, i / options.m_fps, i * 1000 / options.m_fps, packet);
+        if(result)
+        {
+            fillFrame(frame, i);
+            frame->pts = i;
+            result = encodeFrame(format_context, codec_context, stream, frame, packet);
+        }
+    }
+
+    result = result && encodeFrame(format_context, codec_context, stream, nullptr, packet);
+    result = result && (av_write_trailer(format_context) == 0);
+
+    if(format_context->pb != nullptr)
+        avio_closep(&format_context->pb);
+    av_packet_free(&packet);
+    av_frame_free(&frame);
+    avcodec_free_context(&codec_context);
+    avformat_free_context(format_context);
+
+    if(!result)
+        qWarning() << "Failed to encode" << path;
+    return result;
+}
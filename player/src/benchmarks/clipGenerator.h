@@ -0,0 +1,86 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef CLIPGENERATOR_H
+#define CLIPGENERATOR_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QString>
+
+//! Encodes synthetic video clips with libav* for the decode benchmarks.
+/*!
+ * \brief Clips are written as fragmented MP4 files with a fragment per group of pictures, like the recorded segments.
+ * Frames show a moving gradient, so the encoders produce a realistic mix of sync and predicted frames.
+ * Clips can have an ONVIF metadata track with a scene description every second.
+ */
+class ClipGenerator CC_CXX11_FINAL
+{
+public:
+    //! Parameters of the generated clip.
+    struct Options
+    {
+        Options()
+            : m_codec("mpeg4")
+            , m_width(1280)
+            , m_height(720)
+            , m_fps(25)
+            , m_gop_size(25)
+            , m_frame_count(250)
+            , m_with_metadata(false)
+        {}
+
+        //! Name of the libav encoder.
+        QString m_codec;
+        //! Frame width.
+        int m_width;
+        //! Frame height.
+        int m_height;
+        //! Frames per second.
+        int m_fps;
+        //! Distance between the sync frames.
+        int m_gop_size;
+        //! Count of the frames.
+        int m_frame_count;
+        //! Whether a metadata track is written.
+        bool m_with_metadata;
+    };
+
+public:
+    //! Checks if the encoder is available in the linked libav* build.
+    static bool isAvailable(const QString & codec);
+
+    //! Writes a clip.
+    /*!
+     * \param path path of the clip, which is overwritten
+     * \param options parameters of the clip
+     * \return true, if the clip was written
+     */
+    static bool generate(const QString & path, const Options & options);
+};
+
+#endif // CLIPGENERATOR_H
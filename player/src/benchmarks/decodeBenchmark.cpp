@@ -0,0 +1,275 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "decodeBenchmark.h"
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QtDebug>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "benchmarkCommon.h"
+#include "defines.h"
+#include "engine.h"
+#include "queuedVideoDecoder.h"
+#include "segmentInfo.h"
+
+namespace
+{
+    //! Count of the seeks measured in each iteration.
+    const int sc_seek_count = 20;
+
+    //! Target time to the first frame of a local 1080p H.264 clip in milliseconds.
+    const double sc_first_frame_target_ms = 150;
+
+    //! Time the start of a clip may take before it counts as failed, in milliseconds.
+    const qint64 sc_start_timeout_ms = 10000;
+}
+
+DecodeBenchmark::DecodeBenchmark(const QString & work_folder, int iterations)
+    : m_work_folder(work_folder)
+    , m_iterations(std::max(1, iterations))
+{
+}
+
+QList<DecodeBenchmark::Case> DecodeBenchmark::getDefaultCases()
+{
+    struct CaseShape
+    {
+        const char * m_codec;
+        int m_width;
+        int m_height;
+        int m_gop_size;
+    };
+
+    static const CaseShape sc_shapes[] =
+    {
+        { "mpeg4", 640, 360, 25 },
+        { "mpeg4", 1920, 1080, 25 },
+        { "mpeg4", 1920, 1080, 250 },
+        { "libx264", 1920, 1080, 25 },
+        { "libx264", 1920, 1080, 250 },
+        { "mjpeg", 1280, 720, 1 }
+    };
+
+    QList<Case> cases;
+    for(const CaseShape & shape : sc_shapes)
+    {
+        if(!ClipGenerator::isAvailable(shape.m_codec))
+        {
+            qWarning() << "Skipping" << shape.m_codec << "clips, the encoder is not available";
+            continue;
+        }
+
+        Case benchmark_case;
+        benchmark_case.m_options.m_codec = shape.m_codec;
+        benchmark_case.m_options.m_width = shape.m_width;
+        benchmark_case.m_options.m_height = shape.m_height;
+        benchmark_case.m_options.m_gop_size = shape.m_gop_size;
+        benchmark_case.m_options.m_frame_count = 500;
+        benchmark_case.m_name = QString("%1_%2p_gop%3").arg(shape.m_codec).arg(shape.m_height).arg(shape.m_gop_size);
+        cases.append(benchmark_case);
+    }
+    return cases;
+}
+
+QJsonArray DecodeBenchmark::run(const QList<Case> & cases)
+{
+    QJsonArray results;
+    for(auto it = cases.begin(), end = cases.end(); it != end; ++it)
+    {
+        QString path = m_work_folder + "/" + it->m_name + ".mp4";
+        if(!ClipGenerator::generate(path, it->m_options))
+            continue;
+
+        results.append(measure(*it, path));
+
+        QFile::remove(path);
+    }
+    return results;
+}
+
+QJsonObject DecodeBenchmark::measure(const Case & benchmark_case, const QString & path)
+{
+    const int duration_ms = benchmark_case.m_options.m_frame_count * 1000 / benchmark_case.m_options.m_fps;
+
+    QList<double> decode_times, first_frame_times, preroll_times, seek_times;
+    double conversion_time = 0;
+    int frame_count = 0, converted_frames = 0, start_failures = 0;
+    quint64 allocations = 0;
+    qint64 peak_memory = -1;
+
+    // the same seek targets in every run, so the results of the builds are comparable
+    QRandomGenerator random(benchmark_case.m_options.m_frame_count);
+
+    for(int i = 0; i < m_iterations; ++i)
+    {
+        BenchmarkCommon::resetPeakMemory();
+
+        // a failed start is reported, instead of counting as a fast one
+        double preroll_time = 0;
+        double first_frame_time = measureFirstFrame(path, preroll_time);
+        if(std::isnan(first_frame_time) || std::isnan(preroll_time))
+            ++start_failures;
+        if(!std::isnan(first_frame_time))
+            first_frame_times.append(first_frame_time);
+        if(!std::isnan(preroll_time))
+            preroll_times.append(preroll_time);
+
+        // decode the whole clip from its beginning
+        QueuedVideoDecoder decoder;
+        if(!decoder.open(path) || !decoder.getStreamsCount())
+        {
+            qWarning() << "Failed to open" << path;
+            continue;
+        }
+        decoder.setStream(0);
+        decoder.resetConversionStatistics();
+
+        quint64 allocations_before = BenchmarkCommon::getAllocationCount();
+        QElapsedTimer timer;
+        timer.start();
+        frame_count = decodeAll(decoder);
+        decode_times.append(timer.nsecsElapsed() / 1000000.0);
+        allocations += BenchmarkCommon::getAllocationCount() - allocations_before;
+
+        conversion_time += decoder.conversionTime() / 1000000.0;
+        converted_frames += decoder.convertedFrames();
+
+        for(int seek = 0; seek < sc_seek_count; ++seek)
+            seek_times.append(measureSeek(decoder, random.bounded(duration_ms)));
+
+        decoder.stop();
+        decoder.clear();
+
+        peak_memory = std::max(peak_memory, BenchmarkCommon::getPeakMemory());
+    }
+
+    double time = BenchmarkCommon::median(decode_times);
+
+    QJsonObject result;
+    result["case"] = benchmark_case.m_name;
+    result["mode"] = QString("unlimited");
+    result["codec"] = benchmark_case.m_options.m_codec;
+    result["width"] = benchmark_case.m_options.m_width;
+    result["height"] = benchmark_case.m_options.m_height;
+    result["gop_size"] = benchmark_case.m_options.m_gop_size;
+    result["file_size"] = QFileInfo(path).size();
+    result["frames"] = frame_count;
+    result["iterations"] = m_iterations;
+    result["time_ms"] = time;
+    result["decode_fps"] = (time > 0) ? frame_count * 1000.0 / time : 0.0;
+    result["conversion_ms_per_frame"] = converted_frames ? conversion_time / converted_frames : 0.0;
+    result["time_to_first_frame_ms"] = BenchmarkCommon::median(first_frame_times);
+    result["time_to_preroll_ms"] = BenchmarkCommon::median(preroll_times);
+    result["start_failures"] = start_failures;
+    if(benchmark_case.m_options.m_codec == "libx264" && benchmark_case.m_options.m_height == 1080)
+        result["first_frame_target_ms"] = sc_first_frame_target_ms;
+    result["seek_p50_ms"] = BenchmarkCommon::percentile(seek_times, 50);
+    result["seek_p99_ms"] = BenchmarkCommon::percentile(seek_times, 99);
+    result["allocations_per_frame"] = frame_count ? double(allocations) / (frame_count * m_iterations) : 0.0;
+    result["peak_memory_kb"] = peak_memory;
+    return result;
+}
+
+double DecodeBenchmark::measureFirstFrame(const QString & path, double & preroll_time)
+{
+    const double failed = std::numeric_limits<double>::quiet_NaN();
+    preroll_time = failed;
+
+    // without a widget the first frame stays in the queue instead of being painted
+    Engine engine;
+    SegmentInfo segment(path);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    if(!engine.init(path, segment))
+    {
+        qWarning() << "Failed to open" << path;
+        return failed;
+    }
+    engine.start();
+    if(engine.getState() != Playing)
+    {
+        qWarning() << "Failed to start the playback of" << path;
+        return failed;
+    }
+    double first_frame_time = timer.nsecsElapsed() / 1000000.0;
+
+    // the engine checks the pre-roll on a timer, which needs the event loop
+    QEventLoop loop;
+    while(engine.isPrerolling() && (timer.elapsed() < sc_start_timeout_ms))
+        loop.processEvents(QEventLoop::WaitForMoreEvents);
+
+    if(engine.isPrerolling())
+        qWarning() << "Pre-roll of" << path << "not buffered after" << sc_start_timeout_ms << "ms";
+    else
+        preroll_time = timer.nsecsElapsed() / 1000000.0;
+
+    engine.stop();
+    return first_frame_time;
+}
+
+int DecodeBenchmark::decodeAll(QueuedVideoDecoder & decoder)
+{
+    int frame_count = 0;
+    decoder.m_pause = false;
+    decoder.start();
+
+    // frames are dropped at once instead of being presented
+    VideoFrame frame;
+    while(!decoder.isFinished() || decoder.m_queue.size())
+    {
+        if(decoder.getNextFrame(frame))
+            ++frame_count;
+        else
+            QThread::usleep(100);
+    }
+    return frame_count;
+}
+
+double DecodeBenchmark::measureSeek(QueuedVideoDecoder & decoder, int time_ms)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // the same steps as Engine::seek in the paused state
+    decoder.stop();
+    decoder.clearBuffers();
+    decoder.seek(time_ms);
+    decoder.start();
+    decoder.wait(true);
+
+    return timer.nsecsElapsed() / 1000000.0;
+}
@@ -0,0 +1,102 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef DECODEBENCHMARK_H
+#define DECODEBENCHMARK_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+#include "clipGenerator.h"
+
+class QueuedVideoDecoder;
+
+//! Measures the video decoding pipeline on locally encoded clips, without a window or an audio device.
+/*!
+ * \brief Frames are taken from the QueuedVideoDecoder queue as soon as they are there, instead of being presented,
+ * so the results show the throughput of the demuxing, decoding and conversion to images.
+ * Besides the decoding speed the results hold the conversion time per frame, the times to the first frame and to the
+ * buffered pre-roll of a headless Engine starting a clip, the latencies of seeks as done by Engine::seek,
+ * the allocations per frame and the peak memory. Starts failing to show a frame are counted, not timed.
+ */
+class DecodeBenchmark CC_CXX11_FINAL
+{
+public:
+    //! Clip measured by the benchmark.
+    struct Case
+    {
+        //! Name of the case in the report.
+        QString m_name;
+        //! Parameters of the clip.
+        ClipGenerator::Options m_options;
+    };
+
+public:
+    /*!
+     * \param work_folder folder for the generated clips
+     * \param iterations count of the measurements of each case
+     */
+    DecodeBenchmark(const QString & work_folder, int iterations);
+
+public:
+    //! Returns the default cases, skipping the codecs missing in the linked libav* build.
+    static QList<Case> getDefaultCases();
+
+    //! Runs the cases and returns their results.
+    QJsonArray run(const QList<Case> & cases);
+
+private:
+    //! Measures decoding of a clip.
+    QJsonObject measure(const Case & benchmark_case, const QString & path);
+
+    //! Starts the playback of a clip on an Engine without a widget and returns the time until its first frame is decoded.
+    /*!
+     * The steps are the ones of opening a file in the player, Engine::init and Engine::start, which waits for the first frame.
+     * The parsing of the file is left out, the parser benchmark measures it.
+     * \param preroll_time time until the pre-roll is buffered and the playback runs, NaN if it is not buffered in time
+     * \return time in milliseconds, NaN if the clip can not be played
+     */
+    static double measureFirstFrame(const QString & path, double & preroll_time);
+
+    //! Decodes the opened clip as fast as possible and returns the count of the frames.
+    static int decodeAll(QueuedVideoDecoder & decoder);
+
+    //! Seeks in the opened clip and returns the time until the first frame at the target is decoded, in milliseconds.
+    static double measureSeek(QueuedVideoDecoder & decoder, int time_ms);
+
+private:
+    //! Folder for the generated clips.
+    QString m_work_folder;
+    //! Count of the measurements of each case.
+    int m_iterations;
+};
+
+#endif // DECODEBENCHMARK_H
@@ -0,0 +1,169 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "exportBenchmark.h"
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QtDebug>
+
+#include <algorithm>
+
+#include "benchmarkCommon.h"
+#include "clipExporter.h"
+#include "ffmpeg.h"
+
+ExportBenchmark::ExportBenchmark(const QString & work_folder, int iterations)
+    : m_work_folder(work_folder)
+    , m_iterations(std::max(1, iterations))
+{
+}
+
+QList<ExportBenchmark::Case> ExportBenchmark::getDefaultCases()
+{
+    static const char * const sc_codecs[] = { "mpeg4", "libx264" };
+
+    QList<Case> cases;
+    for(const char * codec : sc_codecs)
+    {
+        if(!ClipGenerator::isAvailable(codec))
+        {
+            qWarning() << "Skipping" << codec << "clips, the encoder is not available";
+            continue;
+        }
+
+        Case benchmark_case;
+        benchmark_case.m_options.m_codec = codec;
+        benchmark_case.m_options.m_width = 1920;
+        benchmark_case.m_options.m_height = 1080;
+        benchmark_case.m_options.m_gop_size = 25;
+        benchmark_case.m_options.m_frame_count = 1000;
+        benchmark_case.m_name = QString("%1_1080p_gop25").arg(codec);
+        cases.append(benchmark_case);
+    }
+    return cases;
+}
+
+QJsonArray ExportBenchmark::run(const QList<Case> & cases)
+{
+    QJsonArray results;
+    for(auto it = cases.begin(), end = cases.end(); it != end; ++it)
+    {
+        QString path = m_work_folder + "/" + it->m_name + ".mp4";
+        if(!ClipGenerator::generate(path, it->m_options))
+            continue;
+
+        results.append(measure(*it, path));
+
+        QFile::remove(path);
+    }
+    return results;
+}
+
+QJsonObject ExportBenchmark::measure(const Case & benchmark_case, const QString & path)
+{
+    const int duration_ms = benchmark_case.m_options.m_frame_count * 1000 / benchmark_case.m_options.m_fps;
+    // the range starts between two sync frames, so the clip starts earlier
+    const int start_ms = duration_ms / 4 + 500 / benchmark_case.m_options.m_fps;
+    const int end_ms = duration_ms * 3 / 4;
+    const QString clip_path = m_work_folder + "/" + benchmark_case.m_name + "_clip.mp4";
+
+    QList<double> export_times;
+    qint64 clip_size = 0;
+    double clip_duration = -1;
+    for(int i = 0; i < m_iterations; ++i)
+    {
+        QFile::remove(clip_path);
+
+        QElapsedTimer timer;
+        timer.start();
+        if(!exportClip(path, clip_path, start_ms, end_ms))
+        {
+            qWarning() << "Failed to export" << clip_path;
+            break;
+        }
+        export_times.append(timer.nsecsElapsed() / 1000000.0);
+
+        clip_size = QFileInfo(clip_path).size();
+        clip_duration = getDuration(clip_path);
+    }
+    QFile::remove(clip_path);
+
+    double time = BenchmarkCommon::median(export_times);
+    double megabytes_per_second = (time > 0) ? clip_size / 1048576.0 * 1000.0 / time : 0.0;
+
+    QJsonObject result;
+    result["case"] = benchmark_case.m_name;
+    result["mode"] = QString("export");
+    result["codec"] = benchmark_case.m_options.m_codec;
+    result["width"] = benchmark_case.m_options.m_width;
+    result["height"] = benchmark_case.m_options.m_height;
+    result["gop_size"] = benchmark_case.m_options.m_gop_size;
+    result["file_size"] = QFileInfo(path).size();
+    result["clip_size"] = clip_size;
+    result["range_ms"] = end_ms - start_ms;
+    result["clip_duration_ms"] = clip_duration;
+    result["iterations"] = export_times.size();
+    result["time_ms"] = time;
+    result["mb_per_s"] = megabytes_per_second;
+    result["gb_per_min"] = megabytes_per_second * 60.0 / 1024.0;
+    return result;
+}
+
+bool ExportBenchmark::exportClip(const QString & path, const QString & clip_path, int start_ms, int end_ms)
+{
+    ClipExporter exporter;
+    QEventLoop loop;
+    bool success = false;
+    QObject::connect(&exporter, &ClipExporter::finished, &loop, [&](bool finished_successfully)
+    {
+        success = finished_successfully;
+        loop.quit();
+    });
+
+    // without a parse the sync frame is found by the demuxer
+    if(!exporter.start(path, clip_path, start_ms, end_ms, SampleIndex()))
+        return false;
+    loop.exec();
+    exporter.cancel();
+    return success;
+}
+
+double ExportBenchmark::getDuration(const QString & path)
+{
+    AVFormatContext * context = nullptr;
+    if(avformat_open_input(&context, path.toUtf8().data(), nullptr, nullptr) != 0)
+        return -1;
+
+    double duration = -1;
+    if(avformat_find_stream_info(context, nullptr) >= 0 && context->duration != AV_NOPTS_VALUE)
+        duration = context->duration / 1000.0;
+    avformat_close_input(&context);
+    return duration;
+}
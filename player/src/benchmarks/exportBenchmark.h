@@ -0,0 +1,89 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef EXPORTBENCHMARK_H
+#define EXPORTBENCHMARK_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+#include "clipGenerator.h"
+
+//! Measures the lossless clip export on locally encoded clips.
+/*!
+ * \brief The middle half of every clip is exported by ClipExporter on the decode pool, as done by the player.
+ * The results hold the export time, the throughput in megabytes of the written clip per second
+ * and the duration of the clip, which starts at the sync frame before the range.
+ */
+class ExportBenchmark CC_CXX11_FINAL
+{
+public:
+    //! Clip measured by the benchmark.
+    struct Case
+    {
+        //! Name of the case in the report.
+        QString m_name;
+        //! Parameters of the clip.
+        ClipGenerator::Options m_options;
+    };
+
+public:
+    /*!
+     * \param work_folder folder for the generated and the exported clips
+     * \param iterations count of the measurements of each case
+     */
+    ExportBenchmark(const QString & work_folder, int iterations);
+
+public:
+    //! Returns the default cases, skipping the codecs missing in the linked libav* build.
+    static QList<Case> getDefaultCases();
+
+    //! Runs the cases and returns their results.
+    QJsonArray run(const QList<Case> & cases);
+
+private:
+    //! Measures exporting a clip.
+    QJsonObject measure(const Case & benchmark_case, const QString & path);
+
+    //! Exports a range of a clip and waits until it is written.
+    static bool exportClip(const QString & path, const QString & clip_path, int start_ms, int end_ms);
+
+    //! Returns the duration of a clip in milliseconds, or -1 if it cannot be opened.
+    static double getDuration(const QString & path);
+
+private:
+    //! Folder for the generated and the exported clips.
+    QString m_work_folder;
+    //! Count of the measurements of each case.
+    int m_iterations;
+};
+
+#endif // EXPORTBENCHMARK_H
@@ -0,0 +1,156 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "parserBenchmark.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QtDebug>
+
+#include <algorithm>
+
+#include "benchmarkCommon.h"
+#include "mediaParser.h"
+#include "parseIndex.h"
+
+ParserBenchmark::ParserBenchmark(const QString & work_folder, int iterations)
+    : m_work_folder(work_folder)
+    , m_iterations(std::max(1, iterations))
+{
+}
+
+QList<ParserBenchmark::Case> ParserBenchmark::getDefaultCases()
+{
+    QList<Case> cases;
+
+    Case short_segment;
+    short_segment.m_name = "short_segment";
+    short_segment.m_options.m_fragment_count = 10;
+    short_segment.m_options.m_is_surveillance = true;
+    cases.append(short_segment);
+
+    // an hour of 25 fps video in one second fragments
+    Case long_segment;
+    long_segment.m_name = "long_segment";
+    long_segment.m_options.m_fragment_count = 3600;
+    long_segment.m_options.m_samples_per_fragment = 25;
+    long_segment.m_options.m_sample_duration = 3600;
+    long_segment.m_options.m_is_surveillance = true;
+    cases.append(long_segment);
+
+    Case multi_track;
+    multi_track.m_name = "multi_track";
+    multi_track.m_options.m_fragment_count = 600;
+    multi_track.m_options.m_track_count = 4;
+    multi_track.m_options.m_is_surveillance = true;
+    cases.append(multi_track);
+
+    Case large_sample_table;
+    large_sample_table.m_name = "large_sample_table";
+    large_sample_table.m_options.m_fragment_count = 10;
+    large_sample_table.m_options.m_sample_table_size = 1000000;
+    cases.append(large_sample_table);
+
+    Case signed_export;
+    signed_export.m_name = "signed_export";
+    signed_export.m_options.m_fragment_count = 600;
+    signed_export.m_options.m_signature_count = 64;
+    signed_export.m_options.m_is_surveillance = true;
+    cases.append(signed_export);
+
+    return cases;
+}
+
+QJsonArray ParserBenchmark::run(const QList<Case> & cases)
+{
+    QJsonArray results;
+    for(auto it = cases.begin(), end = cases.end(); it != end; ++it)
+    {
+        QString path = m_work_folder + "/" + it->m_name + ".mp4";
+        SyntheticFileGenerator generator(it->m_options);
+        if(!generator.generate(path))
+        {
+            qWarning() << "Failed to generate" << path;
+            continue;
+        }
+
+        results.append(measure(*it, path, generator.getBoxCount(), Full));
+        results.append(measure(*it, path, generator.getBoxCount(), Fast));
+        results.append(measure(*it, path, generator.getBoxCount(), Indexed));
+
+        ParseIndex::remove(path);
+        QFile::remove(path);
+    }
+    return results;
+}
+
+QJsonObject ParserBenchmark::measure(const Case & benchmark_case, const QString & path, int box_count, Mode mode)
+{
+    static const char * sc_mode_names[] = { "full", "fast", "indexed" };
+
+    if(mode == Indexed)
+    {
+        // the index is written by a full parse
+        ParseIndex::remove(path);
+        MediaParser parser;
+        parser.addFile(path);
+    }
+
+    QList<double> times;
+    qint64 peak_memory = -1;
+    for(int i = 0; i < m_iterations; ++i)
+    {
+        if(mode != Indexed)
+            ParseIndex::remove(path);
+
+        BenchmarkCommon::resetPeakMemory();
+        QElapsedTimer timer;
+        timer.start();
+        {
+            MediaParser parser;
+            parser.setFastOpen(mode == Fast);
+            parser.addFile(path);
+        }
+        times.append(timer.nsecsElapsed() / 1000000.0);
+        peak_memory = std::max(peak_memory, BenchmarkCommon::getPeakMemory());
+    }
+
+    double time = BenchmarkCommon::median(times);
+
+    QJsonObject result;
+    result["case"] = benchmark_case.m_name;
+    result["mode"] = QString(sc_mode_names[mode]);
+    result["file_size"] = QFileInfo(path).size();
+    result["boxes"] = box_count;
+    result["iterations"] = m_iterations;
+    result["time_ms"] = time;
+    result["time_min_ms"] = *std::min_element(times.begin(), times.end());
+    result["boxes_per_second"] = (time > 0) ? box_count * 1000.0 / time : 0.0;
+    result["peak_memory_kb"] = peak_memory;
+    return result;
+}
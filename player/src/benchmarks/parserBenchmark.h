@@ -0,0 +1,92 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef PARSERBENCHMARK_H
+#define PARSERBENCHMARK_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+#include "syntheticFileGenerator.h"
+
+//! Measures the parser throughput on synthetic files.
+/*!
+ * \brief Every case is generated once and opened through MediaParser::addFile in three modes:
+ * "full" parses and checks the file without a parse index, "fast" parses it in the fast open mode,
+ * "indexed" reopens it from the parse index saved by a full parse.
+ * Each result holds the median time, the peak memory and the boxes parsed per second.
+ */
+class ParserBenchmark CC_CXX11_FINAL
+{
+public:
+    //! Synthetic file measured by the benchmark.
+    struct Case
+    {
+        //! Name of the case in the report.
+        QString m_name;
+        //! Shape of the file.
+        SyntheticFileGenerator::Options m_options;
+    };
+
+public:
+    /*!
+     * \param work_folder folder for the generated files
+     * \param iterations count of the measurements of each case and mode
+     */
+    ParserBenchmark(const QString & work_folder, int iterations);
+
+public:
+    //! Returns the default cases.
+    static QList<Case> getDefaultCases();
+
+    //! Runs the cases and returns their results.
+    QJsonArray run(const QList<Case> & cases);
+
+private:
+    //! Opening mode of the measured files.
+    enum Mode
+    {
+        Full,
+        Fast,
+        Indexed
+    };
+
+    //! Measures opening of a file.
+    QJsonObject measure(const Case & benchmark_case, const QString & path, int box_count, Mode mode);
+
+private:
+    //! Folder for the generated files.
+    QString m_work_folder;
+    //! Count of the measurements of each case and mode.
+    int m_iterations;
+};
+
+#endif // PARSERBENCHMARK_H
@@ -0,0 +1,200 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "activityCurve.h"
+
+#include <QByteArray>
+#include <QByteArrayMatcher>
+
+#include <algorithm>
+
+#include "defines.h"
+#include "fileView.h"
+
+namespace
+{
+    //! Handler type of the video tracks.
+    const uint32_t sc_video_handler = 'vide';
+    //! Handler type of the metadata tracks.
+    const uint32_t sc_metadata_handler = 'meta';
+    //! Every object of an ONVIF metadata frame has an id, whatever namespace prefix the stream uses.
+    const char * const sc_object_pattern = "Object ObjectId=";
+}
+
+ActivityCurve::ActivityCurve()
+{
+}
+
+ActivityCurve ActivityCurve::compute(const SampleIndex & sample_index, const std::shared_ptr<FileView> & view)
+{
+    ActivityCurve curve;
+    QVector<quint64> video_bytes;
+    bool has_video = false;
+    for(auto it = sample_index.begin(), end = sample_index.end(); it != end; ++it)
+    {
+        const TrackSampleIndex & track = it.value();
+        if(track.isEmpty() || track.getTimescale() == 0)
+            continue;
+
+        int seconds = int(track.getDurationMs() / 1000) + 1;
+        if(seconds > curve.size())
+        {
+            curve.m_bytes.resize(seconds);
+            curve.m_objects.resize(seconds);
+            video_bytes.resize(seconds);
+        }
+
+        bool is_video = (track.getHandlerType() == sc_video_handler);
+        has_video = has_video || is_video;
+        curve.addBytes(track, is_video ? &video_bytes : nullptr);
+    }
+
+    // files indexed without handler types are measured by all their bytes
+    curve.setActivity(has_video ? video_bytes : curve.m_bytes);
+
+    int position = 0;
+    while(view && curve.countObjects(sample_index, *view, position))
+    {
+    }
+    return curve;
+}
+
+bool ActivityCurve::countObjects(const SampleIndex & sample_index, FileView & view, int & position)
+{
+    int step_end = position + ACTIVITY_METADATA_STEP_SAMPLES;
+    int track_begin = 0;
+    for(auto it = sample_index.begin(), end = sample_index.end(); it != end; ++it)
+    {
+        const TrackSampleIndex & track = it.value();
+        if(track.getHandlerType() != sc_metadata_handler || track.isEmpty() || track.getTimescale() == 0)
+            continue;
+
+        int track_end = track_begin + track.size();
+        if(track_end > position)
+            addObjects(track, view, std::max(position, track_begin) - track_begin, std::min(step_end, track_end) - track_begin);
+        // the step ends within the samples, the next one finds out if there are more
+        if(track_end >= step_end)
+        {
+            position = step_end;
+            return true;
+        }
+        track_begin = track_end;
+    }
+
+    position = track_begin;
+    return false;
+}
+
+void ActivityCurve::addBytes(const TrackSampleIndex & track, QVector<quint64> * video_bytes)
+{
+    QVector<quint64> inter_bytes;
+    if(video_bytes != nullptr)
+        inter_bytes.resize(video_bytes->size());
+
+    bool has_inter_samples = false;
+    for(int i = 0, count = track.size(); i < count; ++i)
+    {
+        int second = getSecond(track, i);
+        m_bytes[second] += track.getSize(i);
+        if(video_bytes != nullptr && !track.isSync(i))
+        {
+            inter_bytes[second] += track.getSize(i);
+            has_inter_samples = true;
+        }
+    }
+
+    if(video_bytes == nullptr)
+        return;
+
+    // tracks of sync samples only are measured by all their samples
+    for(int i = 0, count = track.size(); !has_inter_samples && i < count; ++i)
+    {
+        inter_bytes[getSecond(track, i)] += track.getSize(i);
+    }
+    for(int second = 0, count = inter_bytes.size(); second < count; ++second)
+    {
+        (*video_bytes)[second] += inter_bytes.at(second);
+    }
+}
+
+void ActivityCurve::addObjects(const TrackSampleIndex & track, FileView & view, int begin, int end)
+{
+    QByteArrayMatcher matcher(sc_object_pattern);
+    QByteArray data;
+    for(int i = begin; i < end; ++i)
+    {
+        uint32_t size = track.getSize(i);
+        if(size == 0 || size > ACTIVITY_METADATA_SAMPLE_MAX)
+            continue;
+
+        data.resize(size);
+        qint64 read = view.read((qint64)track.getOffset(i), data.data(), size);
+        if(read <= 0)
+            continue;
+        data.resize(read);
+
+        int objects = 0;
+        for(qsizetype position = matcher.indexIn(data); position >= 0; position = matcher.indexIn(data, position + 1))
+        {
+            ++objects;
+        }
+
+        // consecutive samples describe the same objects again, so they are not added up
+        int & second_objects = m_objects[getSecond(track, i)];
+        second_objects = std::max(second_objects, objects);
+    }
+}
+
+void ActivityCurve::setActivity(const QVector<quint64> & video_bytes)
+{
+    m_activity.fill(0.0f, video_bytes.size());
+
+    QVector<quint64> busy_seconds;
+    busy_seconds.reserve(video_bytes.size());
+    for(auto it = video_bytes.begin(), end = video_bytes.end(); it != end; ++it)
+    {
+        if(*it != 0)
+            busy_seconds.append(*it);
+    }
+    if(busy_seconds.isEmpty())
+        return;
+
+    auto median = busy_seconds.begin() + busy_seconds.size() / 2;
+    std::nth_element(busy_seconds.begin(), median, busy_seconds.end());
+    double median_bytes = (double)*median;
+
+    for(int second = 0, count = video_bytes.size(); second < count; ++second)
+    {
+        double ratio = video_bytes.at(second) / median_bytes;
+        m_activity[second] = (float)std::min(1.0, std::max(0.0, (ratio - 1.0) / (ACTIVITY_FULL_RATIO - 1.0)));
+    }
+}
+
+int ActivityCurve::getSecond(const TrackSampleIndex & track, int index)
+{
+    return int(track.toMs(track.getDecodeTime(index) - track.getDecodeTime(0)) / 1000);
+}
@@ -0,0 +1,107 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef ACTIVITYCURVE_H
+#define ACTIVITYCURVE_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QVector>
+
+#include <memory>
+
+#include "sampleIndex.h"
+
+class FileView;
+
+//! Per second bitrate and activity of a file, computed from its sample index without decoding.
+/*!
+ * \brief Motion makes the predicted frames of a video track larger, so the bytes of the non-sync video samples
+ * of a second compared to the median second tell the activity. Sync samples are left out, as their size
+ * follows the group of pictures rather than the scene. Tracks with sync samples only are measured as they are.
+ * The objects of the metadata tracks are counted in the sample data, which is read but not parsed.
+ * Seconds are counted from the first sample of each track.
+ */
+class ActivityCurve CC_CXX11_FINAL
+{
+public:
+    ActivityCurve();
+
+    //! Computes the curve of a file.
+    /*!
+     * \param sample_index sample index of the file
+     * \param view view of the file to count the metadata objects in, or nullptr to skip counting
+     */
+    static ActivityCurve compute(const SampleIndex & sample_index, const std::shared_ptr<FileView> & view = std::shared_ptr<FileView>());
+
+    //! Counts the objects of the next metadata samples, up to ACTIVITY_METADATA_STEP_SAMPLES of them.
+    /*!
+     * The curve has to be computed from the same sample index without a view.
+     * \param position position among the samples of all the metadata tracks, moved past the counted samples
+     * \return false, if all the samples are counted
+     */
+    bool countObjects(const SampleIndex & sample_index, FileView & view, int & position);
+
+public:
+    //! Get count of the seconds.
+    int size() const { return m_bytes.size(); }
+
+    //! Checks if there are no seconds.
+    bool isEmpty() const { return m_bytes.isEmpty(); }
+
+    //! Get bytes of all tracks in a second.
+    quint64 getBytes(int second) const { return m_bytes.at(second); }
+
+    //! Get activity of a second from 0 for a still scene to 1.
+    float getActivity(int second) const { return m_activity.at(second); }
+
+    //! Get the largest count of objects in a metadata sample of a second.
+    int getObjectCount(int second) const { return m_objects.at(second); }
+
+private:
+    //! Adds the sizes of the samples of a track to the seconds, the video ones also to the video bytes.
+    void addBytes(const TrackSampleIndex & track, QVector<quint64> * video_bytes);
+
+    //! Counts the objects of a range of the samples of a metadata track.
+    void addObjects(const TrackSampleIndex & track, FileView & view, int begin, int end);
+
+    //! Computes the activity from the video bytes of the seconds.
+    void setActivity(const QVector<quint64> & video_bytes);
+
+    //! Get second of a sample from the first sample of its track.
+    static int getSecond(const TrackSampleIndex & track, int index);
+
+private:
+    //! Bytes of all tracks per second.
+    QVector<quint64> m_bytes;
+    //! Activity per second.
+    QVector<float> m_activity;
+    //! Metadata objects per second.
+    QVector<int> m_objects;
+};
+
+#endif // ACTIVITYCURVE_H
@@ -0,0 +1,676 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "decodePool.h"
+
+#include <QMutexLocker>
+
+#include "queueBudget.h"
+
+namespace
+{
+    //! Function run by the pool until it returns false.
+    class DecodeTask CC_CXX11_FINAL : public DecodeJob
+    {
+    public:
+        explicit DecodeTask(const std::function<bool()> & step)
+            : m_step(step)
+        {}
+
+        virtual bool needsDecoding() const CC_CXX11_OVERRIDE { return true; }
+
+        virtual bool decodeStep() CC_CXX11_OVERRIDE
+        {
+            return m_step();
+        }
+
+    private:
+        //! Step to run.
+        std::function<bool()> m_step;
+    };
+}
+
+void DecodeJob::notifyReady()
+{
+    DecodePool * pool = m_pool;
+    if(pool != nullptr)
+        pool->notify(this);
+}
+
+DecodePool::Worker::Worker(DecodePool & pool, int index)
+    : m_jobs(0)
+    , m_priority(QThread::NormalPriority)
+    , m_pool(pool)
+    , m_index(index)
+{
+    for(int i = 0; i < PriorityCount; ++i)
+        m_counts[i] = 0;
+}
+
+void DecodePool::Worker::run()
+{
+    while(!isInterruptionRequested())
+        m_pool.runNext(m_index);
+}
+
+DecodePool & DecodePool::instance()
+{
+    static DecodePool pool;
+    //decoders stop at a full budget without work, they are queued again when it frees up
+    static const bool budget_watched = [] ()
+    {
+        QueueBudget::instance().setAvailableCallback([] () { pool.notifyAll(); });
+        return true;
+    }();
+    Q_UNUSED(budget_watched);
+    return pool;
+}
+
+DecodePool::DecodePool(int thread_count)
+    : m_waiters(0)
+    , m_idle(0)
+    , m_steps(0)
+    , m_steals(0)
+    , m_background_steps(0)
+{
+    if(thread_count < 2)
+        thread_count = qMax(2, QThread::idealThreadCount());
+
+    //the threads look into the queues of each other, so all of them exist before the first one starts
+    for(int i = 0; i < thread_count; ++i)
+    {
+        m_workers.emplace_back(new Worker(*this, i));
+        m_workers.back()->setObjectName("Decode pool " + QString::number(i));
+    }
+    //the priority follows the class of each step
+    for(auto it = m_workers.begin(), end = m_workers.end(); it != end; ++it)
+        (*it)->start(QThread::NormalPriority);
+}
+
+DecodePool::~DecodePool()
+{
+    //all threads are interrupted at once, so they do not end one after another
+    for(auto it = m_workers.begin(), end = m_workers.end(); it != end; ++it)
+        (*it)->requestInterruption();
+    {
+        QMutexLocker locker(&m_idle_mutex);
+        m_work_ready.wakeAll();
+    }
+    for(auto it = m_workers.begin(), end = m_workers.end(); it != end; ++it)
+        (*it)->wait();
+    m_workers.clear();
+    qDeleteAll(m_entries);
+}
+
+void DecodePool::add(DecodeJob * job, Priority priority, int rank)
+{
+    bool queued = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        Entry * entry = m_entries.value(job);
+        if(entry == nullptr)
+            entry = insert(job, priority, rank);
+        else
+            reprioritize(entry, priority, rank);
+        queued = wake(entry, true);
+    }
+    if(queued)
+        wakeWorker();
+}
+
+void DecodePool::remove(DecodeJob * job)
+{
+    QMutexLocker locker(&m_mutex);
+    Entry * entry = m_entries.value(job);
+    if(entry == nullptr)
+        return;
+
+    //the job is not queued again after its running step
+    entry->m_canceled = true;
+    ++m_waiters;
+    for(;;)
+    {
+        Worker & worker = lockWorker(*entry);
+        int state = entry->m_state;
+        if(state == QueuedState)
+        {
+            dequeue(worker, entry);
+            entry->m_state = IdleState;
+        }
+        worker.m_mutex.unlock();
+
+        if(state != RunningState)
+            break;
+        m_step_done.wait(&m_mutex);
+
+        //another removal of the job may end meanwhile
+        entry = m_entries.value(job);
+        if(entry == nullptr)
+        {
+            --m_waiters;
+            return;
+        }
+    }
+    --m_waiters;
+
+    --m_workers[entry->m_worker]->m_jobs;
+    m_entries.remove(job);
+    job->m_pool = nullptr;
+    delete entry;
+}
+
+void DecodePool::setPriority(DecodeJob * job, Priority priority, int rank)
+{
+    QMutexLocker locker(&m_mutex);
+    Entry * entry = m_entries.value(job);
+    if(entry != nullptr)
+        reprioritize(entry, priority, rank);
+}
+
+bool DecodePool::contains(const DecodeJob * job) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_entries.contains(job);
+}
+
+bool DecodePool::isFinished(const DecodeJob * job) const
+{
+    QMutexLocker locker(&m_mutex);
+    const Entry * entry = m_entries.value(job);
+    return entry != nullptr && entry->m_state == FinishedState;
+}
+
+void DecodePool::notify(const DecodeJob * job)
+{
+    bool queued = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        Entry * entry = m_entries.value(job);
+        queued = entry != nullptr && wake(entry, false);
+    }
+    if(queued)
+        wakeWorker();
+}
+
+void DecodePool::notifyAll()
+{
+    bool queued = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        for(auto it = m_entries.begin(), end = m_entries.end(); it != end; ++it)
+            queued = wake(it.value(), false) || queued;
+    }
+    if(queued &&
+       m_idle > 0)
+    {
+        QMutexLocker locker(&m_idle_mutex);
+        m_work_ready.wakeAll();
+    }
+}
+
+void DecodePool::run(const std::function<void()> & task, const void * owner, Priority priority)
+{
+    runSteps([task] ()
+    {
+        task();
+        return false;
+    }, owner, priority);
+}
+
+void DecodePool::runSteps(const std::function<bool()> & step, const void * owner, Priority priority)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        std::unique_ptr<DecodeJob> job(new DecodeTask(step));
+        Entry * entry = insert(job.get(), priority, 0);
+        entry->m_task = std::move(job);
+        entry->m_owner = owner;
+        wake(entry, false);
+    }
+    wakeWorker();
+}
+
+void DecodePool::cancel(const void * owner)
+{
+    QMutexLocker locker(&m_mutex);
+    QList<Entry *> entries = m_entries.values();
+    for(auto it = entries.begin(), end = entries.end(); it != end; ++it)
+    {
+        Entry * entry = *it;
+        if(!entry->m_task ||
+           entry->m_owner != owner)
+            continue;
+
+        entry->m_canceled = true;
+        Worker & worker = lockWorker(*entry);
+        int state = entry->m_state;
+        if(state == QueuedState)
+            dequeue(worker, entry);
+        worker.m_mutex.unlock();
+
+        //a running step is not interrupted, the task is removed when it ends
+        if(state == QueuedState ||
+           state == IdleState)
+            erase(entry);
+    }
+}
+
+void DecodePool::wait(const void * owner)
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_waiters;
+    for(;;)
+    {
+        bool running = false;
+        for(auto it = m_entries.begin(), end = m_entries.end(); it != end; ++it)
+        {
+            const Entry * entry = it.value();
+            int state = entry->m_state;
+            //a finished task is removed by the thread that ran it
+            if(entry->m_task &&
+               entry->m_owner == owner &&
+               (state == RunningState || state == FinishedState))
+            {
+                running = true;
+                break;
+            }
+        }
+
+        if(!running)
+            break;
+        m_step_done.wait(&m_mutex);
+    }
+    --m_waiters;
+}
+
+void DecodePool::runNext(int index)
+{
+    Worker & worker = *m_workers[index];
+    bool background = false;
+    Entry * entry = take(index, &background);
+    if(entry == nullptr)
+    {
+        QMutexLocker locker(&m_idle_mutex);
+        //a job queued after the check wakes the thread, as it sees the thread waiting
+        ++m_idle;
+        if(!hasWork() &&
+           !worker.isInterruptionRequested())
+            m_work_ready.wait(&m_idle_mutex);
+        --m_idle;
+        return;
+    }
+
+    //the work of the job is checked without any lock of the pool, as the job takes its own locks
+    int priority = entry->m_canceled ? -1 : readyPriority(*entry);
+    if(priority < 0)
+    {
+        if(background)
+            releaseBackground();
+        if(entry->m_canceled)
+            finishStep(entry, true, index);
+        else
+            park(entry, index);
+        return;
+    }
+
+    //a playback job may only have prefetch work, and a job waiting for a background slot may need decoding again
+    if((priority >= PrefetchPriority) != background)
+    {
+        if(background)
+        {
+            releaseBackground();
+            background = false;
+        }
+        else if(reserveBackground())
+        {
+            background = true;
+        }
+        else
+        {
+            //the job waits in the prefetch class until a background slot is free
+            worker.m_mutex.lock();
+            push(worker, entry, PrefetchPriority);
+            worker.m_mutex.unlock();
+            wakeWaiters();
+            return;
+        }
+    }
+
+    QThread::Priority thread_priority = background ? QThread::LowPriority : QThread::HighPriority;
+    if(worker.m_priority != thread_priority)
+    {
+        worker.m_priority = thread_priority;
+        worker.setPriority(thread_priority);
+    }
+
+    entry->m_last_run = ++m_steps;
+    bool result = entry->m_job->decodeStep();
+
+    if(background)
+        releaseBackground();
+    finishStep(entry, result, index);
+}
+
+DecodePool::Entry * DecodePool::take(int index, bool * background)
+{
+    int count = getThreadCount();
+    for(;;)
+    {
+        //one thread is kept free of background work for the playback
+        int below = m_background_steps < count - 1 ? (int)PriorityCount : (int)PrefetchPriority;
+        int own = queuedClass(index, below);
+
+        //a job of another thread is only stolen if it goes before the own ones, so streams keep their thread
+        int victim = index, victim_class = own < 0 ? below : own;
+        for(int i = 1; i < count; ++i)
+        {
+            int other = (index + i) % count;
+            int priority = queuedClass(other, victim_class);
+            if(priority >= 0)
+            {
+                victim = other;
+                victim_class = priority;
+            }
+        }
+        if(victim == index &&
+           own < 0)
+            return nullptr;
+
+        Worker & worker = *m_workers[victim];
+        QMutexLocker locker(&worker.m_mutex);
+        Entry * next = nullptr;
+        for(auto it = worker.m_queue.begin(), end = worker.m_queue.end(); it != end; ++it)
+        {
+            if((*it)->m_class < below &&
+               (next == nullptr || goesBefore(**it, *next)))
+                next = *it;
+        }
+        //the queue changed since the counts were read
+        if(next == nullptr)
+            continue;
+
+        *background = next->m_class >= PrefetchPriority;
+        if(*background &&
+           !reserveBackground())
+            continue;
+
+        dequeue(worker, next);
+        next->m_state = RunningState;
+        next->m_notified = false;
+        if(victim != index)
+        {
+            //the stolen job stays with this thread
+            next->m_worker = index;
+            --worker.m_jobs;
+            ++m_workers[index]->m_jobs;
+            ++m_steals;
+        }
+        return next;
+    }
+}
+
+int DecodePool::queuedClass(int index, int below) const
+{
+    const Worker & worker = *m_workers[index];
+    for(int i = 0; i < below; ++i)
+    {
+        if(worker.m_counts[i] > 0)
+            return i;
+    }
+    return -1;
+}
+
+int DecodePool::readyPriority(const Entry & entry) const
+{
+    if(entry.m_job->needsDecoding())
+        return entry.m_priority;
+    //work ahead of the consumer of a job never goes before the playback
+    if(entry.m_job->needsPrefetching())
+        return qMax((int)entry.m_priority, (int)PrefetchPriority);
+    return -1;
+}
+
+void DecodePool::finishStep(Entry * entry, bool result, int index)
+{
+    Worker & worker = *m_workers[index];
+    bool erased = false;
+    bool queued = false;
+    worker.m_mutex.lock();
+    if(entry->m_task &&
+       (!result || entry->m_canceled))
+    {
+        entry->m_state = FinishedState;
+        erased = true;
+    }
+    else if(!result)
+    {
+        entry->m_state = FinishedState;
+    }
+    else if(entry->m_canceled)
+    {
+        entry->m_state = IdleState;
+    }
+    else
+    {
+        push(worker, entry, entry->m_priority);
+        //other threads without work take the further jobs of the thread
+        queued = worker.m_queue.size() > 1;
+    }
+    worker.m_mutex.unlock();
+
+    //a removal may delete the entry once its state is set, only a finished task is left to this thread
+    if(erased)
+    {
+        QMutexLocker locker(&m_mutex);
+        erase(entry);
+        m_step_done.wakeAll();
+        return;
+    }
+    if(queued)
+        wakeWorker();
+    wakeWaiters();
+}
+
+void DecodePool::park(Entry * entry, int index)
+{
+    Worker & worker = *m_workers[index];
+    worker.m_mutex.lock();
+    //a notification during the check may come after the work was checked
+    if(entry->m_notified)
+        push(worker, entry, entry->m_priority);
+    else
+        entry->m_state = IdleState;
+    worker.m_mutex.unlock();
+    wakeWaiters();
+}
+
+bool DecodePool::goesBefore(const Entry & entry, const Entry & other)
+{
+    if(entry.m_class != other.m_class)
+        return entry.m_class < other.m_class;
+    if(entry.m_rank != other.m_rank)
+        return entry.m_rank > other.m_rank;
+    return entry.m_last_run < other.m_last_run;
+}
+
+bool DecodePool::hasWork() const
+{
+    int below = m_background_steps < getThreadCount() - 1 ? (int)PriorityCount : (int)PrefetchPriority;
+    for(int i = 0; i < getThreadCount(); ++i)
+    {
+        if(queuedClass(i, below) >= 0)
+            return true;
+    }
+    return false;
+}
+
+bool DecodePool::reserveBackground()
+{
+    int steps = m_background_steps;
+    while(steps < getThreadCount() - 1)
+    {
+        if(m_background_steps.compare_exchange_weak(steps, steps + 1))
+            return true;
+    }
+    return false;
+}
+
+void DecodePool::releaseBackground()
+{
+    --m_background_steps;
+    //a background job waiting for the slot is taken by a thread without work
+    for(auto it = m_workers.begin(), end = m_workers.end(); it != end; ++it)
+    {
+        if((*it)->m_counts[PrefetchPriority] > 0 ||
+           (*it)->m_counts[IndexingPriority] > 0)
+        {
+            wakeWorker();
+            return;
+        }
+    }
+}
+
+void DecodePool::wakeWorker()
+{
+    if(m_idle > 0)
+    {
+        QMutexLocker locker(&m_idle_mutex);
+        m_work_ready.wakeOne();
+    }
+}
+
+void DecodePool::wakeWaiters()
+{
+    if(m_waiters > 0)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_step_done.wakeAll();
+    }
+}
+
+DecodePool::Worker & DecodePool::lockWorker(const Entry & entry) const
+{
+    //the thread of a job changes only under the mutex of the thread it is stolen from
+    for(;;)
+    {
+        int index = entry.m_worker;
+        Worker & worker = *m_workers[index];
+        worker.m_mutex.lock();
+        if(entry.m_worker == index)
+            return worker;
+        worker.m_mutex.unlock();
+    }
+}
+
+void DecodePool::push(Worker & worker, Entry * entry, int priority)
+{
+    entry->m_state = QueuedState;
+    entry->m_class = priority;
+    entry->m_notified = false;
+    worker.m_queue.append(entry);
+    ++worker.m_counts[priority];
+}
+
+void DecodePool::dequeue(Worker & worker, Entry * entry)
+{
+    worker.m_queue.removeOne(entry);
+    --worker.m_counts[entry->m_class];
+}
+
+bool DecodePool::wake(Entry * entry, bool restart)
+{
+    Worker & worker = lockWorker(*entry);
+    if(entry->m_canceled)
+    {
+        worker.m_mutex.unlock();
+        return false;
+    }
+
+    bool queued = false;
+    int state = entry->m_state;
+    if(state == IdleState ||
+            (restart && state == FinishedState))
+    {
+        push(worker, entry, entry->m_priority);
+        queued = true;
+    }
+    else if(state == RunningState)
+    {
+        entry->m_notified = true;
+    }
+    else if(state == QueuedState &&
+            entry->m_class != entry->m_priority)
+    {
+        //a job waiting for a background slot may need decoding meanwhile
+        dequeue(worker, entry);
+        push(worker, entry, entry->m_priority);
+        queued = true;
+    }
+    worker.m_mutex.unlock();
+    return queued;
+}
+
+void DecodePool::reprioritize(Entry * entry, Priority priority, int rank)
+{
+    Worker & worker = lockWorker(*entry);
+    entry->m_priority = priority;
+    entry->m_rank = rank;
+    if(entry->m_state == QueuedState)
+    {
+        dequeue(worker, entry);
+        push(worker, entry, priority);
+    }
+    worker.m_mutex.unlock();
+}
+
+DecodePool::Entry * DecodePool::insert(DecodeJob * job, Priority priority, int rank)
+{
+    //a new job goes to the thread with the fewest jobs
+    int index = 0;
+    for(int i = 1; i < getThreadCount(); ++i)
+    {
+        if(m_workers[i]->m_jobs < m_workers[index]->m_jobs)
+            index = i;
+    }
+
+    Entry * entry = new Entry();
+    entry->m_job = job;
+    entry->m_priority = priority;
+    entry->m_rank = rank;
+    entry->m_worker = index;
+    ++m_workers[index]->m_jobs;
+    m_entries.insert(job, entry);
+    job->m_pool = this;
+    return entry;
+}
+
+void DecodePool::erase(Entry * entry)
+{
+    --m_workers[entry->m_worker]->m_jobs;
+    m_entries.remove(entry->m_job);
+    delete entry;
+}
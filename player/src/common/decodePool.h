@@ -0,0 +1,346 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef DECODEPOOL_H
+#define DECODEPOOL_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class DecodePool;
+
+//! Decoding work run by the threads of a DecodePool.
+class DecodeJob
+{
+public:
+    DecodeJob()
+        : m_pool(nullptr)
+    {}
+
+    virtual ~DecodeJob() {}
+
+    //! Checks if the job has work to do, called by the pool before a step, never under a lock of the pool.
+    virtual bool needsDecoding() const = 0;
+
+    //! Checks if the job has work ahead of its consumer, e.g. opening the following file, it runs as prefetch work.
+    virtual bool needsPrefetching() const { return false; }
+
+    //! Does a bounded part of the work.
+    /*!
+     * \return false, if the job is finished, e.g. at the end of its file
+     */
+    virtual bool decodeStep() = 0;
+
+protected:
+    //! Tells the pool the job may have work again, e.g. after its frames are consumed.
+    /*!
+     * A job without work is not checked again by the pool until it is notified or added again.
+     */
+    void notifyReady();
+
+private:
+    friend class DecodePool;
+
+    //! Pool the job is added to.
+    std::atomic<DecodePool *> m_pool;
+};
+
+//! Fixed set of threads running the steps of the decoding jobs and the background tasks of the player.
+/*!
+ * \brief Each thread has its own queue of jobs with work, guarded by its own mutex, so a stream stays on the same
+ * thread between its steps and picking a job locks one queue only. A thread takes the job of its queue that goes first
+ * by priority class, by rank within the class and by the time of its last step, so jobs of the same class and rank
+ * take turns. It steals a job from the queue of another thread, if that one holds a more urgent class or the own
+ * queue is empty. Prefetch and indexing work runs on all threads but one, so playback always has a thread.
+ * A job without work leaves the queues until it notifies the pool, threads without work sleep until a job is queued.
+ * Threads run playback steps at high priority and background steps at low priority.
+ */
+class DecodePool CC_CXX11_FINAL
+{
+public:
+    //! Classes of work, from the most urgent one.
+    enum Priority
+    {
+        //! Decoding for the audio output, a late frame is heard.
+        AudioPriority,
+        //! Decoding of presented video.
+        VideoPriority,
+        //! Work ahead of the playback.
+        PrefetchPriority,
+        //! Background parsing and indexing of files.
+        IndexingPriority,
+        //! Count of the classes.
+        PriorityCount
+    };
+
+public:
+    //! Pool shared by the whole player, its jobs are notified when the queue memory budget frees up.
+    static DecodePool & instance();
+
+    //! Creates the pool, a thread count below 2 uses one thread per core, but at least two threads.
+    explicit DecodePool(int thread_count = 0);
+
+    ~DecodePool();
+
+public:
+    //! Adds a job or restarts a finished one, higher ranks go first within a priority class.
+    void add(DecodeJob * job, Priority priority, int rank = 0);
+
+    //! Removes a job, waiting for its running step to end.
+    void remove(DecodeJob * job);
+
+    //! Changes the priority of a job.
+    void setPriority(DecodeJob * job, Priority priority, int rank = 0);
+
+    //! Checks if a job is added.
+    bool contains(const DecodeJob * job) const;
+
+    //! Checks if a job finished.
+    bool isFinished(const DecodeJob * job) const;
+
+    //! Queues a job without work, so its work is checked again.
+    void notify(const DecodeJob * job);
+
+    //! Queues all jobs without work, e.g. when a resource they wait for frees up.
+    void notifyAll();
+
+    //! Runs a function once, the pool removes the task when it is done.
+    /*!
+     * \param task function to run
+     * \param owner object the task belongs to, to cancel its tasks
+     * \param priority class of the task
+     */
+    void run(const std::function<void()> & task, const void * owner, Priority priority = IndexingPriority);
+
+    //! Runs a function step by step until it returns false, the pool removes the task when it is done.
+    /*!
+     * Long work, e.g. parsing a whole file, is split into steps, so it holds a thread for a bounded time only
+     * and can be canceled between the steps.
+     * \param step function doing a bounded part of the work, returning false when the work is done
+     * \param owner object the task belongs to, to cancel its tasks
+     * \param priority class of the task
+     */
+    void runSteps(const std::function<bool()> & step, const void * owner, Priority priority = IndexingPriority);
+
+    //! Drops the tasks of an owner, the running steps end without waiting for them.
+    void cancel(const void * owner);
+
+    //! Waits for the running steps of the tasks of an owner to end, the owner has to wait before it is destroyed.
+    void wait(const void * owner);
+
+    //! Get count of the threads.
+    int getThreadCount() const { return (int)m_workers.size(); }
+
+    //! Get count of the jobs taken over from the queue of another thread.
+    quint64 getStealCount() const { return m_steals; }
+
+private:
+    //! Scheduling states of a job.
+    enum State
+    {
+        //! Without work, waiting for a notification.
+        IdleState,
+        //! In the queue of its thread.
+        QueuedState,
+        //! A step runs.
+        RunningState,
+        //! The last step returned false.
+        FinishedState
+    };
+
+    //! Job with its scheduling state.
+    struct Entry
+    {
+        Entry()
+            : m_job(nullptr)
+            , m_owner(nullptr)
+            , m_priority(IndexingPriority)
+            , m_rank(0)
+            , m_state(IdleState)
+            , m_worker(0)
+            , m_class(IndexingPriority)
+            , m_notified(false)
+            , m_canceled(false)
+            , m_last_run(0)
+        {}
+
+        //! Job.
+        DecodeJob * m_job;
+        //! Job owned by the pool, set for the tasks.
+        std::unique_ptr<DecodeJob> m_task;
+        //! Owner of a task.
+        const void * m_owner;
+        //! Priority class of the job.
+        std::atomic<int> m_priority;
+        //! Rank of the job within its class.
+        std::atomic<int> m_rank;
+        //! Scheduling state, changed under the mutex of the thread of the job.
+        std::atomic<int> m_state;
+        //! Thread the job belongs to, changed under the mutex of the thread when the job is stolen.
+        std::atomic<int> m_worker;
+        //! Class the job is queued in, guarded by the mutex of its thread.
+        int m_class;
+        //! Is the job notified while its step runs, guarded by the mutex of its thread.
+        bool m_notified;
+        //! Is the job removed or the task canceled, a running step ends first.
+        std::atomic<bool> m_canceled;
+        //! Order of the last step of the job, the job waiting longest goes first among equal priorities.
+        quint64 m_last_run;
+    };
+
+    //! Thread of the pool with its queue of jobs.
+    class Worker CC_CXX11_FINAL : public QThread
+    {
+    public:
+        Worker(DecodePool & pool, int index);
+
+        //! Guards the queue.
+        QMutex m_mutex;
+        //! Jobs with work, queued on the thread.
+        QList<Entry *> m_queue;
+        //! Count of the queued jobs of each class, read without the mutex to find work.
+        std::atomic<int> m_counts[PriorityCount];
+        //! Count of the jobs belonging to the thread.
+        std::atomic<int> m_jobs;
+        //! Priority the thread runs at, used by the thread only.
+        QThread::Priority m_priority;
+
+    protected:
+        virtual void run() CC_CXX11_OVERRIDE;
+
+    private:
+        //! Pool of the thread.
+        DecodePool & m_pool;
+        //! Index of the thread in the pool.
+        int m_index;
+    };
+
+private:
+    DecodePool(const DecodePool &);
+    DecodePool & operator =(const DecodePool &);
+
+    //! Runs a step of the next job of a thread, waits for work if there is none.
+    void runNext(int index);
+
+    //! Takes the next job of a thread, stealing it from another thread if needed.
+    /*!
+     * \param index index of the thread
+     * \param background set if the job is taken from a background class, its slot is reserved then
+     * \return nullptr, if no job can be taken
+     */
+    Entry * take(int index, bool * background);
+
+    //! Get the most urgent class queued on a thread below a class, -1 if none. Does not lock the thread.
+    int queuedClass(int index, int below) const;
+
+    //! Get the class the next step of a job runs in, -1 if the job has nothing to do. Called without a lock.
+    int readyPriority(const Entry & entry) const;
+
+    //! Ends the step of a job on the thread running it.
+    void finishStep(Entry * entry, bool result, int index);
+
+    //! Leaves a job without work out of the queues, unless it is notified meanwhile.
+    void park(Entry * entry, int index);
+
+    //! Checks if a job goes before another one.
+    static bool goesBefore(const Entry & entry, const Entry & other);
+
+    //! Checks if a thread would find work now.
+    bool hasWork() const;
+
+    //! Reserves a slot for a background step, false if all slots are taken.
+    bool reserveBackground();
+
+    //! Frees the slot of a background step.
+    void releaseBackground();
+
+    //! Wakes a thread waiting for work, if there is one.
+    void wakeWorker();
+
+    //! Wakes the threads waiting for the steps of jobs, if there are any.
+    void wakeWaiters();
+
+    //! Locks the thread of a job and returns it.
+    Worker & lockWorker(const Entry & entry) const;
+
+    //! Queues a job on its locked thread in a class.
+    void push(Worker & worker, Entry * entry, int priority);
+
+    //! Removes a queued job from its locked thread.
+    void dequeue(Worker & worker, Entry * entry);
+
+    //! Queues an idle job, or a finished one on restart, or marks a running one as notified. Has to be called under the mutex.
+    /*!
+     * \return true, if the job is queued
+     */
+    bool wake(Entry * entry, bool restart);
+
+    //! Changes the priority of a job, moving it to its new class if it is queued. Has to be called under the mutex.
+    void reprioritize(Entry * entry, Priority priority, int rank);
+
+    //! Adds an idle entry for a job on the thread with the fewest jobs, has to be called under the mutex.
+    Entry * insert(DecodeJob * job, Priority priority, int rank);
+
+    //! Removes the entry of a task and deletes it, has to be called under the mutex.
+    void erase(Entry * entry);
+
+private:
+    //! Guards the registry of the jobs, never taken to pick a job.
+    mutable QMutex m_mutex;
+    //! Entries of the jobs.
+    QHash<const DecodeJob *, Entry *> m_entries;
+    //! Wakes the removal waiting for the step of a job, used with the mutex.
+    QWaitCondition m_step_done;
+    //! Count of the threads waiting for the steps of jobs.
+    std::atomic<int> m_waiters;
+    //! Guards the sleep of the threads without work.
+    QMutex m_idle_mutex;
+    //! Wakes the threads waiting for work.
+    QWaitCondition m_work_ready;
+    //! Count of the threads waiting for work.
+    std::atomic<int> m_idle;
+    //! Count of the steps run.
+    std::atomic<quint64> m_steps;
+    //! Count of the jobs stolen.
+    std::atomic<quint64> m_steals;
+    //! Count of the prefetch and indexing steps running.
+    std::atomic<int> m_background_steps;
+    //! Threads of the pool.
+    std::vector<std::unique_ptr<Worker> > m_workers;
+};
+
+#endif // DECODEPOOL_H
@@ -30,14 +30,20 @@
 
 #include <QObject>
 
-//! After that count DecodeThread will sent queryFilled() signal.
+//! After that count DecodeThread will sent queryFilled() signal, unless the queue is full earlier.
 #define MINIMUM_FRAMES_IN_QUEUE_TO_START 20
 
-//! DecodeThread will try to keep query size in this value.
-#define MINIMUM_FRAMES_IN_QUEUE 30
+//! DecodeThread keeps at least this count of frames in the queue, even above the memory budget.
+#define MINIMUM_FRAMES_IN_QUEUE 4
 
-//! Sleep timeout for DecodeThread.
-#define DECODE_SLEEP_TIMEOUT 50
+//! DecodeThread stops filling the queue when it holds this playing time in ms.
+#define QUEUE_TARGET_DURATION 1500
+
+//! Default memory budget of all decoder queues in MB.
+#define QUEUE_MEMORY_BUDGET 256
+
+//! Count of packets a decoder reads in one step on the decode pool, before the next job takes its turn.
+#define DECODE_STEP_PACKETS 32
 
 //! Extentions for Open File dialog.
 #define AVAILIBLE_EXTENTIONS "Video (*.mp4 *.mov);;All (*.*)"
@@ -48,6 +54,12 @@
 //! Sleep timeout for decoders threads.
 #define WAIT_TREAD 50
 
+//! Playing time in ms the video and audio queues hold before the playback starts, the first frame is shown earlier.
+#define START_PREROLL_DURATION 250
+
+//! Interval the engine checks the pre-roll in ms.
+#define PREROLL_CHECK_INTERVAL 10
+
 //! Backstep for seeking in ms.
 #define SEEK_BACKSTEP 6400
 
@@ -81,6 +93,153 @@
 //! Folder for certificates
 #define CERTIFICATES_FOLDER "KnownCerts"
 
+//! Folder for parse index files
+#define PARSE_INDEX_FOLDER "ParseIndex"
+
+//! Count of leading bytes of a file hashed to detect, that a file was replaced behind its parse index.
+#define PARSE_INDEX_HEADER_SIZE 65536
+
+//! Size of the parse index folder in MB, the indexes used longest ago are removed above it.
+#define PARSE_INDEX_MAX_SIZE 256
+
+//! Days a parse index is kept without being used.
+#define PARSE_INDEX_MAX_AGE 90
+
+//! Folder for thumbnail cache files
+#define THUMBNAIL_CACHE_FOLDER "Thumbnails"
+
+//! Size of the thumbnail cache folder in MB, the caches used longest ago are removed above it.
+#define THUMBNAIL_CACHE_MAX_SIZE 512
+
+//! Days a thumbnail cache is kept without being used.
+#define THUMBNAIL_CACHE_MAX_AGE 90
+
+//! JPEG quality of the cached thumbnails.
+#define THUMBNAIL_CACHE_QUALITY 80
+
+//! Width of the thumbnails in pixels.
+#define THUMBNAIL_WIDTH 160
+
+//! Maximum count of the thumbnails of a file.
+#define THUMBNAIL_MAX_COUNT 256
+
+//! Shortest time between the thumbnails of a file in ms.
+#define THUMBNAIL_MIN_INTERVAL 2000
+
+//! Count of packets read after a seek to find a keyframe, before the thumbnail is given up.
+#define THUMBNAIL_READ_PACKETS 256
+
+//! Height of the thumbnail strip above the timeline slider in pixels.
+#define THUMBNAIL_STRIP_HEIGHT 36
+
+//! Delay between a change notification of a followed file and parsing of the appended data in ms.
+#define FOLLOW_UPDATE_DELAY 200
+
+//! Polling interval of a followed file in ms, for file systems not reporting the changes.
+#define FOLLOW_POLL_INTERVAL 2000
+
+//! Time in ms the decoders wait for new data at the end of a followed file before treating it as finished.
+#define FOLLOW_READ_TIMEOUT 10000
+
+//! Count of bytes the parser and the demuxers read from a file view at once.
+#define FILE_VIEW_BLOCK_SIZE 65536
+
+//! Count of bytes read at once from files on network shares and slow disks.
+#define READ_AHEAD_BLOCK_SIZE 262144
+
+//! Count of blocks read ahead of a sequential reader.
+#define READ_AHEAD_BLOCKS 8
+
+//! Count of blocks used by the readers of a file kept for backward seeks, besides the ones read ahead.
+#define READ_AHEAD_CACHE_BLOCKS 16
+
+//! Count of readers of a file whose blocks read ahead are kept until they are used, e.g. the parser and the demuxers.
+#define READ_AHEAD_READERS 4
+
+//! Count of threads reading ahead, each one reads another file.
+#define READ_AHEAD_THREADS 4
+
+//! Count of the top level boxes of a file, up to which the file structure is shown expanded.
+#define PARSER_EXPAND_BOX_LIMIT 64
+
+//! Count of the list entries of a box property shown at once.
+#define PROPERTY_PAGE_SIZE 256
+
+//! Count of bytes in a line of a hex dump of a box property.
+#define PROPERTY_HEX_DUMP_LINE_SIZE 16
+
+//! Update interval of the statistics overlay in ms.
+#define STATISTICS_OVERLAY_INTERVAL 500
+
+//! Margin of the statistics overlay in pixels.
+#define STATISTICS_OVERLAY_MARGIN 8
+
+//! Filter of the exported clips.
+#define CLIP_FILE_FILTER "MP4 (*.mp4)"
+
+//! Filter of the statistics files.
+#define STATISTICS_FILE_FILTER "JSON (*.json)"
+
+//! Count of spans kept for each thread by the trace recorder.
+#define TRACE_BUFFER_SIZE 32768
+
+//! Filter of the trace files.
+#define TRACE_FILE_FILTER "Chrome trace (*.json)"
+
+//! Interval of the GUI thread heartbeat in ms.
+#define STALL_HEARTBEAT_INTERVAL 10
+
+//! GUI thread stall longer than a frame in ms.
+#define STALL_FRAME_THRESHOLD 16
+
+//! GUI thread stall logged as a long one in ms.
+#define STALL_LONG_THRESHOLD 100
+
+//! GUI thread blocking reported by the watchdog thread while it lasts in ms.
+#define STALL_HANG_THRESHOLD 1000
+
+//! Check interval of the stall watchdog thread in ms.
+#define STALL_WATCHDOG_INTERVAL 100
+
+//! Maximum count of packets kept for a track not being played, to switch to it without seeking.
+#define TRACK_CACHE_PACKETS 1024
+
+//! Maximum count of frames of the last played track decoded in advance.
+#define TRACK_PREDECODE_FRAMES 64
+
+//! Maximum count of the tiles of a mosaic.
+#define MOSAIC_MAX_TILES 16
+
+//! Interval of the mosaic presentation in ms.
+#define MOSAIC_TICK_INTERVAL 10
+
+//! Count of packets a mosaic tile reads in one decoding step, before another tile takes its turn.
+#define MOSAIC_STEP_PACKETS 8
+
+//! Mosaic tile showing a frame older than this behind the clock in ms is late.
+#define MOSAIC_LATE_THRESHOLD 200
+
+//! Interval of the mosaic load checks in ms.
+#define MOSAIC_LOAD_INTERVAL 1000
+
+//! Count of the load checks without late tiles before a degraded mosaic tile decodes all frames again.
+#define MOSAIC_RECOVER_CHECKS 5
+
+//! Seek step of the mosaic arrow keys in ms.
+#define MOSAIC_SEEK_STEP 10000
+
+//! Ratio of the video bytes of a second to the median second, which is shown as full activity on the timeline.
+#define ACTIVITY_FULL_RATIO 4.0
+
+//! Metadata samples larger than this in bytes are not searched for objects.
+#define ACTIVITY_METADATA_SAMPLE_MAX 1048576
+
+//! Count of the metadata samples read in a step of the background activity computation.
+#define ACTIVITY_METADATA_STEP_SAMPLES 256
+
+//! Height of the activity heatmap under the timeline slider in pixels.
+#define ACTIVITY_BAR_HEIGHT 8
+
 //! Binary format filter
 #define BINARY_FORMAT QObject::tr("Binary format (*.der)")
 
@@ -0,0 +1,233 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "fileView.h"
+
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStorageInfo>
+
+#include <cstring>
+
+#include "defines.h"
+#include "readAhead.h"
+
+std::shared_ptr<FileView> FileView::open(const QString & path)
+{
+    static QMutex s_mutex;
+    static QHash<QString, std::weak_ptr<FileView> > s_views;
+
+    QFileInfo file_info(path);
+    QString key = file_info.absoluteFilePath();
+
+    QMutexLocker locker(&s_mutex);
+    std::shared_ptr<FileView> view = s_views.value(key).lock();
+    //a file replaced or rewritten since it was viewed gets a new view, even if its size is the same
+    if(view &&
+       view->getSize() == file_info.size() &&
+       view->getModified() == file_info.lastModified())
+        return view;
+
+    view.reset(new FileView(path));
+    if(!view->m_file.isOpen())
+        return nullptr;
+
+    for(auto it = s_views.begin(); it != s_views.end(); )
+    {
+        if(it->expired())
+            it = s_views.erase(it);
+        else
+            ++it;
+    }
+    s_views[key] = view;
+    return view;
+}
+
+FileView::FileView(const QString & path)
+    : m_path(path)
+    , m_file(path)
+    , m_data(nullptr)
+    , m_size(0)
+{
+    if(!m_file.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+        return;
+
+    m_size = m_file.size();
+    m_modified = m_file.fileTime(QFileDevice::FileModificationTime);
+    if(m_size > 0 && !isOnSlowStorage(path))
+        m_data = reinterpret_cast<const char *>(m_file.map(0, m_size));
+    if(m_data == nullptr)
+        m_read_ahead.reset(new ReadAhead(m_file, m_size));
+}
+
+FileView::~FileView()
+{
+    //the read-ahead reads the file until it is destroyed
+    m_read_ahead.reset();
+    if(m_data != nullptr)
+        m_file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(m_data)));
+}
+
+qint64 FileView::read(qint64 position, char * data, qint64 size, ReadAhead::Cursor * cursor) const
+{
+    if(position < 0 || size < 0)
+        return -1;
+    if(position >= m_size)
+        return 0;
+
+    size = qMin(size, m_size - position);
+    if(m_data != nullptr)
+    {
+        memcpy(data, m_data + position, size);
+        return size;
+    }
+
+    return m_read_ahead->read(position, data, size, cursor);
+}
+
+bool FileView::isOnSlowStorage(const QString & path)
+{
+    static const char * const sc_file_systems[] =
+    {
+        //network shares
+        "cifs", "smb2", "smb3", "smbfs", "nfs", "nfs4", "9p", "afs", "davfs", "fuse.sshfs",
+        //file systems of removable drives, fuseblk is left out, as local NTFS disks are mounted through it
+        "vfat", "msdos", "exfat", "fat", "fat32"
+    };
+
+    QString absolute_path = QFileInfo(path).absoluteFilePath();
+    if(absolute_path.startsWith("//") || absolute_path.startsWith("\\\\"))
+        return true;
+
+    QByteArray file_system = QStorageInfo(absolute_path).fileSystemType().toLower();
+    for(const char * name : sc_file_systems)
+    {
+        if(file_system == name)
+            return true;
+    }
+    return false;
+}
+
+FileViewBuffer::FileViewBuffer(const std::shared_ptr<FileView> & view)
+    : m_view(view)
+    , m_buffer_position(0)
+{
+    //mapped data is read in place
+    if(m_view->getData() != nullptr)
+    {
+        char * data = const_cast<char *>(m_view->getData());
+        setg(data, data, data + m_view->getSize());
+    }
+}
+
+FileViewBuffer::int_type FileViewBuffer::underflow()
+{
+    if(gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+    if(m_view->getData() != nullptr)
+        return traits_type::eof();
+
+    qint64 position = getPosition();
+    m_buffer.resize(FILE_VIEW_BLOCK_SIZE);
+    qint64 size = m_view->read(position, m_buffer.data(), (qint64)m_buffer.size(), &m_cursor);
+    if(size <= 0)
+        return traits_type::eof();
+
+    m_buffer_position = position;
+    setg(m_buffer.data(), m_buffer.data(), m_buffer.data() + size);
+    return traits_type::to_int_type(*gptr());
+}
+
+FileViewBuffer::pos_type FileViewBuffer::seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode)
+{
+    qint64 position = offset;
+    if(direction == std::ios_base::cur)
+        position += getPosition();
+    else if(direction == std::ios_base::end)
+        position += m_view->getSize();
+    return seekpos(pos_type(position), mode);
+}
+
+FileViewBuffer::pos_type FileViewBuffer::seekpos(pos_type position, std::ios_base::openmode mode)
+{
+    qint64 target = (qint64)position;
+    if((mode & std::ios_base::in) == 0 ||
+       target < 0 ||
+       target > m_view->getSize())
+        return pos_type(off_type(-1));
+
+    if(m_view->getData() != nullptr)
+    {
+        setg(eback(), eback() + target, egptr());
+        return position;
+    }
+
+    //the buffered data is kept, if the position is in it
+    if(target >= m_buffer_position &&
+       target <= m_buffer_position + (egptr() - eback()))
+        setg(eback(), eback() + (target - m_buffer_position), egptr());
+    else
+    {
+        m_buffer_position = target;
+        setg(nullptr, nullptr, nullptr);
+    }
+    return position;
+}
+
+qint64 FileViewBuffer::getPosition() const
+{
+    return m_buffer_position + (gptr() - eback());
+}
+
+FileViewDevice::FileViewDevice(const std::shared_ptr<FileView> & view)
+    : m_view(view)
+{
+}
+
+bool FileViewDevice::open(OpenMode mode)
+{
+    if((mode & QIODevice::WriteOnly) != 0)
+        return false;
+    return QIODevice::open(mode | QIODevice::Unbuffered);
+}
+
+qint64 FileViewDevice::size() const
+{
+    return m_view->getSize();
+}
+
+qint64 FileViewDevice::readData(char * data, qint64 max_size)
+{
+    return m_view->read(pos(), data, max_size, &m_cursor);
+}
+
+qint64 FileViewDevice::writeData(const char *, qint64)
+{
+    return -1;
+}
@@ -0,0 +1,174 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef FILEVIEW_H
+#define FILEVIEW_H
+
+#include "crosscompilation_cxx11.h"
+#include "crosscompilation_inttypes.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QIODevice>
+#include <QString>
+
+#include <istream>
+#include <memory>
+#include <streambuf>
+#include <vector>
+
+#include "readAhead.h"
+
+//! Read-only view of a file, shared by the parser and the demuxers of the player.
+/*!
+ * \brief The file is memory mapped, so the data the parser read stays in memory for the demuxers,
+ * which read the same boxes again on opening. Views are shared while they are in use: opening a file
+ * with a view returns that view. Files on network shares and removable drives, and files that cannot be mapped,
+ * are read through a ReadAhead instead, as page faults read them in small synchronous pieces.
+ * Files still being written are not opened through views, as their size changes.
+ */
+class FileView CC_CXX11_FINAL
+{
+public:
+    //! Returns the view of a file, nullptr if the file cannot be opened.
+    static std::shared_ptr<FileView> open(const QString & path);
+
+    ~FileView();
+
+public:
+    //! Returns the path of the file.
+    const QString & getPath() const { return m_path; }
+
+    //! Returns the size of the file when it was opened.
+    qint64 getSize() const { return m_size; }
+
+    //! Returns the modification time of the file when it was opened.
+    const QDateTime & getModified() const { return m_modified; }
+
+    //! Returns the mapped data, nullptr if the file is not mapped.
+    const char * getData() const { return m_data; }
+
+    //! Copies data from a position of the file.
+    /*!
+     * \param cursor position of the reader for reading ahead of it, nullptr for a single read
+     * \return count of the bytes copied, 0 at the end of the file, -1 on errors
+     */
+    qint64 read(qint64 position, char * data, qint64 size, ReadAhead::Cursor * cursor = nullptr) const;
+
+private:
+    explicit FileView(const QString & path);
+
+    FileView(const FileView &);
+    FileView & operator =(const FileView &);
+
+    //! Checks if a file is on a network share or a removable drive.
+    static bool isOnSlowStorage(const QString & path);
+
+private:
+    //! Path of the file.
+    QString m_path;
+    //! Opened file.
+    QFile m_file;
+    //! Mapped data.
+    const char * m_data;
+    //! Reads a file, which is not mapped.
+    std::unique_ptr<ReadAhead> m_read_ahead;
+    //! Size of the file.
+    qint64 m_size;
+    //! Modification time of the file.
+    QDateTime m_modified;
+};
+
+//! Stream buffer reading a FileView, so the parser reads a file through a std::istream.
+class FileViewBuffer CC_CXX11_FINAL : public std::streambuf
+{
+public:
+    explicit FileViewBuffer(const std::shared_ptr<FileView> & view);
+
+protected:
+    virtual int_type underflow() CC_CXX11_OVERRIDE;
+
+    virtual pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode) CC_CXX11_OVERRIDE;
+
+    virtual pos_type seekpos(pos_type position, std::ios_base::openmode mode) CC_CXX11_OVERRIDE;
+
+private:
+    //! Returns the position of the next character in the file.
+    qint64 getPosition() const;
+
+private:
+    //! View read.
+    std::shared_ptr<FileView> m_view;
+    //! Data of a view, which is not mapped.
+    std::vector<char> m_buffer;
+    //! Position of the buffer in the file.
+    qint64 m_buffer_position;
+    //! Position of the stream for reading ahead.
+    ReadAhead::Cursor m_cursor;
+};
+
+//! Input stream of a FileView.
+class FileViewStream CC_CXX11_FINAL : public std::istream
+{
+public:
+    explicit FileViewStream(const std::shared_ptr<FileView> & view)
+        : std::istream(nullptr)
+        , m_buffer(view)
+    {
+        rdbuf(&m_buffer);
+    }
+
+private:
+    //! Buffer of the stream.
+    FileViewBuffer m_buffer;
+};
+
+//! Read-only device of a FileView, for readers of a QIODevice.
+class FileViewDevice CC_CXX11_FINAL : public QIODevice
+{
+public:
+    explicit FileViewDevice(const std::shared_ptr<FileView> & view);
+
+public:
+    //! Opens the device, only for reading, the view buffers the data already.
+    virtual bool open(OpenMode mode) CC_CXX11_OVERRIDE;
+
+    virtual qint64 size() const CC_CXX11_OVERRIDE;
+
+protected:
+    virtual qint64 readData(char * data, qint64 max_size) CC_CXX11_OVERRIDE;
+
+    virtual qint64 writeData(const char * data, qint64 size) CC_CXX11_OVERRIDE;
+
+private:
+    //! View read.
+    std::shared_ptr<FileView> m_view;
+    //! Position of the device for reading ahead.
+    ReadAhead::Cursor m_cursor;
+};
+
+#endif // FILEVIEW_H
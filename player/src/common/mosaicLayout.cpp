@@ -0,0 +1,101 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "mosaicLayout.h"
+
+#include <QtGlobal>
+
+MosaicLayout::MosaicLayout(int count, const QRect & area, double aspect)
+    : m_count(qMax(0, count))
+    , m_area(area)
+    , m_columns(0)
+    , m_rows(0)
+{
+    if(m_count == 0)
+        return;
+    if(aspect <= 0.0)
+        aspect = 16.0 / 9.0;
+
+    double best_scale = -1.0;
+    for(int columns = 1; columns <= m_count; ++columns)
+    {
+        int rows = (m_count + columns - 1) / columns;
+        //more columns than needed for the rows leave empty cells only
+        if(columns > 1 && (m_count + columns - 2) / (columns - 1) == rows)
+            continue;
+
+        double cell_width = (double)m_area.width() / columns;
+        double cell_height = (double)m_area.height() / rows;
+        double scale = qMin(cell_width / aspect, cell_height);
+        if(scale > best_scale)
+        {
+            best_scale = scale;
+            m_columns = columns;
+            m_rows = rows;
+        }
+    }
+}
+
+QRect MosaicLayout::getTileRect(int index) const
+{
+    if(index < 0 || index >= m_count)
+        return QRect();
+
+    int column = index % m_columns, row = index / m_columns;
+    int left = cellStart(column, m_columns, m_area.width()), right = cellStart(column + 1, m_columns, m_area.width());
+    int top = cellStart(row, m_rows, m_area.height()), bottom = cellStart(row + 1, m_rows, m_area.height());
+    return QRect(m_area.left() + left, m_area.top() + top, right - left, bottom - top);
+}
+
+QSize MosaicLayout::getTileSize() const
+{
+    if(m_count == 0)
+        return QSize();
+    return QSize(m_area.width() / m_columns, m_area.height() / m_rows);
+}
+
+int MosaicLayout::getTileAt(const QPoint & point) const
+{
+    if(m_count == 0 || !m_area.contains(point))
+        return -1;
+
+    int column = 0, row = 0;
+    while(column + 1 < m_columns && cellStart(column + 1, m_columns, m_area.width()) <= point.x() - m_area.left())
+        ++column;
+    while(row + 1 < m_rows && cellStart(row + 1, m_rows, m_area.height()) <= point.y() - m_area.top())
+        ++row;
+
+    int index = row * m_columns + column;
+    return (index < m_count) ? index : -1;
+}
+
+int MosaicLayout::cellStart(int index, int parts, int length)
+{
+    //the first length % parts cells are a pixel larger
+    int size = length / parts, remainder = length % parts;
+    return index * size + qMin(index, remainder);
+}
@@ -0,0 +1,81 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef MOSAICLAYOUT_H
+#define MOSAICLAYOUT_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QPoint>
+#include <QRect>
+#include <QSize>
+
+//! Grid of the tiles of a mosaic view.
+/*!
+ * \brief The column count is chosen so the tiles of the given aspect ratio fitted into the grid cells are the largest.
+ * Cells share the area evenly, the remainder pixels go to the first columns and rows.
+ */
+class MosaicLayout CC_CXX11_FINAL
+{
+public:
+    //! Creates the grid of count tiles in an area, aspect is the width to height ratio of the tiles.
+    MosaicLayout(int count = 0, const QRect & area = QRect(), double aspect = 16.0 / 9.0);
+
+    //! Get count of the tiles.
+    int getCount() const { return m_count; }
+
+    //! Get count of the columns.
+    int getColumns() const { return m_columns; }
+
+    //! Get count of the rows.
+    int getRows() const { return m_rows; }
+
+    //! Get rectangle of the cell of a tile.
+    QRect getTileRect(int index) const;
+
+    //! Get size of the smallest cell, the frames are scaled to fit into it.
+    QSize getTileSize() const;
+
+    //! Get index of the tile at a point, -1 if none.
+    int getTileAt(const QPoint & point) const;
+
+private:
+    //! Get start of a cell in a length split into parts.
+    static int cellStart(int index, int parts, int length);
+
+private:
+    //! Count of the tiles.
+    int m_count;
+    //! Area of the grid.
+    QRect m_area;
+    //! Count of the columns.
+    int m_columns;
+    //! Count of the rows.
+    int m_rows;
+};
+
+#endif // MOSAICLAYOUT_H
@@ -28,23 +28,66 @@
 #ifndef QUEUE_H
 #define QUEUE_H
 
+#include <QDeadlineTimer>
 #include <QMutex>
 #include <QMutexLocker>
 #include <QQueue>
+#include <QWaitCondition>
+
+#include <functional>
+
+#include "queueBudget.h"
+
+//! Returns the memory occupied by a queued element.
+template<typename T>
+qint64 queueItemSize(const T& t)
+{
+    return t.size();
+}
+
+//! Queued pointers are accounted by the pointer size only.
+template<typename T>
+qint64 queueItemSize(T* const&)
+{
+    return sizeof(T*);
+}
 
 //! Template class for queue.
 template<typename T>
 class Queue
 {
 public:
-    Queue()
+    Queue() :
+        m_data_size(0),
+        m_budget(nullptr)
     {
 
     }
 
     ~Queue()
     {
+        clear();
+    }
+
+    //! Accounts the data of the queue in a memory budget, nullptr stops the accounting.
+    void setBudget(QueueBudget* budget)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if(m_budget != nullptr)
+            m_budget->add(-m_data_size);
+        m_budget = budget;
+        if(m_budget != nullptr)
+            m_budget->add(m_data_size);
+    }
 
+    //! Sets a function called after elements are taken from the queue, outside of the lock of the queue.
+    /*!
+     * Has to be set before the queue is shared, e.g. to tell the producer it may push again.
+     */
+    void setTakenCallback(const std::function<void()>& callback)
+    {
+        m_taken_callback = callback;
     }
 
     //! Put object at the end of a queue.
@@ -53,6 +96,25 @@ public:
         QMutexLocker locker(&m_mutex);
 
         m_queue.enqueue(t);
+        addDataSize(queueItemSize(t));
+        m_pushed.wakeAll();
+    }
+
+    //! Wait until the queue holds a count of elements, or a timeout passes.
+    /*!
+     * \return false, if the queue holds less elements after the timeout
+     */
+    bool waitForSize(int count, int timeout_ms)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        QDeadlineTimer deadline(timeout_ms);
+        while(m_queue.size() < count)
+        {
+            if(!m_pushed.wait(&m_mutex, deadline))
+                return m_queue.size() >= count;
+        }
+        return true;
     }
 
     //! Get head element size in bytes.
@@ -91,20 +153,40 @@ public:
         return 0;
     }
 
+    //! Get time between the head and the tail elements.
+    /*!
+     *  Currently this fuction is valid and used only for T with m_time member (Queue<VideoFrame> for example).
+     */
+    int timeSpan() const
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if(m_queue.size() < 2)
+            return 0;
+
+        return m_queue.last().m_time - m_queue.head().m_time;
+    }
+
     //! Get head element from queue.
     T pop()
     {
         QMutexLocker locker(&m_mutex);
 
         if(!m_queue.isEmpty())
-            return m_queue.dequeue();
+        {
+            T t = m_queue.dequeue();
+            addDataSize(-queueItemSize(t));
+            locker.unlock();
+            taken();
+            return t;
+        }
 
         return T();
     }
     bool empty() const { return m_queue.isEmpty(); }
 
     //! Count of elements in queue.
-    int size()
+    int size() const
     {
         QMutexLocker locker(&m_mutex);
 
@@ -112,16 +194,11 @@ public:
     }
 
     //! Size in bytes of data, stored in queue.
-    int dataSize() const
+    qint64 dataSize() const
     {
         QMutexLocker locker(&m_mutex);
 
-        int data_size = 0;
-
-        for(typename QQueue<T>::const_iterator cIter = m_queue.constBegin(); cIter != m_queue.constEnd(); ++cIter)
-            data_size += cIter->size();
-
-        return data_size;
+        return m_data_size;
     }
 
     //! Clear queue.
@@ -129,14 +206,43 @@ public:
     {
         QMutexLocker locker(&m_mutex);
 
+        if(m_queue.isEmpty())
+            return;
         m_queue.clear();
+        addDataSize(-m_data_size);
+        locker.unlock();
+        taken();
+    }
+
+private:
+    //! Calls the callback after elements are taken.
+    void taken()
+    {
+        if(m_taken_callback)
+            m_taken_callback();
+    }
+
+    //! Accounts added or removed data, the mutex has to be locked.
+    void addDataSize(qint64 data_size)
+    {
+        m_data_size += data_size;
+        if(m_budget != nullptr)
+            m_budget->add(data_size);
     }
 
 private:
     //! Qt mutext to guard queue operations.
     mutable QMutex  m_mutex;
+    //! Wakes the threads waiting for elements.
+    QWaitCondition  m_pushed;
     //! Qt queue used as container.
     QQueue<T>       m_queue;
+    //! Size in bytes of data, stored in queue.
+    qint64          m_data_size;
+    //! Budget the data is accounted in.
+    QueueBudget*    m_budget;
+    //! Called after elements are taken.
+    std::function<void()> m_taken_callback;
 };
 
 #endif // QUEUE_H
@@ -0,0 +1,77 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "queueBudget.h"
+
+#include <QDir>
+#include <QMutexLocker>
+#include <QSettings>
+
+#include "defines.h"
+
+QueueBudget & QueueBudget::instance()
+{
+    static QueueBudget budget;
+    return budget;
+}
+
+QueueBudget::QueueBudget()
+    : m_limit(qint64(QUEUE_MEMORY_BUDGET) * 1024 * 1024)
+    , m_used(0)
+{
+#ifdef _WIN32
+    QSettings settings(QDir::homePath() + WINP_APP_DATA_ROAMING + COMPANY_NAME + "/" + PRODUCT_NAME + "/" + CONFIG_FILE_NAME, QSettings::IniFormat);
+#else
+    QSettings settings(QDir::homePath() + "/." + PRODUCT_NAME + "/" + CONFIG_FILE_NAME, QSettings::IniFormat);
+#endif //UNIX
+    bool ok = false;
+    qint64 limit_mb = settings.value("queueMemoryBudgetMB").toLongLong(&ok);
+    if(ok && limit_mb > 0)
+        m_limit = limit_mb * 1024 * 1024;
+}
+
+void QueueBudget::setLimit(qint64 limit)
+{
+    qint64 previous = m_limit.exchange(limit, std::memory_order_relaxed);
+    qint64 used = getUsed();
+    if(used >= previous &&
+       used < limit)
+        available();
+}
+
+void QueueBudget::setAvailableCallback(const std::function<void()> & callback)
+{
+    QMutexLocker locker(&m_callback_mutex);
+    m_available_callback = callback;
+}
+
+void QueueBudget::available()
+{
+    QMutexLocker locker(&m_callback_mutex);
+    if(m_available_callback)
+        m_available_callback();
+}
@@ -0,0 +1,95 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef QUEUEBUDGET_H
+#define QUEUEBUDGET_H
+
+#include "crosscompilation_cxx11.h"
+#include "crosscompilation_inttypes.h"
+
+#include <QMutex>
+
+#include <atomic>
+#include <functional>
+
+//! Memory budget shared by the queues of all decoders.
+/*!
+ * \brief Queues report the bytes of the frames they hold, decoders stop filling their queues above their minimum
+ * depth when the budget is used up. So the queue depth follows the frame size: a 4K stream keeps a few frames
+ * where a CIF stream keeps seconds of them.
+ * The limit is QUEUE_MEMORY_BUDGET MB, unless the queueMemoryBudgetMB setting overrides it.
+ */
+class QueueBudget CC_CXX11_FINAL
+{
+public:
+    //! Returns the budget of the application.
+    static QueueBudget & instance();
+
+public:
+    //! Sets the limit in bytes.
+    void setLimit(qint64 limit);
+
+    //! Returns the limit in bytes.
+    qint64 getLimit() const { return m_limit.load(std::memory_order_relaxed); }
+
+    //! Returns the bytes held by the queues.
+    qint64 getUsed() const { return m_used.load(std::memory_order_relaxed); }
+
+    //! Checks if the queues may grow.
+    bool isAvailable() const { return getUsed() < getLimit(); }
+
+    //! Accounts bytes added to a queue, negative for removed ones.
+    void add(qint64 bytes)
+    {
+        qint64 used = m_used.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        if(bytes < 0 &&
+           used < getLimit() &&
+           used - bytes >= getLimit())
+            available();
+    }
+
+    //! Sets a function called when the queues may grow again, e.g. to resume the decoders stopped by the budget.
+    void setAvailableCallback(const std::function<void()> & callback);
+
+private:
+    QueueBudget();
+
+    //! Calls the callback, as the budget became available.
+    void available();
+
+private:
+    //! Limit in bytes.
+    std::atomic<qint64> m_limit;
+    //! Bytes held by the queues.
+    std::atomic<qint64> m_used;
+    //! Guards the callback.
+    QMutex m_callback_mutex;
+    //! Called when the budget becomes available.
+    std::function<void()> m_available_callback;
+};
+
+#endif // QUEUEBUDGET_H
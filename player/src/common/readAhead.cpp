@@ -0,0 +1,386 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "readAhead.h"
+
+#include <QList>
+#include <QMutexLocker>
+#include <QPair>
+#include <QThread>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "defines.h"
+
+namespace
+{
+    //! Counters of all read-aheads.
+    struct TotalStatistics
+    {
+        std::atomic<quint64> m_hits;
+        std::atomic<quint64> m_waits;
+        std::atomic<quint64> m_misses;
+        std::atomic<quint64> m_read_blocks;
+        std::atomic<quint64> m_read_bytes;
+    };
+
+    TotalStatistics s_totals;
+}
+
+class ReadAhead::Loader CC_CXX11_FINAL
+{
+public:
+    static Loader & instance()
+    {
+        static Loader loader;
+        return loader;
+    }
+
+    ~Loader()
+    {
+        for(auto it = m_workers.begin(), end = m_workers.end(); it != end; ++it)
+            (*it)->requestInterruption();
+        {
+            QMutexLocker locker(&m_mutex);
+            m_requested.wakeAll();
+        }
+        for(auto it = m_workers.begin(), end = m_workers.end(); it != end; ++it)
+            (*it)->wait();
+    }
+
+    //! Queues a block of a read-ahead to be read.
+    void request(ReadAhead * read_ahead, qint64 index)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_requests.append(qMakePair(read_ahead, index));
+        m_requested.wakeAll();
+    }
+
+    //! Drops the requests of a read-ahead and waits until its block being read is stored.
+    void cancel(ReadAhead * read_ahead)
+    {
+        QMutexLocker locker(&m_mutex);
+        for(auto it = m_requests.begin(); it != m_requests.end(); )
+        {
+            if(it->first == read_ahead)
+                it = m_requests.erase(it);
+            else
+                ++it;
+        }
+        while(m_loading.contains(read_ahead))
+            m_done.wait(&m_mutex);
+    }
+
+private:
+    //! Thread reading the requested blocks.
+    class Worker CC_CXX11_FINAL : public QThread
+    {
+    public:
+        explicit Worker(Loader & loader)
+            : m_loader(loader)
+        {}
+
+    protected:
+        virtual void run() CC_CXX11_OVERRIDE
+        {
+            m_loader.work();
+        }
+
+    private:
+        //! Loader of the thread.
+        Loader & m_loader;
+    };
+
+private:
+    Loader()
+    {
+        for(int i = 0; i < READ_AHEAD_THREADS; ++i)
+        {
+            m_workers.emplace_back(new Worker(*this));
+            m_workers.back()->setObjectName("Read-ahead " + QString::number(i));
+            m_workers.back()->start();
+        }
+    }
+
+    //! Reads the requested blocks until the thread is interrupted.
+    void work()
+    {
+        QMutexLocker locker(&m_mutex);
+        while(!QThread::currentThread()->isInterruptionRequested())
+        {
+            //a file is read by one thread at a time, its reads would wait for each other anyway
+            auto it = m_requests.begin();
+            while(it != m_requests.end() && m_loading.contains(it->first))
+                ++it;
+            if(it == m_requests.end())
+            {
+                m_requested.wait(&m_mutex);
+                continue;
+            }
+
+            QPair<ReadAhead *, qint64> request = *it;
+            m_requests.erase(it);
+            m_loading.append(request.first);
+            locker.unlock();
+            request.first->load(request.second);
+            locker.relock();
+            m_loading.removeOne(request.first);
+            m_done.wakeAll();
+            //the following requests of the file can be taken now
+            m_requested.wakeAll();
+        }
+    }
+
+private:
+    //! Guards the requests.
+    QMutex m_mutex;
+    //! Woken when a block is requested.
+    QWaitCondition m_requested;
+    //! Woken when a block was read.
+    QWaitCondition m_done;
+    //! Blocks to read, in the order of the requests.
+    QList<QPair<ReadAhead *, qint64> > m_requests;
+    //! Read-aheads whose blocks are being read.
+    QList<ReadAhead *> m_loading;
+    //! Threads reading the blocks.
+    std::vector<std::unique_ptr<Worker> > m_workers;
+};
+
+ReadAhead::ReadAhead(QIODevice & source, qint64 size)
+    : m_source(source)
+    , m_size(size)
+    , m_use_count(0)
+{
+    //the loader is created first, so it is destroyed after the read-aheads held by static objects
+    Loader::instance();
+}
+
+ReadAhead::~ReadAhead()
+{
+    Loader::instance().cancel(this);
+}
+
+qint64 ReadAhead::read(qint64 position, char * data, qint64 size, Cursor * cursor)
+{
+    if(position < 0 || size < 0)
+        return -1;
+    if(position >= m_size)
+        return 0;
+
+    size = qMin(size, m_size - position);
+    qint64 copied = 0;
+    while(copied < size)
+    {
+        qint64 index = (position + copied) / READ_AHEAD_BLOCK_SIZE;
+        qint64 offset = position + copied - index * READ_AHEAD_BLOCK_SIZE;
+        QByteArray block = getBlock(index, cursor);
+        //the block could not be read, or the file got shorter
+        if(block.size() <= offset)
+            break;
+
+        qint64 count = qMin(block.size() - offset, size - copied);
+        memcpy(data + copied, block.constData() + offset, count);
+        copied += count;
+    }
+    return (copied > 0) ? copied : -1;
+}
+
+ReadAhead::Statistics ReadAhead::getStatistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_statistics;
+}
+
+ReadAhead::Statistics ReadAhead::getTotalStatistics()
+{
+    Statistics statistics;
+    statistics.m_hits = s_totals.m_hits;
+    statistics.m_waits = s_totals.m_waits;
+    statistics.m_misses = s_totals.m_misses;
+    statistics.m_read_blocks = s_totals.m_read_blocks;
+    statistics.m_read_bytes = s_totals.m_read_bytes;
+    return statistics;
+}
+
+QJsonObject ReadAhead::totalsToJson()
+{
+    Statistics statistics = getTotalStatistics();
+
+    QJsonObject result;
+    result["block_size"] = READ_AHEAD_BLOCK_SIZE;
+    result["hits"] = (double)statistics.m_hits;
+    result["waits"] = (double)statistics.m_waits;
+    result["misses"] = (double)statistics.m_misses;
+    result["read_blocks"] = (double)statistics.m_read_blocks;
+    result["read_bytes"] = (double)statistics.m_read_bytes;
+    return result;
+}
+
+QByteArray ReadAhead::getBlock(qint64 index, Cursor * cursor)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_blocks.find(index);
+    if(it != m_blocks.end())
+    {
+        if(it->m_loading)
+        {
+            ++m_statistics.m_waits;
+            ++s_totals.m_waits;
+            //a block not read ahead is dropped, and read below
+            while(it != m_blocks.end() && it->m_loading)
+            {
+                m_loaded.wait(&m_mutex);
+                it = m_blocks.find(index);
+            }
+        }
+        else
+        {
+            ++m_statistics.m_hits;
+            ++s_totals.m_hits;
+        }
+    }
+
+    QByteArray data;
+    if(it == m_blocks.end())
+    {
+        ++m_statistics.m_misses;
+        ++s_totals.m_misses;
+
+        Block & block = m_blocks[index];
+        block.m_last_use = ++m_use_count;
+        locker.unlock();
+        data = readBlock(index);
+        locker.relock();
+        finishBlock(index, data);
+    }
+    else
+    {
+        it->m_last_use = ++m_use_count;
+        it->m_ahead = false;
+        data = it->m_data;
+    }
+
+    if(cursor != nullptr && index != cursor->m_last_index)
+    {
+        if(index == cursor->m_last_index + 1)
+            requestAhead(index);
+        cursor->m_last_index = index;
+    }
+    return data;
+}
+
+QByteArray ReadAhead::readBlock(qint64 index)
+{
+    qint64 position = index * READ_AHEAD_BLOCK_SIZE;
+    QByteArray data(int(qMin<qint64>(READ_AHEAD_BLOCK_SIZE, m_size - position)), Qt::Uninitialized);
+
+    QMutexLocker locker(&m_source_mutex);
+    if(!m_source.seek(position))
+        return QByteArray();
+
+    qint64 size = m_source.read(data.data(), data.size());
+    if(size <= 0)
+        return QByteArray();
+    data.resize(int(size));
+    return data;
+}
+
+void ReadAhead::finishBlock(qint64 index, const QByteArray & data)
+{
+    if(data.isEmpty())
+        m_blocks.remove(index);
+    else
+    {
+        Block & block = m_blocks[index];
+        block.m_data = data;
+        block.m_loading = false;
+
+        ++m_statistics.m_read_blocks;
+        ++s_totals.m_read_blocks;
+        m_statistics.m_read_bytes += data.size();
+        s_totals.m_read_bytes += data.size();
+    }
+    m_loaded.wakeAll();
+    trim();
+}
+
+void ReadAhead::requestAhead(qint64 index)
+{
+    for(qint64 next = index + 1; next <= index + READ_AHEAD_BLOCKS && next * READ_AHEAD_BLOCK_SIZE < m_size; ++next)
+    {
+        if(m_blocks.contains(next))
+            continue;
+
+        Block & block = m_blocks[next];
+        block.m_ahead = true;
+        block.m_last_use = ++m_use_count;
+        Loader::instance().request(this, next);
+    }
+    trim();
+}
+
+void ReadAhead::trim()
+{
+    for(;;)
+    {
+        //blocks being read are kept, their readers wait for them
+        int used_count = 0, ahead_count = 0;
+        auto oldest_used = m_blocks.end(), oldest_ahead = m_blocks.end();
+        for(auto it = m_blocks.begin(), end = m_blocks.end(); it != end; ++it)
+        {
+            if(it->m_ahead)
+                ++ahead_count;
+            else
+                ++used_count;
+            if(it->m_loading)
+                continue;
+
+            auto & oldest = it->m_ahead ? oldest_ahead : oldest_used;
+            if(oldest == m_blocks.end() || it->m_last_use < oldest->m_last_use)
+                oldest = it;
+        }
+
+        //blocks read ahead are dropped only for other blocks read ahead, so they wait for their readers
+        if(used_count > READ_AHEAD_CACHE_BLOCKS && oldest_used != m_blocks.end())
+            m_blocks.erase(oldest_used);
+        else if(ahead_count > READ_AHEAD_BLOCKS * READ_AHEAD_READERS && oldest_ahead != m_blocks.end())
+            m_blocks.erase(oldest_ahead);
+        else
+            break;
+    }
+}
+
+void ReadAhead::load(qint64 index)
+{
+    QByteArray data = readBlock(index);
+
+    QMutexLocker locker(&m_mutex);
+    finishBlock(index, data);
+}
@@ -0,0 +1,177 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef READAHEAD_H
+#define READAHEAD_H
+
+#include "crosscompilation_cxx11.h"
+#include "crosscompilation_inttypes.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QIODevice>
+#include <QJsonObject>
+#include <QMutex>
+#include <QWaitCondition>
+
+//! Block cache with read-ahead over a random access device, for files on network shares and slow disks.
+/*!
+ * \brief Reads are served from blocks of READ_AHEAD_BLOCK_SIZE. When the reads of a reader move on to the following block,
+ * the next READ_AHEAD_BLOCKS blocks are read by READ_AHEAD_THREADS background threads shared by all read-aheads,
+ * so sequential readers find their data in memory. Each reader keeps its own Cursor, so readers interleaving
+ * their reads at different positions are recognized as sequential each. A file is read by one background thread
+ * at a time, the other threads serve the other files. Blocks read ahead are kept until they are used, so the readers
+ * do not drop the blocks read ahead of each other. Up to READ_AHEAD_BLOCKS of READ_AHEAD_READERS readers are kept,
+ * above it the ones requested first are dropped, e.g. the ones left behind by a seek. Besides them the last
+ * READ_AHEAD_CACHE_BLOCKS blocks used are kept for backward seeks.
+ * Reads are thread-safe, the parser and the demuxers of a file read it at the same time.
+ */
+class ReadAhead CC_CXX11_FINAL
+{
+public:
+    //! Counters of the block accesses.
+    struct Statistics
+    {
+        Statistics() :
+            m_hits(0),
+            m_waits(0),
+            m_misses(0),
+            m_read_blocks(0),
+            m_read_bytes(0)
+        {}
+
+        //! Count of the accesses served from the cache.
+        quint64 m_hits;
+        //! Count of the accesses waiting for a block being read ahead.
+        quint64 m_waits;
+        //! Count of the accesses reading their block on the calling thread.
+        quint64 m_misses;
+        //! Count of the blocks read from the device, ahead or on a miss.
+        quint64 m_read_blocks;
+        //! Count of the bytes read from the device.
+        quint64 m_read_bytes;
+    };
+
+    //! Read position of one reader.
+    struct Cursor
+    {
+        Cursor() :
+            m_last_index(-1)
+        {}
+
+        //! Index of the block read last by the reader.
+        qint64 m_last_index;
+    };
+
+public:
+    //! Reads a device of a size, which outlives the read-ahead and is opened for reading.
+    ReadAhead(QIODevice & source, qint64 size);
+
+    ~ReadAhead();
+
+public:
+    //! Copies data from a position of the device.
+    /*!
+     * \param cursor position of the reader, the blocks following it are read ahead, nullptr for a single read without reading ahead
+     * \return count of the bytes copied, 0 at the end of the device, -1 on errors
+     */
+    qint64 read(qint64 position, char * data, qint64 size, Cursor * cursor = nullptr);
+
+    //! Returns the counters of this read-ahead.
+    Statistics getStatistics() const;
+
+    //! Returns the counters of all read-aheads of the application.
+    static Statistics getTotalStatistics();
+
+    //! Returns the counters of all read-aheads as JSON.
+    static QJsonObject totalsToJson();
+
+private:
+    //! Block in the cache.
+    struct Block
+    {
+        Block() :
+            m_loading(true),
+            m_ahead(false),
+            m_last_use(0)
+        {}
+
+        //! Data of the block, shorter at the end of the device.
+        QByteArray m_data;
+        //! Set while the block is being read.
+        bool m_loading;
+        //! Set while the block read ahead is not used by a reader.
+        bool m_ahead;
+        //! Use count of the read-ahead at the last use, or at the request of a block read ahead.
+        quint64 m_last_use;
+    };
+
+    //! Background threads reading the blocks ahead.
+    class Loader;
+
+private:
+    ReadAhead(const ReadAhead &);
+    ReadAhead & operator =(const ReadAhead &);
+
+    //! Returns the data of a block for a reader, reads it if it is not cached. The data is empty on errors.
+    QByteArray getBlock(qint64 index, Cursor * cursor);
+
+    //! Reads a block from the device.
+    QByteArray readBlock(qint64 index);
+
+    //! Stores a block read, or drops it if it could not be read.
+    void finishBlock(qint64 index, const QByteArray & data);
+
+    //! Requests the blocks following a block from the loader.
+    void requestAhead(qint64 index);
+
+    //! Drops the least recently used blocks over READ_AHEAD_CACHE_BLOCKS, and the blocks read ahead requested first over their limit.
+    void trim();
+
+    //! Reads a requested block, called by the loader.
+    void load(qint64 index);
+
+private:
+    //! Device read.
+    QIODevice & m_source;
+    //! Guards the device.
+    QMutex m_source_mutex;
+    //! Size of the device.
+    qint64 m_size;
+    //! Guards the blocks and the counters.
+    mutable QMutex m_mutex;
+    //! Woken when a block was read.
+    QWaitCondition m_loaded;
+    //! Cached and loading blocks by their index.
+    QHash<qint64, Block> m_blocks;
+    //! Count of the block uses, orders the blocks for dropping.
+    quint64 m_use_count;
+    //! Counters of the block accesses.
+    Statistics m_statistics;
+};
+
+#endif // READAHEAD_H
@@ -0,0 +1,237 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "sampleIndex.h"
+
+#include <QIODevice>
+
+#include <algorithm>
+#include <type_traits>
+
+namespace
+{
+    //! Writes the count and the raw entries of a table.
+    template<typename T>
+    void writeTable(QDataStream & stream, const QVector<T> & table)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Table entries are copied as raw data");
+        stream << quint32(table.size());
+        stream.writeRawData(reinterpret_cast<const char *>(table.constData()), int(table.size() * sizeof(T)));
+    }
+
+    //! Reads a table written by writeTable().
+    template<typename T>
+    bool readTable(QDataStream & stream, QVector<T> & table)
+    {
+        quint32 count = 0;
+        stream >> count;
+        //a damaged count does not allocate more than the data holds
+        if(stream.status() != QDataStream::Ok ||
+           (stream.device() != nullptr && count > stream.device()->bytesAvailable() / sizeof(T)))
+            return false;
+
+        table.resize(int(count));
+        int size = int(count * sizeof(T));
+        return stream.readRawData(reinterpret_cast<char *>(table.data()), size) == size;
+    }
+}
+
+TrackSampleIndex::TrackSampleIndex()
+    : m_timescale(0)
+    , m_handler_type(0)
+    , m_end_time(0)
+{
+}
+
+void TrackSampleIndex::append(int64_t decode_time, uint32_t duration, int32_t composition_offset, uint32_t size, uint64_t offset, bool is_sync)
+{
+    if(is_sync)
+        m_sync_samples.append(m_decode_times.size());
+    m_decode_times.append(decode_time);
+    m_composition_offsets.append(composition_offset);
+    m_sizes.append(size);
+    m_offsets.append(offset);
+    m_end_time = std::max<int64_t>(m_end_time, decode_time + duration);
+}
+
+void TrackSampleIndex::setTimescale(uint32_t timescale)
+{
+    m_timescale = timescale;
+}
+
+uint32_t TrackSampleIndex::getTimescale() const
+{
+    return m_timescale;
+}
+
+void TrackSampleIndex::setHandlerType(uint32_t handler_type)
+{
+    m_handler_type = handler_type;
+}
+
+uint32_t TrackSampleIndex::getHandlerType() const
+{
+    return m_handler_type;
+}
+
+int TrackSampleIndex::size() const
+{
+    return m_decode_times.size();
+}
+
+bool TrackSampleIndex::isEmpty() const
+{
+    return m_decode_times.isEmpty();
+}
+
+int64_t TrackSampleIndex::getDecodeTime(int index) const
+{
+    return m_decode_times.at(index);
+}
+
+int64_t TrackSampleIndex::getCompositionTime(int index) const
+{
+    return m_decode_times.at(index) + m_composition_offsets.at(index);
+}
+
+uint32_t TrackSampleIndex::getSize(int index) const
+{
+    return m_sizes.at(index);
+}
+
+uint64_t TrackSampleIndex::getOffset(int index) const
+{
+    return m_offsets.at(index);
+}
+
+bool TrackSampleIndex::isSync(int index) const
+{
+    return std::binary_search(m_sync_samples.begin(), m_sync_samples.end(), index);
+}
+
+int64_t TrackSampleIndex::getEndTime() const
+{
+    return m_end_time;
+}
+
+uint64_t TrackSampleIndex::getDurationMs() const
+{
+    if(m_decode_times.isEmpty())
+        return 0;
+    return toMs(m_end_time - m_decode_times.front());
+}
+
+int TrackSampleIndex::findSample(int64_t decode_time) const
+{
+    auto it = std::upper_bound(m_decode_times.begin(), m_decode_times.end(), decode_time);
+    return int(it - m_decode_times.begin()) - 1;
+}
+
+int TrackSampleIndex::findSampleMs(uint64_t time_ms) const
+{
+    if(m_decode_times.isEmpty())
+        return -1;
+    // time is counted from the first sample, as fragments of a segment usually do not start at zero
+    return std::max(0, findSample(m_decode_times.front() + fromMs(time_ms)));
+}
+
+int TrackSampleIndex::findSyncSample(int index) const
+{
+    auto it = std::upper_bound(m_sync_samples.begin(), m_sync_samples.end(), index);
+    if(it == m_sync_samples.begin())
+        return -1;
+    return *(it - 1);
+}
+
+int TrackSampleIndex::findNextSyncSample(int index) const
+{
+    auto it = std::upper_bound(m_sync_samples.begin(), m_sync_samples.end(), index);
+    if(it == m_sync_samples.end())
+        return -1;
+    return *it;
+}
+
+uint64_t TrackSampleIndex::toMs(int64_t time) const
+{
+    if(m_timescale == 0 || time <= 0)
+        return 0;
+    return (uint64_t)time * 1000 / m_timescale;
+}
+
+int64_t TrackSampleIndex::fromMs(uint64_t time_ms) const
+{
+    return (int64_t)(time_ms * m_timescale / 1000);
+}
+
+void TrackSampleIndex::writeTables(QDataStream & stream) const
+{
+    stream << m_timescale << m_handler_type << m_end_time;
+    writeTable(stream, m_decode_times);
+    writeTable(stream, m_composition_offsets);
+    writeTable(stream, m_sizes);
+    writeTable(stream, m_offsets);
+    writeTable(stream, m_sync_samples);
+}
+
+bool TrackSampleIndex::readTables(QDataStream & stream)
+{
+    stream >> m_timescale >> m_handler_type >> m_end_time;
+    return readTable(stream, m_decode_times) &&
+           readTable(stream, m_composition_offsets) &&
+           readTable(stream, m_sizes) &&
+           readTable(stream, m_offsets) &&
+           readTable(stream, m_sync_samples) &&
+           m_composition_offsets.size() == m_decode_times.size() &&
+           m_sizes.size() == m_decode_times.size() &&
+           m_offsets.size() == m_decode_times.size();
+}
+
+QDataStream & operator <<(QDataStream & stream, const TrackSampleIndex & index)
+{
+    stream << index.m_timescale
+           << index.m_handler_type
+           << index.m_end_time
+           << index.m_decode_times
+           << index.m_composition_offsets
+           << index.m_sizes
+           << index.m_offsets
+           << index.m_sync_samples;
+    return stream;
+}
+
+QDataStream & operator >>(QDataStream & stream, TrackSampleIndex & index)
+{
+    stream >> index.m_timescale
+           >> index.m_handler_type
+           >> index.m_end_time
+           >> index.m_decode_times
+           >> index.m_composition_offsets
+           >> index.m_sizes
+           >> index.m_offsets
+           >> index.m_sync_samples;
+    return stream;
+}
@@ -0,0 +1,158 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef SAMPLEINDEX_H
+#define SAMPLEINDEX_H
+
+#include "crosscompilation_cxx11.h"
+#include "crosscompilation_inttypes.h"
+
+#include <QDataStream>
+#include <QMap>
+#include <QVector>
+
+//! Samples of a single track of a file, from its sample table and all its fragments.
+/*!
+ * \brief Samples are kept in the decode order in parallel arrays, so the index of a long recording stays compact
+ * and lookups by time are binary searches over a plain array.
+ * Times are kept in the track timescale.
+ */
+class TrackSampleIndex
+{
+public:
+    TrackSampleIndex();
+
+public:
+    //! Appends a sample, which has to follow the previous one in the decode order.
+    void append(int64_t decode_time, uint32_t duration, int32_t composition_offset, uint32_t size, uint64_t offset, bool is_sync);
+
+    //! Sets the timescale of the track.
+    void setTimescale(uint32_t timescale);
+
+    //! Returns the timescale of the track.
+    uint32_t getTimescale() const;
+
+    //! Sets the handler type of the track, e.g. 'vide' or 'meta'.
+    void setHandlerType(uint32_t handler_type);
+
+    //! Returns the handler type of the track, 0 if unknown.
+    uint32_t getHandlerType() const;
+
+    //! Returns the count of samples.
+    int size() const;
+
+    //! Checks if there are no samples.
+    bool isEmpty() const;
+
+    //! Returns the decode time of a sample.
+    int64_t getDecodeTime(int index) const;
+
+    //! Returns the composition time of a sample.
+    int64_t getCompositionTime(int index) const;
+
+    //! Returns the size of a sample in bytes.
+    uint32_t getSize(int index) const;
+
+    //! Returns the offset of a sample from the file beginning.
+    uint64_t getOffset(int index) const;
+
+    //! Checks if a sample is a sync sample.
+    bool isSync(int index) const;
+
+    //! Returns the decode time of the track end.
+    int64_t getEndTime() const;
+
+    //! Returns the duration of the track in milliseconds.
+    uint64_t getDurationMs() const;
+
+    //! Returns the position of the sample being decoded at the time.
+    /*!
+     * \param decode_time time in the track timescale
+     * \return sample position or -1, if the time is before the first sample or the index is empty
+     */
+    int findSample(int64_t decode_time) const;
+
+    //! Returns the position of the sample being decoded at the time in milliseconds.
+    int findSampleMs(uint64_t time_ms) const;
+
+    //! Returns the position of the last sync sample at or before the sample.
+    /*!
+     * \return sample position or -1, if there are no sync samples before
+     */
+    int findSyncSample(int index) const;
+
+    //! Returns the position of the first sync sample after the sample.
+    /*!
+     * \return sample position or -1, if there are no sync samples after
+     */
+    int findNextSyncSample(int index) const;
+
+    //! Converts time in the track timescale to milliseconds.
+    uint64_t toMs(int64_t time) const;
+
+    //! Converts time in milliseconds to the track timescale.
+    int64_t fromMs(uint64_t time_ms) const;
+
+    //! Writes the index with its sample tables as raw data in the byte order of the machine, for files local to it.
+    void writeTables(QDataStream & stream) const;
+
+    //! Reads an index written by writeTables(), each sample table is copied at once.
+    /*!
+     * \return false, if the data is damaged or incomplete
+     */
+    bool readTables(QDataStream & stream);
+
+private:
+    friend QDataStream & operator <<(QDataStream & stream, const TrackSampleIndex & index);
+    friend QDataStream & operator >>(QDataStream & stream, TrackSampleIndex & index);
+
+private:
+    //! Timescale of the track.
+    uint32_t m_timescale;
+    //! Handler type of the track.
+    uint32_t m_handler_type;
+    //! Decode time of the track end.
+    qint64 m_end_time;
+    //! Decode times of the samples.
+    QVector<qint64> m_decode_times;
+    //! Composition offsets of the samples.
+    QVector<qint32> m_composition_offsets;
+    //! Sizes of the samples.
+    QVector<quint32> m_sizes;
+    //! File offsets of the samples.
+    QVector<quint64> m_offsets;
+    //! Positions of the sync samples.
+    QVector<qint32> m_sync_samples;
+};
+
+//! Sample indexes of the tracks of a file by track id.
+typedef QMap<uint32_t, TrackSampleIndex> SampleIndex;
+
+QDataStream & operator <<(QDataStream & stream, const TrackSampleIndex & index);
+QDataStream & operator >>(QDataStream & stream, TrackSampleIndex & index);
+
+#endif // SAMPLEINDEX_H
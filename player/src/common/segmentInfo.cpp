@@ -180,6 +180,21 @@ bool SegmentInfo::isSuccessor(const SegmentInfo & right) const
     return (m_successor_uuid == right.m_segment_uuid);
 }
 
+QString SegmentInfo::getSegmentUUID() const
+{
+    return m_segment_uuid;
+}
+
+QString SegmentInfo::getPredecessorUUID() const
+{
+    return m_predecessor_uuid;
+}
+
+QString SegmentInfo::getSuccessorUUID() const
+{
+    return m_successor_uuid;
+}
+
 void SegmentInfo::setFragmentNumber(uint32_t fragment_number)
 {
     m_segment_number = fragment_number;
@@ -202,3 +217,53 @@ void SegmentInfo::createName() const
     else
         m_name = QString("%1\nduration %2 seconds").arg(QFileInfo(m_file_name).fileName()).arg((int)(getDuration()/1000));
 }
+
+QDataStream & operator <<(QDataStream & stream, const SegmentInfo & segment)
+{
+    stream << segment.m_segment_number
+           << segment.m_file_name
+           << segment.m_predecessor_uuid
+           << segment.m_segment_uuid
+           << segment.m_successor_uuid
+           << segment.m_segment_start
+           << segment.m_valid_stream_ids
+           << segment.m_timescale
+           << segment.m_videoTimescale
+           << quint64(segment.m_duration)
+           << segment.m_samples
+           << quint64(segment.m_accumulatedSampleDuration)
+           << quint64(segment.m_firstSampleCompositionOffset)
+           << quint64(segment.m_lastSampleCompositionOffset)
+           << segment.m_firstTrackId
+           << segment.m_currentParserTrackId
+           << segment.m_defaultSampleDuration;
+    return stream;
+}
+
+QDataStream & operator >>(QDataStream & stream, SegmentInfo & segment)
+{
+    quint64 duration, accumulated_sample_duration, first_sample_composition_offset, last_sample_composition_offset;
+    stream >> segment.m_segment_number
+           >> segment.m_file_name
+           >> segment.m_predecessor_uuid
+           >> segment.m_segment_uuid
+           >> segment.m_successor_uuid
+           >> segment.m_segment_start
+           >> segment.m_valid_stream_ids
+           >> segment.m_timescale
+           >> segment.m_videoTimescale
+           >> duration
+           >> segment.m_samples
+           >> accumulated_sample_duration
+           >> first_sample_composition_offset
+           >> last_sample_composition_offset
+           >> segment.m_firstTrackId
+           >> segment.m_currentParserTrackId
+           >> segment.m_defaultSampleDuration;
+    segment.m_duration = duration;
+    segment.m_accumulatedSampleDuration = accumulated_sample_duration;
+    segment.m_firstSampleCompositionOffset = first_sample_composition_offset;
+    segment.m_lastSampleCompositionOffset = last_sample_composition_offset;
+    segment.m_name.clear();
+    return stream;
+}
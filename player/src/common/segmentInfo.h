@@ -32,6 +32,7 @@
 
 #include <QString>
 #include <QList>
+#include <QDataStream>
 #include <QFileInfo>
 #include <QDateTime>
 #include <QMultiMap>
@@ -104,6 +105,15 @@ public:
     //! Checks, if a fragment is a successor of a fragment. Valid only for Surveillance files.
     bool isSuccessor(const SegmentInfo & right) const;
 
+    //! Returns the UUID of the fragment. Valid only for Surveillance files.
+    QString getSegmentUUID() const;
+
+    //! Returns the UUID of the predecessor fragment. Valid only for Surveillance files.
+    QString getPredecessorUUID() const;
+
+    //! Returns the UUID of the successor fragment. Valid only for Surveillance files.
+    QString getSuccessorUUID() const;
+
     //! Sets the fragment number
     void setFragmentNumber(uint32_t fragment_number);
 
@@ -115,6 +125,11 @@ public:
 
     //! Gets the estimated fps from sample information
     double getFpsFromSamples() const;
+
+    //! Writes the segment into a binary stream, e.g. a parse index.
+    friend QDataStream & operator <<(QDataStream & stream, const SegmentInfo & segment);
+    //! Reads the segment from a binary stream.
+    friend QDataStream & operator >>(QDataStream & stream, SegmentInfo & segment);
 private:
     //! Compute name for a fragment. This name will be shown in UI.
     void createName() const;
@@ -0,0 +1,286 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "segmentTimeline.h"
+
+#include <algorithm>
+
+SegmentTimeline::SegmentTimeline(const SegmentList & segments /*= SegmentList()*/)
+    : m_segments(segments)
+{
+    buildIndex();
+}
+
+SegmentTimeline SegmentTimeline::chain(const SegmentList & segments)
+{
+    const int count = segments.size();
+    SegmentChainIssueList issues;
+
+    QHash<QString, int> index_by_uuid;
+    index_by_uuid.reserve(count);
+    QVector<bool> duplicate(count, false);
+    for(int i = 0; i < count; ++i)
+    {
+        const SegmentInfo & segment = segments.at(i);
+        auto it = index_by_uuid.find(segment.getSegmentUUID());
+        if(it != index_by_uuid.end())
+        {
+            issues.append(SegmentChainIssue(SegmentChainIssue::Duplicate, segment.getFileName(),
+                                            QString("Segment %1 is contained in %2 as well").arg(segment.getSegmentUUID(), segments.at(*it).getFileName())));
+            duplicate[i] = true;
+            continue;
+        }
+        index_by_uuid.insert(segment.getSegmentUUID(), i);
+    }
+
+    // link every segment with its successor, the first segment claiming a successor wins
+    // duplicates are reported already, so they are neither linked nor reported as forks
+    QVector<int> next(count, -1), previous(count, -1);
+    int beginning_count = 0;
+    for(int i = 0; i < count; ++i)
+    {
+        if(duplicate[i])
+            continue;
+        const SegmentInfo & segment = segments.at(i);
+        if(segment.isBeginning())
+            beginning_count++;
+        if(segment.isEnd())
+            continue;
+
+        auto it = index_by_uuid.find(segment.getSuccessorUUID());
+        if(it == index_by_uuid.end())
+        {
+            issues.append(SegmentChainIssue(SegmentChainIssue::Break, segment.getFileName(),
+                                            QString("Successor segment %1 is missing").arg(segment.getSuccessorUUID())));
+            continue;
+        }
+        int successor = *it;
+        if(previous[successor] != -1)
+        {
+            issues.append(SegmentChainIssue(SegmentChainIssue::Fork, segment.getFileName(),
+                                            QString("Segment %1 is a successor of %2 as well").arg(segment.getSuccessorUUID(), segments.at(previous[successor]).getFileName())));
+            continue;
+        }
+        if(segments.at(successor).getPredecessorUUID() != segment.getSegmentUUID())
+        {
+            issues.append(SegmentChainIssue(SegmentChainIssue::Fork, segment.getFileName(),
+                                            QString("Successor segment %1 refers to another predecessor %2").arg(segment.getSuccessorUUID(), segments.at(successor).getPredecessorUUID())));
+        }
+        next[i] = successor;
+        previous[successor] = i;
+    }
+    if(beginning_count > 1)
+    {
+        issues.append(SegmentChainIssue(SegmentChainIssue::Fork, QString(),
+                                        QString("Fileset contains %1 beginning segments").arg(beginning_count)));
+    }
+
+    SegmentTimeline timeline;
+    timeline.m_segments.reserve(count);
+    QVector<bool> visited(count, false);
+    auto follow = [&] (int index)
+    {
+        for(; (index != -1) && !visited[index]; index = next[index])
+        {
+            visited[index] = true;
+            timeline.m_segments.append(segments.at(index));
+        }
+    };
+
+    // chains starting with a beginning segment go first, then chains after a break
+    for(int i = 0; i < count; ++i)
+    {
+        if((previous[i] == -1) && segments.at(i).isBeginning())
+            follow(i);
+    }
+    for(int i = 0; i < count; ++i)
+    {
+        if((previous[i] == -1) && !visited[i])
+        {
+            const SegmentInfo & segment = segments.at(i);
+            if(duplicate[i])
+            {
+                // the copy of a segment, which is placed in the chain already
+            }
+            else if(!index_by_uuid.contains(segment.getPredecessorUUID()))
+            {
+                issues.append(SegmentChainIssue(SegmentChainIssue::Break, segment.getFileName(),
+                                                QString("Predecessor segment %1 is missing").arg(segment.getPredecessorUUID())));
+            }
+            else
+            {
+                issues.append(SegmentChainIssue(SegmentChainIssue::Fork, segment.getFileName(),
+                                                QString("Predecessor segment %1 refers to another successor").arg(segment.getPredecessorUUID())));
+            }
+            follow(i);
+        }
+    }
+    // whatever is left can only be reached through a loop
+    for(int i = 0; i < count; ++i)
+    {
+        if(!visited[i])
+        {
+            issues.append(SegmentChainIssue(SegmentChainIssue::Cycle, segments.at(i).getFileName(),
+                                            QString("Segment %1 is a part of a loop").arg(segments.at(i).getSegmentUUID())));
+            follow(i);
+        }
+    }
+
+    for(int i = 0; i < timeline.m_segments.size(); ++i)
+    {
+        timeline.m_segments[i].setFragmentNumber(i);
+    }
+    timeline.m_issues = issues;
+    timeline.buildIndex();
+    return timeline;
+}
+
+const SegmentList & SegmentTimeline::getSegments() const
+{
+    return m_segments;
+}
+
+int SegmentTimeline::size() const
+{
+    return m_segments.size();
+}
+
+bool SegmentTimeline::isEmpty() const
+{
+    return m_segments.isEmpty();
+}
+
+const SegmentInfo & SegmentTimeline::at(int index) const
+{
+    return m_segments.at(index);
+}
+
+int SegmentTimeline::indexOf(const QString & segment_uuid) const
+{
+    return m_index_by_uuid.value(segment_uuid, -1);
+}
+
+uint64_t SegmentTimeline::getStartOffset(int index) const
+{
+    return m_start_offsets.at(index);
+}
+
+uint64_t SegmentTimeline::getDuration() const
+{
+    return m_start_offsets.back();
+}
+
+int SegmentTimeline::findSegment(uint64_t time_ms) const
+{
+    if(m_segments.isEmpty())
+        return -1;
+    auto it = std::upper_bound(m_start_offsets.begin(), m_start_offsets.end() - 1, time_ms);
+    return std::max(0, int(it - m_start_offsets.begin()) - 1);
+}
+
+SegmentTimeline::Position SegmentTimeline::locate(uint64_t time_ms) const
+{
+    int index = findSegment(time_ms);
+    if(index == -1)
+        return Position();
+    return Position(index, std::min(time_ms, m_start_offsets[index + 1]) - m_start_offsets[index]);
+}
+
+SegmentTimeline::Position SegmentTimeline::locate(const QDateTime & time) const
+{
+    if(m_start_times.isEmpty() || !time.isValid())
+        return Position();
+
+    qint64 time_ms = time.toMSecsSinceEpoch();
+    auto it = std::upper_bound(m_start_times.begin(), m_start_times.end(), time_ms);
+    if(it == m_start_times.begin())
+        return Position(0, 0);
+
+    int index = int(it - m_start_times.begin()) - 1;
+    uint64_t offset = uint64_t(time_ms - m_start_times[index]);
+    uint64_t duration = m_start_offsets[index + 1] - m_start_offsets[index];
+    if(offset < duration)
+        return Position(index, offset);
+    if(index + 1 < m_segments.size())
+        return Position(index + 1, 0);
+    return Position(index, duration);
+}
+
+bool SegmentTimeline::hasStartTimes() const
+{
+    return !m_start_times.isEmpty();
+}
+
+int64_t SegmentTimeline::getGap(int index) const
+{
+    if(index <= 0 || m_start_times.isEmpty())
+        return 0;
+    uint64_t previous_duration = m_start_offsets[index] - m_start_offsets[index - 1];
+    return m_start_times[index] - (m_start_times[index - 1] + int64_t(previous_duration));
+}
+
+const SegmentChainIssueList & SegmentTimeline::getIssues() const
+{
+    return m_issues;
+}
+
+bool SegmentTimeline::isContinuous() const
+{
+    return m_issues.isEmpty();
+}
+
+void SegmentTimeline::buildIndex()
+{
+    m_start_offsets.resize(m_segments.size() + 1);
+    m_index_by_uuid.clear();
+    m_index_by_uuid.reserve(m_segments.size());
+
+    uint64_t offset = 0;
+    for(int i = 0; i < m_segments.size(); ++i)
+    {
+        const SegmentInfo & segment = m_segments.at(i);
+        m_start_offsets[i] = offset;
+        offset += segment.getDuration();
+        if(segment.isSurveillanceFragment() && !m_index_by_uuid.contains(segment.getSegmentUUID()))
+            m_index_by_uuid.insert(segment.getSegmentUUID(), i);
+    }
+    m_start_offsets[m_segments.size()] = offset;
+
+    m_start_times.clear();
+    m_start_times.reserve(m_segments.size());
+    for(int i = 0; i < m_segments.size(); ++i)
+    {
+        QDateTime start_time = m_segments.at(i).getStartTime();
+        if(!start_time.isValid() ||
+           (!m_start_times.isEmpty() && (start_time.toMSecsSinceEpoch() < m_start_times.back())))
+        {
+            m_start_times.clear();
+            break;
+        }
+        m_start_times.append(start_time.toMSecsSinceEpoch());
+    }
+}
@@ -0,0 +1,185 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef SEGMENTTIMELINE_H
+#define SEGMENTTIMELINE_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "segmentInfo.h"
+
+//! Describes a problem found while chaining the segments of a fileset.
+struct SegmentChainIssue
+{
+    //! Type of a chain problem.
+    enum Type
+    {
+        Break,      //!< A segment refers to a predecessor or successor, which is not in the fileset.
+        Fork,       //!< Several segments claim the same position in the chain.
+        Cycle,      //!< Segments refer to each other in a loop without a beginning segment.
+        Duplicate   //!< Several files contain the segment with the same UUID.
+    };
+
+    SegmentChainIssue(Type type = Break, const QString & file_name = QString(), const QString & description = QString())
+        : m_type(type)
+        , m_file_name(file_name)
+        , m_description(description)
+    {}
+
+    //! Type of the problem.
+    Type m_type;
+    //! File of the segment, at which the problem was detected.
+    QString m_file_name;
+    //! Human readable description.
+    QString m_description;
+};
+
+typedef QList<SegmentChainIssue> SegmentChainIssueList;
+
+/**
+ * Ordered list of the segments of a fileset with an index over it.
+ * Gives constant time access to a segment by its position or UUID
+ * and logarithmic time lookup of a segment by a fileset-wide or a wall-clock time.
+ * The fileset-wide time runs over the segment durations without gaps, wall-clock gaps and overlaps
+ * between the segments are reported separately.
+ */
+class SegmentTimeline
+{
+public:
+    //! Position within a segment of the timeline.
+    struct Position
+    {
+        Position(int index = -1, uint64_t offset = 0)
+            : m_index(index)
+            , m_offset(offset)
+        {}
+
+        //! Checks if the position refers to a segment.
+        bool isValid() const { return m_index >= 0; }
+
+        //! Segment position, -1 for no segment.
+        int m_index;
+        //! Offset from the segment beginning in milliseconds.
+        uint64_t m_offset;
+    };
+
+public:
+    //! Creates a timeline keeping the segments in the given order.
+    explicit SegmentTimeline(const SegmentList & segments = SegmentList());
+
+    //! Orders Surveillance segments following their predecessor and successor UUIDs.
+    /*!
+     * Runs in linear time of the segments count.
+     * Segments which can not be chained are appended after the longest chain, problems are reported as issues.
+     * \param segments segments in any order
+     * \return ordered timeline
+     */
+    static SegmentTimeline chain(const SegmentList & segments);
+
+public:
+    //! Returns the ordered segments.
+    const SegmentList & getSegments() const;
+
+    //! Returns the count of segments.
+    int size() const;
+
+    //! Checks if there are no segments.
+    bool isEmpty() const;
+
+    //! Returns the segment at the position.
+    const SegmentInfo & at(int index) const;
+
+    //! Returns the position of the segment with the UUID or -1, if there is no such segment.
+    int indexOf(const QString & segment_uuid) const;
+
+    //! Returns the offset of the segment beginning from the fileset beginning in milliseconds.
+    uint64_t getStartOffset(int index) const;
+
+    //! Returns the duration of the whole fileset in milliseconds.
+    uint64_t getDuration() const;
+
+    //! Returns the position of the segment containing the fileset-wide time in milliseconds.
+    /*!
+     * Times beyond the fileset end correspond to the last segment.
+     * \return segment position or -1, if the timeline is empty
+     */
+    int findSegment(uint64_t time_ms) const;
+
+    //! Returns the segment and the offset within it for the fileset-wide time in milliseconds.
+    /*!
+     * Times beyond the fileset end correspond to the end of the last segment.
+     * \return invalid position, if the timeline is empty
+     */
+    Position locate(uint64_t time_ms) const;
+
+    //! Returns the segment and the offset within it for the wall-clock time.
+    /*!
+     * Times in a gap correspond to the beginning of the following segment, times in an overlap to the later segment.
+     * Times before the first segment correspond to its beginning, times after the last segment to its end.
+     * \return invalid position, if the segments can not be located by wall-clock time
+     */
+    Position locate(const QDateTime & time) const;
+
+    //! Checks if all segments have start times ascending in the timeline order, so they can be located by wall-clock time.
+    bool hasStartTimes() const;
+
+    //! Returns the wall-clock time between the end of the previous segment and the beginning of the segment in milliseconds.
+    /*!
+     * \return negative value for an overlap, zero for the first segment or without start times
+     */
+    int64_t getGap(int index) const;
+
+    //! Returns problems found while chaining the segments.
+    const SegmentChainIssueList & getIssues() const;
+
+    //! Checks if the segments form a single unbroken chain.
+    bool isContinuous() const;
+
+private:
+    //! Fills the lookup tables.
+    void buildIndex();
+
+private:
+    //! Segments in playback order.
+    SegmentList m_segments;
+    //! Start offset of each segment in milliseconds, with the fileset duration as the last element.
+    QVector<uint64_t> m_start_offsets;
+    //! Wall-clock start time of each segment in milliseconds since epoch, empty if not all segments can be located by it.
+    QVector<qint64> m_start_times;
+    //! Segment positions by UUID.
+    QHash<QString, int> m_index_by_uuid;
+    //! Problems found while chaining.
+    SegmentChainIssueList m_issues;
+};
+
+#endif // SEGMENTTIMELINE_H
@@ -64,7 +64,8 @@ struct AudioParams
 struct DecodedFrame
 {
     DecodedFrame(int time_ms = 0) :
-        m_time(time_ms)
+        m_time(time_ms),
+        m_decoded_at(0)
     {}
 
     virtual ~DecodedFrame()
@@ -72,6 +73,8 @@ struct DecodedFrame
 
     //! Present time.
     int         m_time;
+    //! Monotonic time of decoding in nanoseconds, 0 if unknown.
+    qint64      m_decoded_at;
 
     //! Get occupied memory.
     virtual size_t size() const = 0;
@@ -80,6 +83,7 @@ struct DecodedFrame
     virtual void clear()
     {
         m_time = 0;
+        m_decoded_at = 0;
     }
 };
 
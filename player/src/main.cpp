@@ -30,6 +30,7 @@
 #include <QApplication>
 
 #include "controller.h"
+#include "stallWatchdog.h"
 int main(int argc, char *argv[])
 {
     QApplication    a(argc, argv);
@@ -54,7 +55,11 @@ int main(int argc, char *argv[])
     player_widget.setWindowIcon(QIcon(":/icon"));
     fullscreen_player_widget.setWindowIcon(QIcon(":/icon"));
 
-    return a.exec();
+    StallWatchdog::instance().startWatching();
+    int result = a.exec();
+    StallWatchdog::instance().stopWatching();
+
+    return result;
 }
 
 #ifdef _WIN32
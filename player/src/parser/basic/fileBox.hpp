@@ -42,15 +42,78 @@ public:
     //! Reads the file contents from the input stream.
     virtual void initialize(LimitedStreamReader &stream)
     {
-        Box::initialize(stream);
+        beginInitialize(stream);
         bool run = false;
         do
         {
-            run = BoxFactory::instance().parseBox(stream, this);
+            run = initializeNext(stream);
         }
         while(run);
     }
 
+    //! Starts reading the file contents from the input stream, the top level boxes are read by initializeNext.
+    void beginInitialize(LimitedStreamReader &stream)
+    {
+        Box::initialize(stream);
+    }
+
+    //! Reads the next top level box from the input stream.
+    /*!
+     * \return false, if there are no more boxes
+     */
+    bool initializeNext(LimitedStreamReader &stream)
+    {
+        return BoxFactory::instance().parseBox(stream, this);
+    }
+
+    //! Reads only the top level boxes starting at the offsets from the input stream.
+    void initializePartially(LimitedStreamReader &stream, const QList<uint64_t> & offsets)
+    {
+        Box::initialize(stream);
+        for(auto it = offsets.begin(), end = offsets.end(); it != end; ++it)
+        {
+            stream.seek(*it);
+            BoxFactory::instance().parseBox(stream, this);
+        }
+    }
+
+    //! Reads the complete top level boxes starting at the offset, for a file which is still being written.
+    /*!
+     * \param stream stream of the whole file
+     * \param offset offset of the first box, which was not read yet
+     * \return offset of the first box, which is not completely written yet
+     */
+    uint64_t initializeAppended(LimitedStreamReader &stream, uint64_t offset)
+    {
+        if(offset == 0)
+            Box::initialize(stream);
+
+        const uint64_t file_size = stream.getSize();
+        while(offset + 2 * sizeof(uint32_t) <= file_size)
+        {
+            uint32_t size = 0;
+            uint64_t large_size = 0;
+            FourCC four_cc;
+            stream.seek(offset);
+            stream.read(size).read(four_cc);
+            if(1 == size)
+            {
+                if(offset + 2 * sizeof(uint32_t) + sizeof(uint64_t) > file_size)
+                    break;
+                stream.read(large_size);
+            }
+            // a box of zero size lasts until the end of the file, so it is never complete while the file grows
+            uint64_t box_size = (1 == size) ? large_size : size;
+            if((box_size < 2 * sizeof(uint32_t)) || (offset + box_size > file_size))
+                break;
+
+            stream.seek(offset);
+            BoxFactory::instance().parseBox(stream, this);
+            offset += box_size;
+        }
+        return offset;
+    }
+
     //! Returns the file FourCC code, currently empty
     virtual FourCC getBoxFourCC() CC_CXX11_OVERRIDE
     {
@@ -27,6 +27,7 @@
 
 #include "boxFactory.h"
 
+#include "parseSession.h"
 #include "basic/box.h"
 #include "basic/mandatoryBox.h"
 #include "basic/unknownBox.h"
@@ -146,8 +147,9 @@ BoxFactory & BoxFactory::instance()
 bool BoxFactory::parseBox(LimitedStreamReader & stream, ChildrenMixin * parent /*= nullptr*/)
 {
     bool result = false;
-    m_debug_tab_count++;
-    std::string debug_tab_string((m_debug_tab_count-1)*2, ' ');
+    ParseSession * session = stream.getSession();
+    size_t debug_tab_count = (session != nullptr) ? session->enterBox() : 0;
+    std::string debug_tab_string(debug_tab_count*2, ' ');
     if(stream)
     {
         try
@@ -201,7 +203,8 @@ bool BoxFactory::parseBox(LimitedStreamReader & stream, ChildrenMixin * parent /
                 break;
             }
 
-            emit boxCreated(box);
+            if(session != nullptr)
+                session->notifyBoxCreated(box);
 
             limited_stream.rewindToFinish();
             result = (bool)stream;
@@ -211,7 +214,8 @@ bool BoxFactory::parseBox(LimitedStreamReader & stream, ChildrenMixin * parent /
         catch(...)
         {}
     }
-    m_debug_tab_count--;
+    if(session != nullptr)
+        session->leaveBox();
     return result;
 }
 
@@ -47,6 +47,11 @@ struct has_four_cc {
 };
 
 //! Singleton class, that performs parsing of the boxes from the input stream.
+/*!
+ * The factory holds only the creator functions registry, which is filled once in the constructor and is never changed later.
+ * Everything, that belongs to a particular parsing run (box listeners, nesting depth), is kept in a ParseSession,
+ * carried by the stream, so several files can be parsed in parallel threads.
+ */
 class BoxFactory CC_CXX11_FINAL
         : public QObject
 {
@@ -70,6 +75,7 @@ public:
 public:
     //! Performs parsing of a box from a stream.
     /*!
+     * The created box is reported to the session of the stream, if there is any.
      * \param stream input stream
      * \param parent parent container, if any
      * \return if the stream contains any further data
@@ -102,10 +108,6 @@ public slots:
      */
     void onUnexpectedBoxesMet(Box * source, QList<Box *> boxes);
 
-signals:
-    //! This signal is sent, after the box was created.
-    void boxCreated(Box * box);
-
 private:
     //! Registers a creator functions for a box, that can be identified either by FourCC code.
     template<typename TBoxType>
@@ -130,8 +132,6 @@ private:
 private:
     //! Creator functions mapping for the boxes identified by FourCC codes
     CreatorMap m_creators;
-    //!
-    size_t m_debug_tab_count;
 };
 
 #endif // BOX_FACTORY_H
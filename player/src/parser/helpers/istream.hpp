@@ -43,6 +43,8 @@
 #include "optional.hpp"
 #include "fourcc.h"
 
+class ParseSession;
+
 //! Stream size state.
 enum StreamState
 {
@@ -276,8 +278,9 @@ private:
 class LimitedStreamReader CC_CXX11_FINAL
 {
 public:
-    LimitedStreamReader(std::shared_ptr<std::istream> stream)
+    LimitedStreamReader(std::shared_ptr<std::istream> stream, ParseSession * session = nullptr)
         : m_stream( stream )
+        , m_session(session)
         , m_initial_offset(0)
     {
         uint64_t final_position = m_stream.getFinishPosition();
@@ -296,6 +299,7 @@ public:
 private:
     LimitedStreamReader(LimitedStreamReader * stream, uint64_t initial_offset, uint32_t size, uint64_t large_size)
         : m_stream( stream->m_stream.makeNew( initial_offset, initial_offset + ( size == 1 ? large_size : size ) ) )
+        , m_session(stream->m_session)
         , m_initial_offset(initial_offset)
         , m_short_size(size)
         , m_large_size(large_size)
@@ -308,6 +312,12 @@ public:
         return LimitedStreamReader( this, initial_offset, size, large_size );
     }
 
+    //! Returns the parse session this stream belongs to, or nullptr if the stream is parsed outside of any session.
+    inline ParseSession * getSession()
+    {
+        return m_session;
+    }
+
     //! Returns the stream initial offset.
     inline uint64_t getInitialOffset()
     {
@@ -681,6 +691,8 @@ private:
 private:
     //! Underlying stream object.
     StreamWrapper m_stream;
+    //! Parse session, shared by all child streams.
+    ParseSession * m_session;
     //! Initial offset.
     uint64_t m_initial_offset;
     //! Stream size. Equal to box size.
@@ -48,17 +48,47 @@
 #include "uint24.hpp"
 #include "optional.hpp"
 
+class Property;
+
+//! Entries of a list property, which are converted only when they are requested.
+/*!
+ * \brief Tables and byte arrays may have millions of entries, so they are kept in their original form
+ * and only the requested range of them is converted to properties.
+ */
+class PropertyEntries
+{
+public:
+    virtual ~PropertyEntries()
+    {}
+
+public:
+    //! Returns the count of entries.
+    virtual int count() const = 0;
+    //! Returns the name of an entry.
+    virtual QString name(int index) const
+    {
+        return QString::number(index);
+    }
+    //! Converts an entry to a property.
+    virtual Property entry(int index) const = 0;
+};
+
+template<typename TContainer>
+class PropertyContainerEntries;
+
 //! Helper class, allowing to build trees of string values. Used for exporting box properties in human readable format. Uses curiosly recurring template pattern.
 class Property CC_CXX11_FINAL
         : public QList<Property>
 {
 public:
 	Property()
+        : m_is_binary(false)
 	{
 	}
 
     template<typename T>
     Property(T value)
+        : m_is_binary(false)
     {
         convert(value);
     }
@@ -67,7 +97,31 @@ public:
     //! Checks if a property contains other ones.
     bool isList() const
     {
-        return size() > 0;
+        return getCount() > 0;
+    }
+
+    //! Checks if the entries of a property are the lines of a hex dump.
+    bool isBinary() const
+    {
+        return m_is_binary;
+    }
+
+    //! Returns the count of the contained properties.
+    int getCount() const
+    {
+        return m_entries ? m_entries->count() : size();
+    }
+
+    //! Returns the name of a contained property.
+    QString getEntryName(int index) const
+    {
+        return m_entries ? m_entries->name(index) : QString::number(index);
+    }
+
+    //! Returns a contained property, converting it on request for tables and byte arrays.
+    Property getEntry(int index) const
+    {
+        return m_entries ? m_entries->entry(index) : at(index);
     }
 
     //! Returns a property value.
@@ -121,37 +175,18 @@ private:
     }
 
     //! Converts bit-arrays to lists of properties.
-    inline void convert(QBitArray value)
-    {
-        m_string = QString("Bitset of %1 records").arg(value.size());
-        for(int i = 0; i < value.size(); ++i)
-        {
-            push_back( Property(value.at(i)) );
-        }
-    }
+    inline void convert(QBitArray value);
 
     //! Converts lists of values to lists of properties.
     template<typename T>
     inline void convert(QList<T> value)
     {
         m_string = QString("List of %1 records").arg(value.size());
-        for(auto it = value.begin(), end = value.end(); it != end; ++it)
-        {
-			T entry = *it;
-            push_back( Property(entry) );
-        }
+        m_entries = std::make_shared< PropertyContainerEntries< QList<T> > >(value);
     }
 
-    //! Converts byte-arrays to lists of properties.
-    inline void convert(QByteArray value)
-    {
-        m_string = QString("Byte array of %1 records").arg(value.size());
-        for(auto it = value.begin(), end = value.end(); it != end; ++it)
-        {
-			uint8_t entry = *it;
-            push_back( Property(entry) );
-        }
-    }
+    //! Converts byte-arrays to hex dumps.
+    inline void convert(QByteArray value);
 
     //! Converts optional values to strings.
     template<typename T>
@@ -380,6 +415,89 @@ private:
 private:
     //! String container.
     QString m_string;
+    //! Entries converted on request, replacing the list contents for tables and byte arrays.
+    std::shared_ptr<const PropertyEntries> m_entries;
+    //! Whether the entries are the lines of a hex dump.
+    bool m_is_binary;
 };
 
+//! Entries of an implicitly shared container, converted one by one.
+template<typename TContainer>
+class PropertyContainerEntries CC_CXX11_FINAL
+        : public PropertyEntries
+{
+public:
+    explicit PropertyContainerEntries(const TContainer & container)
+        : m_container(container)
+    {}
+
+public:
+    virtual int count() const CC_CXX11_OVERRIDE
+    {
+        return m_container.size();
+    }
+
+    virtual Property entry(int index) const CC_CXX11_OVERRIDE
+    {
+        return Property(m_container.at(index));
+    }
+
+private:
+    //! Container, sharing the data with the box.
+    TContainer m_container;
+};
+
+//! Lines of a hex dump of a byte array.
+class PropertyHexDumpEntries CC_CXX11_FINAL
+        : public PropertyEntries
+{
+public:
+    explicit PropertyHexDumpEntries(const QByteArray & bytes)
+        : m_bytes(bytes)
+    {}
+
+public:
+    virtual int count() const CC_CXX11_OVERRIDE
+    {
+        return (m_bytes.size() + PROPERTY_HEX_DUMP_LINE_SIZE - 1) / PROPERTY_HEX_DUMP_LINE_SIZE;
+    }
+
+    //! Entries are named by the offset of their first byte.
+    virtual QString name(int index) const CC_CXX11_OVERRIDE
+    {
+        return QString("%1").arg(index * PROPERTY_HEX_DUMP_LINE_SIZE, 8, 16, QChar('0'));
+    }
+
+    //! Formats the bytes of a line in hex followed by their printable characters.
+    virtual Property entry(int index) const CC_CXX11_OVERRIDE
+    {
+        QByteArray line = m_bytes.mid(index * PROPERTY_HEX_DUMP_LINE_SIZE, PROPERTY_HEX_DUMP_LINE_SIZE);
+        QString hex = QString::fromLatin1(line.toHex(' ')).leftJustified(PROPERTY_HEX_DUMP_LINE_SIZE * 3, ' ');
+        QString text;
+        for(auto it = line.begin(), end = line.end(); it != end; ++it)
+        {
+            char character = *it;
+            text += ((character >= 0x20) && (character < 0x7F)) ? QChar::fromLatin1(character) : QChar('.');
+        }
+        return Property(hex + " " + text);
+    }
+
+private:
+    //! Byte array, sharing the data with the box.
+    QByteArray m_bytes;
+};
+
+inline void Property::convert(QBitArray value)
+{
+    m_string = QString("Bitset of %1 records").arg(value.size());
+    m_entries = std::make_shared< PropertyContainerEntries<QBitArray> >(value);
+}
+
+inline void Property::convert(QByteArray value)
+{
+    m_string = QString("Byte array of %1 records").arg(value.size());
+    m_entries = std::make_shared<PropertyHexDumpEntries>(value);
+    m_is_binary = true;
+}
+
 #endif // PROPERTY_H
@@ -27,74 +27,205 @@
 
 #include "crosscompilation_cxx11.h"
 
-#include <fstream>
+#include <QDir>
+#include <QSemaphore>
+
+#include <atomic>
 
 #include "mediaParser.h"
 
-#include "boxFactory.h"
+#include "decodePool.h"
+#include "parseSession.h"
 
 MediaParser::MediaParser(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    m_fast_open(false),
+    m_is_checking(false),
+    m_generation(0)
 {
-    BoxFactory & factory = BoxFactory::instance();
-
-    QObject::connect(&factory, &BoxFactory::boxCreated, &m_consistency_checker, &ConsistencyChecker::onBoxCreated);
-    QObject::connect(&m_consistency_checker, &ConsistencyChecker::mandatoryBoxIsMissing, &factory, &BoxFactory::onMandatoryBoxIsMissing);
-    QObject::connect(&m_consistency_checker, &ConsistencyChecker::mandatoryBoxesAreMissing, &factory, &BoxFactory::onMandatoryBoxesAreMissing);
-    QObject::connect(&m_consistency_checker, &ConsistencyChecker::boxCountIsExceeding, &factory, &BoxFactory::onBoxCountIsExceeding);
-    QObject::connect(&m_consistency_checker, &ConsistencyChecker::unexpectedBoxesMet, &factory, &BoxFactory::onUnexpectedBoxesMet);
-
-    QObject::connect(this, &MediaParser::fileOpened, &m_validator_iso, &ValidatorISO::onFileOpened);
-    QObject::connect(this, &MediaParser::fileClosed, &m_validator_iso, &ValidatorISO::onFileClosed);
     QObject::connect(this, &MediaParser::contentsCleared, &m_validator_iso, &ValidatorISO::onContentsCleared);
-    QObject::connect(&factory, &BoxFactory::boxCreated, &m_validator_iso, &ValidatorISO::onBoxCreated);
-
-    QObject::connect(this, &MediaParser::fileOpened, &m_validator_Surveillance, &ValidatorSurveillance::onFileOpened);
-    QObject::connect(this, &MediaParser::fileClosed, &m_validator_Surveillance, &ValidatorSurveillance::onFileClosed);
     QObject::connect(this, &MediaParser::contentsCleared, &m_validator_Surveillance, &ValidatorSurveillance::onContentsCleared);
-    QObject::connect(&factory, &BoxFactory::boxCreated, &m_validator_Surveillance, &ValidatorSurveillance::onBoxCreated);
-
-    QObject::connect(this, &MediaParser::fileOpened, &m_validator_oxf, &ValidatorOXF::onFileOpened);
-    QObject::connect(this, &MediaParser::fileClosed, &m_validator_oxf, &ValidatorOXF::onFileClosed);
     QObject::connect(this, &MediaParser::contentsCleared, &m_validator_oxf, &ValidatorOXF::onContentsCleared);
-    QObject::connect(&factory, &BoxFactory::boxCreated, &m_validator_oxf, &ValidatorOXF::onBoxCreated);
-
-    QObject::connect(this, &MediaParser::fileOpened, &m_segment_extractor, &SegmentExtractor::onFileOpened);
-    QObject::connect(this, &MediaParser::fileClosed, &m_segment_extractor, &SegmentExtractor::onFileClosed);
     QObject::connect(this, &MediaParser::contentsCleared, &m_segment_extractor, &SegmentExtractor::onContentsCleared);
-    QObject::connect(&factory, &BoxFactory::boxCreated, &m_segment_extractor, &SegmentExtractor::onBoxCreated);
-
-    QObject::connect(this, &MediaParser::fileOpened, &m_signature_extractor, &SignatureExtractor::onFileAdded);
-    QObject::connect(this, &MediaParser::fileClosed, &m_signature_extractor, &SignatureExtractor::onFileClosed);
     QObject::connect(this, &MediaParser::contentsCleared, &m_signature_extractor, &SignatureExtractor::onContentsCleared);
-    QObject::connect(&factory, &BoxFactory::boxCreated, &m_signature_extractor, &SignatureExtractor::onBoxCreated);
+    QObject::connect(this, &MediaParser::contentsCleared, &m_sample_index_extractor, &SampleIndexExtractor::onContentsCleared);
+}
+
+MediaParser::~MediaParser()
+{
+    DecodePool::instance().cancel(this);
+    DecodePool::instance().wait(this);
+}
+
+void MediaParser::setFastOpen(bool fast_open)
+{
+    m_fast_open = fast_open;
+}
+
+bool MediaParser::isFastOpen() const
+{
+    return m_fast_open;
 }
 
 void MediaParser::addFile(QString path)
 {
     if(!m_fileset_information.contains(path))
     {
-        std::shared_ptr<FileBox> fileBox(new FileBox());
-        const QByteArray asc = path.toLocal8Bit();
-        std::string str_path(asc.constData(), asc.length());
+        ParseSession session(path, m_fast_open);
+        session.parse();
+        mergeSession(session);
+    }
+}
+
+void MediaParser::addFiles(QStringList paths)
+{
+    paths.removeDuplicates();
+    paths.sort();
+
+    std::vector< std::shared_ptr<ParseSession> > sessions;
+    for(auto it = paths.begin(), end = paths.end(); it != end; ++it)
+    {
+        const QString & path = *it;
+        if(!m_fileset_information.contains(path))
+            sessions.push_back(std::make_shared<ParseSession>(path, m_fast_open));
+    }
+
+    parseSessions(sessions, true);
+
+    for(auto it = sessions.begin(), end = sessions.end(); it != end; ++it)
+    {
+        mergeSession(**it);
+    }
+}
+
+void MediaParser::addDirectory(QString path)
+{
+    QDir dir(path);
+    QStringList paths;
+    QStringList file_names = dir.entryList(QStringList() << "*.mp4" << "*.mov", QDir::Files, QDir::Name);
+    for(auto it = file_names.begin(), end = file_names.end(); it != end; ++it)
+    {
+        paths.append(dir.absoluteFilePath(*it));
+    }
+    addFiles(paths);
+}
+
+void MediaParser::followFile(QString path)
+{
+    if(m_fileset_information.contains(path))
+        return;
+
+    m_followed_session = std::make_shared<ParseSession>(path);
+    m_followed_session->parseAppended();
+    mergeSession(*m_followed_session);
+}
 
-        LimitedStreamReader limited_stream( std::shared_ptr<std::istream>(new std::ifstream(str_path, std::ios::binary ) ) );
+bool MediaParser::updateFollowedFile()
+{
+    if(!m_followed_session || !m_followed_session->parseAppended())
+        return false;
 
-        emit fileOpened(path);
+    // the box tree is shared with the session and grows in place, only the results have to be updated
+    const ParseSession & session = *m_followed_session;
+    const QString & path = session.getPath();
+    m_validator_iso.setFileInformation(path, session.getValidatorISO().getFileInformation(path));
+    m_validator_Surveillance.setFileInformation(path, session.getValidatorSurveillance().getFileInformation(path));
+    m_validator_oxf.setFileInformation(path, session.getValidatorOXF().getFileInformation(path));
+    const SegmentList & segments = session.getSegmentExtractor().getFoundSegments();
+    if(!segments.isEmpty())
+        m_segment_extractor.updateSegment(segments.front());
+    m_sample_index_extractor.setSampleIndex(path, session.getSampleIndexExtractor().getSampleIndex(path));
+    return true;
+}
 
-        fileBox->initialize(limited_stream);
+bool MediaParser::isFollowing() const
+{
+    return (bool)m_followed_session;
+}
 
-        m_consistency_checker.checkFileBox(fileBox.get());
+void MediaParser::parseSessions(const std::vector< std::shared_ptr<ParseSession> > & sessions, bool use_index)
+{
+    if(sessions.size() == 1)
+    {
+        sessions.front()->parse(use_index);
+    }
+    else
+    {
+        // the opening is waited for, so it goes before the background indexing
+        QSemaphore parsed;
+        for(auto it = sessions.begin(), end = sessions.end(); it != end; ++it)
+        {
+            std::shared_ptr<ParseSession> session = *it;
+            DecodePool::instance().runSteps([session, use_index, &parsed] ()
+            {
+                if(session->parseStep(use_index))
+                    return true;
+                parsed.release();
+                return false;
+            }, this, DecodePool::PrefetchPriority);
+        }
+        parsed.acquire((int)sessions.size());
+    }
+}
 
-        emit fileClosed();
+void MediaParser::mergeSession(const ParseSession & session)
+{
+    m_validator_iso.merge(session.getValidatorISO());
+    m_validator_Surveillance.merge(session.getValidatorSurveillance());
+    m_validator_oxf.merge(session.getValidatorOXF());
+    m_segment_extractor.merge(session.getSegmentExtractor());
+    m_signature_extractor.merge(session.getSignatureExtractor());
+    m_sample_index_extractor.merge(session.getSampleIndexExtractor());
+
+    m_fileset_information[session.getPath()] = session.getFileBox();
+    // the player opens the files through the same views
+    if(session.getFileView())
+        m_file_views[session.getPath()] = session.getFileView();
+    if(!session.isChecked())
+        m_unchecked_files.append(session.getPath());
+}
+
+void MediaParser::mergeCheckedSessions(const std::vector< std::shared_ptr<ParseSession> > & sessions, uint32_t generation)
+{
+    // the fileset was cleared while checking
+    if(generation != m_generation)
+        return;
 
-        m_fileset_information[path] = fileBox;
+    // the segments, signatures and sample indexes are known already, the signatures even point to the boxes of the old trees
+    for(auto it = sessions.begin(), end = sessions.end(); it != end; ++it)
+    {
+        const ParseSession & session = **it;
+        const QString & path = session.getPath();
+        m_validator_iso.setFileInformation(path, session.getValidatorISO().getFileInformation(path));
+        m_validator_Surveillance.setFileInformation(path, session.getValidatorSurveillance().getFileInformation(path));
+        m_validator_oxf.setFileInformation(path, session.getValidatorOXF().getFileInformation(path));
+        m_superseded_file_boxes.append(m_fileset_information[path]);
+        m_fileset_information[path] = session.getFileBox();
+        m_unchecked_files.removeAll(path);
     }
+    m_is_checking = false;
+
+    // files could be added while checking
+    if(!m_unchecked_files.isEmpty())
+        checkFileset();
+    else
+        emit filesetChecked();
 }
 
 void MediaParser::clearContents()
 {
+    DecodePool::instance().cancel(this);
     m_fileset_information.clear();
+    m_file_views.clear();
+    m_unchecked_files.clear();
+    m_is_checking = false;
+    m_generation++;
+    m_superseded_file_boxes.clear();
+    if(m_followed_session)
+    {
+        m_followed_session->finishAppending();
+        m_followed_session.reset();
+    }
     emit contentsCleared();
 }
 
@@ -123,12 +254,58 @@ SegmentList MediaParser::getSegments()
     return m_segment_extractor.getSegments();
 }
 
+SegmentTimeline MediaParser::getTimeline()
+{
+    return m_segment_extractor.getTimeline();
+}
+
 SigningInformationMap MediaParser::getSignaturesMap() const
 {
     return m_signature_extractor.getSignaturesMap();
 }
 
-FilesetInformation MediaParser::getFilesetInformation()
+SampleIndex MediaParser::getSampleIndex(const QString & path) const
+{
+    return m_sample_index_extractor.getSampleIndex(path);
+}
+
+FilesetInformation MediaParser::getFilesetInformation() const
 {
     return m_fileset_information;
 }
+
+bool MediaParser::isChecked() const
+{
+    return m_unchecked_files.isEmpty();
+}
+
+void MediaParser::checkFileset()
+{
+    if(m_is_checking || m_unchecked_files.isEmpty())
+        return;
+
+    std::vector< std::shared_ptr<ParseSession> > sessions;
+    for(auto it = m_unchecked_files.begin(), end = m_unchecked_files.end(); it != end; ++it)
+    {
+        sessions.push_back(std::make_shared<ParseSession>(*it));
+    }
+    m_is_checking = true;
+
+    // the complete parsing writes the parse index, so the next opening restores the checked results
+    uint32_t generation = m_generation;
+    std::shared_ptr< std::atomic<size_t> > remaining = std::make_shared< std::atomic<size_t> >(sessions.size());
+    for(auto it = sessions.begin(), end = sessions.end(); it != end; ++it)
+    {
+        std::shared_ptr<ParseSession> session = *it;
+        DecodePool::instance().runSteps([this, session, sessions, generation, remaining] ()
+        {
+            // a step parses a single top level box, so clearing the fileset cancels the checking quickly
+            if(session->parseStep(false))
+                return true;
+            // the last finished session merges all of them
+            if(--(*remaining) == 0)
+                QMetaObject::invokeMethod(this, [this, sessions, generation] () { mergeCheckedSessions(sessions, generation); }, Qt::QueuedConnection);
+            return false;
+        }, this);
+    }
+}
@@ -31,31 +31,66 @@
 #include "crosscompilation_cxx11.h"
 
 #include <QObject>
+#include <QStringList>
 #include <memory>
+#include <vector>
 #include "basic/mixin/children.hpp"
 #include "basic/fileBox.hpp"
-#include "consistencyChecker.h"
 #include "validatorISO.h"
 #include "validatorSurveillance.h"
 #include "validatorOXF.h"
 #include "segmentExtractor.h"
 #include "signatureExtractor.h"
+#include "sampleIndexExtractor.h"
+
+class FileView;
+class ParseSession;
 
 typedef QMap< QString, std::shared_ptr<FileBox> > FilesetInformation;
 
 //! Main interface class for the parser.
 /*!
  * \brief Class performing all the necessary actions around file parsing, validation, fragment list extraction.
+ * In the fast open mode files are parsed only for the playback, the consistency and conformance checks are
+ * run by checkFileset in the background, when their results are going to be shown.
  */
 class MediaParser : public QObject
 {
     Q_OBJECT
 public:
     explicit MediaParser(QObject *parent = 0);
+    //! Cancels the checks not started yet and waits for the running ones.
+    ~MediaParser();
 
 public:
+    //! Enables or disables the fast open mode for the files added later.
+    void setFastOpen(bool fast_open);
+    //! Returns if the fast open mode is enabled.
+    bool isFastOpen() const;
     //! Adds a file to a fileset, parsing its contents.
     void addFile(QString path);
+    //! Adds several files to a fileset, parsing them in parallel.
+    /*!
+     * Each file is parsed in its own session on a thread pool.
+     * The results are merged in the order of the file paths, so they do not depend on the thread scheduling.
+     * \param paths list of files to be added
+     */
+    void addFiles(QStringList paths);
+    //! Adds all video files of a directory to a fileset, parsing them in parallel.
+    void addDirectory(QString path);
+    //! Adds a file, which is still being written, to a fileset, parsing its complete boxes.
+    /*!
+     * The file stays opened for parsing, the data appended later are parsed by updateFollowedFile.
+     * \param path path of the file
+     */
+    void followFile(QString path);
+    //! Parses the data appended to the followed file since the previous call.
+    /*!
+     * \return true, if the file has grown and the fileset information was updated
+     */
+    bool updateFollowedFile();
+    //! Returns if a file is being followed.
+    bool isFollowing() const;
     //! Clears a fileset information.
     void clearContents();
     //! Returns if the file (or a fileset) is a valid Onvif export file.
@@ -68,26 +103,61 @@ public:
     bool isValidISOFileset();
     //! Returns the Surveillance fragments list.
     SegmentList getSegments();
+    //! Returns the Surveillance fragments ordered into a timeline, together with the chaining problems found.
+    SegmentTimeline getTimeline();
     //! Returns the signature information for the fragment set.
     SigningInformationMap getSignaturesMap() const;
+    //! Returns the per track sample indexes of a file of the fileset.
+    SampleIndex getSampleIndex(const QString & path) const;
     //! Returns the fileset parsing result, e.g. for showing them in the UI.
-    FilesetInformation getFilesetInformation();
+    /*!
+     * The box trees of the files opened in the fast open mode or restored from their parse index
+     * are complete and checked only after checkFileset has finished.
+     */
+    FilesetInformation getFilesetInformation() const;
+    //! Returns if all the files of the fileset were parsed completely and checked.
+    bool isChecked() const;
+    //! Starts parsing the files, which were not checked yet, completely in the background.
+    /*!
+     * Each file is parsed by an indexing task of the DecodePool, so the checks never hold back the playback.
+     * The results are cached in the parse index of each file, so they are checked only once.
+     * filesetChecked is sent, when the results are merged into the fileset.
+     */
+    void checkFileset();
 
 signals:
-    //! This signal is sent before the file is parsed.
-    void fileOpened(QString path);
-    //! This signal is sent after the file parsing was finished.
-    void fileClosed();
     //! This signal is sent when the fileset is cleared.
     void contentsCleared();
+    //! This signal is sent when all the files of the fileset were checked.
+    void filesetChecked();
     
 public slots:
 
 private:
+    //! Parses the files of the sessions, in parallel if there are several of them.
+    static void parseSessions(const std::vector< std::shared_ptr<ParseSession> > & sessions, bool use_index);
+    //! Adds the results of a finished parse session to the fileset.
+    void mergeSession(const ParseSession & session);
+    //! Replaces the unchecked results by the ones of the sessions run by checkFileset.
+    void mergeCheckedSessions(const std::vector< std::shared_ptr<ParseSession> > & sessions, uint32_t generation);
+
+private:
+    //! Whether the files are added in the fast open mode.
+    bool m_fast_open;
     //! Fileset information.
     FilesetInformation m_fileset_information;
-    //! Consistency checker.
-    ConsistencyChecker m_consistency_checker;
+    //! Files, which were opened in the fast open mode or which box trees were restored from the parse index.
+    QStringList m_unchecked_files;
+    //! Whether checkFileset is running.
+    bool m_is_checking;
+    //! Number of the fileset contents, increased on clearing, so the results of an outdated check are dropped.
+    uint32_t m_generation;
+    //! Partial box trees replaced by the complete ones. Kept, as the signatures point to their boxes.
+    QList< std::shared_ptr<FileBox> > m_superseded_file_boxes;
+    //! Views of the files of the fileset, kept so the player opens the files through the views the parser read.
+    QMap< QString, std::shared_ptr<FileView> > m_file_views;
+    //! Session parsing the followed file.
+    std::shared_ptr<ParseSession> m_followed_session;
     //! Validator for ISO base media files.
     ValidatorISO m_validator_iso;
     //! Validator for Surveillance files.
@@ -98,6 +168,8 @@ private:
     SegmentExtractor m_segment_extractor;
     //! Extractor of the OXF signatures list.
     SignatureExtractor m_signature_extractor;
+    //! Extractor of the sample indexes.
+    SampleIndexExtractor m_sample_index_extractor;
 };
 
 #endif // MEDIAPARSER_H
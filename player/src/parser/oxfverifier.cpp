@@ -35,11 +35,14 @@
 #include <QStringList>
 #include "oxfverifier.h"
 
+#include "defines.h"
+#include "fileView.h"
+
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
 
-static const qint64 cMaxLen = 1024*8;
+static const qint64 cMaxLen = FILE_VIEW_BLOCK_SIZE;
 
 QString toDebug(const char * line, int size)
 {
@@ -227,16 +230,18 @@ bool OXFVerifier::calculateCryptoHashOther(QCryptographicHash& sh, QIODevice& in
 void OXFVerifier::run()
 {
     VerificationStatus  st = vsNA;
-    QFile       inp(m_fileName);
-    QFileInfo   iff(inp);
-
-    if (!inp.open(QIODevice::ReadOnly))
+    std::shared_ptr<FileView> view = FileView::open(m_fileName);
+    if (!view)
     {
         emit operationCompleted(vsFailed);
         return;
     }
 
-    qint64      fileSize = iff.size();
+    // the view reads files on network shares ahead of the hash calculation
+    FileViewDevice  inp(view);
+    inp.open(QIODevice::ReadOnly);
+
+    qint64      fileSize = inp.size();
     int         steps = fileSize/cMaxLen + 15;
 
     emit operationStarted(steps);
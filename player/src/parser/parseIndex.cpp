@@ -0,0 +1,390 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "parseIndex.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSysInfo>
+#include <QtDebug>
+
+#include "defines.h"
+#include "basic/fileBox.hpp"
+#include "signatureBox.hpp"
+
+#include <atomic>
+
+namespace
+{
+    //! Identifies index files.
+    const quint32 sc_index_magic = 0x4F504958; // 'OPIX'
+    //! Has to be increased on every change of the index format or of the parsing results.
+    const quint32 sc_index_version = 6;
+    //! Byte order of the raw tables, indexes written on another machine are not read.
+    const quint8 sc_byte_order = quint8(QSysInfo::ByteOrder);
+    //! Stored size of a box entry.
+    const int sc_box_entry_size = sizeof(quint32) + sizeof(quint16) + 2 * sizeof(quint64);
+
+    //! Appends the boxes of a subtree to the layout in the file order.
+    void collectBoxes(ChildrenMixin * parent, uint16_t depth, ParseIndex::BoxEntryList & layout)
+    {
+        BoxPtrList & children = parent->getChildren();
+        for(auto it = children.begin(), end = children.end(); it != end; ++it)
+        {
+            Box * box = *it;
+            // stubs of missing boxes are recreated by the consistency checker
+            if(box->getConsistencyError() & Box::IsMandatoryBox)
+                continue;
+
+            ParseIndex::BoxEntry entry;
+            entry.m_four_cc = (uint32_t)box->getBoxFourCC();
+            entry.m_depth = depth;
+            entry.m_offset = box->getBoxOffset();
+            entry.m_size = box->getBoxSize();
+            layout.append(entry);
+
+            ChildrenMixin * children_mixin = dynamic_cast<ChildrenMixin *>(box);
+            if(children_mixin != nullptr)
+                collectBoxes(children_mixin, depth + 1, layout);
+        }
+    }
+}
+
+ParseIndex::ParseIndex()
+    : m_is_checked(true)
+{
+}
+
+bool ParseIndex::load(const QString & path)
+{
+    QFile file(getIndexPath(path));
+    if(!file.exists() || !file.open(QIODevice::ReadOnly))
+        return false;
+
+    QByteArray fingerprint_value = fingerprint(path);
+    if(fingerprint_value.isEmpty())
+        return false;
+
+    uchar * data = file.map(0, file.size());
+    QByteArray bytes = (data != nullptr) ? QByteArray::fromRawData(reinterpret_cast<const char *>(data), file.size()) : file.readAll();
+
+    QDataStream stream(bytes);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0, version = 0;
+    quint8 byte_order = 0;
+    QByteArray stored_fingerprint;
+    stream >> magic >> version >> byte_order >> stored_fingerprint;
+    bool result = (magic == sc_index_magic) && (version == sc_index_version) && (byte_order == sc_byte_order) &&
+                  (stored_fingerprint == fingerprint_value);
+    if(result)
+    {
+        quint32 count = 0;
+        stream >> count;
+        result = (stream.status() == QDataStream::Ok) && (count <= quint32(bytes.size() / sc_box_entry_size));
+        if(result)
+        {
+            m_box_layout.resize(int(count));
+            for(auto it = m_box_layout.begin(), end = m_box_layout.end(); it != end; ++it)
+            {
+                quint64 offset = 0, size = 0;
+                stream >> it->m_four_cc >> it->m_depth >> offset >> size;
+                it->m_offset = offset;
+                it->m_size = size;
+            }
+        }
+    }
+    if(result)
+    {
+
+        stream >> m_iso_information.m_filetype_box_count
+               >> m_iso_information.m_movie_box_count
+               >> m_iso_information.m_movie_data_box_count
+               >> m_iso_information.m_movie_header_box_count
+               >> m_iso_information.m_track_box_count;
+
+        qint32 segment_type = 0;
+        stream >> m_surveillance_information.m_af_identification_box_count
+               >> segment_type
+               >> m_surveillance_information.m_predecessor_UUID
+               >> m_surveillance_information.m_segment_UUID
+               >> m_surveillance_information.m_successor_UUID;
+        m_surveillance_information.m_segment_type = SurviellanceFileInformation::FragmentType(segment_type);
+
+        stream >> m_oxf_information.m_surveillance_export_box_count
+               >> m_oxf_information.m_signature_box_count
+               >> m_oxf_information.m_certificate_box_count;
+
+        stream >> m_is_checked >> m_segments;
+
+        quint32 track_count = 0;
+        stream >> track_count;
+        m_sample_index.clear();
+        for(quint32 i = 0; (i < track_count) && result && (stream.status() == QDataStream::Ok); ++i)
+        {
+            quint32 track_id = 0;
+            stream >> track_id;
+            result = m_sample_index[track_id].readTables(stream);
+        }
+
+        result = result && (stream.status() == QDataStream::Ok);
+    }
+
+    if(data != nullptr)
+        file.unmap(data);
+
+    //the index is kept by the pruning as long as it is used
+    if(result)
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    else
+        qDebug() << "Parse index of" << path << "is outdated";
+    return result;
+}
+
+bool ParseIndex::save(const QString & path) const
+{
+    QByteArray fingerprint_value = fingerprint(path);
+    if(fingerprint_value.isEmpty())
+        return false;
+
+    QSaveFile file(getIndexPath(path));
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    stream << sc_index_magic << sc_index_version << sc_byte_order << fingerprint_value;
+
+    stream << quint32(m_box_layout.size());
+    for(auto it = m_box_layout.begin(), end = m_box_layout.end(); it != end; ++it)
+        stream << it->m_four_cc << it->m_depth << quint64(it->m_offset) << quint64(it->m_size);
+
+    stream << m_iso_information.m_filetype_box_count
+           << m_iso_information.m_movie_box_count
+           << m_iso_information.m_movie_data_box_count
+           << m_iso_information.m_movie_header_box_count
+           << m_iso_information.m_track_box_count;
+
+    stream << m_surveillance_information.m_af_identification_box_count
+           << qint32(m_surveillance_information.m_segment_type)
+           << m_surveillance_information.m_predecessor_UUID
+           << m_surveillance_information.m_segment_UUID
+           << m_surveillance_information.m_successor_UUID;
+
+    stream << m_oxf_information.m_surveillance_export_box_count
+           << m_oxf_information.m_signature_box_count
+           << m_oxf_information.m_certificate_box_count;
+
+    stream << m_is_checked << m_segments;
+
+    stream << quint32(m_sample_index.size());
+    for(auto it = m_sample_index.begin(), end = m_sample_index.end(); it != end; ++it)
+    {
+        stream << quint32(it.key());
+        it->writeTables(stream);
+    }
+
+    if(stream.status() != QDataStream::Ok)
+    {
+        file.cancelWriting();
+        return false;
+    }
+    if(!file.commit())
+        return false;
+
+    //indexes of files not opened for long are dropped once per run
+    static std::atomic<bool> pruned(false);
+    if(!pruned.exchange(true))
+        prune(getIndexFolder(), "*.idx", qint64(PARSE_INDEX_MAX_SIZE) * 1024 * 1024, PARSE_INDEX_MAX_AGE);
+    return true;
+}
+
+void ParseIndex::remove(const QString & path)
+{
+    QFile::remove(getIndexPath(path));
+}
+
+int ParseIndex::prune(const QString & folder, const QString & name_filter, qint64 max_size, int max_age_days)
+{
+    //the files used longest ago come first
+    QFileInfoList files = QDir(folder).entryInfoList(QStringList() << name_filter, QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 size = 0;
+    for(auto it = files.begin(), end = files.end(); it != end; ++it)
+        size += it->size();
+
+    QDateTime oldest = QDateTime::currentDateTime().addDays(-max_age_days);
+    int removed = 0;
+    for(auto it = files.begin(), end = files.end(); it != end; ++it)
+    {
+        if(size <= max_size &&
+           it->lastModified() >= oldest)
+            break;
+        if(QFile::remove(it->absoluteFilePath()))
+        {
+            size -= it->size();
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+QString ParseIndex::getIndexFolder()
+{
+    QString index_folder;
+#ifdef _WIN32
+    index_folder = QDir::homePath() + WINP_APP_DATA_ROAMING + COMPANY_NAME + "/" + PRODUCT_NAME + "/" + PARSE_INDEX_FOLDER;
+#else
+    index_folder = QDir::homePath() + "/." + PRODUCT_NAME + "/" + PARSE_INDEX_FOLDER;
+#endif //UNIX
+
+    //create it if needed
+    if(!QDir().exists(index_folder))
+        QDir().mkpath(index_folder);
+
+    return index_folder;
+}
+
+void ParseIndex::setBoxLayout(FileBox * file_box)
+{
+    m_box_layout.clear();
+    collectBoxes(file_box, 0, m_box_layout);
+}
+
+const ParseIndex::BoxEntryList & ParseIndex::getBoxLayout() const
+{
+    return m_box_layout;
+}
+
+QList<uint64_t> ParseIndex::getSignatureContainerOffsets() const
+{
+    static const uint32_t sc_sibo_four_cc = (uint32_t)SignatureBox::getFourCC();
+
+    QList<uint64_t> offsets;
+    const BoxEntry * top_level_box = nullptr;
+    for(auto it = m_box_layout.begin(), end = m_box_layout.end(); it != end; ++it)
+    {
+        if(it->m_depth == 0)
+        {
+            top_level_box = &(*it);
+        }
+        else if((it->m_four_cc == sc_sibo_four_cc) && (top_level_box != nullptr))
+        {
+            if(offsets.isEmpty() || (offsets.back() != top_level_box->m_offset))
+                offsets.append(top_level_box->m_offset);
+        }
+    }
+    return offsets;
+}
+
+void ParseIndex::setISOFileInformation(const ISOFileInformation & information)
+{
+    m_iso_information = information;
+}
+
+const ISOFileInformation & ParseIndex::getISOFileInformation() const
+{
+    return m_iso_information;
+}
+
+void ParseIndex::setSurveillanceFileInformation(const SurviellanceFileInformation & information)
+{
+    m_surveillance_information = information;
+}
+
+const SurviellanceFileInformation & ParseIndex::getSurveillanceFileInformation() const
+{
+    return m_surveillance_information;
+}
+
+void ParseIndex::setOXFFileInformation(const OXFFileInformation & information)
+{
+    m_oxf_information = information;
+}
+
+const OXFFileInformation & ParseIndex::getOXFFileInformation() const
+{
+    return m_oxf_information;
+}
+
+void ParseIndex::setChecked(bool is_checked)
+{
+    m_is_checked = is_checked;
+}
+
+bool ParseIndex::isChecked() const
+{
+    return m_is_checked;
+}
+
+void ParseIndex::setSegments(const SegmentList & segments)
+{
+    m_segments = segments;
+}
+
+const SegmentList & ParseIndex::getSegments() const
+{
+    return m_segments;
+}
+
+void ParseIndex::setSampleIndex(const SampleIndex & sample_index)
+{
+    m_sample_index = sample_index;
+}
+
+const SampleIndex & ParseIndex::getSampleIndex() const
+{
+    return m_sample_index;
+}
+
+QString ParseIndex::getIndexPath(const QString & path)
+{
+    QByteArray path_hash = QCryptographicHash::hash(QFileInfo(path).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1);
+    return getIndexFolder() + "/" + QString::fromLatin1(path_hash.toHex()) + ".idx";
+}
+
+QByteArray ParseIndex::fingerprint(const QString & path)
+{
+    QFileInfo file_info(path);
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    QByteArray header;
+    QDataStream header_stream(&header, QIODevice::WriteOnly);
+    header_stream << file_info.absoluteFilePath() << qint64(file_info.size()) << file_info.lastModified().toMSecsSinceEpoch();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(header);
+    hash.addData(file.read(PARSE_INDEX_HEADER_SIZE));
+    return hash.result();
+}
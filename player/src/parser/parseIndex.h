@@ -0,0 +1,183 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef PARSEINDEX_H
+#define PARSEINDEX_H
+
+#include "crosscompilation_cxx11.h"
+#include "crosscompilation_inttypes.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "segmentInfo.h"
+#include "sampleIndex.h"
+#include "validatorISO.h"
+#include "validatorSurveillance.h"
+#include "validatorOXF.h"
+
+class FileBox;
+
+//! Results of a file parsing, stored next to the application settings to reopen the file without parsing it again.
+/*!
+ * \brief The index is bound to the file by its path, size, modification time and a hash of its beginning,
+ * so any change of the file invalidates the index.
+ * It keeps the layout of the boxes, the validation results, the segments and the sample index of the file.
+ * An index written by a fast open session is marked as unchecked, as its Surveillance and OXF validation results are missing:
+ * it is enough to reopen the file for the playback, but the checks have to parse the file again.
+ * Index files are memory mapped on loading, so reopening a file costs a single read of a small file.
+ * The sample tables are stored as raw data in the byte order of the machine, so each of them is copied from the mapping at once.
+ * They are not used in place, as they outlive the mapping: the player keeps the sample index for the whole playback,
+ * while the index file is replaced when the file grows. The box layout is written field by field, as its entries hold padding.
+ * Loading an index marks it as used, the indexes used longest ago are removed above PARSE_INDEX_MAX_SIZE
+ * or after PARSE_INDEX_MAX_AGE days, when the first index of a run is saved.
+ */
+class ParseIndex CC_CXX11_FINAL
+{
+public:
+    //! Position of a box within the file.
+    struct BoxEntry
+    {
+        BoxEntry()
+            : m_four_cc(0)
+            , m_depth(0)
+            , m_offset(0)
+            , m_size(0)
+        {}
+
+        //! FourCC code of the box.
+        uint32_t m_four_cc;
+        //! Nesting depth of the box, top level boxes have 0.
+        uint16_t m_depth;
+        //! Offset of the box from the file beginning.
+        uint64_t m_offset;
+        //! Size of the box.
+        uint64_t m_size;
+    };
+
+    typedef QVector<BoxEntry> BoxEntryList;
+
+public:
+    ParseIndex();
+
+public:
+    //! Loads the index of a file.
+    /*!
+     * \param path path of the indexed file
+     * \return true, if the index exists and was created for the current file contents
+     */
+    bool load(const QString & path);
+
+    //! Saves the index of a file.
+    /*!
+     * \param path path of the indexed file
+     * \return true, if the index was written
+     */
+    bool save(const QString & path) const;
+
+    //! Removes the index of a file.
+    static void remove(const QString & path);
+
+    //! Removes the files of a cache folder used longest ago, until the folder keeps a size and an age limit.
+    /*!
+     * A file counts as used at its modification time, so loading it has to touch it.
+     * \param folder cache folder
+     * \param name_filter pattern of the cache files, e.g. "*.idx"
+     * \param max_size size of the files in bytes kept at most
+     * \param max_age_days days a file is kept without being used
+     * \return count of the removed files
+     */
+    static int prune(const QString & folder, const QString & name_filter, qint64 max_size, int max_age_days);
+
+    //! Returns the folder where index files are stored.
+    static QString getIndexFolder();
+
+    //! Computes the identity of the file contents, empty if the file cannot be read.
+    static QByteArray fingerprint(const QString & path);
+
+public:
+    //! Collects the box layout from a parsed box tree.
+    void setBoxLayout(FileBox * file_box);
+    //! Returns the box layout in the file order.
+    const BoxEntryList & getBoxLayout() const;
+    //! Returns the offsets of the top level boxes containing signatures.
+    QList<uint64_t> getSignatureContainerOffsets() const;
+
+    //! Sets the ISO base media validation result.
+    void setISOFileInformation(const ISOFileInformation & information);
+    //! Returns the ISO base media validation result.
+    const ISOFileInformation & getISOFileInformation() const;
+
+    //! Sets the Surveillance validation result.
+    void setSurveillanceFileInformation(const SurviellanceFileInformation & information);
+    //! Returns the Surveillance validation result.
+    const SurviellanceFileInformation & getSurveillanceFileInformation() const;
+
+    //! Sets the Onvif export file validation result.
+    void setOXFFileInformation(const OXFFileInformation & information);
+    //! Returns the Onvif export file validation result.
+    const OXFFileInformation & getOXFFileInformation() const;
+
+    //! Sets whether the consistency and conformance checks were run, so the validation results are complete.
+    void setChecked(bool is_checked);
+    //! Checks if the consistency and conformance checks were run, so the validation results are complete.
+    bool isChecked() const;
+
+    //! Sets the segments found in the file.
+    void setSegments(const SegmentList & segments);
+    //! Returns the segments found in the file.
+    const SegmentList & getSegments() const;
+
+    //! Sets the sample indexes of the tracks.
+    void setSampleIndex(const SampleIndex & sample_index);
+    //! Returns the sample indexes of the tracks.
+    const SampleIndex & getSampleIndex() const;
+
+private:
+    //! Returns the path of the index file of a file.
+    static QString getIndexPath(const QString & path);
+
+private:
+    //! Layout of the boxes.
+    BoxEntryList m_box_layout;
+    //! ISO base media validation result.
+    ISOFileInformation m_iso_information;
+    //! Surveillance validation result.
+    SurviellanceFileInformation m_surveillance_information;
+    //! Onvif export file validation result.
+    OXFFileInformation m_oxf_information;
+    //! Whether the validation results are complete.
+    bool m_is_checked;
+    //! Segments found in the file.
+    SegmentList m_segments;
+    //! Sample indexes of the tracks.
+    SampleIndex m_sample_index;
+};
+
+#endif // PARSEINDEX_H
@@ -0,0 +1,297 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "crosscompilation_cxx11.h"
+
+#include <fstream>
+
+#include <QtDebug>
+
+#include "parseSession.h"
+
+#include "boxFactory.h"
+#include "fileView.h"
+
+ParseSession::ParseSession(const QString & path, bool fast_open /*= false*/)
+    : QObject()
+    , m_path(path)
+    , m_file_box(new FileBox())
+    , m_depth(0)
+    , m_fast_open(fast_open)
+    , m_is_restored(false)
+    , m_is_restoring(false)
+    , m_is_parsed(false)
+    , m_is_appending(false)
+    , m_appended_size(0)
+{
+    BoxFactory & factory = BoxFactory::instance();
+
+    // The session is usually created in one thread and parsed in another one, so all connections have to be direct.
+    if(!m_fast_open)
+    {
+        QObject::connect(this, &ParseSession::boxCreated, &m_consistency_checker, &ConsistencyChecker::onBoxCreated, Qt::DirectConnection);
+        QObject::connect(&m_consistency_checker, &ConsistencyChecker::mandatoryBoxIsMissing, &factory, &BoxFactory::onMandatoryBoxIsMissing, Qt::DirectConnection);
+        QObject::connect(&m_consistency_checker, &ConsistencyChecker::mandatoryBoxesAreMissing, &factory, &BoxFactory::onMandatoryBoxesAreMissing, Qt::DirectConnection);
+        QObject::connect(&m_consistency_checker, &ConsistencyChecker::boxCountIsExceeding, &factory, &BoxFactory::onBoxCountIsExceeding, Qt::DirectConnection);
+        QObject::connect(&m_consistency_checker, &ConsistencyChecker::unexpectedBoxesMet, &factory, &BoxFactory::onUnexpectedBoxesMet, Qt::DirectConnection);
+    }
+
+    QObject::connect(this, &ParseSession::fileOpened, &m_validator_iso, &ValidatorISO::onFileOpened, Qt::DirectConnection);
+    QObject::connect(this, &ParseSession::fileClosed, &m_validator_iso, &ValidatorISO::onFileClosed, Qt::DirectConnection);
+    QObject::connect(this, &ParseSession::boxCreated, &m_validator_iso, &ValidatorISO::onBoxCreated, Qt::DirectConnection);
+
+    if(!m_fast_open)
+    {
+        QObject::connect(this, &ParseSession::fileOpened, &m_validator_surveillance, &ValidatorSurveillance::onFileOpened, Qt::DirectConnection);
+        QObject::connect(this, &ParseSession::fileClosed, &m_validator_surveillance, &ValidatorSurveillance::onFileClosed, Qt::DirectConnection);
+        QObject::connect(this, &ParseSession::boxCreated, &m_validator_surveillance, &ValidatorSurveillance::onBoxCreated, Qt::DirectConnection);
+
+        QObject::connect(this, &ParseSession::fileOpened, &m_validator_oxf, &ValidatorOXF::onFileOpened, Qt::DirectConnection);
+        QObject::connect(this, &ParseSession::fileClosed, &m_validator_oxf, &ValidatorOXF::onFileClosed, Qt::DirectConnection);
+        QObject::connect(this, &ParseSession::boxCreated, &m_validator_oxf, &ValidatorOXF::onBoxCreated, Qt::DirectConnection);
+    }
+
+    QObject::connect(this, &ParseSession::fileOpened, &m_segment_extractor, &SegmentExtractor::onFileOpened, Qt::DirectConnection);
+    QObject::connect(this, &ParseSession::fileClosed, &m_segment_extractor, &SegmentExtractor::onFileClosed, Qt::DirectConnection);
+    QObject::connect(this, &ParseSession::boxCreated, &m_segment_extractor, &SegmentExtractor::onBoxCreated, Qt::DirectConnection);
+
+    QObject::connect(this, &ParseSession::fileOpened, &m_signature_extractor, &SignatureExtractor::onFileAdded, Qt::DirectConnection);
+    QObject::connect(this, &ParseSession::fileClosed, &m_signature_extractor, &SignatureExtractor::onFileClosed, Qt::DirectConnection);
+    QObject::connect(this, &ParseSession::boxCreated, &m_signature_extractor, &SignatureExtractor::onBoxCreated, Qt::DirectConnection);
+
+    QObject::connect(this, &ParseSession::fileOpened, &m_sample_index_extractor, &SampleIndexExtractor::onFileOpened, Qt::DirectConnection);
+    QObject::connect(this, &ParseSession::fileClosed, &m_sample_index_extractor, &SampleIndexExtractor::onFileClosed, Qt::DirectConnection);
+    QObject::connect(this, &ParseSession::boxCreated, &m_sample_index_extractor, &SampleIndexExtractor::onBoxCreated, Qt::DirectConnection);
+}
+
+void ParseSession::parse(bool use_index /*= true*/)
+{
+    while(parseStep(use_index))
+    {
+    }
+}
+
+bool ParseSession::parseStep(bool use_index /*= true*/)
+{
+    if(m_is_parsed)
+        return false;
+
+    if(!m_stream)
+    {
+        if(use_index && restore())
+        {
+            m_is_parsed = true;
+            return false;
+        }
+
+        m_stream.reset(new LimitedStreamReader( openFile(), this ));
+
+        emit fileOpened(m_path);
+
+        m_file_box->beginInitialize(*m_stream);
+        return true;
+    }
+
+    if(m_file_box->initializeNext(*m_stream))
+        return true;
+
+    if(!m_fast_open)
+        m_consistency_checker.checkFileBox(m_file_box.get());
+
+    emit fileClosed();
+
+    m_stream.reset();
+    m_is_parsed = true;
+
+    // an index without the results of the checks is marked as unchecked, it still spares the parsing on reopening
+    saveIndex();
+    return false;
+}
+
+bool ParseSession::parseAppended()
+{
+    const QByteArray asc = m_path.toLocal8Bit();
+    std::string str_path(asc.constData(), asc.length());
+
+    std::shared_ptr<std::istream> file_stream(new std::ifstream(str_path, std::ios::binary));
+    if(!*file_stream)
+        return false;
+
+    // the stream measures the file size once, so every call sees the data written so far
+    LimitedStreamReader limited_stream( file_stream, this );
+
+    if(!m_is_appending)
+    {
+        m_is_appending = true;
+        emit fileOpened(m_path);
+    }
+
+    uint64_t appended_size = m_file_box->initializeAppended(limited_stream, m_appended_size);
+    bool result = (appended_size != m_appended_size);
+    m_appended_size = appended_size;
+    return result;
+}
+
+void ParseSession::finishAppending()
+{
+    if(!m_is_appending)
+        return;
+
+    m_consistency_checker.checkFileBox(m_file_box.get());
+
+    emit fileClosed();
+
+    m_is_appending = false;
+}
+
+bool ParseSession::isRestored() const
+{
+    return m_is_restored;
+}
+
+bool ParseSession::isChecked() const
+{
+    return !m_is_restored && !m_fast_open;
+}
+
+const QString & ParseSession::getPath() const
+{
+    return m_path;
+}
+
+std::shared_ptr<FileBox> ParseSession::getFileBox() const
+{
+    return m_file_box;
+}
+
+std::shared_ptr<FileView> ParseSession::getFileView() const
+{
+    return m_file_view;
+}
+
+const ValidatorISO & ParseSession::getValidatorISO() const
+{
+    return m_validator_iso;
+}
+
+const ValidatorSurveillance & ParseSession::getValidatorSurveillance() const
+{
+    return m_validator_surveillance;
+}
+
+const ValidatorOXF & ParseSession::getValidatorOXF() const
+{
+    return m_validator_oxf;
+}
+
+const SegmentExtractor & ParseSession::getSegmentExtractor() const
+{
+    return m_segment_extractor;
+}
+
+const SignatureExtractor & ParseSession::getSignatureExtractor() const
+{
+    return m_signature_extractor;
+}
+
+const SampleIndexExtractor & ParseSession::getSampleIndexExtractor() const
+{
+    return m_sample_index_extractor;
+}
+
+void ParseSession::notifyBoxCreated(Box * box)
+{
+    // the validators already know the results of the whole file, only the signatures have to point to the actual boxes
+    if(m_is_restoring)
+        m_signature_extractor.onBoxCreated(box);
+    else
+        emit boxCreated(box);
+}
+
+size_t ParseSession::enterBox()
+{
+    return m_depth++;
+}
+
+void ParseSession::leaveBox()
+{
+    m_depth--;
+}
+
+bool ParseSession::restore()
+{
+    ParseIndex index;
+    if(!index.load(m_path))
+        return false;
+    // the checks need all the results, so an index of a fast open is parsed again
+    if(!m_fast_open && !index.isChecked())
+        return false;
+
+    LimitedStreamReader limited_stream( openFile(), this );
+
+    m_is_restoring = true;
+    m_signature_extractor.onFileAdded(m_path);
+    m_file_box->initializePartially(limited_stream, index.getSignatureContainerOffsets());
+    m_signature_extractor.onFileClosed();
+    m_is_restoring = false;
+
+    m_validator_iso.setFileInformation(m_path, index.getISOFileInformation());
+    m_validator_surveillance.setFileInformation(m_path, index.getSurveillanceFileInformation());
+    m_validator_oxf.setFileInformation(m_path, index.getOXFFileInformation());
+    const SegmentList & segments = index.getSegments();
+    for(auto it = segments.begin(), end = segments.end(); it != end; ++it)
+        m_segment_extractor.addSegment(*it);
+    m_sample_index_extractor.setSampleIndex(m_path, index.getSampleIndex());
+    m_is_restored = true;
+    return true;
+}
+
+void ParseSession::saveIndex()
+{
+    ParseIndex index;
+    index.setChecked(!m_fast_open);
+    index.setBoxLayout(m_file_box.get());
+    index.setISOFileInformation(m_validator_iso.getFileInformation(m_path));
+    index.setSurveillanceFileInformation(m_validator_surveillance.getFileInformation(m_path));
+    index.setOXFFileInformation(m_validator_oxf.getFileInformation(m_path));
+    index.setSegments(m_segment_extractor.getFoundSegments());
+    index.setSampleIndex(m_sample_index_extractor.getSampleIndex(m_path));
+
+    if(!index.save(m_path))
+        qDebug() << "Could not save the parse index of" << m_path;
+}
+
+std::shared_ptr<std::istream> ParseSession::openFile()
+{
+    m_file_view = FileView::open(m_path);
+    if(m_file_view)
+        return std::make_shared<FileViewStream>(m_file_view);
+
+    const QByteArray asc = m_path.toLocal8Bit();
+    std::string str_path(asc.constData(), asc.length());
+    return std::shared_ptr<std::istream>(new std::ifstream(str_path, std::ios::binary));
+}
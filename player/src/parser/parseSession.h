@@ -0,0 +1,182 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef PARSESESSION_H
+#define PARSESESSION_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QObject>
+#include <memory>
+
+#include "basic/fileBox.hpp"
+#include "consistencyChecker.h"
+#include "validatorISO.h"
+#include "validatorSurveillance.h"
+#include "validatorOXF.h"
+#include "segmentExtractor.h"
+#include "signatureExtractor.h"
+#include "sampleIndexExtractor.h"
+#include "parseIndex.h"
+
+class FileView;
+
+//! Context of a single file parsing.
+/*!
+ * \brief Owns everything, that has a state while a file is being parsed: the consistency checker,
+ * the validators and extractors listening to created boxes and the box nesting depth.
+ * Sessions do not share any state, so different files can be parsed in different threads at the same time.
+ * All the listeners are connected directly, so they are called in the thread performing the parsing.
+ * Parsing results are stored in a ParseIndex, so a file, which was not changed since, is reopened
+ * by reading only its index and the boxes containing signatures.
+ * In the fast open mode only the results needed for the playback are collected: the consistency checker and
+ * the Surveillance and OXF validators are not run, and the results are stored to the parse index marked as unchecked,
+ * so they are restored by the next fast open, but not by a session running the checks.
+ */
+class ParseSession CC_CXX11_FINAL
+        : public QObject
+{
+    Q_OBJECT
+public:
+    /*!
+     * \param path path of the file
+     * \param fast_open skip the consistency and conformance checks
+     */
+    explicit ParseSession(const QString & path, bool fast_open = false);
+
+public:
+    //! Parses the file. Can be called from any thread, but only once.
+    /*!
+     * \param use_index restore the results from the parse index, if it is up to date
+     */
+    void parse(bool use_index = true);
+
+    //! Parses the next top level box of the file, so the parsing can be run in bounded steps.
+    /*!
+     * The first step restores the results from the parse index or opens the file, the last one runs the checks.
+     * The steps can be called from different threads, but one at a time.
+     * \param use_index restore the results from the parse index, if it is up to date
+     * \return false, if the file is parsed completely
+     */
+    bool parseStep(bool use_index = true);
+
+    //! Parses the complete top level boxes appended since the previous call, for a file which is still being written.
+    /*!
+     * The file is treated as opened until finishAppending is called, so the boxes parsed later are added to the same results.
+     * \return true, if new boxes were parsed
+     */
+    bool parseAppended();
+    //! Finishes parsing of a file, which was parsed by parseAppended.
+    void finishAppending();
+
+    //! Checks if the results were restored from the parse index, so the box tree contains only the boxes with signatures.
+    bool isRestored() const;
+    //! Checks if the box tree is complete and all the checks were run, so the session does not have to be repeated before showing its results.
+    bool isChecked() const;
+
+    //! Returns the path of the parsed file.
+    const QString & getPath() const;
+    //! Returns the parsed box tree.
+    std::shared_ptr<FileBox> getFileBox() const;
+    //! Returns the view the file was parsed through, nullptr if the file was not parsed or was read directly.
+    std::shared_ptr<FileView> getFileView() const;
+    //! Returns the ISO base media validation result of the file.
+    const ValidatorISO & getValidatorISO() const;
+    //! Returns the Surveillance validation result of the file.
+    const ValidatorSurveillance & getValidatorSurveillance() const;
+    //! Returns the Onvif export file validation result of the file.
+    const ValidatorOXF & getValidatorOXF() const;
+    //! Returns the segments found in the file.
+    const SegmentExtractor & getSegmentExtractor() const;
+    //! Returns the signatures found in the file.
+    const SignatureExtractor & getSignatureExtractor() const;
+    //! Returns the sample indexes of the file.
+    const SampleIndexExtractor & getSampleIndexExtractor() const;
+
+    //! Reports a box created within this session to all the listeners. Called by the BoxFactory.
+    void notifyBoxCreated(Box * box);
+    //! Marks the beginning of a box parsing, returning the nesting depth of the box.
+    size_t enterBox();
+    //! Marks the end of a box parsing.
+    void leaveBox();
+
+signals:
+    //! This signal is sent before the file is parsed.
+    void fileOpened(QString path);
+    //! This signal is sent after the file parsing was finished.
+    void fileClosed();
+    //! This signal is sent, after the box was created.
+    void boxCreated(Box * box);
+
+private:
+    //! Restores the parsing results from the parse index, parsing only the boxes containing signatures.
+    bool restore();
+    //! Stores the parsing results to the parse index.
+    void saveIndex();
+    //! Opens the file through its view, so the demuxers of the player find the parsed data in memory.
+    std::shared_ptr<std::istream> openFile();
+
+private:
+    //! Path of the file being parsed.
+    QString m_path;
+    //! Parsed box tree.
+    std::shared_ptr<FileBox> m_file_box;
+    //! View the file was parsed through.
+    std::shared_ptr<FileView> m_file_view;
+    //! Nesting depth of the box being parsed.
+    size_t m_depth;
+    //! Whether the consistency and conformance checks are skipped.
+    bool m_fast_open;
+    //! Whether the results were restored from the parse index.
+    bool m_is_restored;
+    //! Whether the results are being restored from the parse index.
+    bool m_is_restoring;
+    //! Whether the file was parsed by parse or parseStep.
+    bool m_is_parsed;
+    //! Stream of the file being parsed by parseStep.
+    std::unique_ptr<LimitedStreamReader> m_stream;
+    //! Whether the file is being parsed by parseAppended.
+    bool m_is_appending;
+    //! Size of the file part parsed by parseAppended.
+    uint64_t m_appended_size;
+    //! Consistency checker.
+    ConsistencyChecker m_consistency_checker;
+    //! Validator for ISO base media files.
+    ValidatorISO m_validator_iso;
+    //! Validator for Surveillance files.
+    ValidatorSurveillance m_validator_surveillance;
+    //! Validator for Onvif export files.
+    ValidatorOXF m_validator_oxf;
+    //! Extractor of the Surveillance fragments list.
+    SegmentExtractor m_segment_extractor;
+    //! Extractor of the OXF signatures list.
+    SignatureExtractor m_signature_extractor;
+    //! Extractor of the sample indexes.
+    SampleIndexExtractor m_sample_index_extractor;
+};
+
+#endif // PARSESESSION_H
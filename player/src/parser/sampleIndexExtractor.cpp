@@ -0,0 +1,299 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "sampleIndexExtractor.h"
+
+#include "templateFullBoxes.hpp"
+#include "sampleSizeBox.hpp"
+#include "compactSampleSizeBox.hpp"
+#include "mediaHeaderBox.hpp"
+#include "trackHeaderBox.hpp"
+#include "trackFragmentHeaderBox.hpp"
+#include "trackRunBox.hpp"
+
+namespace
+{
+    //! 'tfhd' flag saying, that the base data offset of a track fragment is the 'moof' box offset.
+    const uint32_t sc_default_base_is_moof = 0x020000;
+    //! Sample flag marking a sample, which is not a sync sample.
+    const uint32_t sc_sample_is_non_sync_sample = 0x010000;
+}
+
+SampleIndexExtractor::SampleIndexExtractor(QObject *parent) :
+    QObject(parent),
+    m_current_track_id(0),
+    m_fragment_offset(0),
+    m_fragment_track_id(0),
+    m_base_data_offset(0),
+    m_next_data_offset(0)
+{
+}
+
+SampleIndex SampleIndexExtractor::getSampleIndex(const QString & path) const
+{
+    return m_sample_indexes.value(path);
+}
+
+void SampleIndexExtractor::setSampleIndex(const QString & path, const SampleIndex & sample_index)
+{
+    m_sample_indexes.insert(path, sample_index);
+}
+
+void SampleIndexExtractor::merge(const SampleIndexExtractor & other)
+{
+    for(auto it = other.m_sample_indexes.begin(), end = other.m_sample_indexes.end(); it != end; ++it)
+    {
+        m_sample_indexes.insert(it.key(), it.value());
+    }
+}
+
+void SampleIndexExtractor::onContentsCleared()
+{
+    m_sample_indexes.clear();
+}
+
+void SampleIndexExtractor::onFileOpened(QString path)
+{
+    m_sample_indexes.insert(path, SampleIndex());
+    m_current_path = path;
+    m_current_track_id = 0;
+    m_track_defaults.clear();
+    m_decode_times.clear();
+    m_sample_tables = SampleTables();
+    m_fragment_offset = 0;
+    m_next_data_offset = 0;
+}
+
+void SampleIndexExtractor::onFileClosed()
+{
+    m_current_path.clear();
+}
+
+void SampleIndexExtractor::onBoxCreated(Box *box)
+{
+    if(m_current_path.isEmpty())
+        return;
+
+    // boxes are reported after their children, so the 'tkhd' of a track comes before its 'mdhd'
+    switch((uint32_t)box->getBoxFourCC()) {
+    case 'tkhd':
+        m_current_track_id = dynamic_cast<TrackHeaderBox*>(box)->getTrackID();
+        break;
+    case 'mdhd':
+        m_sample_indexes[m_current_path][m_current_track_id].setTimescale(dynamic_cast<MediaHeaderBox*>(box)->getTimeScale());
+        break;
+    case 'hdlr':
+        // 'meta' boxes have handlers too
+        if(box->getParent() != nullptr && (uint32_t)box->getParent()->getBoxFourCC() == 'mdia')
+            m_sample_indexes[m_current_path][m_current_track_id].setHandlerType((uint32_t)dynamic_cast<HandlerBox*>(box)->getHandlerType());
+        break;
+    case 'stts':
+        m_sample_tables.m_time_to_sample = dynamic_cast<TimeToSampleBox*>(box)->getTable();
+        break;
+    case 'ctts':
+        m_sample_tables.m_composition_offsets = dynamic_cast<CompositionOffsetBox*>(box)->getTable();
+        break;
+    case 'stss':
+        m_sample_tables.m_sync_samples = dynamic_cast<SyncSampleBox*>(box)->getTable();
+        m_sample_tables.m_has_sync_samples = true;
+        break;
+    case 'stsz':
+    {
+        SampleSizeBox * stsz = dynamic_cast<SampleSizeBox*>(box);
+        m_sample_tables.m_sample_size = stsz->getSampleSize();
+        m_sample_tables.m_sample_sizes = stsz->getTable();
+        break;
+    }
+    case 'stz2':
+    {
+        QList<CompactSampleSizeEntry> sizes = dynamic_cast<CompactSampleSizeBox*>(box)->getTable();
+        m_sample_tables.m_sample_sizes.reserve(sizes.size());
+        for(auto it = sizes.begin(), end = sizes.end(); it != end; ++it)
+        {
+            m_sample_tables.m_sample_sizes.append(*it);
+        }
+        break;
+    }
+    case 'stsc':
+        m_sample_tables.m_sample_to_chunk = dynamic_cast<SampleToChunkBox*>(box)->getTable();
+        break;
+    case 'stco':
+    {
+        QList<ChunkOffsetEntry> offsets = dynamic_cast<ChunkOffsetBox*>(box)->getTable();
+        m_sample_tables.m_chunk_offsets.reserve(offsets.size());
+        for(auto it = offsets.begin(), end = offsets.end(); it != end; ++it)
+        {
+            m_sample_tables.m_chunk_offsets.append(*it);
+        }
+        break;
+    }
+    case 'co64':
+        m_sample_tables.m_chunk_offsets = dynamic_cast<ChunkLargeOffsetBox*>(box)->getTable();
+        break;
+    case 'stbl':
+        readSampleTables();
+        m_sample_tables = SampleTables();
+        break;
+    case 'trex':
+    {
+        TrackExtendsBox * trex = dynamic_cast<TrackExtendsBox*>(box);
+        TrackDefaults & defaults = m_track_defaults[trex->getTrackID()];
+        defaults.m_sample_duration = trex->getDefaultSampleDuration();
+        defaults.m_sample_size = trex->getDefaultSampleSize();
+        defaults.m_sample_flags = trex->getDefaultSampleFlags();
+        break;
+    }
+    case 'tfhd':
+    {
+        TrackFragmentHeaderBox * tfhd = dynamic_cast<TrackFragmentHeaderBox*>(box);
+        Box * moof = (box->getParent() != nullptr) ? box->getParent()->getParent() : nullptr;
+        uint64_t moof_offset = (moof != nullptr) ? moof->getBoxOffset() : 0;
+        if(moof_offset != m_fragment_offset)
+        {
+            // data of the first track fragment of a movie fragment starts relative to the 'moof' box
+            m_fragment_offset = moof_offset;
+            m_next_data_offset = moof_offset;
+        }
+
+        m_fragment_track_id = tfhd->getTrackID();
+        m_fragment_defaults = m_track_defaults.value(m_fragment_track_id);
+        if(tfhd->getDefaultSampleDuration().hasValue())
+            m_fragment_defaults.m_sample_duration = tfhd->getDefaultSampleDuration().value();
+        if(tfhd->getDefaultSampleSize().hasValue())
+            m_fragment_defaults.m_sample_size = tfhd->getDefaultSampleSize().value();
+        if(tfhd->getDefaultSampleFlags().hasValue())
+            m_fragment_defaults.m_sample_flags = tfhd->getDefaultSampleFlags().value();
+
+        if(tfhd->getBaseDataOffset().hasValue())
+            m_base_data_offset = tfhd->getBaseDataOffset().value();
+        else if((uint32_t)tfhd->getTrackFragmentFlags() & sc_default_base_is_moof)
+            m_base_data_offset = moof_offset;
+        else
+            m_base_data_offset = m_next_data_offset;
+        m_next_data_offset = m_base_data_offset;
+        break;
+    }
+    case 'tfdt':
+        m_decode_times[m_fragment_track_id] = dynamic_cast<TrackFragmentDecodeTimeBox*>(box)->getStartTime();
+        break;
+    case 'trun':
+    {
+        TrackRunBox * trun = dynamic_cast<TrackRunBox*>(box);
+        TrackSampleIndex & track_index = m_sample_indexes[m_current_path][m_fragment_track_id];
+        int64_t & decode_time = m_decode_times[m_fragment_track_id];
+        uint64_t offset = trun->getDataOffset().hasValue() ? m_base_data_offset + trun->getDataOffset().value() : m_next_data_offset;
+
+        bool is_first_sample = true;
+        QListIterator<TrackRunEntry> it(trun->getTable());
+        while(it.hasNext())
+        {
+            const TrackRunEntry & entry = it.next();
+            uint32_t duration = std::get<0>(entry).hasValue() ? std::get<0>(entry).value() : m_fragment_defaults.m_sample_duration;
+            uint32_t size = std::get<1>(entry).hasValue() ? std::get<1>(entry).value() : m_fragment_defaults.m_sample_size;
+            uint32_t flags = m_fragment_defaults.m_sample_flags;
+            if(std::get<2>(entry).hasValue())
+                flags = std::get<2>(entry).value();
+            else if(is_first_sample && trun->getFirstSampleFlags().hasValue())
+                flags = trun->getFirstSampleFlags().value();
+            // signed in version 1 boxes, and never large enough to differ in version 0 ones
+            int32_t composition_offset = std::get<3>(entry).hasValue() ? (int32_t)std::get<3>(entry).value() : 0;
+
+            track_index.append(decode_time, duration, composition_offset, size, offset, !(flags & sc_sample_is_non_sync_sample));
+
+            decode_time += duration;
+            offset += size;
+            is_first_sample = false;
+        }
+        m_next_data_offset = offset;
+        break;
+    }
+    }
+}
+
+void SampleIndexExtractor::readSampleTables()
+{
+    const SampleTables & tables = m_sample_tables;
+    if(tables.m_time_to_sample.isEmpty())
+        return;
+
+    TrackSampleIndex & track_index = m_sample_indexes[m_current_path][m_current_track_id];
+    int64_t & decode_time = m_decode_times[m_current_track_id];
+
+    // samples are numbered from 1 in 'stss' and chunks in 'stsc'
+    int sample = 0;
+    int sync_entry = 0;
+    int composition_entry = 0;
+    uint32_t composition_left = tables.m_composition_offsets.isEmpty() ? 0 : std::get<0>(tables.m_composition_offsets.front());
+    int chunk = -1;
+    int chunk_entry = 0;
+    uint32_t chunk_left = 0;
+    uint64_t offset = 0;
+    for(auto it = tables.m_time_to_sample.begin(), end = tables.m_time_to_sample.end(); it != end; ++it)
+    {
+        uint32_t duration = std::get<1>(*it);
+        for(uint32_t count = std::get<0>(*it); count != 0; --count, ++sample)
+        {
+            // a broken table must not make up samples
+            if(tables.m_sample_size == 0 && sample >= tables.m_sample_sizes.size())
+                return;
+            uint32_t size = (tables.m_sample_size != 0) ? tables.m_sample_size : tables.m_sample_sizes.at(sample);
+
+            while(chunk_left == 0 && chunk + 1 < tables.m_chunk_offsets.size())
+            {
+                ++chunk;
+                while(chunk_entry + 1 < tables.m_sample_to_chunk.size() &&
+                      std::get<0>(tables.m_sample_to_chunk.at(chunk_entry + 1)) <= uint32_t(chunk + 1))
+                    ++chunk_entry;
+                chunk_left = tables.m_sample_to_chunk.isEmpty() ? 0 : std::get<1>(tables.m_sample_to_chunk.at(chunk_entry));
+                offset = tables.m_chunk_offsets.at(chunk);
+            }
+
+            while(composition_left == 0 && composition_entry + 1 < tables.m_composition_offsets.size())
+                composition_left = std::get<0>(tables.m_composition_offsets.at(++composition_entry));
+            // signed in version 1 boxes, and never large enough to differ in version 0 ones
+            int32_t composition_offset = 0;
+            if(composition_left != 0)
+            {
+                composition_offset = (int32_t)std::get<1>(tables.m_composition_offsets.at(composition_entry));
+                --composition_left;
+            }
+
+            bool is_sync = !tables.m_has_sync_samples;
+            while(sync_entry < tables.m_sync_samples.size() && tables.m_sync_samples.at(sync_entry) < uint32_t(sample + 1))
+                ++sync_entry;
+            if(sync_entry < tables.m_sync_samples.size() && tables.m_sync_samples.at(sync_entry) == uint32_t(sample + 1))
+                is_sync = true;
+
+            track_index.append(decode_time, duration, composition_offset, size, offset, is_sync);
+
+            decode_time += duration;
+            offset += size;
+            if(chunk_left != 0)
+                --chunk_left;
+        }
+    }
+}
@@ -0,0 +1,133 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef SAMPLEINDEXEXTRACTOR_H
+#define SAMPLEINDEXEXTRACTOR_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QObject>
+#include <QMap>
+#include "basic/box.h"
+#include "templateTableBoxes.hpp"
+#include "../common/sampleIndex.h"
+
+//! This class builds the per track sample indexes of the files of a fileset.
+/*!
+ * \brief Samples are collected from the sample table of each track, which is empty in fragmented files,
+ * and from the 'trun' boxes of all fragments, resolving their values against
+ * the 'tfhd' and 'trex' defaults, the 'tfdt' decode times and the data offset rules of ISO base media format.
+ */
+class SampleIndexExtractor : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SampleIndexExtractor(QObject *parent = nullptr);
+
+public:
+    //! Returns the sample index of a file.
+    SampleIndex getSampleIndex(const QString & path) const;
+    //! Sets the sample index of a file, which is known without parsing, e.g. from a parse index.
+    void setSampleIndex(const QString & path, const SampleIndex & sample_index);
+    //! Adds the sample indexes built by another extractor, e.g. in a separate parse session.
+    void merge(const SampleIndexExtractor & other);
+
+public slots:
+    //! This slot is called when the fileset information is cleared.
+    void onContentsCleared();
+    //! This slot is called when the file is being added to a fileset.
+    void onFileOpened(QString path);
+    //! This slot is called when the file parsing was finished.
+    void onFileClosed();
+    //! This slot is called when the box is created.
+    void onBoxCreated(Box *box);
+
+private:
+    //! Default values of the samples of a track, from 'trex' box.
+    struct TrackDefaults
+    {
+        TrackDefaults()
+            : m_sample_duration(0)
+            , m_sample_size(0)
+            , m_sample_flags(0)
+        {}
+
+        uint32_t m_sample_duration;
+        uint32_t m_sample_size;
+        uint32_t m_sample_flags;
+    };
+
+    //! Tables of the 'stbl' box being parsed, they are reported before the box itself.
+    struct SampleTables
+    {
+        SampleTables()
+            : m_sample_size(0)
+            , m_has_sync_samples(false)
+        {}
+
+        QList<TimeToSampleEntry> m_time_to_sample;
+        QList<CompositionOffsetEntry> m_composition_offsets;
+        QList<SyncSampleEntry> m_sync_samples;
+        //! Size of all samples, or 0 if they have their own sizes.
+        uint32_t m_sample_size;
+        QList<uint32_t> m_sample_sizes;
+        QList<SampleToChunkEntry> m_sample_to_chunk;
+        QList<uint64_t> m_chunk_offsets;
+        //! Without a 'stss' box every sample is a sync sample.
+        bool m_has_sync_samples;
+    };
+
+private:
+    //! Appends the samples of the sample table of the current track.
+    void readSampleTables();
+
+private:
+    //! Sample indexes by file.
+    QMap<QString, SampleIndex> m_sample_indexes;
+    //! File currently being parsed.
+    QString m_current_path;
+    //! Track of the 'trak' box being parsed.
+    uint32_t m_current_track_id;
+    //! Tables of the current track.
+    SampleTables m_sample_tables;
+    //! Defaults of the tracks from 'trex' boxes.
+    QMap<uint32_t, TrackDefaults> m_track_defaults;
+    //! Decode time of the next sample of each track.
+    QMap<uint32_t, int64_t> m_decode_times;
+    //! Offset of the 'moof' box being parsed.
+    uint64_t m_fragment_offset;
+    //! Defaults of the track fragment being parsed.
+    TrackDefaults m_fragment_defaults;
+    //! Track of the track fragment being parsed.
+    uint32_t m_fragment_track_id;
+    //! Base data offset of the track fragment being parsed.
+    uint64_t m_base_data_offset;
+    //! Offset of the data following the last parsed track run.
+    uint64_t m_next_data_offset;
+};
+
+#endif // SAMPLEINDEXEXTRACTOR_H
@@ -27,6 +27,8 @@
 
 #include "segmentExtractor.h"
 
+#include <QDebug>
+
 #include "afIdentificationBox.hpp"
 #include "mediaHeaderBox.hpp"
 #include "movieHeaderBox.hpp"
@@ -35,54 +37,91 @@
 #include "correctstarttimebox.hpp"
 
 SegmentExtractor::SegmentExtractor(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    m_fragments_have_surveillance_boxes(true),
+    m_timeline_outdated(false)
 {
 }
 
-SegmentList SegmentExtractor::getSegments()
+SegmentList SegmentExtractor::getSegments() const
 {
-    if(m_fragments_have_surveillance_boxes)
+    return getTimeline().getSegments();
+}
+
+const SegmentTimeline & SegmentExtractor::getTimeline() const
+{
+    if(m_timeline_outdated)
     {
-        uint32_t fragment_number = 0;
-        auto beginning_fragment = std::find_if(m_segments.begin(), m_segments.end(), [] (SegmentInfo & fi) -> bool {return fi.isBeginning();});
-        if(beginning_fragment != m_segments.end())
+        m_timeline = m_fragments_have_surveillance_boxes ? SegmentTimeline::chain(m_segments) : SegmentTimeline(m_segments);
+        m_timeline_outdated = false;
+
+        const SegmentChainIssueList & issues = m_timeline.getIssues();
+        for(auto it = issues.begin(), end = issues.end(); it != end; ++it)
         {
-            beginning_fragment->setFragmentNumber(fragment_number++);
-            m_segments.move(beginning_fragment - m_segments.begin(), 0);
+            qWarning() << "Segment chain:" << it->m_file_name << it->m_description;
         }
-        for(int i = 0; i < m_segments.size() - 1; ++i)
+    }
+    return m_timeline;
+}
+
+const SegmentList & SegmentExtractor::getFoundSegments() const
+{
+    return m_segments;
+}
+
+void SegmentExtractor::merge(const SegmentExtractor & other)
+{
+    m_timeline_outdated = true;
+    m_segments.append(other.m_segments);
+    if(m_fragments_have_surveillance_boxes)
+        m_fragments_have_surveillance_boxes = other.m_fragments_have_surveillance_boxes;
+}
+
+void SegmentExtractor::addSegment(const SegmentInfo & segment)
+{
+    m_timeline_outdated = true;
+    m_segments.append(segment);
+    if(m_fragments_have_surveillance_boxes)
+        m_fragments_have_surveillance_boxes = segment.isSurveillanceFragment();
+}
+
+void SegmentExtractor::updateSegment(const SegmentInfo & segment)
+{
+    m_timeline_outdated = true;
+    for(auto it = m_segments.begin(), end = m_segments.end(); it != end; ++it)
+    {
+        if(it->getFileName() == segment.getFileName())
         {
-            const SegmentInfo & current_fragment = m_segments.at(i);
-            auto next_fragment = std::find_if(m_segments.begin() + i + 1, m_segments.end(), [&current_fragment] (SegmentInfo & fi) -> bool {return current_fragment.isSuccessor(fi);});
-            if(next_fragment != m_segments.end())
-            {
-                next_fragment->setFragmentNumber(fragment_number++);
-                m_segments.move(next_fragment - m_segments.begin(), i + 1);
-            }
+            *it = segment;
+            return;
         }
     }
-    return m_segments;
+    addSegment(segment);
 }
 
 void SegmentExtractor::onContentsCleared()
 {
+    m_timeline_outdated = true;
     m_segments.clear();
     m_fragments_have_surveillance_boxes = true;
 }
 
 void SegmentExtractor::onFileOpened(QString path)
 {
+    m_timeline_outdated = true;
     m_segments.append(SegmentInfo(path));
 }
 
 void SegmentExtractor::onFileClosed()
 {
+    m_timeline_outdated = true;
     if(m_fragments_have_surveillance_boxes)
         m_fragments_have_surveillance_boxes = m_segments.back().isSurveillanceFragment();
 }
 
 void SegmentExtractor::onBoxCreated(Box *box)
 {
+    m_timeline_outdated = true;
 	switch((uint32_t)box->getBoxFourCC()) {
 	case 'mvhd':
 		m_segments.back().readMovieHeaderBox(dynamic_cast<MovieHeaderBox *>(box));
@@ -33,6 +33,7 @@
 #include <QObject>
 #include "basic/box.h"
 #include "../common/segmentInfo.h"
+#include "../common/segmentTimeline.h"
 
 /**
  * Class performing the extraction of file segments.
@@ -47,7 +48,20 @@ public:
 
 public:
     //! Returns the Surveillance fragments list.
-    SegmentList getSegments();
+    SegmentList getSegments() const;
+    //! Returns the fragments ordered by their predecessor and successor links, if all of them are Surveillance files.
+    /*!
+     * The timeline is built once after the segments change, its issues are logged then.
+     */
+    const SegmentTimeline & getTimeline() const;
+    //! Returns the fragments in the order they were found, without chaining them.
+    const SegmentList & getFoundSegments() const;
+    //! Appends the segments found by another extractor, e.g. in a separate parse session.
+    void merge(const SegmentExtractor & other);
+    //! Adds a segment, which is known without parsing, e.g. from a parse index.
+    void addSegment(const SegmentInfo & segment);
+    //! Replaces the segment of the same file, e.g. when the file has grown.
+    void updateSegment(const SegmentInfo & segment);
 
 signals:
 
@@ -66,6 +80,10 @@ private:
     bool m_fragments_have_surveillance_boxes;
     //! Surveillance fragments list for a fileset.
     SegmentList m_segments;
+    //! Timeline built from the fragments list, valid until the list changes.
+    mutable SegmentTimeline m_timeline;
+    //! Flag indicating, that the timeline has to be rebuilt.
+    mutable bool m_timeline_outdated;
 };
 
 #endif // FRAGMENTEXTRACTOR_H
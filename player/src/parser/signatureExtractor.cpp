@@ -42,6 +42,14 @@ SigningInformationMap SignatureExtractor::getSignaturesMap() const
     return m_signatures_map;
 }
 
+void SignatureExtractor::merge(const SignatureExtractor & other)
+{
+    for(auto it = other.m_signatures_map.begin(), end = other.m_signatures_map.end(); it != end; ++it)
+    {
+        m_signatures_map.insert(it.key(), it.value());
+    }
+}
+
 void SignatureExtractor::onContentsCleared()
 {
     m_signatures_map.clear();
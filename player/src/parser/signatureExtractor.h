@@ -77,6 +77,8 @@ public:
 public:
     //! Returns the signature list.
     SigningInformationMap getSignaturesMap() const;
+    //! Adds the signatures found by another extractor, e.g. in a separate parse session.
+    void merge(const SignatureExtractor & other);
 
 signals:
 
@@ -48,6 +48,24 @@ bool ValidatorISO::isValidFileset()
     return (m_fileset_information.isEmpty() == false);
 }
 
+void ValidatorISO::merge(const ValidatorISO & other)
+{
+    for(auto it = other.m_fileset_information.begin(), end = other.m_fileset_information.end(); it != end; ++it)
+    {
+        m_fileset_information.insert(it.key(), it.value());
+    }
+}
+
+ISOFileInformation ValidatorISO::getFileInformation(const QString & path) const
+{
+    return m_fileset_information.value(path);
+}
+
+void ValidatorISO::setFileInformation(const QString & path, const ISOFileInformation & information)
+{
+    m_fileset_information.insert(path, information);
+}
+
 void ValidatorISO::onContentsCleared()
 {
     m_fileset_information.clear();
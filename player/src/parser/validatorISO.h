@@ -81,6 +81,13 @@ public:
     //! Checks if the fileset consists of valid files.
     bool isValidFileset();
 
+    //! Adds the validation results of the files checked by another validator, e.g. in a separate parse session.
+    void merge(const ValidatorISO & other);
+    //! Returns the validation result of a file.
+    ISOFileInformation getFileInformation(const QString & path) const;
+    //! Sets the validation result of a file, which is known without parsing, e.g. from a parse index.
+    void setFileInformation(const QString & path, const ISOFileInformation & information);
+
 signals:
     
 public slots:
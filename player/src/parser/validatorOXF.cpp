@@ -52,6 +52,24 @@ bool ValidatorOXF::isValidFileset() const
     return (m_fileset_information.isEmpty() == false);
 }
 
+void ValidatorOXF::merge(const ValidatorOXF & other)
+{
+    for(auto it = other.m_fileset_information.begin(), end = other.m_fileset_information.end(); it != end; ++it)
+    {
+        m_fileset_information.insert(it.key(), it.value());
+    }
+}
+
+OXFFileInformation ValidatorOXF::getFileInformation(const QString & path) const
+{
+    return m_fileset_information.value(path);
+}
+
+void ValidatorOXF::setFileInformation(const QString & path, const OXFFileInformation & information)
+{
+    m_fileset_information.insert(path, information);
+}
+
 void ValidatorOXF::onContentsCleared()
 {
     m_fileset_information.clear();
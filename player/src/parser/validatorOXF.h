@@ -39,6 +39,7 @@ struct OXFFileInformation
     OXFFileInformation()
         : m_surveillance_export_box_count(0)
         , m_signature_box_count(0)
+        , m_certificate_box_count(0)
     {
 
     }
@@ -72,6 +73,13 @@ public:
     //! Checks if the fileset consists of valid files.
     bool isValidFileset() const;
 
+    //! Adds the validation results of the files checked by another validator, e.g. in a separate parse session.
+    void merge(const ValidatorOXF & other);
+    //! Returns the validation result of a file.
+    OXFFileInformation getFileInformation(const QString & path) const;
+    //! Sets the validation result of a file, which is known without parsing, e.g. from a parse index.
+    void setFileInformation(const QString & path, const OXFFileInformation & information);
+
 signals:
     
 public slots:
@@ -97,14 +97,38 @@ SurveillanceConformanceType ValidatorSurveillance::isValidFileset()
         return IsNotSurveillanceFileset;
 }
 
+void ValidatorSurveillance::merge(const ValidatorSurveillance & other)
+{
+    for(auto it = other.m_fileset_information.begin(), end = other.m_fileset_information.end(); it != end; ++it)
+    {
+        storeFileInformation(it.key(), it.value());
+    }
+    for(auto it = other.m_fileset_information.begin(), end = other.m_fileset_information.end(); it != end; ++it)
+    {
+        linkFragment(it.key());
+    }
+}
+
+SurviellanceFileInformation ValidatorSurveillance::getFileInformation(const QString & path) const
+{
+    return m_fileset_information.value(path);
+}
+
+void ValidatorSurveillance::setFileInformation(const QString & path, const SurviellanceFileInformation & information)
+{
+    storeFileInformation(path, information);
+    linkFragment(path);
+}
+
 void ValidatorSurveillance::onContentsCleared()
 {
     m_fileset_information.clear();
+    m_fragment_files.clear();
 }
 
 void ValidatorSurveillance::onFileOpened(QString path)
 {
-    m_fileset_information.insert(path, SurviellanceFileInformation());
+    storeFileInformation(path, SurviellanceFileInformation());
     m_current_file = path;
 }
 
@@ -129,9 +153,11 @@ void ValidatorSurveillance::onBoxCreated(Box *box)
             current_file_info.m_segment_type = SurviellanceFileInformation::FragmentType(current_file_info.m_segment_type | SurviellanceFileInformation::IsSurveillance);
 
             AFIdentificationBox * af_identification_box = dynamic_cast<AFIdentificationBox*>(box);
+            m_fragment_files.remove(current_file_info.m_segment_UUID, m_current_file);
             current_file_info.m_predecessor_UUID = af_identification_box->getPredecessorUUID();
             current_file_info.m_segment_UUID = af_identification_box->getFragmentUUID();
             current_file_info.m_successor_UUID = af_identification_box->getSuccessorUUID();
+            m_fragment_files.insert(current_file_info.m_segment_UUID, m_current_file);
 
             if(current_file_info.m_predecessor_UUID == current_file_info.m_segment_UUID)
             {
@@ -142,25 +168,48 @@ void ValidatorSurveillance::onBoxCreated(Box *box)
                 current_file_info.m_segment_type = SurviellanceFileInformation::FragmentType(current_file_info.m_segment_type | SurviellanceFileInformation::IsFinalFragment);
             }
 
-            for(auto it = m_fileset_information.begin(), end = m_fileset_information.end(); it != end; ++it)
-			{
-				SurviellanceFileInformation & file_info = *it;
-                if(file_info.m_segment_UUID != current_file_info.m_segment_UUID)
-                {
-                    if((file_info.m_successor_UUID == current_file_info.m_segment_UUID)
-                            && (current_file_info.m_predecessor_UUID == file_info.m_segment_UUID))
-                    {
-                        file_info.m_segment_type = SurviellanceFileInformation::FragmentType(file_info.m_segment_type | SurviellanceFileInformation::HasSuccessor);
-                        current_file_info.m_segment_type = SurviellanceFileInformation::FragmentType(current_file_info.m_segment_type | SurviellanceFileInformation::HasPredecessor);
-                    }
-                    if((file_info.m_predecessor_UUID == current_file_info.m_segment_UUID)
-                            && (current_file_info.m_successor_UUID == file_info.m_segment_UUID))
-                    {
-                        file_info.m_segment_type = SurviellanceFileInformation::FragmentType(file_info.m_segment_type | SurviellanceFileInformation::HasPredecessor);
-                        current_file_info.m_segment_type = SurviellanceFileInformation::FragmentType(current_file_info.m_segment_type | SurviellanceFileInformation::HasSuccessor);
-                    }
-                }
-            }
+            linkFragment(m_current_file);
+        }
+    }
+}
+
+void ValidatorSurveillance::storeFileInformation(const QString & path, const SurviellanceFileInformation & information)
+{
+    auto it = m_fileset_information.find(path);
+    if(it != m_fileset_information.end())
+        m_fragment_files.remove(it->m_segment_UUID, path);
+    m_fileset_information.insert(path, information);
+    if(!information.m_segment_UUID.isNull())
+        m_fragment_files.insert(information.m_segment_UUID, path);
+}
+
+void ValidatorSurveillance::linkFragment(const QString & path)
+{
+    SurviellanceFileInformation & current_file_info = m_fileset_information[path];
+    if(current_file_info.m_segment_UUID.isNull())
+        return;
+
+    //the predecessor and the successor are the files of the fragments the file refers to
+    const QStringList predecessors = m_fragment_files.values(current_file_info.m_predecessor_UUID);
+    for(auto it = predecessors.begin(), end = predecessors.end(); it != end; ++it)
+    {
+        SurviellanceFileInformation & file_info = m_fileset_information[*it];
+        if((file_info.m_segment_UUID != current_file_info.m_segment_UUID)
+                && (file_info.m_successor_UUID == current_file_info.m_segment_UUID))
+        {
+            file_info.m_segment_type = SurviellanceFileInformation::FragmentType(file_info.m_segment_type | SurviellanceFileInformation::HasSuccessor);
+            current_file_info.m_segment_type = SurviellanceFileInformation::FragmentType(current_file_info.m_segment_type | SurviellanceFileInformation::HasPredecessor);
+        }
+    }
+    const QStringList successors = m_fragment_files.values(current_file_info.m_successor_UUID);
+    for(auto it = successors.begin(), end = successors.end(); it != end; ++it)
+    {
+        SurviellanceFileInformation & file_info = m_fileset_information[*it];
+        if((file_info.m_segment_UUID != current_file_info.m_segment_UUID)
+                && (file_info.m_predecessor_UUID == current_file_info.m_segment_UUID))
+        {
+            file_info.m_segment_type = SurviellanceFileInformation::FragmentType(file_info.m_segment_type | SurviellanceFileInformation::HasPredecessor);
+            current_file_info.m_segment_type = SurviellanceFileInformation::FragmentType(current_file_info.m_segment_type | SurviellanceFileInformation::HasSuccessor);
         }
     }
 }
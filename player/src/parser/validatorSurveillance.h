@@ -30,6 +30,7 @@
 
 #include "crosscompilation_cxx11.h"
 
+#include <QMultiHash>
 #include <QObject>
 #include "basic/box.h"
 
@@ -103,6 +104,13 @@ public:
     //! Checks if the fileset consists of valid files.
     SurveillanceConformanceType isValidFileset();
 
+    //! Adds the validation results of the files checked by another validator, linking them with the fragments already known.
+    void merge(const ValidatorSurveillance & other);
+    //! Returns the validation result of a file.
+    SurviellanceFileInformation getFileInformation(const QString & path) const;
+    //! Sets the validation result of a file, which is known without parsing, e.g. from a parse index.
+    void setFileInformation(const QString & path, const SurviellanceFileInformation & information);
+
 signals:
 
 public slots:
@@ -116,9 +124,17 @@ public slots:
     void onBoxCreated(Box *box);
 
 
+private:
+    //! Stores the validation result of a file and indexes it by its fragment UUID.
+    void storeFileInformation(const QString & path, const SurviellanceFileInformation & information);
+    //! Marks a file and the fragments it refers to as predecessor and successor of each other.
+    void linkFragment(const QString & path);
+
 private:
     //! Fileset validity information.
     QMap< QString, SurviellanceFileInformation > m_fileset_information;
+    //! Files by the UUID of their fragment, so a fragment finds the ones it refers to without walking the fileset.
+    QMultiHash< QUuid, QString > m_fragment_files;
     //! Current file being parsed.
     QString m_current_file;
 };
@@ -0,0 +1,335 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "boxTreeModel.h"
+
+#include <QCommonStyle>
+#include <QFileInfo>
+
+#include "parser/basic/mandatoryBox.h"
+#include "parser/basic/unknownBox.h"
+
+namespace
+{
+    //! Position within a children list, used to walk the box trees without recursion.
+    struct WalkPosition
+    {
+        WalkPosition(ChildrenMixin * parent, int row)
+            : m_parent(parent)
+            , m_row(row)
+        {}
+
+        //! Box, which children are walked.
+        ChildrenMixin * m_parent;
+        //! Row of the current child.
+        int m_row;
+    };
+}
+
+BoxTreeModel::BoxTreeModel(QObject *parent) :
+    QAbstractItemModel(parent),
+    m_warning_icon(QCommonStyle().standardIcon(QStyle::SP_MessageBoxWarning))
+{
+}
+
+void BoxTreeModel::setFilesetInformation(const FilesetInformation & fileset_information)
+{
+    beginResetModel();
+    m_fileset_information = fileset_information;
+    m_paths = fileset_information.keys();
+    m_file_boxes.clear();
+    for(auto it = m_paths.begin(), end = m_paths.end(); it != end; ++it)
+    {
+        m_file_boxes.append(fileset_information[*it].get());
+    }
+    m_rows.clear();
+    endResetModel();
+}
+
+Box * BoxTreeModel::getBox(const QModelIndex & index) const
+{
+    if(!index.isValid())
+        return nullptr;
+    // only the file boxes have no parent
+    Box * box = static_cast<Box *>(index.internalPointer());
+    return (box->getParent() != nullptr) ? box : nullptr;
+}
+
+QModelIndex BoxTreeModel::findBox(const QString & text, const QModelIndex & from, bool include_from) const
+{
+    if(text.isEmpty() || m_file_boxes.isEmpty())
+        return QModelIndex();
+
+    // the search starts at the file of the start index and walks all the files once, wrapping around
+    Box * from_box = getBox(from);
+    int first_file = 0;
+    if(from.isValid())
+    {
+        QModelIndex file_index = from;
+        while(file_index.parent().isValid())
+            file_index = file_index.parent();
+        first_file = file_index.row();
+    }
+
+    bool passed = (from_box == nullptr);
+    for(int i = 0, size = m_file_boxes.size(); i <= size; ++i)
+    {
+        int file_row = (first_file + i) % size;
+        QList<WalkPosition> stack;
+        stack.append(WalkPosition(m_file_boxes[file_row], 0));
+        while(!stack.isEmpty())
+        {
+            WalkPosition & position = stack.back();
+            BoxPtrList & children = position.m_parent->getChildren();
+            if(position.m_row >= children.size())
+            {
+                stack.removeLast();
+                if(!stack.isEmpty())
+                    stack.back().m_row++;
+                continue;
+            }
+
+            Box * box = children[position.m_row];
+            bool is_from = (box == from_box);
+            if(((passed && !is_from) || (is_from && include_from)) && ((QString)box->getBoxFourCC()).startsWith(text, Qt::CaseInsensitive))
+            {
+                // the rows of all the ancestors have to be known for the parent indexes
+                for(auto it = stack.begin(), end = stack.end(); it != end; ++it)
+                {
+                    m_rows.insert(it->m_parent->getChildren()[it->m_row], it->m_row);
+                }
+                return createBoxIndex(position.m_row, 0, box);
+            }
+            // the start box is met again after wrapping around
+            if(is_from && passed)
+                return QModelIndex();
+            passed = passed || is_from;
+
+            ChildrenMixin * super_box = dynamic_cast<ChildrenMixin *>(box);
+            if((super_box != nullptr) && !super_box->getChildren().isEmpty())
+                stack.append(WalkPosition(super_box, 0));
+            else
+                position.m_row++;
+        }
+    }
+    return QModelIndex();
+}
+
+QStringList BoxTreeModel::getErrorList(Box *box)
+{
+    QStringList errorList;
+    switch(box->getSizeError())
+    {
+    case Box::SizeInsufficient:
+        errorList << "Actual box size is less, than expected. Data may be corrupted.";
+        break;
+    case Box::SizeExceeding:
+        errorList << "Actual box size is more, than expected. Data may be corrupted.";
+        break;
+    default:
+        break;
+    }
+
+    Box::ConsistencyError consistency_error = box->getConsistencyError();
+
+    if(consistency_error & Box::HasNotEnoughBoxes)
+    {
+        errorList << "Box does not contain all mandatory boxes needed.";
+    }
+    if(consistency_error & Box::HasTooManyBoxes)
+    {
+        errorList << "Box contains exceeding count of child boxes of specific type.";
+    }
+    if(consistency_error & Box::HasConflictingBoxes)
+    {
+        errorList << "Box contains conflicting types of child boxes.";
+    }
+    if(consistency_error & Box::HasUnexpectedBoxes)
+    {
+        errorList << "Box contains unexpected boxes.";
+    }
+    if(consistency_error & Box::IsMandatoryBox)
+    {
+        if(is_a<MandatoryBox>(box))
+        {
+            errorList << "Parent box should contain at least one box of type '" + (QString)box->getBoxFourCC() + "'.";
+        }
+        else
+        {
+            QString errorString;
+            MandatoryBoxes * mandatory_boxes = dynamic_cast<MandatoryBoxes *>(box);
+            errorString = "Parent box should contain at least one box of one of the following types: ";
+            auto mandatory_four_cc = mandatory_boxes->getMandatoryFourCC();
+            for( auto it = mandatory_four_cc.begin(), end = mandatory_four_cc.end(); it != end; ++it )
+            {
+                FourCC & mandatory_four_cc = *it;
+                errorString += "'" + (QString)mandatory_four_cc + "', ";
+            }
+            if(errorString.endsWith(", "))
+            {
+                errorString.replace(errorString.length() - 3, 2, ".");
+            }
+            errorList << errorString;
+        }
+    }
+    if(consistency_error & Box::IsBoxWithExceedingCount)
+    {
+        errorList << "Parent box contains too many boxes of this type.";
+    }
+    if(consistency_error & Box::IsConflictingBox)
+    {
+        errorList << "Parent box contains conflicting types of child box.";
+    }
+    if(consistency_error & Box::IsUnexpectedBox)
+    {
+        if(is_a<UnknownBox>(box))
+        {
+            errorList << "Box type is unknown.";
+
+        }
+        errorList << "Box presence is not expected here.";
+    }
+    return errorList;
+}
+
+QModelIndex BoxTreeModel::index(int row, int column, const QModelIndex & parent) const
+{
+    if(!hasIndex(row, column, parent))
+        return QModelIndex();
+
+    if(!parent.isValid())
+        return createIndex(row, column, static_cast<Box *>(m_file_boxes[row]));
+
+    ChildrenMixin * children = getChildren(parent);
+    if(children == nullptr)
+        return QModelIndex();
+    return createBoxIndex(row, column, children->getChildren()[row]);
+}
+
+QModelIndex BoxTreeModel::parent(const QModelIndex & child) const
+{
+    if(!child.isValid())
+        return QModelIndex();
+
+    Box * parent_box = static_cast<Box *>(child.internalPointer())->getParent();
+    if(parent_box == nullptr)
+        return QModelIndex();
+
+    // the top level boxes have the file box as their parent
+    if(parent_box->getParent() == nullptr)
+    {
+        for(int i = 0, size = m_file_boxes.size(); i < size; ++i)
+        {
+            if(static_cast<Box *>(m_file_boxes[i]) == parent_box)
+                return createIndex(i, 0, parent_box);
+        }
+        return QModelIndex();
+    }
+
+    auto it = m_rows.find(parent_box);
+    if(it == m_rows.end())
+        return QModelIndex();
+    return createIndex(*it, 0, parent_box);
+}
+
+int BoxTreeModel::rowCount(const QModelIndex & parent) const
+{
+    if(!parent.isValid())
+        return m_file_boxes.size();
+    if(parent.column() > 0)
+        return 0;
+
+    ChildrenMixin * children = getChildren(parent);
+    return (children != nullptr) ? children->getChildren().size() : 0;
+}
+
+int BoxTreeModel::columnCount(const QModelIndex & parent) const
+{
+    Q_UNUSED(parent);
+    return 2;
+}
+
+bool BoxTreeModel::hasChildren(const QModelIndex & parent) const
+{
+    return rowCount(parent) > 0;
+}
+
+QVariant BoxTreeModel::data(const QModelIndex & index, int role) const
+{
+    if(!index.isValid())
+        return QVariant();
+
+    Box * box = getBox(index);
+    if(box == nullptr)
+    {
+        if(role == Qt::DisplayRole)
+            return (index.column() == 0) ? QFileInfo(m_paths[index.row()]).fileName() : QString("File");
+        return QVariant();
+    }
+
+    switch(role)
+    {
+    case Qt::DisplayRole:
+        return (index.column() == 0) ? (QString)box->getBoxFourCC() : box->getBoxDescription();
+    case Qt::DecorationRole:
+        if((index.column() == 0) && hasErrors(box))
+            return m_warning_icon;
+        break;
+    case Qt::ToolTipRole:
+        if((index.column() == 0) && hasErrors(box))
+            return getErrorList(box).join("\r\n").trimmed();
+        break;
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+QVariant BoxTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if((orientation == Qt::Horizontal) && (role == Qt::DisplayRole))
+        return (section == 0) ? QString("FourCC") : QString("Description");
+    return QVariant();
+}
+
+ChildrenMixin * BoxTreeModel::getChildren(const QModelIndex & index) const
+{
+    if(!index.isValid())
+        return nullptr;
+    return dynamic_cast<ChildrenMixin *>(static_cast<Box *>(index.internalPointer()));
+}
+
+QModelIndex BoxTreeModel::createBoxIndex(int row, int column, Box * box) const
+{
+    m_rows.insert(box, row);
+    return createIndex(row, column, box);
+}
+
+bool BoxTreeModel::hasErrors(Box *box)
+{
+    return (box->getSizeError() != Box::SizeOk) || (box->getConsistencyError() != Box::Consistent);
+}
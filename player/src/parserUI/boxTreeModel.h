@@ -0,0 +1,100 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef BOXTREEMODEL_H
+#define BOXTREEMODEL_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QIcon>
+#include <QStringList>
+
+#include "../parser/mediaParser.h"
+
+//! Item model presenting the box trees of a fileset.
+/*!
+ * \brief Rows are created by the view only when they are shown, so opening a file with hundreds of thousands of boxes
+ * does not depend on its size. Error tooltips are generated on request and all the rows share one warning icon.
+ * Top level rows are the files, their children are the top level boxes of the file.
+ */
+class BoxTreeModel CC_CXX11_FINAL
+        : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    explicit BoxTreeModel(QObject *parent = 0);
+
+public:
+    //! Sets the fileset to be shown.
+    void setFilesetInformation(const FilesetInformation & fileset_information);
+    //! Returns the box of an index, nullptr for a file row.
+    Box * getBox(const QModelIndex & index) const;
+    //! Finds the next box, which FourCC starts with a text, in the file order.
+    /*!
+     * \param text beginning of the FourCC code, case insensitive
+     * \param from index to start the search at, the search wraps around at the end of the fileset
+     * \param include_from whether the box at the start index matches too
+     * \return index of the found box or an invalid index
+     */
+    QModelIndex findBox(const QString & text, const QModelIndex & from, bool include_from) const;
+    //! Returns the list of errors for a box.
+    static QStringList getErrorList(Box *box);
+
+public:
+    QModelIndex index(int row, int column, const QModelIndex & parent = QModelIndex()) const CC_CXX11_OVERRIDE;
+    QModelIndex parent(const QModelIndex & child) const CC_CXX11_OVERRIDE;
+    int rowCount(const QModelIndex & parent = QModelIndex()) const CC_CXX11_OVERRIDE;
+    int columnCount(const QModelIndex & parent = QModelIndex()) const CC_CXX11_OVERRIDE;
+    bool hasChildren(const QModelIndex & parent = QModelIndex()) const CC_CXX11_OVERRIDE;
+    QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const CC_CXX11_OVERRIDE;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const CC_CXX11_OVERRIDE;
+
+private:
+    //! Returns the children of an index, nullptr if it can not have any.
+    ChildrenMixin * getChildren(const QModelIndex & index) const;
+    //! Creates an index of a box with a known row.
+    QModelIndex createBoxIndex(int row, int column, Box * box) const;
+    //! Checks if a box has any errors.
+    static bool hasErrors(Box *box);
+
+private:
+    //! Paths of the files in the row order.
+    QStringList m_paths;
+    //! Box trees of the files in the row order.
+    QList<FileBox *> m_file_boxes;
+    //! Keeps the fileset alive while it is shown.
+    FilesetInformation m_fileset_information;
+    //! Rows of the boxes within their parents. Filled when indexes are created, as the boxes do not know their position.
+    mutable QHash<Box *, int> m_rows;
+    //! Icon of the boxes with errors.
+    QIcon m_warning_icon;
+};
+
+#endif // BOXTREEMODEL_H
@@ -29,18 +29,27 @@
 #include "ui_parserWidget.h"
 
 #include <QCommonStyle>
+#include <QFontDatabase>
 
+#include <algorithm>
+
+#include "defines.h"
+#include "stallWatchdog.h"
 #include "parser/helpers/optional.hpp"
-#include "parser/basic/mandatoryBox.h"
-#include "parser/basic/unknownBox.h"
 
 ParserWidget::ParserWidget(QWidget *parent) :
     QDialog(parent),
     m_ui(new Ui::parserWidget)
 {
     m_ui->setupUi(this);
+    m_ui->boxTree->setModel(&m_box_tree_model);
     m_ui->boxTree->setSelectionMode(QAbstractItemView::SingleSelection);
-    connect(m_ui->boxTree, &QTreeWidget::currentItemChanged, this, &ParserWidget::onItemChanged);
+    // all the rows have the same height, so the view does not have to measure them
+    m_ui->boxTree->setUniformRowHeights(true);
+    connect(m_ui->boxTree->selectionModel(), &QItemSelectionModel::currentChanged, this, &ParserWidget::onItemChanged);
+    connect(m_ui->boxSearch, &QLineEdit::textEdited, this, &ParserWidget::onSearchTextEdited);
+    connect(m_ui->boxSearch, &QLineEdit::returnPressed, this, &ParserWidget::onFindNext);
+    connect(m_ui->findNextBox, &QPushButton::clicked, this, &ParserWidget::onFindNext);
     connect(m_ui->expandBoxes, &QPushButton::clicked, [this] () {
         this->m_ui->boxTree->expandAll();
         this->resizeTreeToContents(m_ui->boxTree);
@@ -49,7 +58,17 @@ ParserWidget::ParserWidget(QWidget *parent) :
         this->m_ui->boxTree->collapseAll();
         this->resizeTreeToContents(m_ui->boxTree);
     });
+    connect(m_ui->propertyTree, &QTreeWidget::itemExpanded, this, &ParserWidget::onPropertyItemExpanded);
+    connect(m_ui->propertyTree, &QTreeWidget::itemClicked, this, &ParserWidget::onPropertyItemClicked);
     connect(m_ui->expandProperties, &QPushButton::clicked, [this] () {
+        // only the first pages of the top level properties and of their entries are loaded
+        for(int i = 0, size = this->m_ui->propertyTree->topLevelItemCount(); i < size; ++i)
+        {
+            QTreeWidgetItem * item = this->m_ui->propertyTree->topLevelItem(i);
+            this->loadPropertyPage(item);
+            for(int j = 0, count = item->childCount(); j < count; ++j)
+                this->loadPropertyPage(item->child(j));
+        }
         this->m_ui->propertyTree->expandAll();
         this->resizeTreeToContents(m_ui->propertyTree);
     });
@@ -71,6 +90,7 @@ ParserWidget::~ParserWidget()
 
 void ParserWidget::showFilesetInformation(FilesetInformation fileset_information)
 {
+    StallScope scope("ParserWidget::showFilesetInformation");
     if(fileset_information == m_fileset_information)
     {
         return;
@@ -80,158 +100,51 @@ void ParserWidget::showFilesetInformation(FilesetInformation fileset_information
         clearContents();
 
         m_fileset_information = fileset_information;
+        m_box_tree_model.setFilesetInformation(m_fileset_information);
 
-        Q_FOREACH(QString filename, m_fileset_information.keys())
-        {
-            QTreeWidgetItem * item = new QTreeWidgetItem();
-            item->setText(0, QFileInfo(filename).fileName());
-            item->setText(1, "File");
-            Q_FOREACH(Box * child, m_fileset_information[filename]->getChildren())
-            {
-                createBoxItem(child, item);
-            }
-            m_ui->boxTree->addTopLevelItem(item);
-        }
-        resizeTreeToContents(m_ui->boxTree);
         if (fileset_information.size() == 1) {
-            m_ui->boxTree->expandToDepth(2);
+            // expanding the fragments of a long recording would create all their rows
+            QModelIndex file_index = m_box_tree_model.index(0, 0);
+            if(m_box_tree_model.rowCount(file_index) <= PARSER_EXPAND_BOX_LIMIT)
+                m_ui->boxTree->expandToDepth(2);
+            else
+                m_ui->boxTree->expand(file_index);
         }
+        resizeTreeToContents(m_ui->boxTree);
     }
 }
 
 void ParserWidget::clearContents()
 {
     m_fileset_information.clear();
-    m_ui->boxTree->clear();
+    m_box_tree_model.setFilesetInformation(m_fileset_information);
     m_ui->propertyTree->clear();
+    m_paged_properties.clear();
 }
 
-QTreeWidgetItem * ParserWidget::createBoxItem(Box * box, QTreeWidgetItem * parent)
-{
-    QTreeWidgetItem * item = new QTreeWidgetItem(parent);
-    item->setData(0, Qt::UserRole, QVariant::fromValue((void*)box));
-    item->setText(0, (QString)box->getBoxFourCC());
-    item->setText(1, box->getBoxDescription());
-
-    QString errorTooltip = generateErrorList(box).join("\r\n").trimmed();
-
-    if(!errorTooltip.isEmpty())
-    {
-        item->setIcon(0, QCommonStyle().standardIcon(QStyle::SP_MessageBoxWarning));
-        item->setToolTip(0, errorTooltip);
-    }
-
-    ChildrenMixin * super_box = dynamic_cast<ChildrenMixin *>(box);
-    if(super_box != nullptr)
-    {
-		auto super_box_children = super_box->getChildren();
-        for(auto it = super_box_children.begin(), end = super_box_children.end(); it != end; ++it)
-        {
-			Box * child = *it;
-            createBoxItem(child, item);
-        }
-    }
-    return item;
-}
-
-QStringList ParserWidget::generateErrorList(Box *box)
-{
-    QStringList errorList;
-    switch(box->getSizeError())
-    {
-    case Box::SizeInsufficient:
-        errorList << "Actual box size is less, than expected. Data may be corrupted.";
-        break;
-    case Box::SizeExceeding:
-        errorList << "Actual box size is more, than expected. Data may be corrupted.";
-        break;
-    default:
-        break;
-    }
-
-    Box::ConsistencyError consistency_error = box->getConsistencyError();
-
-    if(consistency_error & Box::HasNotEnoughBoxes)
-    {
-        errorList << "Box does not contain all mandatory boxes needed.";
-    }
-    if(consistency_error & Box::HasTooManyBoxes)
-    {
-        errorList << "Box contains exceeding count of child boxes of specific type.";
-    }
-    if(consistency_error & Box::HasConflictingBoxes)
-    {
-        errorList << "Box contains conflicting types of child boxes.";
-    }
-    if(consistency_error & Box::HasUnexpectedBoxes)
-    {
-        errorList << "Box contains unexpected boxes.";
-    }
-    if(consistency_error & Box::IsMandatoryBox)
-    {
-        if(is_a<MandatoryBox>(box))
-        {
-            errorList << "Parent box should contain at least one box of type '" + (QString)box->getBoxFourCC() + "'.";
-        }
-        else
-        {
-            QString errorString;
-            MandatoryBoxes * mandatory_boxes = dynamic_cast<MandatoryBoxes *>(box);
-            errorString = "Parent box should contain at least one box of one of the following types: ";
-            auto mandatory_four_cc = mandatory_boxes->getMandatoryFourCC();
-            for( auto it = mandatory_four_cc.begin(), end = mandatory_four_cc.end(); it != end; ++it )
-            {
-                FourCC & mandatory_four_cc = *it;
-                errorString += "'" + (QString)mandatory_four_cc + "', ";
-            }
-            if(errorString.endsWith(", "))
-            {
-                errorString.replace(errorString.length() - 3, 2, ".");
-            }
-            errorList << errorString;
-        }
-    }
-    if(consistency_error & Box::IsBoxWithExceedingCount)
-    {
-        errorList << "Parent box contains too many boxes of this type.";
-    }
-    if(consistency_error & Box::IsConflictingBox)
-    {
-        errorList << "Parent box contains conflicting types of child box.";
-    }
-    if(consistency_error & Box::IsUnexpectedBox)
-    {
-        if(is_a<UnknownBox>(box))
-        {
-            errorList << "Box type is unknown.";
-
-        }
-        errorList << "Box presence is not expected here.";
-    }
-    return errorList;
-}
-
-void ParserWidget::resizeTreeToContents(QTreeWidget *widget)
+void ParserWidget::resizeTreeToContents(QTreeView *widget)
 {
     if(widget != nullptr)
     {
-        for(int i = 0, size = widget->columnCount(); i < size; ++i)
+        for(int i = 0, size = widget->model()->columnCount(); i < size; ++i)
         {
             widget->resizeColumnToContents(i);
         }
     }
 }
 
-void ParserWidget::onItemChanged(QTreeWidgetItem *item)
+void ParserWidget::onItemChanged(const QModelIndex & index)
 {
+    StallScope scope("ParserWidget::onItemChanged");
     m_ui->propertyTree->clear();
+    m_paged_properties.clear();
 
-    if((item != nullptr) && (item->data(0, Qt::UserRole).canConvert<void *>()))
+    Box * box = m_box_tree_model.getBox(index);
+    if(box != nullptr)
     {
-        Box * box = (Box*)item->data(0, Qt::UserRole).value<void *>();
         QList<QString> properties = box->getProperties();
 
-        Q_FOREACH(QString errorString, generateErrorList(box))
+        Q_FOREACH(QString errorString, BoxTreeModel::getErrorList(box))
         {
             QTreeWidgetItem * item = new QTreeWidgetItem();
             item->setText(0, errorString);
@@ -250,6 +163,39 @@ void ParserWidget::onItemChanged(QTreeWidgetItem *item)
     }
 }
 
+void ParserWidget::onSearchTextEdited(const QString & text)
+{
+    Q_UNUSED(text);
+    findBox(true);
+}
+
+void ParserWidget::onFindNext()
+{
+    findBox(false);
+}
+
+void ParserWidget::findBox(bool include_current)
+{
+    QModelIndex index = m_box_tree_model.findBox(m_ui->boxSearch->text().trimmed(), m_ui->boxTree->currentIndex(), include_current);
+    if(index.isValid())
+    {
+        m_ui->boxTree->setCurrentIndex(index);
+        m_ui->boxTree->scrollTo(index);
+    }
+}
+
+void ParserWidget::onPropertyItemExpanded(QTreeWidgetItem * item)
+{
+    loadPropertyPage(item);
+}
+
+void ParserWidget::onPropertyItemClicked(QTreeWidgetItem * item, int column)
+{
+    Q_UNUSED(column);
+    if(item->data(0, Qt::UserRole).toBool() && (item->parent() != nullptr))
+        loadPropertyPage(item->parent(), true);
+}
+
 QTreeWidgetItem * ParserWidget::createPropertyItem(QString name, const Property & value, QTreeWidgetItem *parent)
 {
     QTreeWidgetItem * item = new QTreeWidgetItem(parent);
@@ -258,12 +204,62 @@ QTreeWidgetItem * ParserWidget::createPropertyItem(QString name, const Property
     item->setText(1, string.isEmpty() ? QString("<Empty>") : string);
     if(value.isList())
     {
-        int idx = 0;
-        for(auto it = value.begin(), end = value.end(); it != end; ++it)
+        // the entries are created page by page, when the item is expanded
+        item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+        m_paged_properties.insert(item, value);
+    }
+    return item;
+}
+
+void ParserWidget::loadPropertyPage(QTreeWidgetItem * item, bool next_page /*= false*/)
+{
+    StallScope scope("ParserWidget::loadPropertyPage");
+    auto it = m_paged_properties.find(item);
+    if(it == m_paged_properties.end())
+        return;
+    const Property & value = *it;
+
+    // the last child is the item loading the next page, if there are more entries
+    int loaded = item->childCount();
+    QTreeWidgetItem * more_item = nullptr;
+    if((loaded > 0) && item->child(loaded - 1)->data(0, Qt::UserRole).toBool())
+    {
+        more_item = item->child(loaded - 1);
+        loaded--;
+    }
+    if((loaded > 0) && !next_page)
+        return;
+
+    int count = value.getCount();
+    int last = std::min(count, loaded + PROPERTY_PAGE_SIZE);
+    QFont fixed_font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    QList<QTreeWidgetItem *> page;
+    for(int i = loaded; i < last; ++i)
+    {
+        QTreeWidgetItem * entry_item = createPropertyItem(value.getEntryName(i), value.getEntry(i));
+        if(value.isBinary())
         {
-			const Property & entry = *it;
-            createPropertyItem( QString::number(idx++), entry, item );
+            entry_item->setFont(0, fixed_font);
+            entry_item->setFont(1, fixed_font);
         }
+        page.append(entry_item);
+    }
+    item->insertChildren(loaded, page);
+
+    if(last < count)
+    {
+        if(more_item == nullptr)
+        {
+            more_item = new QTreeWidgetItem(item);
+            more_item->setData(0, Qt::UserRole, true);
+            more_item->setFirstColumnSpanned(true);
+        }
+        more_item->setText(0, QString("Show next %1 of %2 records...").arg(std::min(PROPERTY_PAGE_SIZE, count - last)).arg(count - last));
+    }
+    else if(more_item != nullptr)
+    {
+        // the item can not be deleted here, as it may be the one being clicked
+        more_item->setHidden(true);
+        more_item->setData(0, Qt::UserRole, false);
     }
-    return item;
 }
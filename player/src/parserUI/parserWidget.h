@@ -31,11 +31,13 @@
 #include "crosscompilation_cxx11.h"
 
 #include <QDialog>
+#include <QHash>
 #include <QTreeWidgetItem>
 #include <QStringList>
 #include <memory>
 
 #include "../parser/mediaParser.h"
+#include "boxTreeModel.h"
 
 namespace Ui {
 class parserWidget;
@@ -58,23 +60,39 @@ public:
 
 public slots:
     //! This slot is called when the box is selected and we need to show its content.
-    void onItemChanged(QTreeWidgetItem * item);
+    void onItemChanged(const QModelIndex & index);
+    //! This slot is called when the searched FourCC is edited, selecting the first matching box from the current one.
+    void onSearchTextEdited(const QString & text);
+    //! This slot is called to select the next box matching the searched FourCC.
+    void onFindNext();
+    //! This slot is called when a property is expanded, creating the first page of its entries.
+    void onPropertyItemExpanded(QTreeWidgetItem * item);
+    //! This slot is called when a property is clicked, creating the next page of entries, if it is the item for it.
+    void onPropertyItemClicked(QTreeWidgetItem * item, int column);
 
 private:
-    //! Creates a tree item for a box.
-    QTreeWidgetItem * createBoxItem(Box *box, QTreeWidgetItem *parent = nullptr);
-    //! Creates a tree item for a box property.
+    //! Creates a tree item for a box property. Entries of list properties are created later by loadPropertyPage.
     QTreeWidgetItem * createPropertyItem(QString name, const Property & value, QTreeWidgetItem *parent = nullptr);
-    //! Generates a list of errors for a box
-    QStringList generateErrorList(Box *box);
+    //! Creates a page of the entries of a list property.
+    /*!
+     * \param item tree item of the property
+     * \param next_page create the next page, otherwise only the first one, if no entries were created yet
+     */
+    void loadPropertyPage(QTreeWidgetItem * item, bool next_page = false);
+    //! Selects the box matching the searched FourCC.
+    void findBox(bool include_current);
     //! Resizes a specified tree widget columns to fit its content
-    void resizeTreeToContents(QTreeWidget *widget);
+    void resizeTreeToContents(QTreeView *widget);
     
 private:
     //! UI
     Ui::parserWidget* m_ui;
     //! Fileset information.
     FilesetInformation m_fileset_information;
+    //! Model of the box trees.
+    BoxTreeModel m_box_tree_model;
+    //! List properties of the property tree items, which entries are created on request.
+    QHash<QTreeWidgetItem *, Property> m_paged_properties;
 };
 
 #endif // PARSERWIDGET_H
@@ -0,0 +1,293 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "clipExporter.h"
+
+#include <QFile>
+#include <QtDebug>
+
+#include "defines.h"
+
+namespace
+{
+    //! Sample entry of the ONVIF metadata tracks, used when the demuxer reports no codec tag.
+    const uint32_t sc_metadata_tag = MKTAG('m', 'e', 't', 'x');
+}
+
+ClipExporter::ClipExporter() :
+    QObject(),
+    m_reader(AVMEDIA_TYPE_DATA),
+    m_output(nullptr),
+    m_open_streams(0),
+    m_video_index(-1),
+    m_clip_start_us(AV_NOPTS_VALUE),
+    m_seek_us(0),
+    m_end_us(0),
+    m_progress(-1),
+    m_skipped_tracks(0),
+    m_packet(av_packet_alloc())
+{
+}
+
+ClipExporter::~ClipExporter()
+{
+    cancel();
+    av_packet_free(&m_packet);
+}
+
+bool ClipExporter::start(const QString& file_name, const QString& clip_file_name, int start_ms, int end_ms, const SampleIndex& sample_index)
+{
+    cancel();
+    if(end_ms <= start_ms || !m_reader.open(file_name))
+        return false;
+
+    AVFormatContext* input = m_reader.getFormatContext();
+    m_video_index = av_find_best_stream(input, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if(m_video_index < 0)
+        m_video_index = -1;
+    m_seek_us = findClipStart((m_video_index >= 0) ? input->streams[m_video_index] : nullptr, start_ms, sample_index);
+    m_end_us = (int64_t)end_ms * 1000;
+    m_clip_start_us = AV_NOPTS_VALUE;
+    m_progress = -1;
+
+    if(!openClip(clip_file_name))
+    {
+        close(false);
+        return false;
+    }
+
+    //the demuxer goes back to the sync sample at or before the time
+    int result = (m_video_index >= 0) ?
+        av_seek_frame(input, m_video_index, av_rescale_q(m_seek_us, AV_TIME_BASE_Q, input->streams[m_video_index]->time_base), AVSEEK_FLAG_BACKWARD) :
+        av_seek_frame(input, -1, m_seek_us, AVSEEK_FLAG_BACKWARD);
+    if(result < 0)
+    {
+        close(false);
+        return false;
+    }
+
+    DecodePool::instance().add(this, DecodePool::IndexingPriority);
+    return true;
+}
+
+void ClipExporter::cancel()
+{
+    DecodePool::instance().remove(this);
+    close(false);
+}
+
+bool ClipExporter::decodeStep()
+{
+    if(m_output == nullptr)
+        return false;
+
+    AVFormatContext* input = m_reader.getFormatContext();
+    for(int i = 0; i < DECODE_STEP_PACKETS; ++i)
+    {
+        int result = av_read_frame(input, m_packet);
+        if(result < 0)
+        {
+            //the range reaches the end of the file
+            emit finished(close(result == AVERROR_EOF));
+            return false;
+        }
+
+        bool copied = copyPacket(m_packet);
+        av_packet_unref(m_packet);
+        if(!copied || m_open_streams == 0)
+        {
+            emit finished(close(copied));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ClipExporter::openClip(const QString& clip_file_name)
+{
+    AVFormatContext* input = m_reader.getFormatContext();
+    QByteArray clip_name = clip_file_name.toUtf8();
+    m_clip_file_name = clip_file_name;
+    if(avformat_alloc_output_context2(&m_output, nullptr, "mp4", clip_name.data()) < 0)
+        return false;
+    //the metadata sample entries are not in the codec tables of the muxer, they are stored by their tags
+    m_output->strict_std_compliance = FF_COMPLIANCE_UNOFFICIAL;
+
+    m_stream_map.assign(input->nb_streams, -1);
+    m_stream_ended.assign(input->nb_streams, false);
+    m_open_streams = 0;
+    m_skipped_tracks = 0;
+    for(unsigned int index = 0; index < input->nb_streams; ++index)
+    {
+        AVStream* stream = input->streams[index];
+        AVMediaType type = stream->codecpar->codec_type;
+        if(type != AVMEDIA_TYPE_VIDEO &&
+           type != AVMEDIA_TYPE_AUDIO &&
+           type != AVMEDIA_TYPE_DATA &&
+           type != AVMEDIA_TYPE_SUBTITLE)
+            continue;
+
+        //the muxer writes sample entries for the codecs it knows only, the metadata tracks keep the tags of their sample entries
+        bool is_metadata = (type == AVMEDIA_TYPE_DATA);
+        if(!is_metadata &&
+           avformat_query_codec(m_output->oformat, stream->codecpar->codec_id, FF_COMPLIANCE_NORMAL) != 1)
+        {
+            qWarning() << "Track" << stream->id << "cannot be stored in the clip";
+            ++m_skipped_tracks;
+            continue;
+        }
+
+        AVStream* clip_stream = avformat_new_stream(m_output, nullptr);
+        if(clip_stream == nullptr ||
+           avcodec_parameters_copy(clip_stream->codecpar, stream->codecpar) < 0)
+            return false;
+        if(is_metadata)
+            clip_stream->codecpar->codec_tag = (stream->codecpar->codec_tag != 0) ? stream->codecpar->codec_tag : sc_metadata_tag;
+        else
+            clip_stream->codecpar->codec_tag = 0;
+        clip_stream->time_base = stream->time_base;
+        clip_stream->disposition = stream->disposition;
+        av_dict_copy(&clip_stream->metadata, stream->metadata, 0);
+
+        m_stream_map[index] = clip_stream->index;
+        if(type == AVMEDIA_TYPE_VIDEO || type == AVMEDIA_TYPE_AUDIO)
+            ++m_open_streams;
+    }
+
+    //a clip of a video file cannot start without its video
+    if(m_open_streams == 0 ||
+       (m_video_index >= 0 && m_stream_map[m_video_index] < 0))
+        return false;
+
+    //creation time and the other tags of the file
+    av_dict_copy(&m_output->metadata, input->metadata, 0);
+
+    if(avio_open(&m_output->pb, clip_name.data(), AVIO_FLAG_WRITE) < 0)
+        return false;
+    return avformat_write_header(m_output, nullptr) >= 0;
+}
+
+int64_t ClipExporter::findClipStart(const AVStream* video_stream, int start_ms, const SampleIndex& sample_index)
+{
+    int64_t start_us = (int64_t)start_ms * 1000;
+    if(video_stream == nullptr)
+        return start_us;
+
+    //the mov demuxer uses the track ids as stream ids
+    auto it = sample_index.find((uint32_t)video_stream->id);
+    if(it == sample_index.end() ||
+       it->isEmpty() ||
+       it->getTimescale() == 0)
+        return start_us;
+
+    int sync_sample = it->findSyncSample(qMax(it->findSampleMs(start_ms), 0));
+    if(sync_sample < 0)
+        return start_us;
+    return av_rescale(it->getCompositionTime(sync_sample), AV_TIME_BASE, it->getTimescale());
+}
+
+bool ClipExporter::copyPacket(AVPacket* packet)
+{
+    int index = packet->stream_index;
+    if(index < 0 ||
+       index >= (int)m_stream_map.size() ||
+       m_stream_map[index] < 0 ||
+       m_stream_ended[index])
+        return true;
+
+    AVStream* stream = m_reader.getFormatContext()->streams[index];
+    int64_t pts = (packet->pts != AV_NOPTS_VALUE) ? packet->pts : packet->dts;
+    int64_t dts = (packet->dts != AV_NOPTS_VALUE) ? packet->dts : packet->pts;
+    if(pts == AV_NOPTS_VALUE)
+        return true;
+    int64_t pts_us = av_rescale_q(pts, stream->time_base, AV_TIME_BASE_Q);
+    int64_t dts_us = av_rescale_q(dts, stream->time_base, AV_TIME_BASE_Q);
+
+    if(m_clip_start_us == AV_NOPTS_VALUE)
+    {
+        //the clip starts with a sync sample of the video, the other tracks join at its time
+        if(m_video_index >= 0 &&
+           (index != m_video_index || (packet->flags & AV_PKT_FLAG_KEY) == 0))
+            return true;
+        if(m_video_index < 0 && pts_us < m_seek_us)
+            return true;
+        m_clip_start_us = pts_us;
+    }
+
+    if(dts_us >= m_end_us)
+    {
+        m_stream_ended[index] = true;
+        AVMediaType type = stream->codecpar->codec_type;
+        if(type == AVMEDIA_TYPE_VIDEO || type == AVMEDIA_TYPE_AUDIO)
+            --m_open_streams;
+        return true;
+    }
+
+    //samples before the start, e.g. leading frames of an open GOP, cannot be shown in the clip
+    if(pts_us < m_clip_start_us)
+        return true;
+
+    if(index == m_video_index || m_video_index < 0)
+    {
+        int percent = (int)qBound<int64_t>(0, (dts_us - m_clip_start_us) * 100 / qMax<int64_t>(1, m_end_us - m_clip_start_us), 100);
+        if(percent != m_progress)
+        {
+            m_progress = percent;
+            emit progress(percent);
+        }
+    }
+
+    int64_t shift = av_rescale_q(m_clip_start_us, AV_TIME_BASE_Q, stream->time_base);
+    if(packet->pts != AV_NOPTS_VALUE)
+        packet->pts -= shift;
+    if(packet->dts != AV_NOPTS_VALUE)
+        packet->dts -= shift;
+
+    AVStream* clip_stream = m_output->streams[m_stream_map[index]];
+    av_packet_rescale_ts(packet, stream->time_base, clip_stream->time_base);
+    packet->stream_index = clip_stream->index;
+    packet->pos = -1;
+    return av_interleaved_write_frame(m_output, packet) >= 0;
+}
+
+bool ClipExporter::close(bool complete)
+{
+    if(m_output != nullptr)
+    {
+        //a clip without samples is not complete
+        complete = complete &&
+                   m_clip_start_us != AV_NOPTS_VALUE &&
+                   av_write_trailer(m_output) >= 0;
+        avio_closep(&m_output->pb);
+        avformat_free_context(m_output);
+        m_output = nullptr;
+        if(!complete)
+            QFile::remove(m_clip_file_name);
+    }
+    m_reader.clear();
+    return complete;
+}
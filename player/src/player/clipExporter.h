@@ -0,0 +1,134 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef CLIPEXPORTER_H
+#define CLIPEXPORTER_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QObject>
+#include <QString>
+
+#include <vector>
+
+#include "decodePool.h"
+#include "ffmpeg.h"
+#include "sampleIndex.h"
+#include "streamReader.h"
+
+//! Lossless export of a time range of a file to a new MP4 file.
+/*!
+ * \brief The packets of the range are copied without decoding, so the export runs at the speed of the disks.
+ * The clip starts at the sync sample of the video track preceding the start time, found in the sample index
+ * of the parser when the file is fragmented, or by the demuxer from the sync sample tables otherwise.
+ * Video and audio tracks are copied as far as the MP4 muxer can store their codecs, metadata tracks are copied
+ * with the tags of their sample entries. The timestamps are shifted so the clip starts at zero.
+ * The export runs in steps on the DecodePool as indexing work, its progress is reported by signals.
+ */
+class ClipExporter : public QObject, public DecodeJob
+{
+private:
+    Q_OBJECT
+
+public:
+    ClipExporter();
+
+    ~ClipExporter();
+
+public:
+    //! Starts exporting a time range of a file.
+    /*!
+     * \param start_ms start of the range on the timeline of the file
+     * \param end_ms end of the range on the timeline of the file
+     * \param sample_index sample index of the file from the parser, it may be empty
+     * \return false, if the files cannot be opened or the range is empty
+     */
+    bool start(const QString& file_name, const QString& clip_file_name, int start_ms, int end_ms, const SampleIndex& sample_index);
+
+    //! Stops exporting and removes the unfinished clip.
+    void cancel();
+
+    //! Get count of the tracks of the file, which could not be stored in the clip.
+    int getSkippedTracks() const { return m_skipped_tracks; }
+
+    virtual bool needsDecoding() const CC_CXX11_OVERRIDE { return true; }
+
+    virtual bool decodeStep() CC_CXX11_OVERRIDE;
+
+signals:
+    //! Emitted when the exported part of the range grows, in percent.
+    void progress(int percent);
+
+    //! Emitted when the export ended, the clip is removed if it failed.
+    void finished(bool success);
+
+private:
+    //! Opens the clip and writes its header.
+    bool openClip(const QString& clip_file_name);
+
+    //! Find the time to read a range from, the time of the sync sample of the video stream preceding the start.
+    static int64_t findClipStart(const AVStream* video_stream, int start_ms, const SampleIndex& sample_index);
+
+    //! Copy a packet to the clip if it belongs to the range.
+    /*!
+     * \return false, if the packet could not be written
+     */
+    bool copyPacket(AVPacket* packet);
+
+    //! Close the files, the clip is completed or removed.
+    bool close(bool complete);
+
+private:
+    //! Reader of the exported file.
+    StreamReader        m_reader;
+    //! Clip being written.
+    AVFormatContext*    m_output;
+    //! Name of the clip file.
+    QString             m_clip_file_name;
+    //! Clip stream of each stream of the file, -1 for the ones not copied.
+    std::vector<int>    m_stream_map;
+    //! Set for the streams of the file past the end of the range.
+    std::vector<bool>   m_stream_ended;
+    //! Count of the copied audio and video streams not past the end yet.
+    int                 m_open_streams;
+    //! Video stream the clip starts with, -1 for files without video.
+    int                 m_video_index;
+    //! Start of the clip in microseconds, AV_NOPTS_VALUE until the first sync sample is read.
+    int64_t             m_clip_start_us;
+    //! Time the reading started from.
+    int64_t             m_seek_us;
+    //! End of the range in microseconds.
+    int64_t             m_end_us;
+    //! Last progress reported.
+    int                 m_progress;
+    //! Count of the tracks not copied.
+    int                 m_skipped_tracks;
+    //! Packet being copied.
+    AVPacket*           m_packet;
+};
+
+#endif // CLIPEXPORTER_H
@@ -31,10 +31,74 @@
 #include <QMessageBox>
 #include <QDir>
 #include <QDirIterator>
+#include <QFileInfo>
+#include <QFile>
+#include <QJsonDocument>
+#include <QSaveFile>
 
+#include "defines.h"
+#include "activityCurve.h"
 #include "certificateStorage.h"
 #include "certificateStorageDialog.h"
 #include "queuedMetadataDecoder.h"
+#include "pipelineStatistics.h"
+#include "decodePool.h"
+#include "fileView.h"
+#include "readAhead.h"
+#include "traceRecorder.h"
+#include "stallWatchdog.h"
+
+namespace
+{
+    //! Formats the statistics for the overlay.
+    QString formatStatistics(const QJsonObject& statistics)
+    {
+        QString text = QString("%1 %2 %3 %4\n").arg("stage", -16).arg("count", 8).arg("mean ms", 9).arg("p99 ms", 9);
+        QJsonObject stages = statistics["stages"].toObject();
+        for(int i = 0; i < PipelineStatistics::StageCount; ++i)
+        {
+            QString name = PipelineStatistics::getStageName(PipelineStatistics::Stage(i));
+            QJsonObject stage = stages[name].toObject();
+            text += QString("%1 %2 %3 %4\n").arg(name, -16)
+                    .arg((qint64)stage["count"].toDouble(), 8)
+                    .arg(stage["mean_us"].toDouble() / 1000.0, 9, 'f', 2)
+                    .arg(stage["p99_us"].toDouble() / 1000.0, 9, 'f', 2);
+        }
+
+        text += QString("dropped %1, late %2, A/V drift %3 ms\n")
+                .arg((qint64)statistics["dropped_frames"].toDouble())
+                .arg((qint64)statistics["late_frames"].toDouble())
+                .arg(statistics["av_drift_ms"].toInt());
+
+        QJsonObject queues = statistics["queues"].toObject();
+        QStringList queue_names = QStringList() << "video" << "audio" << "metadata";
+        for(auto it = queue_names.begin(), end = queue_names.end(); it != end; ++it)
+        {
+            QJsonObject queue = queues[*it].toObject();
+            text += QString("%1 queue %2 frames, %3 KB\n").arg(*it)
+                    .arg(queue["frames"].toInt())
+                    .arg(queue["bytes"].toInt() / 1024);
+        }
+
+        QJsonObject stalls = statistics["gui_stalls"].toObject();
+        QJsonObject operations = stalls["operations"].toObject();
+        QString worst_operation;
+        double worst_time = 0;
+        for(auto it = operations.begin(), end = operations.end(); it != end; ++it)
+        {
+            double total_time = it.value().toObject()["total_ms"].toDouble();
+            if(total_time > worst_time)
+            {
+                worst_operation = it.key();
+                worst_time = total_time;
+            }
+        }
+        text += QString("GUI stalls %1, long %2").arg((qint64)stalls["count"].toDouble()).arg((qint64)stalls["long_count"].toDouble());
+        if(!worst_operation.isEmpty())
+            text += QString(", mostly in %1 (%2 ms)").arg(worst_operation).arg((qint64)worst_time);
+        return text.trimmed();
+    }
+}
 
 Controller::Controller(Engine& engine,
                        PlayerWidget& player_widget, FullscreenPlayerWidget& fullscreen_player_widget, ControlsWidget& controls_widget,
@@ -47,10 +111,23 @@ Controller::Controller(Engine& engine,
     m_parser_widget(parser_widget),
     m_verifyer_dialog(verifyer_dlg),
     m_media_parser(media_parser),
-    m_playing_fragment_index(-1)
+    m_playing_fragment_index(-1),
+    m_clip_fragment_index(-1),
+    m_clip_start_ms(-1),
+    m_clip_end_ms(-1),
+    m_clip_progress(nullptr),
+    m_activity_generation(0)
 {
     QObject::connect(&m_player_widget, SIGNAL(openFile(QString)), this, SLOT(openFile(QString)));
     QObject::connect(&m_player_widget, SIGNAL(openDir(QString)), this, SLOT(openDir(QString)));
+    QObject::connect(&m_player_widget, SIGNAL(followFile(QString)), this, SLOT(followFile(QString)));
+    QObject::connect(&m_player_widget, SIGNAL(openMosaic(QStringList)), this, SLOT(openMosaic(QStringList)));
+    QObject::connect(&m_player_widget, SIGNAL(markClipStart()), this, SLOT(onMarkClipStart()));
+    QObject::connect(&m_player_widget, SIGNAL(markClipEnd()), this, SLOT(onMarkClipEnd()));
+    QObject::connect(&m_player_widget, SIGNAL(exportClip(QString)), this, SLOT(exportClip(QString)));
+    QObject::connect(&m_clip_exporter, SIGNAL(progress(int)), this, SLOT(onClipExportProgress(int)));
+    QObject::connect(&m_clip_exporter, SIGNAL(finished(bool)), this, SLOT(onClipExported(bool)));
+    QObject::connect(&m_thumbnail_extractor, SIGNAL(thumbnail(QString,int,QImage)), this, SLOT(onThumbnail(QString,int,QImage)));
     QObject::connect(&m_player_widget, SIGNAL(changeVideoStream(int)), this, SLOT(onVideoStreamIndexChanged(int)));
     QObject::connect(&m_player_widget, SIGNAL(changeAudioStream(int)), this, SLOT(onAudioStreamIndexChanged(int)));
     QObject::connect(&m_player_widget, SIGNAL(showFileStructure()), this, SLOT(showFileStructure()));
@@ -81,6 +158,32 @@ Controller::Controller(Engine& engine,
 
     QObject::connect(&m_engine, SIGNAL(played(BasePlayback*)), this, SLOT(onPlayed(BasePlayback*)));
 
+    // only the playback needs the files at once, they are checked when the parser widget or the verification dialog is opened
+    m_media_parser.setFastOpen(true);
+    QObject::connect(&m_media_parser, SIGNAL(filesetChecked()), this, SLOT(onFilesetChecked()));
+
+    m_follow_update_timer.setSingleShot(true);
+    m_follow_update_timer.setInterval(FOLLOW_UPDATE_DELAY);
+    m_follow_poll_timer.setInterval(FOLLOW_POLL_INTERVAL);
+    QObject::connect(&m_file_watcher, SIGNAL(fileChanged(QString)), this, SLOT(onFollowedFileChanged(QString)));
+    QObject::connect(&m_follow_update_timer, SIGNAL(timeout()), this, SLOT(updateFollowedFile()));
+    QObject::connect(&m_follow_poll_timer, SIGNAL(timeout()), this, SLOT(updateFollowedFile()));
+
+    m_statistics_timer.setInterval(STATISTICS_OVERLAY_INTERVAL);
+    QObject::connect(&m_player_widget, SIGNAL(showStatisticsChanged(bool)), this, SLOT(onShowStatisticsChanged(bool)));
+    QObject::connect(&m_player_widget, SIGNAL(saveStatistics(QString)), this, SLOT(saveStatistics(QString)));
+    QObject::connect(&m_statistics_timer, SIGNAL(timeout()), this, SLOT(updateStatistics()));
+    QObject::connect(&m_player_widget, SIGNAL(recordTraceChanged(bool)), this, SLOT(onRecordTraceChanged(bool)));
+    QObject::connect(&m_player_widget, SIGNAL(saveTrace(QString)), this, SLOT(saveTrace(QString)));
+
+    QObject::connect(&m_mosaic_playback, SIGNAL(updated()), this, SLOT(onMosaicUpdated()));
+    QObject::connect(&m_mosaic_playback, SIGNAL(finished()), this, SLOT(onMosaicUpdated()));
+    QObject::connect(&m_mosaic_widget, SIGNAL(playPause()), this, SLOT(onMosaicPlayPause()));
+    QObject::connect(&m_mosaic_widget, SIGNAL(seek(int)), this, SLOT(onMosaicSeek(int)));
+    QObject::connect(&m_mosaic_widget, SIGNAL(tileSelected(int)), this, SLOT(onMosaicTileSelected(int)));
+    QObject::connect(&m_mosaic_widget, SIGNAL(tileSizeChanged(QSize)), this, SLOT(onMosaicTileSizeChanged(QSize)));
+    QObject::connect(&m_mosaic_widget, SIGNAL(closed()), this, SLOT(onMosaicClosed()));
+
 #ifdef MEMORY_INFO
     //Debug
     QObject::connect(&m_player_widget, SIGNAL(memoryInfo()), this, SLOT(showMemoryInfo()));
@@ -96,22 +199,16 @@ Controller::Controller(Engine& engine,
 
 Controller::~Controller()
 {
+    DecodePool::instance().cancel(this);
+    DecodePool::instance().wait(this);
     m_engine.stop();
     m_engine.clear();
 }
 
 void Controller::openFile(const QString& file_name)
 {
-    m_engine.stop();
-    m_engine.clear();
-    m_player_widget.getEventWidget()->clear();
-    m_player_widget.getVideoWidget()->clear();
-    m_player_widget.getEventTreeWidget()->clear();
-    m_controls_widget.enableUI(true);
-    m_parser_widget.clearContents();
-    m_verifyer_dialog.clearContent();
-    m_media_parser.clearContents();
-    m_segments.clear();
+    StallScope scope("Controller::openFile");
+    clearContents();
 
     m_media_parser.addFile(file_name);
 
@@ -127,10 +224,113 @@ void Controller::openFile(const QString& file_name)
         return;
     }
 
+    openSegments();
+}
+
+void Controller::openDir(const QString& dir_name)
+{
+    StallScope scope("Controller::openDir");
+    clearContents();
+
+    m_media_parser.addDirectory(dir_name);
+
+    if(!m_media_parser.isValidISOFileset())
+    {
+        QMessageBox message_box(QMessageBox::Information,
+                               m_player_widget.windowTitle(),
+                               QString("This folder does not contain files conforming ISO Base Media format only"),
+                               QMessageBox::Ok,
+                               &m_player_widget);
+        message_box.exec();
+        m_media_parser.clearContents();
+        return;
+    }
+
+    openSegments();
+}
+
+void Controller::followFile(const QString& file_name)
+{
+    StallScope scope("Controller::followFile");
+    clearContents();
+
+    m_media_parser.followFile(file_name);
+
+    if(!m_media_parser.isValidISO())
+    {
+        QMessageBox message_box(QMessageBox::Information,
+                               m_player_widget.windowTitle(),
+                               QString("This file does not conform ISO Base Media format or does not contain any complete fragment yet"),
+                               QMessageBox::Ok,
+                               &m_player_widget);
+        message_box.exec();
+        m_media_parser.clearContents();
+        return;
+    }
+
+    m_engine.setFollowMode(true);
+    openSegments();
+
+    m_file_watcher.addPath(file_name);
+    m_follow_poll_timer.start();
+}
+
+void Controller::onFollowedFileChanged(const QString& file_name)
+{
+    //some writers replace the file, so the watcher drops it
+    if(!m_file_watcher.files().contains(file_name) &&
+       QFile::exists(file_name))
+        m_file_watcher.addPath(file_name);
+
+    if(!m_follow_update_timer.isActive())
+        m_follow_update_timer.start();
+}
+
+void Controller::updateFollowedFile()
+{
+    StallScope scope("Controller::updateFollowedFile");
+    if(!m_media_parser.updateFollowedFile())
+        return;
+
+    m_segments = m_media_parser.getSegments();
+    m_timeline = SegmentTimeline(m_segments);
+    m_controls_widget.updateFragmentsList(m_segments);
+    m_controls_widget.updateUI();
+}
+
+void Controller::clearContents()
+{
+    m_follow_update_timer.stop();
+    m_follow_poll_timer.stop();
+    if(!m_file_watcher.files().isEmpty())
+        m_file_watcher.removePaths(m_file_watcher.files());
+    m_engine.setFollowMode(false);
+
+    m_engine.stop();
+    m_engine.clear();
+    m_player_widget.getEventWidget()->clear();
+    m_player_widget.getVideoWidget()->clear();
+    m_player_widget.getEventTreeWidget()->clear();
+    m_controls_widget.enableUI(true);
+    m_parser_widget.clearContents();
+    m_verifyer_dialog.clearContent();
+    m_media_parser.clearContents();
+    m_segments.clear();
+    m_timeline = SegmentTimeline();
+    clearClipMarks();
+    m_activity_generation++;
+    DecodePool::instance().cancel(this);
+    m_thumbnail_extractor.cancel();
+}
+
+void Controller::openSegments()
+{
+    StallScope scope("Controller::openSegments");
     m_segments = m_media_parser.getSegments();
     updateFragmentsList(m_segments);
+    m_timeline = SegmentTimeline(m_segments);
 
-    if(!m_engine.init(file_name, m_segments.front()))
+    if(!m_engine.init(m_segments.front().getFileName(), m_segments.front()))
     {
         QMessageBox message_box(QMessageBox::Information,
                                m_player_widget.windowTitle(),
@@ -142,29 +342,104 @@ void Controller::openFile(const QString& file_name)
         return;
     }
 
-    m_parser_widget.showFilesetInformation(m_media_parser.getFilesetInformation());
+    // the box trees are complete and checked only after the files are parsed again, so it is done on demand
+    if(m_parser_widget.isVisible() || m_verifyer_dialog.isVisible())
+        m_media_parser.checkFileset();
     m_verifyer_dialog.initialize(m_media_parser);
 
     m_playing_fragment_index = 0;
+    m_engine.setFollowingSegments(m_segments.mid(1));
     m_player_widget.setStreamsInfo(m_engine.m_video_decoder.getStreamsCount(), m_engine.m_audio_decoder.getStreamsCount());
     m_controls_widget.setFragmentsList(m_segments);
     m_controls_widget.startPlayback();
     m_controls_widget.updateUI();
     m_engine.start();
+    computeActivity();
+    makeThumbnails();
+}
+
+void Controller::computeActivity()
+{
+    // the sample indexes are known since the files were opened, so only the metadata samples are read
+    uint32_t generation = m_activity_generation;
+    for(int i = 0; i < m_segments.size(); ++i)
+    {
+        QString file_name = m_segments.at(i).getFileName();
+        SampleIndex sample_index = m_media_parser.getSampleIndex(file_name);
+        std::shared_ptr<ActivityCurve> curve;
+        std::shared_ptr<FileView> view;
+        int position = 0;
+        // the bytes are summed in the first step, the metadata samples are read in bounded steps after it
+        DecodePool::instance().runSteps([this, i, file_name, sample_index, generation, curve, view, position] () mutable
+        {
+            if(!curve)
+            {
+                curve = std::make_shared<ActivityCurve>(ActivityCurve::compute(sample_index));
+                view = FileView::open(file_name);
+            }
+            if(view && curve->countObjects(sample_index, *view, position))
+                return true;
+
+            ActivityCurve result = *curve;
+            QMetaObject::invokeMethod(this, [this, i, result, generation] ()
+            {
+                if(generation == m_activity_generation)
+                    m_controls_widget.setActivity(i, result);
+            }, Qt::QueuedConnection);
+            return false;
+        }, this);
+    }
+}
+
+void Controller::makeThumbnails()
+{
+    QStringList file_names;
+    QList<SampleIndex> sample_indexes;
+    for(auto it = m_segments.begin(), end = m_segments.end(); it != end; ++it)
+    {
+        //files with several segments are processed once
+        if(file_names.contains(it->getFileName()))
+            continue;
+        file_names.append(it->getFileName());
+        sample_indexes.append(m_media_parser.getSampleIndex(it->getFileName()));
+    }
+    m_thumbnail_extractor.start(file_names, sample_indexes);
+}
+
+void Controller::onThumbnail(const QString& file_name, int time_ms, const QImage& image)
+{
+    //thumbnails of the previous fileset may still come, they match no fragment
+    for(int i = 0; i < m_segments.size(); ++i)
+    {
+        if(m_segments.at(i).getFileName() == file_name)
+            m_controls_widget.addThumbnail(i, time_ms, image);
+    }
 }
 
 void Controller::showFileStructure()
 {
+    StallScope scope("Controller::showFileStructure");
     m_parser_widget.hide();
-    m_parser_widget.showFilesetInformation(m_media_parser.getFilesetInformation());
+    if(m_media_parser.isChecked())
+        m_parser_widget.showFilesetInformation(m_media_parser.getFilesetInformation());
+    else
+        m_media_parser.checkFileset();
     m_parser_widget.show();
 }
 
 void Controller::verifyFileSignature()
 {
+    StallScope scope("Controller::verifyFileSignature");
     m_verifyer_dialog.hide();
     m_verifyer_dialog.initialize( m_media_parser );
     m_verifyer_dialog.show();
+    m_media_parser.checkFileset();
+}
+
+void Controller::onFilesetChecked()
+{
+    if(m_parser_widget.isVisible())
+        m_parser_widget.showFilesetInformation(m_media_parser.getFilesetInformation());
 }
 
 void Controller::openCertificateStorage()
@@ -173,8 +448,173 @@ void Controller::openCertificateStorage()
     certificate_storage_dialog.exec();
 }
 
+void Controller::openMosaic(const QStringList& file_names)
+{
+    StallScope scope("Controller::openMosaic");
+    //tiles share the decoding threads and the queue budget with the engine
+    if(m_engine.getState() == Playing)
+    {
+        m_engine.pause();
+        m_controls_widget.pausePlayback();
+    }
+
+    m_mosaic_widget.hide();
+    m_mosaic_widget.setTileCount(0);
+    if(!m_mosaic_playback.open(file_names))
+    {
+        QMessageBox message_box(QMessageBox::Information,
+                               m_player_widget.windowTitle(),
+                               QString("None of the files has a video track to play"),
+                               QMessageBox::Ok,
+                               &m_player_widget);
+        message_box.exec();
+        return;
+    }
+
+    m_mosaic_widget.setTileCount(m_mosaic_playback.getTileCount());
+    m_mosaic_widget.show();
+    m_mosaic_widget.activateWindow();
+    m_mosaic_playback.play();
+}
+
+void Controller::onMosaicUpdated()
+{
+    for(int i = 0; i < m_mosaic_playback.getTileCount(); ++i)
+        m_mosaic_widget.setTile(i, m_mosaic_playback.getTileImage(i), m_mosaic_playback.getTileName(i),
+                                i == m_mosaic_playback.getPrimaryTile(), m_mosaic_playback.isTileDegraded(i));
+    m_mosaic_widget.setTime(m_mosaic_playback.getTime(), m_mosaic_playback.getDuration());
+}
+
+void Controller::onMosaicPlayPause()
+{
+    if(m_mosaic_playback.isPlaying())
+        m_mosaic_playback.pause();
+    else
+        m_mosaic_playback.play();
+}
+
+void Controller::onMosaicSeek(int time_ms)
+{
+    StallScope scope("Controller::onMosaicSeek");
+    m_mosaic_playback.seek(time_ms);
+    onMosaicUpdated();
+}
+
+void Controller::onMosaicTileSelected(int index)
+{
+    m_mosaic_playback.setPrimaryTile(index);
+    onMosaicUpdated();
+}
+
+void Controller::onMosaicTileSizeChanged(const QSize& size)
+{
+    m_mosaic_playback.setTileSize(size);
+}
+
+void Controller::onMosaicClosed()
+{
+    m_mosaic_playback.clear();
+    m_mosaic_widget.setTileCount(0);
+}
+
+void Controller::onMarkClipStart()
+{
+    if(m_playing_fragment_index < 0)
+        return;
+
+    //a clip is exported from one file
+    if(m_clip_fragment_index != m_playing_fragment_index)
+        m_clip_end_ms = -1;
+    m_clip_fragment_index = m_playing_fragment_index;
+    m_clip_start_ms = m_engine.getPlayingTime();
+    m_player_widget.setClipMarks(m_clip_start_ms, m_clip_end_ms);
+}
+
+void Controller::onMarkClipEnd()
+{
+    if(m_playing_fragment_index < 0)
+        return;
+
+    if(m_clip_fragment_index != m_playing_fragment_index)
+        m_clip_start_ms = -1;
+    m_clip_fragment_index = m_playing_fragment_index;
+    m_clip_end_ms = m_engine.getPlayingTime();
+    m_player_widget.setClipMarks(m_clip_start_ms, m_clip_end_ms);
+}
+
+void Controller::exportClip(const QString& file_name)
+{
+    if(m_clip_progress != nullptr ||
+       m_clip_fragment_index < 0 ||
+       m_clip_fragment_index >= m_segments.size() ||
+       m_clip_start_ms < 0 ||
+       m_clip_end_ms <= m_clip_start_ms)
+        return;
+
+    QString source_name = m_segments[m_clip_fragment_index].getFileName();
+    if(QFileInfo(file_name).absoluteFilePath() == QFileInfo(source_name).absoluteFilePath() ||
+       !m_clip_exporter.start(source_name, file_name, m_clip_start_ms, m_clip_end_ms, m_media_parser.getSampleIndex(source_name)))
+    {
+        QMessageBox message_box(QMessageBox::Warning,
+                               m_player_widget.windowTitle(),
+                               QString("The clip could not be exported to ") + file_name,
+                               QMessageBox::Ok,
+                               &m_player_widget);
+        message_box.exec();
+        return;
+    }
+
+    m_clip_file_name = file_name;
+    m_clip_progress = new QProgressDialog("Exporting " + QFileInfo(file_name).fileName(), "Cancel", 0, 100, &m_player_widget);
+    m_clip_progress->setWindowTitle(m_player_widget.windowTitle());
+    m_clip_progress->setAutoClose(false);
+    m_clip_progress->setAutoReset(false);
+    m_clip_progress->setMinimumDuration(0);
+    QObject::connect(m_clip_progress, SIGNAL(canceled()), this, SLOT(onClipExportCanceled()));
+    m_clip_progress->show();
+}
+
+void Controller::onClipExportProgress(int percent)
+{
+    if(m_clip_progress != nullptr)
+        m_clip_progress->setValue(percent);
+}
+
+void Controller::onClipExported(bool success)
+{
+    //the export was canceled already
+    if(m_clip_progress == nullptr)
+        return;
+
+    closeClipProgress();
+    m_clip_exporter.cancel();
+
+    QString text = success ? QString("The clip was exported to ") + m_clip_file_name :
+                             QString("The clip could not be exported to ") + m_clip_file_name;
+    if(success && m_clip_exporter.getSkippedTracks() > 0)
+        text += QString("\n%1 tracks could not be stored in MP4 and were left out.").arg(m_clip_exporter.getSkippedTracks());
+    QMessageBox message_box(success ? QMessageBox::Information : QMessageBox::Warning,
+                           m_player_widget.windowTitle(),
+                           text,
+                           QMessageBox::Ok,
+                           &m_player_widget);
+    message_box.exec();
+}
+
+void Controller::onClipExportCanceled()
+{
+    closeClipProgress();
+    m_clip_exporter.cancel();
+}
+
 void Controller::exit()
 {
+    closeClipProgress();
+    m_clip_exporter.cancel();
+    DecodePool::instance().cancel(this);
+    m_thumbnail_extractor.cancel();
+    m_mosaic_playback.clear();
+    m_mosaic_widget.hide();
     m_engine.stop();
     m_engine.clear();
     qApp->quit();
@@ -204,12 +644,30 @@ void Controller::onStop()
 
 void Controller::onPlayed(BasePlayback* playback)
 {
+    //engine continues with the following segments on its own
+    QString playing_file = m_engine.getPlayingSegment().getFileName();
+    if(m_playing_fragment_index >= 0 &&
+       m_playing_fragment_index < m_segments.size() &&
+       m_segments[m_playing_fragment_index].getFileName() != playing_file)
+    {
+        for(int index = m_playing_fragment_index + 1; index < m_segments.size(); ++index)
+        {
+            if(m_segments[index].getFileName() == playing_file)
+            {
+                m_playing_fragment_index = index;
+                m_controls_widget.startFragment(index);
+                break;
+            }
+        }
+    }
+
     m_controls_widget.setPlayedTime(playback);
     m_controls_widget.updateUI();
 }
 
 void Controller::onSeek(int time_ms)
 {
+    StallScope scope("Controller::onSeek");
     m_engine.seek(time_ms);
     m_controls_widget.setPlayedTime(&m_engine);
     m_controls_widget.updateUI();
@@ -217,6 +675,14 @@ void Controller::onSeek(int time_ms)
 
 void Controller::onSeek(int fragment_index, int time_ms)
 {
+    //the engine seeks within the opened segment on its own
+    if(fragment_index == m_playing_fragment_index)
+    {
+        onSeek(time_ms);
+        return;
+    }
+
+    StallScope scope("Controller::onSeek");
     PlayerState old_engine_state = m_engine.getState();
     m_controls_widget.stopPlayback();
     m_engine.stop();
@@ -224,6 +690,7 @@ void Controller::onSeek(int fragment_index, int time_ms)
     SegmentInfo fragment_info = m_segments[fragment_index];
     if(!m_engine.init(fragment_info.getFileName(), fragment_info))
     {
+        m_playing_fragment_index = -1;
         m_controls_widget.updateUI();
         //TODO - common function for this message
         QMessageBox message_box(QMessageBox::Information,
@@ -235,6 +702,7 @@ void Controller::onSeek(int fragment_index, int time_ms)
         return;
     }
     m_playing_fragment_index = fragment_index;
+    m_engine.setFollowingSegments(m_segments.mid(fragment_index + 1));
     m_player_widget.setStreamsInfo(m_engine.m_video_decoder.getStreamsCount(), m_engine.m_audio_decoder.getStreamsCount());
     m_controls_widget.startFragment(fragment_index);
     m_engine.seek(time_ms);
@@ -274,7 +742,11 @@ void Controller::onEventSelected()
     auto items = m_player_widget.getEventWidget()->selectedItems();
     if (items.count()) {
         auto ev = dynamic_cast<EventItem*>(items[0]);
-        if (ev) m_engine.seek(ev->m_time);
+        if (!ev) return;
+        //events found in other segments are located by their time
+        SegmentTimeline::Position position = m_timeline.locate(ev->m_utc_time);
+        if (position.isValid()) onSeek(position.m_index, (int)position.m_offset);
+        else onSeek(ev->m_time);
     }
 }
 
@@ -293,18 +765,19 @@ void Controller::onNextFragment()
 		m_controls_widget.setTimeLabels();
 		return;
 	}
-	else {
-        assert(false);
-    }
+	else
+		onSeek(m_playing_fragment_index + 1, 0);
 }
 
 void Controller::onPrevFragment()
 {
-    assert(false);
+    if(m_playing_fragment_index > 0)
+        onSeek(m_playing_fragment_index - 1, 0);
 }
 
 void Controller::toFullScreenMode()
 {
+    StallScope scope("Controller::toFullScreenMode");
     m_player_widget.hide();
     m_player_widget.removeControls();
     m_engine.setVideoWidget(m_fullscreen_player_widget.getVideoWidget(), m_player_widget.getEventWidget());
@@ -316,6 +789,7 @@ void Controller::toFullScreenMode()
 
 void Controller::fromFullScreenMode()
 {
+    StallScope scope("Controller::fromFullScreenMode");
     m_fullscreen_player_widget.hide();
     m_fullscreen_player_widget.removeControls();
     m_engine.setVideoWidget(m_player_widget.getVideoWidget(), m_player_widget.getEventWidget());
@@ -345,6 +819,91 @@ void Controller::onshowLocalTimeChanged(bool on)
 	m_controls_widget.setTimeLabels();
 }
 
+void Controller::onShowStatisticsChanged(bool on)
+{
+    if(on)
+    {
+        updateStatistics();
+        m_statistics_timer.start();
+    }
+    else
+    {
+        m_statistics_timer.stop();
+        m_player_widget.getVideoWidget()->setStatisticsText(QString());
+        m_fullscreen_player_widget.getVideoWidget()->setStatisticsText(QString());
+    }
+}
+
+void Controller::updateStatistics()
+{
+    QString text = formatStatistics(getStatistics());
+    m_player_widget.getVideoWidget()->setStatisticsText(text);
+    m_fullscreen_player_widget.getVideoWidget()->setStatisticsText(text);
+}
+
+void Controller::saveStatistics(const QString& file_name)
+{
+    QSaveFile file(file_name);
+    if(!file.open(QIODevice::WriteOnly) ||
+       file.write(QJsonDocument(getStatistics()).toJson()) < 0 ||
+       !file.commit())
+    {
+        QMessageBox message_box(QMessageBox::Warning,
+                               m_player_widget.windowTitle(),
+                               QString("Statistics could not be saved to ") + file_name,
+                               QMessageBox::Ok,
+                               &m_player_widget);
+        message_box.exec();
+    }
+}
+
+QJsonObject Controller::getStatistics() const
+{
+    QJsonObject statistics = m_engine.getStatistics();
+    statistics["gui_stalls"] = StallWatchdog::instance().toJson();
+    statistics["read_ahead"] = ReadAhead::totalsToJson();
+    return statistics;
+}
+
+void Controller::clearClipMarks()
+{
+    m_clip_fragment_index = -1;
+    m_clip_start_ms = -1;
+    m_clip_end_ms = -1;
+    m_player_widget.setClipMarks(m_clip_start_ms, m_clip_end_ms);
+}
+
+void Controller::closeClipProgress()
+{
+    if(m_clip_progress == nullptr)
+        return;
+
+    m_clip_progress->disconnect(this);
+    m_clip_progress->deleteLater();
+    m_clip_progress = nullptr;
+}
+
+void Controller::onRecordTraceChanged(bool on)
+{
+    TraceRecorder::instance().setEnabled(on);
+}
+
+void Controller::saveTrace(const QString& file_name)
+{
+    QSaveFile file(file_name);
+    if(!file.open(QIODevice::WriteOnly) ||
+       file.write(TraceRecorder::instance().toJson()) < 0 ||
+       !file.commit())
+    {
+        QMessageBox message_box(QMessageBox::Warning,
+                               m_player_widget.windowTitle(),
+                               QString("Trace could not be saved to ") + file_name,
+                               QMessageBox::Ok,
+                               &m_player_widget);
+        message_box.exec();
+    }
+}
+
 void Controller::onPlaybackFinished()
 {
     if(m_segments.size() == 1 ||
@@ -355,7 +914,13 @@ void Controller::onPlaybackFinished()
         m_controls_widget.updateUI();
     }
     else
-        onNextFragment();
+    {
+        //following segment could not be continued with, so it is opened anew
+        onSeek(m_playing_fragment_index + 1, 0);
+        m_engine.resume();
+        m_controls_widget.startPlayback();
+        m_controls_widget.updateUI();
+    }
 }
 
 #ifdef MEMORY_INFO
@@ -377,27 +942,11 @@ void Controller::updateFragmentsList(SegmentList&)
 
 void Controller::changeStreamIndex(int index, bool video)
 {
-    PlayerState old_engine_state = m_engine.getState();
-    int current_position_ms = m_engine.getPlayingTime();
-    m_engine.stop();
+    StallScope scope("Controller::changeStreamIndex");
+    //the engine keeps its state, the playback continues on the new track
     if(video)
-        m_engine.m_video_decoder.setStream(index);
+        m_engine.setVideoStreamIndex(index);
     else
         m_engine.setAudioStreamIndex(index);
-    m_engine.seek(current_position_ms);
-    switch(old_engine_state)
-    {
-    case Stopped:
-        //do nothing
-        break;
-    case Playing:
-        m_engine.resume(); //due to seek in stop state will lead us to pause state
-        m_controls_widget.startPlayback();
-        break;
-    case Paused:
-        m_engine.startAndPause();
-        m_controls_widget.pausePlayback();
-        break;
-    }
     m_controls_widget.updateUI();
 }
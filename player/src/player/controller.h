@@ -31,7 +31,12 @@
 #include "crosscompilation_cxx11.h"
 
 #include <QObject>
+#include <QFileSystemWatcher>
+#include <QProgressDialog>
+#include <QTimer>
 
+#include "clipExporter.h"
+#include "thumbnailExtractor.h"
 #include "engine.h"
 #include "playerWidget.h"
 #include "fullscreenPlayerWidget.h"
@@ -39,6 +44,9 @@
 #include "verifyerdialog.h"
 #include "videoFrameWidget.h"
 #include "mediaParser.h"
+#include "mosaicPlayback.h"
+#include "mosaicWidget.h"
+#include "segmentTimeline.h"
 
 //! Main class that controls all work.
 class Controller : public QObject
@@ -57,12 +65,69 @@ private slots:
     //! This slot will be called when new file is selected to be opened.
     void openFile(const QString& file_name);
 
+    //! This slot will be called when a folder with a fileset is selected to be opened.
+    void openDir(const QString& dir_name);
+
+    //! This slot will be called when a file still being written is selected to be followed.
+    void followFile(const QString& file_name);
+
+    //! This slot will be called when the followed file was changed.
+    void onFollowedFileChanged(const QString& file_name);
+
+    //! Parse the data appended to the followed file and extend the timeline.
+    void updateFollowedFile();
+
+    //! This slot will be called when files are selected to be played side by side.
+    void openMosaic(const QStringList& file_names);
+
+    //! Mosaic tiles present new frames.
+    void onMosaicUpdated();
+
+    //! Space pressed in the mosaic - pause or play it.
+    void onMosaicPlayPause();
+
+    //! Mosaic slider released - seek to some position.
+    void onMosaicSeek(int time_ms);
+
+    //! Mosaic tile clicked - make it the primary tile.
+    void onMosaicTileSelected(int index);
+
+    //! Mosaic grid resized - decode the frames at the tile size.
+    void onMosaicTileSizeChanged(const QSize& size);
+
+    //! Mosaic window closed.
+    void onMosaicClosed();
+
+    //! Mark the playing time as the start of the clip to export.
+    void onMarkClipStart();
+
+    //! Mark the playing time as the end of the clip to export.
+    void onMarkClipEnd();
+
+    //! Export the marked clip to a file.
+    void exportClip(const QString& file_name);
+
+    //! Clip export progressed.
+    void onClipExportProgress(int percent);
+
+    //! Clip export ended.
+    void onClipExported(bool success);
+
+    //! Cancel button of the clip export pressed.
+    void onClipExportCanceled();
+
+    //! Thumbnail of a file was made.
+    void onThumbnail(const QString& file_name, int time_ms, const QImage& image);
+
     //! This slot will be called when file structure needs to be shown.
     void showFileStructure();
 
     //! This slot will be called when file signature needs to be verified.
     void verifyFileSignature();
 
+    //! This slot will be called when the consistency and conformance checks of the fileset are finished.
+    void onFilesetChecked();
+
     //! This slot will be called when we want to work with certificates.
     void openCertificateStorage();
 
@@ -120,18 +185,54 @@ private slots:
 	//! Use local or utc time
 	void onshowLocalTimeChanged(bool on);
 
+    //! Show or hide the statistics overlay.
+    void onShowStatisticsChanged(bool on);
+
+    //! Update the statistics overlay.
+    void updateStatistics();
+
+    //! Save the statistics to a file.
+    void saveStatistics(const QString& file_name);
+
+    //! Start or stop recording the trace.
+    void onRecordTraceChanged(bool on);
+
+    //! Save the recorded trace to a file.
+    void saveTrace(const QString& file_name);
+
 #ifdef MEMORY_INFO
     //!Debug. Show memory info.
     void showMemoryInfo();
 #endif //MEMORY_INFO
 
 private:
+    //! Stops playback and clears all information about previously opened file or fileset.
+    void clearContents();
+
+    //! Starts playback of the parsed file or fileset.
+    void openSegments();
+
     //! Update duration of fragments if it is unknown from SUMI box.
     void updateFragmentsList(SegmentList& fragments_list);
 
     //! Change stream index of audio or video.
     void changeStreamIndex(int index, bool video);
 
+    //! Returns the playback statistics together with the GUI thread stalls.
+    QJsonObject getStatistics() const;
+
+    //! Clear the marks of the clip to export.
+    void clearClipMarks();
+
+    //! Close the progress dialog of the clip export.
+    void closeClipProgress();
+
+    //! Compute the activity of the fragments in the background and show it under the timeline.
+    void computeActivity();
+
+    //! Make the keyframe thumbnails of the fragments in the background and show them over the timeline.
+    void makeThumbnails();
+
 private:
     //! Engine.
     Engine&                 m_engine;
@@ -149,8 +250,38 @@ private:
     MediaParser&            m_media_parser;
     //! Fragments info of opened file/file set.
     SegmentList           m_segments;
+    //! Timeline of the fragments, used to locate a time in them.
+    SegmentTimeline         m_timeline;
     //! Currently playing fragment.
     int                     m_playing_fragment_index;
+    //! Watcher of the followed file.
+    QFileSystemWatcher      m_file_watcher;
+    //! Timer delaying the parsing of the followed file after a change, to handle a burst of changes at once.
+    QTimer                  m_follow_update_timer;
+    //! Timer polling the followed file, as not all file systems report the changes.
+    QTimer                  m_follow_poll_timer;
+    //! Timer updating the statistics overlay.
+    QTimer                  m_statistics_timer;
+    //! Playback of several tracks or files side by side.
+    MosaicPlayback          m_mosaic_playback;
+    //! Mosaic window.
+    MosaicWidget            m_mosaic_widget;
+    //! Exports clips in the background.
+    ClipExporter            m_clip_exporter;
+    //! Fragment the clip marks are in, -1 if no mark is set.
+    int                     m_clip_fragment_index;
+    //! Start of the clip to export in ms, -1 if not marked.
+    int                     m_clip_start_ms;
+    //! End of the clip to export in ms, -1 if not marked.
+    int                     m_clip_end_ms;
+    //! Name of the clip being exported.
+    QString                 m_clip_file_name;
+    //! Progress of the clip export, nullptr if no clip is being exported.
+    QProgressDialog*        m_clip_progress;
+    //! Increased when the contents are cleared, so the activity of closed files is dropped.
+    uint32_t                m_activity_generation;
+    //! Makes the thumbnails of the timeline in the background.
+    ThumbnailExtractor      m_thumbnail_extractor;
 };
 
 #endif // CONTROLLER_H
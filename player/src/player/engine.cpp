@@ -32,8 +32,14 @@
 
 #include "queuedVideoDecoder.h"
 #include "queuedAudioDecoder.h"
+#include "pipelineStatistics.h"
+#include "traceRecorder.h"
+#include "stallWatchdog.h"
 
 #include <QDebug>
+#include <QDir>
+#include <QSettings>
+#include <QTimerEvent>
 
 Engine::Engine() :
     BasePlayback(),
@@ -41,13 +47,25 @@ Engine::Engine() :
     m_video_widget(nullptr),
     m_is_initialized(false),
     m_player_state(Stopped),
-    m_playing_time(0)
+    m_chain_index(0),
+    m_playing_time(0),
+    m_preroll_timer(-1)
 {
-    QObject::connect(&m_video_playback, SIGNAL(played(BasePlayback*)), this, SIGNAL(played(BasePlayback*)));
+    QObject::connect(&m_video_playback, SIGNAL(played(BasePlayback*)), this, SLOT(onPlayed()));
     QObject::connect(&m_video_playback, SIGNAL(playbackFinished()), this, SLOT(onFinished()));
     //direct connection used to prevent receiving messages from previously opened file
     QObject::connect(&m_audio_playback, SIGNAL(played(BasePlayback*)), &m_video_playback, SLOT(syncWithAudio(BasePlayback*)), Qt::DirectConnection);
     QObject::connect(&m_audio_playback, SIGNAL(playbackFinished()), this, SLOT(onFinished()));
+
+#ifdef _WIN32
+    QSettings settings(QDir::homePath() + WINP_APP_DATA_ROAMING + COMPANY_NAME + "/" + PRODUCT_NAME + "/" + CONFIG_FILE_NAME, QSettings::IniFormat);
+#else
+    QSettings settings(QDir::homePath() + "/." + PRODUCT_NAME + "/" + CONFIG_FILE_NAME, QSettings::IniFormat);
+#endif //UNIX
+    //decoding another track in advance costs decoding time and memory of TRACK_PREDECODE_FRAMES frames
+    bool predecoding = settings.value("predecodeInactiveTrack", true).toBool();
+    m_video_decoder.setTrackPredecoding(predecoding);
+    m_audio_decoder.setTrackPredecoding(predecoding);
 }
 
 Engine::~Engine()
@@ -67,8 +85,19 @@ void Engine::setVideoWidget(VideoFrameWidget* video_widget, QTreeWidget* event_w
 
 bool Engine::init(const QString& file_name, SegmentInfo& fragment)
 {
+    StallScope scope("Engine::init");
+    //keep own copy, as the list the fragment belongs to may change while playing
+    m_segment = fragment;
+    ChainedSegment chained = { fragment, 0 };
+    m_chain.clear();
+    m_chain.append(chained);
+    m_following_segments.clear();
+    m_chain_index = 0;
+
+    PipelineStatistics::instance().reset();
+
 	bool res = true;
-	res = res && initDecoders(file_name, &fragment);
+	res = res && initDecoders(file_name, &m_segment);
     res = res && initPlayback();
     res = res && m_video_decoder.getStreamsCount();
 
@@ -79,6 +108,7 @@ bool Engine::init(const QString& file_name, SegmentInfo& fragment)
 
 void Engine::start()
 {
+    StallScope scope("Engine::start");
     if(!m_is_initialized ||
        m_player_state != Stopped)
         return;
@@ -92,14 +122,14 @@ void Engine::start()
     m_video_decoder.start();
     m_audio_decoder.start();
     m_metadata_decoder.start();
-    m_video_decoder.wait();
-    if (audio) m_audio_decoder.wait();
-    m_metadata_decoder.wait();
 
-    m_video_playback.start();
-    if (audio) m_audio_playback.start();
+    //the first frame is shown as soon as it is decoded, the playback runs when the pre-roll is buffered
+    m_video_decoder.wait(true);
+    m_video_playback.startAndPause();
+    if (audio) m_audio_playback.startAndPause();
 
     m_player_state = Playing;
+    startPreroll();
 }
 
 void Engine::pause()
@@ -108,6 +138,7 @@ void Engine::pause()
        m_player_state != Playing)
         return;
 
+    stopPreroll();
     if(m_audio_decoder.getStreamsCount())
         m_audio_playback.pause();
     m_video_playback.pause();
@@ -121,18 +152,20 @@ void Engine::resume()
        m_player_state != Paused)
         return;
 
-    if(m_audio_decoder.getStreamsCount())
-        m_audio_playback.resume();
-    m_video_playback.resume();
-
+    //queues may hold the shown frame only, e.g. after a seek in pause
     m_player_state = Playing;
+    startPreroll();
 }
 
 void Engine::stop()
 {
+    StallScope scope("Engine::stop");
     if(!m_is_initialized)
         return;
 
+    //stop at the beginning of the playing segment
+    holdPlayingSegment();
+
     //do stop actions
     stopPlayback();
 
@@ -144,6 +177,7 @@ void Engine::stop()
 
 void Engine::startAndPause()
 {
+    StallScope scope("Engine::startAndPause");
     if(!m_is_initialized ||
        m_player_state != Stopped)
         return;
@@ -157,9 +191,9 @@ void Engine::startAndPause()
     m_video_decoder.start();
     m_audio_decoder.start();
     m_metadata_decoder.start();
+    //audio is buffered by the pre-roll on resuming
     m_video_decoder.wait(true);
     m_metadata_decoder.wait(true);
-    if (audio) m_audio_decoder.wait(true);
     m_video_playback.startAndPause();
     if (audio) m_audio_playback.startAndPause();
 
@@ -175,23 +209,36 @@ void Engine::clear()
     m_audio_playback.clear();
     m_player_state = Stopped;
     m_playing_time = 0;
+    m_chain.clear();
+    m_following_segments.clear();
+    m_chain_index = 0;
 }
 
 int Engine::getPlayingTime() const
 {
     if(m_player_state != Stopped)
+    {
+        //playback time runs on over the chained segments
         m_playing_time = m_video_playback.getPlayingTime();
+        int index = getChainIndex();
+        if(index > 0)
+            m_playing_time -= m_chain[index].m_offset;
+    }
     return m_playing_time;
 }
 
 void Engine::seek(int time_ms)
 {
+    StallScope scope("Engine::seek");
     if(!m_is_initialized)
         return;
 
     qDebug() << "Seek to" << time_ms;
 
-    switch(m_player_state)
+    PlayerState state = m_player_state;
+    holdPlayingSegment();
+
+    switch(state)
     {
     case Stopped:
         //seeking in stop state
@@ -213,10 +260,73 @@ void Engine::seek(int time_ms)
     }
 }
 
+void Engine::setVideoStreamIndex(int index)
+{
+    StallScope scope("Engine::setVideoStreamIndex");
+    switchTrack(m_video_decoder, index);
+
+    //show the frame of the track in pause
+    if(m_player_state == Paused)
+    {
+        m_video_decoder.wait(true);
+        m_video_playback.startAndPause();
+    }
+}
+
 void Engine::setAudioStreamIndex(int index)
 {
-    m_audio_decoder.setIndex(index);
-    m_audio_playback.setAudioParams(m_audio_decoder.getParams());
+    StallScope scope("Engine::setAudioStreamIndex");
+    //audio output keeps the parameters of the first track, other tracks are resampled to them
+    switchTrack(m_audio_decoder, index);
+}
+
+void Engine::setFollowMode(bool follow)
+{
+    m_video_decoder.setFollowMode(follow);
+    m_audio_decoder.setFollowMode(follow);
+    m_metadata_decoder.setFollowMode(follow);
+}
+
+QJsonObject Engine::getStatistics() const
+{
+    QJsonObject video_queue;
+    video_queue["frames"] = m_video_decoder.m_queue.size();
+    video_queue["bytes"] = m_video_decoder.buffersSize();
+
+    QJsonObject audio_queue;
+    audio_queue["frames"] = m_audio_decoder.m_queue.size();
+    audio_queue["bytes"] = m_audio_decoder.buffersSize();
+
+    QJsonObject metadata_queue;
+    metadata_queue["frames"] = m_metadata_decoder.m_queue.size();
+    metadata_queue["bytes"] = m_metadata_decoder.buffersSize();
+
+    QJsonObject queues;
+    queues["video"] = video_queue;
+    queues["audio"] = audio_queue;
+    queues["metadata"] = metadata_queue;
+    queues["budget_bytes"] = (double)QueueBudget::instance().getLimit();
+    queues["budget_used_bytes"] = (double)QueueBudget::instance().getUsed();
+
+    QJsonObject statistics = PipelineStatistics::instance().toJson();
+    statistics["segment_index"] = getChainIndex();
+    statistics["queues"] = queues;
+    statistics["playing_time_ms"] = getPlayingTime();
+    return statistics;
+}
+
+void Engine::setFollowingSegments(const SegmentList& segments)
+{
+    m_following_segments = segments;
+    queueNextSegment();
+}
+
+const SegmentInfo& Engine::getPlayingSegment() const
+{
+    int index = getChainIndex();
+    if(index >= 0)
+        return m_chain[index].m_segment;
+    return m_segment;
 }
 
 void Engine::setVolume(int volume)
@@ -275,6 +385,7 @@ bool Engine::initPlayback()
 
 void Engine::stopPlayback()
 {
+    stopPreroll();
     if(m_audio_decoder.getStreamsCount())
         m_audio_playback.stop();
     m_video_playback.stop();
@@ -294,28 +405,212 @@ void Engine::stopPlayback()
 
 void Engine::doSeek(int time_ms)
 {
+    TraceSpan span("seek");
     m_playing_time = time_ms;
 
-    m_video_decoder.seek(time_ms);
+    //decoders play the times of the chained segments in a row
+    if(m_chain_index < m_chain.size())
+        time_ms += m_chain[m_chain_index].m_offset;
+
+    m_video_decoder.seekInFile(time_ms);
     //skip threshold
-    m_audio_decoder.seek(time_ms);
-    m_metadata_decoder.seek(time_ms);
+    m_audio_decoder.seekInFile(time_ms);
+    m_metadata_decoder.seekInFile(time_ms);
 
     //clear video context fps
     m_video_decoder.m_context.flushCurrentFps();
 }
 
+template<typename T>
+void Engine::switchTrack(QueuedDecoder<T>& decoder, int index)
+{
+    if(!m_is_initialized ||
+       index == decoder.getIndex() ||
+       index < 0 ||
+       index >= decoder.getStreamsCount())
+        return;
+
+    bool playing = (m_player_state == Playing);
+    if(playing)
+        pause();
+
+    //decoders work with the times of the chained segments in a row
+    int time_ms = m_video_playback.getPlayingTime();
+    if(m_player_state == Stopped)
+        time_ms = m_playing_time + ((m_chain_index < m_chain.size()) ? m_chain[m_chain_index].m_offset : 0);
+
+    decoder.stop();
+    if(!decoder.switchTrack(index, time_ms))
+        decoder.seekInFile(time_ms);
+    if(m_player_state != Stopped)
+        decoder.start();
+
+    if(playing)
+        resume();
+}
+
+void Engine::queueNextSegment()
+{
+    if(m_chain.isEmpty() ||
+       m_video_decoder.isFollowMode())
+        return;
+
+    //the next segment is chained when the video decoder continued with the last one
+    if(m_video_decoder.getFileIndex() == m_chain.size() - 1 &&
+       !m_following_segments.isEmpty())
+    {
+        const ChainedSegment& last = m_chain.back();
+        ChainedSegment chained = { m_following_segments.takeFirst(), last.m_offset + (int)last.m_segment.getDuration() };
+        //segments of a single file are played by seeking, segments of unknown duration can not be placed on the playing time
+        if(chained.m_segment.getFileName() == last.m_segment.getFileName() ||
+           last.m_segment.getDuration() == 0)
+        {
+            m_following_segments.clear();
+            return;
+        }
+        m_chain.append(chained);
+    }
+
+    //each decoder gets the segment following the one it plays, decoders may reach the end of a file at different times
+    QueuedVideoDecoder* video_decoders[] = { &m_video_decoder, &m_metadata_decoder };
+    for(QueuedVideoDecoder* decoder : video_decoders)
+    {
+        int next = decoder->getFileIndex() + 1;
+        if(decoder->getStreamsCount() && next < m_chain.size())
+            decoder->setNextFile(m_chain[next].m_segment, m_chain[next].m_offset, next);
+    }
+    int next = m_audio_decoder.getFileIndex() + 1;
+    if(m_audio_decoder.getStreamsCount() && next < m_chain.size())
+        m_audio_decoder.setNextFile(m_chain[next].m_segment.getFileName(), m_chain[next].m_offset, next);
+}
+
+int Engine::getChainIndex(int time_ms) const
+{
+    if(m_chain.isEmpty())
+        return -1;
+
+    int index = m_chain.size() - 1;
+    while(index > 0 && time_ms < m_chain[index].m_offset)
+        --index;
+    return index;
+}
+
+bool Engine::isOnChainSegment(int index) const
+{
+    return (!m_video_decoder.getStreamsCount() || m_video_decoder.getFileIndex() == index) &&
+           (!m_audio_decoder.getStreamsCount() || m_audio_decoder.getFileIndex() == index) &&
+           (!m_metadata_decoder.getStreamsCount() || m_metadata_decoder.getFileIndex() == index);
+}
+
+void Engine::holdPlayingSegment()
+{
+    int index = getChainIndex();
+    if(index < 0)
+        return;
+
+    if(isOnChainSegment(index))
+        m_chain_index = index;
+    else
+        restartChain();
+}
+
+void Engine::restartChain()
+{
+    int index = getChainIndex();
+    if(index < 0)
+        return;
+
+    SegmentInfo segment = m_chain[index].m_segment;
+    SegmentList following;
+    for(int i = index + 1; i < m_chain.size(); ++i)
+        following.append(m_chain[i].m_segment);
+    following.append(m_following_segments);
+
+    stopPlayback();
+    clear();
+    if(init(segment.getFileName(), segment))
+        setFollowingSegments(following);
+}
+
 int Engine::showNextFrame()
 {
 	VideoFrame video_frame;
 	m_video_decoder.getNextFrame(video_frame);
 	m_video_widget->setDrawImage(video_frame.m_image);
+	int index = getChainIndex(video_frame.m_time);
+	if(index > 0)
+		video_frame.m_time -= m_chain[index].m_offset;
 	return video_frame.m_time;
 }
 
+void Engine::timerEvent(QTimerEvent* event)
+{
+    if(event->timerId() != m_preroll_timer)
+    {
+        BasePlayback::timerEvent(event);
+        return;
+    }
+
+    if(isPrerolled())
+        finishPreroll();
+}
+
+void Engine::startPreroll()
+{
+    if(isPrerolled())
+    {
+        finishPreroll();
+        return;
+    }
+
+    if(m_preroll_timer == -1)
+        m_preroll_timer = startTimer(PREROLL_CHECK_INTERVAL, Qt::PreciseTimer);
+}
+
+void Engine::stopPreroll()
+{
+    if(m_preroll_timer != -1)
+    {
+        killTimer(m_preroll_timer);
+        m_preroll_timer = -1;
+    }
+}
+
+void Engine::finishPreroll()
+{
+    TraceSpan span("finish pre-roll");
+    stopPreroll();
+
+    if(m_audio_decoder.getStreamsCount())
+        m_audio_playback.resume();
+    m_video_playback.resume();
+}
+
+bool Engine::isPrerolled() const
+{
+    return isBuffered(m_video_decoder) &&
+           (!m_audio_decoder.getStreamsCount() || isBuffered(m_audio_decoder));
+}
+
+template<typename T>
+bool Engine::isBuffered(const QueuedDecoder<T>& decoder)
+{
+    //a full queue or the end of the file do not get more frames
+    return decoder.m_queue.timeSpan() >= START_PREROLL_DURATION ||
+           !decoder.needsFrames() ||
+           !decoder.isRunning();
+}
+
 void Engine::onFinished()
 {
     pause();
 
     emit playbackFinished();
 }
+
+void Engine::onPlayed()
+{
+    queueNextSegment();
+
+    emit played(this);
+}
@@ -29,8 +29,11 @@
 #define ENGINE_H
 
 #include "basePlayback.h"
+#include <QJsonObject>
 #include <QTimer>
 
+#include <algorithm>
+
 #include "enums.h"
 #include "types.h"
 #include "streamReader.h"
@@ -90,6 +93,9 @@ public:
 	//! Get player state.
     PlayerState getState() const { return m_player_state; }
 
+    //! Checks if the playback waits for the pre-roll to be buffered.
+    bool isPrerolling() const { return m_preroll_timer != -1; }
+
     //! Video decoder.
     QueuedVideoDecoder m_video_decoder;
     //! Audio decoder.
@@ -97,9 +103,29 @@ public:
     //! Metadata decoder.
     MetadataDecoder m_metadata_decoder;
 
-    //! Set new stream index for audio.
+    //! Switch to another video track at the playing time, without restarting the playback.
+    void setVideoStreamIndex(int index);
+
+    //! Switch to another audio track at the playing time, without restarting the playback.
     void setAudioStreamIndex(int index);
 
+    //! Set follow mode for files still being written. Takes effect on the next init.
+    void setFollowMode(bool follow);
+
+    //! Get the pipeline timing statistics together with the current queue depths, as JSON.
+    QJsonObject getStatistics() const;
+
+    //! Set segments to continue with at the end of the initialized one, without a gap.
+    /*!
+     * The decoders open the following segment in advance and continue with it at the end of the playing one,
+     * the playing time stays relative to the segment being played.
+     * \param segments segments following the initialized one, in the playing order
+     */
+    void setFollowingSegments(const SegmentList& segments);
+
+    //! Get segment being played, it differs from the initialized one after continuing with the following segments.
+    const SegmentInfo& getPlayingSegment() const;
+
 public slots:
     //! Set volume. Volume should be between 0 and 100.
     void setVolume(int volume);
@@ -123,10 +149,55 @@ private:
     //! Seek to some position.
     void doSeek(int time_ms);
 
+    //! Set the next chained segment to the decoders which continued with the last one.
+    void queueNextSegment();
+
+    //! Get index of the chained segment a playback time belongs to.
+    int getChainIndex(int time_ms) const;
+
+    //! Get index of the chained segment being played, playback never goes back to an earlier segment on its own.
+    int getChainIndex() const { return std::max(m_chain_index, getChainIndex(m_video_playback.getPlayingTime())); }
+
+    //! Checks if all decoders play the chained segment.
+    bool isOnChainSegment(int index) const;
+
+    //! Keep the decoders on the playing segment for seeking, reinit on it if any decoder continued with another one.
+    void holdPlayingSegment();
+
+    //! Reinit on the playing segment.
+    void restartChain();
+
+    //! Switch a decoder to another track at the playing time.
+    template<typename T>
+    void switchTrack(QueuedDecoder<T>& decoder, int index);
+
+    //! Run the playback once the queues hold START_PREROLL_DURATION, checked every PREROLL_CHECK_INTERVAL.
+    void startPreroll();
+
+    //! Stop waiting for the pre-roll.
+    void stopPreroll();
+
+    //! Run the paused video and audio playback.
+    void finishPreroll();
+
+    //! Checks if the video and audio queues are buffered for the playback.
+    bool isPrerolled() const;
+
+    //! Checks if a queue holds the pre-roll, or gets no more frames.
+    template<typename T>
+    static bool isBuffered(const QueuedDecoder<T>& decoder);
+
+protected:
+    //! Checks the pre-roll.
+    virtual void timerEvent(QTimerEvent* event);
+
 	private slots:
     //! This slot will be called when video or audio playback finished.
     void onFinished();
 
+    //! This slot will be called time by time while video is played.
+    void onPlayed();
+
 private:
     //! Widget to present video.
     VideoFrameWidget*   m_video_widget;
@@ -144,8 +215,28 @@ private:
     //! Player state.
     PlayerState     m_player_state;
 
+    //! Playing segment, decoders point to it.
+    SegmentInfo     m_segment;
+
+    //! Segment played in a row with the initialized one.
+    struct ChainedSegment
+    {
+        //! Segment.
+        SegmentInfo m_segment;
+        //! Playing time the segment starts at, in ms from the start of the initialized one.
+        int         m_offset;
+    };
+    //! Initialized segment and the following ones passed to the decoders.
+    QList<ChainedSegment> m_chain;
+    //! Following segments not passed to the decoders yet.
+    SegmentList     m_following_segments;
+    //! Index of the chained segment the engine was positioned in by the last seek.
+    int             m_chain_index;
+
     //! Playing time.
     mutable int     m_playing_time;
+    //! Timer checking the pre-roll, -1 if the playback is not waiting for it.
+    int             m_preroll_timer;
 };
 
 #endif //ENGINE_H
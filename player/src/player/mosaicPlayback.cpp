@@ -0,0 +1,400 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "mosaicPlayback.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QTimerEvent>
+#include <QtDebug>
+
+#include "defines.h"
+
+MosaicPlayback::MosaicPlayback() :
+    QObject(),
+    m_playing(false),
+    m_clock_base(0),
+    m_duration(0),
+    m_timer(-1),
+    m_calm_checks(0)
+{
+}
+
+MosaicPlayback::~MosaicPlayback()
+{
+    clear();
+}
+
+bool MosaicPlayback::open(const QStringList& file_names)
+{
+    clear();
+
+    for(auto it = file_names.begin(), end = file_names.end(); it != end && (int)m_tiles.size() < MOSAIC_MAX_TILES; ++it)
+    {
+        //further tracks of the file get their own readers
+        Tile* tile = openTile(*it, 0);
+        for(int track = 1; tile != nullptr && track < tile->m_decoder.getStreamsCount() && (int)m_tiles.size() < MOSAIC_MAX_TILES; ++track)
+            openTile(*it, track);
+    }
+    if(m_tiles.empty())
+        return false;
+
+    alignTiles();
+    for(int i = 0; i < (int)m_tiles.size(); ++i)
+        m_ranks.append(i);
+
+    startDecoding();
+    m_timer = startTimer(MOSAIC_TICK_INTERVAL, Qt::PreciseTimer);
+    return true;
+}
+
+void MosaicPlayback::clear()
+{
+    if(m_timer != -1)
+    {
+        killTimer(m_timer);
+        m_timer = -1;
+    }
+    stopDecoding();
+    m_tiles.clear();
+    m_ranks.clear();
+    m_playing = false;
+    m_clock_base = 0;
+    m_duration = 0;
+    m_calm_checks = 0;
+}
+
+void MosaicPlayback::play()
+{
+    if(m_tiles.empty() ||
+       m_playing)
+        return;
+
+    if(m_clock_base >= m_duration)
+        seek(0);
+
+    m_clock.start();
+    m_load_check.start();
+    m_calm_checks = 0;
+    for(auto it = m_tiles.begin(), end = m_tiles.end(); it != end; ++it)
+        (*it)->m_late = false;
+    m_playing = true;
+}
+
+void MosaicPlayback::pause()
+{
+    if(!m_playing)
+        return;
+
+    m_clock_base = getTime();
+    m_playing = false;
+}
+
+void MosaicPlayback::seek(int time_ms)
+{
+    if(m_tiles.empty())
+        return;
+
+    stopDecoding();
+    m_clock_base = qBound(0, time_ms, m_duration);
+    if(m_playing)
+        m_clock.start();
+    for(auto it = m_tiles.begin(), end = m_tiles.end(); it != end; ++it)
+        (*it)->m_frame.clear();
+    startDecoding();
+}
+
+int MosaicPlayback::getTime() const
+{
+    if(!m_playing)
+        return m_clock_base;
+    return m_clock_base + (int)m_clock.elapsed();
+}
+
+const QImage& MosaicPlayback::getTileImage(int index) const
+{
+    static const QImage sc_empty;
+    if(index < 0 || index >= (int)m_tiles.size())
+        return sc_empty;
+    return m_tiles[index]->m_frame.m_image;
+}
+
+QString MosaicPlayback::getTileName(int index) const
+{
+    if(index < 0 || index >= (int)m_tiles.size())
+        return QString();
+
+    const Tile& tile = *m_tiles[index];
+    QString name = QFileInfo(tile.m_file_name).fileName();
+    if(tile.m_track > 0)
+        name += " [" + QString::number(tile.m_track) + "]";
+    return name;
+}
+
+bool MosaicPlayback::isTileDegraded(int index) const
+{
+    if(index < 0 || index >= (int)m_tiles.size())
+        return false;
+    return m_tiles[index]->m_degraded;
+}
+
+int MosaicPlayback::getPrimaryTile() const
+{
+    return m_ranks.isEmpty() ? -1 : m_ranks.front();
+}
+
+void MosaicPlayback::setPrimaryTile(int index)
+{
+    if(index < 0 || index >= (int)m_tiles.size())
+        return;
+
+    m_ranks.removeAll(index);
+    m_ranks.prepend(index);
+
+    restoreTile(*m_tiles[index]);
+    updatePriorities();
+}
+
+void MosaicPlayback::setTileSize(const QSize& size)
+{
+    m_tile_size = size;
+    for(auto it = m_tiles.begin(), end = m_tiles.end(); it != end; ++it)
+        (*it)->m_decoder.setOutputSize(size.width(), size.height());
+}
+
+void MosaicPlayback::timerEvent(QTimerEvent* event)
+{
+    if(event->timerId() != m_timer)
+    {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    present();
+    if(m_playing &&
+       m_load_check.elapsed() >= MOSAIC_LOAD_INTERVAL)
+    {
+        balanceLoad();
+        m_load_check.start();
+    }
+}
+
+MosaicPlayback::Tile* MosaicPlayback::openTile(const QString& file_name, int track)
+{
+    std::unique_ptr<Tile> tile(new Tile());
+    if(!tile->m_decoder.open(file_name) ||
+       track >= tile->m_decoder.getStreamsCount())
+    {
+        qDebug() << "Mosaic can not open track" << track << "of" << file_name;
+        return nullptr;
+    }
+
+    tile->m_file_name = file_name;
+    tile->m_track = track;
+    tile->m_decoder.setStream(track);
+    //tiles decode a single track in short steps, so they take turns on the pool
+    tile->m_decoder.setTrackCaching(false);
+    tile->m_decoder.setTrackPredecoding(false);
+    tile->m_decoder.setStepPackets(MOSAIC_STEP_PACKETS);
+    tile->m_decoder.setOutputSize(m_tile_size.width(), m_tile_size.height());
+
+    m_tiles.push_back(std::move(tile));
+    return m_tiles.back().get();
+}
+
+void MosaicPlayback::alignTiles()
+{
+    QList<QDateTime> creation_times;
+    for(auto it = m_tiles.begin(), end = m_tiles.end(); it != end; ++it)
+    {
+        AVFormatContext* context = (*it)->m_decoder.getFormatContext();
+        AVDictionaryEntry* entry = av_dict_get(context->metadata, "creation_time", nullptr, 0);
+        QDateTime creation_time;
+        if(entry != nullptr)
+            creation_time = QDateTime::fromString(QString::fromLatin1(entry->value), Qt::ISODateWithMs);
+        creation_times.append(creation_time);
+    }
+
+    //tiles start together, unless every file tells its creation time
+    QDateTime first;
+    for(auto it = creation_times.begin(), end = creation_times.end(); it != end; ++it)
+    {
+        if(!it->isValid())
+        {
+            first = QDateTime();
+            break;
+        }
+        if(!first.isValid() || *it < first)
+            first = *it;
+    }
+
+    m_duration = 0;
+    for(int i = 0; i < (int)m_tiles.size(); ++i)
+    {
+        Tile& tile = *m_tiles[i];
+        tile.m_offset = first.isValid() ? (int)first.msecsTo(creation_times[i]) : 0;
+
+        AVFormatContext* context = tile.m_decoder.getFormatContext();
+        int duration = (context->duration != AV_NOPTS_VALUE) ? (int)(context->duration * 1000 / AV_TIME_BASE) : 0;
+        m_duration = qMax(m_duration, tile.m_offset + duration);
+    }
+}
+
+void MosaicPlayback::startDecoding()
+{
+    int time = getTime();
+    for(auto it = m_tiles.begin(), end = m_tiles.end(); it != end; ++it)
+    {
+        Tile& tile = **it;
+        tile.m_decoder.seekInFile(qMax(0, time - tile.m_offset));
+        tile.m_decoder.start();
+    }
+    updatePriorities();
+}
+
+void MosaicPlayback::stopDecoding()
+{
+    for(auto it = m_tiles.begin(), end = m_tiles.end(); it != end; ++it)
+    {
+        (*it)->m_decoder.stop();
+        (*it)->m_decoder.clearBuffers();
+    }
+}
+
+void MosaicPlayback::present()
+{
+    int time = getTime();
+    bool presented = false, ended = true;
+    for(auto it = m_tiles.begin(), end = m_tiles.end(); it != end; ++it)
+    {
+        Tile& tile = **it;
+        int tile_time = time - tile.m_offset;
+        if(tile_time < 0)
+        {
+            //the recording of the tile did not start yet
+            if(tile.m_frame)
+            {
+                tile.m_frame.clear();
+                presented = true;
+            }
+            ended = false;
+            continue;
+        }
+
+        //an empty tile shows the first frame at once, e.g. after a seek in pause
+        Queue<VideoFrame>& queue = tile.m_decoder.m_queue;
+        while(!queue.empty() &&
+              (queue.headTime() <= tile_time || !tile.m_frame))
+        {
+            tile.m_frame = queue.pop();
+            presented = true;
+        }
+
+        bool tile_ended = queue.empty() && tile.m_decoder.isFinished();
+        if(m_playing &&
+           !tile_ended &&
+           !tile.m_degraded &&
+           tile.m_frame.m_time < tile_time - MOSAIC_LATE_THRESHOLD)
+            tile.m_late = true;
+        ended = ended && tile_ended;
+    }
+
+    if(presented)
+        emit updated();
+
+    if(m_playing && ended)
+    {
+        pause();
+        emit finished();
+    }
+}
+
+void MosaicPlayback::balanceLoad()
+{
+    bool late = false;
+    for(auto it = m_tiles.begin(), end = m_tiles.end(); it != end; ++it)
+    {
+        late = late || (*it)->m_late;
+        (*it)->m_late = false;
+    }
+
+    if(late)
+    {
+        //the primary tile keeps decoding all frames
+        m_calm_checks = 0;
+        for(int rank = m_ranks.size() - 1; rank > 0; --rank)
+        {
+            Tile& tile = *m_tiles[m_ranks[rank]];
+            if(!tile.m_degraded)
+            {
+                qDebug() << "Mosaic tile" << m_ranks[rank] << "decodes keyframes only";
+                tile.m_decoder.setKeyframesOnly(true);
+                tile.m_degraded = true;
+                break;
+            }
+        }
+        updatePriorities();
+    }
+    else if(++m_calm_checks >= MOSAIC_RECOVER_CHECKS)
+    {
+        m_calm_checks = 0;
+        for(int rank = 1; rank < m_ranks.size(); ++rank)
+        {
+            if(m_tiles[m_ranks[rank]]->m_degraded)
+            {
+                qDebug() << "Mosaic tile" << m_ranks[rank] << "decodes all frames";
+                restoreTile(*m_tiles[m_ranks[rank]]);
+                break;
+            }
+        }
+        updatePriorities();
+    }
+}
+
+void MosaicPlayback::restoreTile(Tile& tile)
+{
+    if(!tile.m_degraded)
+        return;
+
+    //queued keyframes reach far ahead, so the frames from the playing time on are decoded again
+    tile.m_decoder.stop();
+    tile.m_decoder.clearBuffers();
+    tile.m_decoder.setKeyframesOnly(false);
+    tile.m_decoder.seekInFile(qMax(0, getTime() - tile.m_offset));
+    tile.m_degraded = false;
+    tile.m_decoder.start();
+}
+
+void MosaicPlayback::updatePriorities()
+{
+    //degraded tiles are decoded last, so they do not hold back the others
+    for(int rank = 0; rank < m_ranks.size(); ++rank)
+    {
+        Tile& tile = *m_tiles[m_ranks[rank]];
+        tile.m_decoder.setPoolPriority(DecodePool::VideoPriority, tile.m_degraded ? 0 : (int)m_ranks.size() - rank);
+    }
+}
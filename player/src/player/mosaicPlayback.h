@@ -0,0 +1,197 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef MOSAICPLAYBACK_H
+#define MOSAICPLAYBACK_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSize>
+#include <QStringList>
+
+#include <memory>
+#include <vector>
+
+#include "decodePool.h"
+#include "queuedVideoDecoder.h"
+#include "types.h"
+
+//! Synchronized playback of several video tracks or files side by side.
+/*!
+ * \brief Every video track of the opened files is a tile with its own decoder, the decoders run on the DecodePool of the player.
+ * Tiles present the frames due at a master clock, tiles of files with a creation time start at their offset
+ * to the earliest one, so recordings of the same incident run in step.
+ * The tiles are ranked, the first one is the primary tile. When tiles fall behind the clock, the lowest ranked tile
+ * drops to decoding keyframes only, and tiles are restored from the highest ranked one after the load eased.
+ */
+class MosaicPlayback : public QObject
+{
+private:
+    Q_OBJECT
+
+public:
+    MosaicPlayback();
+
+    ~MosaicPlayback();
+
+    //! Opens the video tracks of files as tiles, up to MOSAIC_MAX_TILES.
+    /*!
+     * \return false, if no file has a video track
+     */
+    bool open(const QStringList& file_names);
+
+    //! Stops the playback and closes the tiles.
+    void clear();
+
+    //! Starts or continues the playback.
+    void play();
+
+    //! Pauses the playback.
+    void pause();
+
+    //! Checks if the playback runs.
+    bool isPlaying() const { return m_playing; }
+
+    //! Moves the clock to a time, tiles show the frames at the time.
+    void seek(int time_ms);
+
+    //! Get master clock time in ms.
+    int getTime() const;
+
+    //! Get length of the mosaic timeline in ms.
+    int getDuration() const { return m_duration; }
+
+    //! Get count of the tiles.
+    int getTileCount() const { return (int)m_tiles.size(); }
+
+    //! Get the frame presented by a tile.
+    const QImage& getTileImage(int index) const;
+
+    //! Get the name of a tile.
+    QString getTileName(int index) const;
+
+    //! Checks if a tile decodes keyframes only.
+    bool isTileDegraded(int index) const;
+
+    //! Get the primary tile, it is never degraded.
+    int getPrimaryTile() const;
+
+    //! Makes a tile the primary one, the other tiles keep their order.
+    void setPrimaryTile(int index);
+
+    //! Set size the frames of all tiles are scaled to.
+    void setTileSize(const QSize& size);
+
+signals:
+    //! Emitted when tiles present new frames.
+    void updated();
+
+    //! Emitted when all tiles reached their end.
+    void finished();
+
+protected:
+    //! Presents the due frames and balances the decoding load.
+    virtual void timerEvent(QTimerEvent* event);
+
+private:
+    //! Video track played in a tile.
+    struct Tile
+    {
+        Tile() :
+            m_track(0),
+            m_offset(0),
+            m_late(false),
+            m_degraded(false)
+        {}
+
+        //! Decoder of the track.
+        QueuedVideoDecoder m_decoder;
+        //! File of the track.
+        QString m_file_name;
+        //! Zero based index of the video track.
+        int m_track;
+        //! Start of the track on the mosaic timeline in ms.
+        int m_offset;
+        //! Frame presented.
+        VideoFrame m_frame;
+        //! Set when the tile fell behind the clock since the last load check.
+        bool m_late;
+        //! Set when the tile decodes keyframes only.
+        bool m_degraded;
+    };
+
+private:
+    //! Opens a tile, returns nullptr if the track cannot be decoded.
+    Tile* openTile(const QString& file_name, int track);
+
+    //! Align the tiles by the creation times of their files.
+    void alignTiles();
+
+    //! Start decoding of all tiles at the clock time.
+    void startDecoding();
+
+    //! Stop decoding of all tiles.
+    void stopDecoding();
+
+    //! Present the frames due at the clock time.
+    void present();
+
+    //! Degrade or restore a tile by the lateness of the tiles.
+    void balanceLoad();
+
+    //! Make a degraded tile decode all frames again.
+    void restoreTile(Tile& tile);
+
+    //! Update the pool priorities by the tile ranks.
+    void updatePriorities();
+
+private:
+    //! Tiles in the grid order.
+    std::vector<std::unique_ptr<Tile> > m_tiles;
+    //! Tile indexes from the highest ranked one.
+    QList<int>              m_ranks;
+    //! Is the clock running.
+    bool                    m_playing;
+    //! Clock time when it started running, or the time it stopped at.
+    int                     m_clock_base;
+    //! Measures the time since the clock started running.
+    QElapsedTimer           m_clock;
+    //! Length of the timeline in ms.
+    int                     m_duration;
+    //! Size the frames are scaled to.
+    QSize                   m_tile_size;
+    //! Presentation timer.
+    int                     m_timer;
+    //! Time of the last load check.
+    QElapsedTimer           m_load_check;
+    //! Count of the load checks without late tiles in a row.
+    int                     m_calm_checks;
+};
+
+#endif // MOSAICPLAYBACK_H
@@ -0,0 +1,182 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "pipelineStatistics.h"
+
+#include <QJsonArray>
+
+#include <chrono>
+
+namespace
+{
+    //! Returns the bucket of a duration.
+    int bucketOf(qint64 duration_ns)
+    {
+        quint64 duration_us = (duration_ns > 0) ? quint64(duration_ns) / 1000 : 0;
+        int bucket = 0;
+        while(duration_us > 1 && bucket < StageCounter::sc_bucket_count - 1)
+        {
+            duration_us >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+}
+
+StageCounter::StageCounter()
+    : m_count(0)
+    , m_total_ns(0)
+    , m_max_ns(0)
+{
+    for(auto & bucket : m_buckets)
+        bucket = 0;
+}
+
+void StageCounter::add(qint64 duration_ns)
+{
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_total_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+    m_buckets[bucketOf(duration_ns)].fetch_add(1, std::memory_order_relaxed);
+
+    qint64 max_ns = m_max_ns.load(std::memory_order_relaxed);
+    while(duration_ns > max_ns && !m_max_ns.compare_exchange_weak(max_ns, duration_ns, std::memory_order_relaxed));
+}
+
+void StageCounter::reset()
+{
+    m_count = 0;
+    m_total_ns = 0;
+    m_max_ns = 0;
+    for(auto & bucket : m_buckets)
+        bucket = 0;
+}
+
+quint64 StageCounter::count() const
+{
+    return m_count;
+}
+
+double StageCounter::percentile(double percent) const
+{
+    quint64 total = 0;
+    for(auto & bucket : m_buckets)
+        total += bucket;
+    if(total == 0)
+        return 0;
+
+    quint64 rank = quint64(percent / 100 * total + 0.5);
+    quint64 counted = 0;
+    for(int i = 0; i < sc_bucket_count; ++i)
+    {
+        counted += m_buckets[i];
+        if(counted >= rank)
+            return double(quint64(2) << i);
+    }
+    return double(quint64(2) << (sc_bucket_count - 1));
+}
+
+QJsonObject StageCounter::toJson() const
+{
+    quint64 count_value = m_count;
+
+    QJsonArray histogram;
+    for(auto & bucket : m_buckets)
+        histogram.append(double(bucket));
+
+    QJsonObject result;
+    result["count"] = double(count_value);
+    result["mean_us"] = count_value ? m_total_ns / 1000.0 / count_value : 0.0;
+    result["max_us"] = m_max_ns / 1000.0;
+    result["p50_us"] = percentile(50);
+    result["p99_us"] = percentile(99);
+    result["histogram_us_log2"] = histogram;
+    return result;
+}
+
+PipelineStatistics::PipelineStatistics()
+    : m_dropped_frames(0)
+    , m_late_frames(0)
+    , m_av_drift_ms(0)
+{
+}
+
+PipelineStatistics & PipelineStatistics::instance()
+{
+    static PipelineStatistics statistics;
+    return statistics;
+}
+
+qint64 PipelineStatistics::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void PipelineStatistics::setAvDrift(int drift_ms)
+{
+    m_av_drift_ms = drift_ms;
+    m_stages[AvDrift].add(qint64(qAbs(drift_ms)) * 1000000);
+}
+
+void PipelineStatistics::reset()
+{
+    for(auto & stage : m_stages)
+        stage.reset();
+    m_dropped_frames = 0;
+    m_late_frames = 0;
+    m_av_drift_ms = 0;
+}
+
+QJsonObject PipelineStatistics::toJson() const
+{
+    QJsonObject stages;
+    for(int i = 0; i < StageCount; ++i)
+        stages[getStageName(Stage(i))] = m_stages[i].toJson();
+
+    QJsonObject result;
+    result["stages"] = stages;
+    result["dropped_frames"] = double(m_dropped_frames);
+    result["late_frames"] = double(m_late_frames);
+    result["av_drift_ms"] = int(m_av_drift_ms);
+    return result;
+}
+
+const char * PipelineStatistics::getStageName(Stage stage)
+{
+    static const char * sc_names[StageCount] =
+    {
+        "demux",
+        "video_decode",
+        "audio_decode",
+        "conversion",
+        "video_queue_wait",
+        "audio_queue_wait",
+        "present",
+        "audio_write",
+        "av_drift"
+    };
+    return sc_names[stage];
+}
@@ -0,0 +1,161 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef PIPELINESTATISTICS_H
+#define PIPELINESTATISTICS_H
+
+#include "crosscompilation_cxx11.h"
+#include "crosscompilation_inttypes.h"
+
+#include <QJsonObject>
+
+#include <array>
+#include <atomic>
+
+//! Histogram of durations of a pipeline stage.
+/*!
+ * \brief Durations are counted in buckets of powers of two microseconds, so adding one is a few relaxed atomic
+ * operations and the stage threads never wait for each other or for the reader.
+ */
+class StageCounter CC_CXX11_FINAL
+{
+public:
+    //! Count of the histogram buckets, the last one holds everything above 2^(sc_bucket_count - 1) microseconds.
+    static const int sc_bucket_count = 24;
+
+public:
+    StageCounter();
+
+public:
+    //! Adds a duration.
+    void add(qint64 duration_ns);
+
+    //! Clears the counter.
+    void reset();
+
+    //! Returns the count of durations.
+    quint64 count() const;
+
+    //! Returns the upper bound of the bucket containing the percentile of the durations, in microseconds.
+    double percentile(double percent) const;
+
+    //! Returns the counter as JSON: count, mean, max, p50, p99 and the histogram.
+    QJsonObject toJson() const;
+
+private:
+    //! Count of durations.
+    std::atomic<quint64> m_count;
+    //! Sum of durations in nanoseconds.
+    std::atomic<qint64> m_total_ns;
+    //! Longest duration in nanoseconds.
+    std::atomic<qint64> m_max_ns;
+    //! Counts of durations by bucket.
+    std::array<std::atomic<quint64>, sc_bucket_count> m_buckets;
+};
+
+//! Timing counters of the playback pipeline stages, shared by the decoder, playback and audio threads.
+/*!
+ * \brief Counters are always on, each stage measures itself with now() and adds the duration to its counter.
+ * The queue depths are not kept here, they are read from the decoders when a snapshot is made by Engine::getStatistics.
+ */
+class PipelineStatistics CC_CXX11_FINAL
+{
+public:
+    //! Measured stages.
+    enum Stage
+    {
+        //! Reading a packet from a file.
+        Demux,
+        //! Decoding a video packet.
+        VideoDecode,
+        //! Decoding an audio packet.
+        AudioDecode,
+        //! Converting a decoded video frame to an image.
+        Conversion,
+        //! Time a video frame waits in the queue between decoding and presentation.
+        VideoQueueWait,
+        //! Time an audio frame waits in the queue between decoding and playing.
+        AudioQueueWait,
+        //! Presenting a video frame.
+        Present,
+        //! Writing audio data to the audio device.
+        AudioWrite,
+        //! Distance between the video and the audio playing times.
+        AvDrift,
+        StageCount
+    };
+
+public:
+    //! Returns the statistics of the application.
+    static PipelineStatistics & instance();
+
+    //! Returns the monotonic time in nanoseconds, to measure stage durations.
+    static qint64 now();
+
+public:
+    //! Adds a duration of a stage.
+    void add(Stage stage, qint64 duration_ns) { m_stages[stage].add(duration_ns); }
+
+    //! Adds a duration of a stage started at a time returned by now().
+    void addSince(Stage stage, qint64 start_ns) { m_stages[stage].add(now() - start_ns); }
+
+    //! Counts a video frame skipped to catch up with the audio.
+    void addDroppedFrame() { ++m_dropped_frames; }
+
+    //! Counts a video frame presented later than its frame interval.
+    void addLateFrame() { ++m_late_frames; }
+
+    //! Sets the last distance between the video and audio playing times, positive if the video is ahead.
+    void setAvDrift(int drift_ms);
+
+    //! Returns the counter of a stage.
+    const StageCounter & getStage(Stage stage) const { return m_stages[stage]; }
+
+    //! Clears the statistics, e.g. when a file is opened.
+    void reset();
+
+    //! Returns the statistics as JSON.
+    QJsonObject toJson() const;
+
+    //! Returns the name of a stage used in the JSON.
+    static const char * getStageName(Stage stage);
+
+private:
+    PipelineStatistics();
+
+private:
+    //! Counters of the stages.
+    std::array<StageCounter, StageCount> m_stages;
+    //! Count of the dropped video frames.
+    std::atomic<quint64> m_dropped_frames;
+    //! Count of the late video frames.
+    std::atomic<quint64> m_late_frames;
+    //! Last distance between the video and audio playing times.
+    std::atomic<int> m_av_drift_ms;
+};
+
+#endif // PIPELINESTATISTICS_H
@@ -28,6 +28,8 @@
 #include "portAudioThread.h"
 
 #include "defines.h"
+#include "pipelineStatistics.h"
+#include "traceRecorder.h"
 
 template<typename T>
 void modifyVolumeLevel(QByteArray& data, double factor)
@@ -52,6 +54,8 @@ PortAudioThread::PortAudioThread() :
     m_sent_time(-1),
     m_volume(1.0)
 {
+    setObjectName("PortAudio");
+
     PaError error = Pa_Initialize();
     m_is_initialized = (error == paNoError &&
                         Pa_GetDefaultOutputDevice() != paNoDevice);
@@ -143,7 +147,10 @@ bool PortAudioThread::threadBody()
                     modifyVolumeLevel<float>(audio_data.m_data, factor);
             }
         }
+        qint64 write_start = PipelineStatistics::now();
         Pa_WriteStream(m_stream, audio_data.m_data.data(), audio_data.m_data.size() / m_audio_params.m_channels / m_audio_params.m_fmt_size);
+        PipelineStatistics::instance().addSince(PipelineStatistics::AudioWrite, write_start);
+        TraceRecorder::addSpan("Pa_WriteStream", write_start);
         return true;
     }
 
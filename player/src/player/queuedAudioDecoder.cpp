@@ -29,6 +29,8 @@
 
 #include "ffmpeg.h"
 #include "avFrameWrapper.h"
+#include "pipelineStatistics.h"
+#include "traceRecorder.h"
 
 #include <QDebug>
 
@@ -64,50 +66,93 @@ void QueuedAudioDecoder::processPacket(AVPacket* packet, int timestamp_ms)
     AVFrame* frame = av_frame_alloc();
     auto stream = m_streams[m_streamIndex];
 
+    qint64 decode_start = PipelineStatistics::now();
     avcodec_send_packet(stream.m_codec, packet);
 
     while (avcodec_receive_frame(stream.m_codec, frame) == 0)
     {
-        int data_size = av_samples_get_buffer_size(0, frame->ch_layout.nb_channels, frame->nb_samples, (AVSampleFormat)frame->format, 1);
+        PipelineStatistics::instance().addSince(PipelineStatistics::AudioDecode, decode_start);
+        TraceRecorder::addSpan("decode audio", decode_start);
 
-        if(data_size > 0)
+        processFrame(frame, timestamp_ms);
+        av_frame_unref(frame);
+
+        //next frames of the packet are decoded by the next receive call
+        decode_start = PipelineStatistics::now();
+    }
+    av_frame_free(&frame);
+}
+
+void QueuedAudioDecoder::drain()
+{
+    AVCodecContext* codec = getCodecContext(m_streamIndex);
+    if (codec == nullptr)
+        return;
+
+    AVFrame* frame = av_frame_alloc();
+    avcodec_send_packet(codec, nullptr);
+    while (avcodec_receive_frame(codec, frame) == 0)
+    {
+        processFrame(frame, toPlayingTime(frame->best_effort_timestamp));
+        av_frame_unref(frame);
+    }
+    av_frame_free(&frame);
+}
+
+void QueuedAudioDecoder::fileChanged()
+{
+    //sample format of the next file may differ, output parameters stay the same
+    cleatSwrContext();
+}
+
+void QueuedAudioDecoder::trackChanged()
+{
+    //output parameters stay the same, so the playback goes on
+    cleatSwrContext();
+}
+
+void QueuedAudioDecoder::processFrame(AVFrame* frame, int timestamp_ms)
+{
+    int data_size = av_samples_get_buffer_size(0, frame->ch_layout.nb_channels, frame->nb_samples, (AVSampleFormat)frame->format, 1);
+
+    if(data_size > 0)
+    {
+        if(timestamp_ms >= lastSeekTime())
         {
-            if(timestamp_ms >= lastSeekTime())
+            //resample audio
+            if(m_swr_context == nullptr)
+                initSwrContext(frame);
+
+            if(m_swr_context != nullptr)
             {
-                //resample audio
-                if(m_swr_context == nullptr)
-                    initSwrContext(frame);
+                const uint8_t **in = (const uint8_t **)frame->extended_data;
+                uint8_t* out_buffer = 0;
+                unsigned int outBufferSize = 0;
+                uint8_t **out = &out_buffer;
+                int out_count = (int64_t)frame->nb_samples * m_context.m_audio_params.m_freq / frame->sample_rate + 256;
+                int out_size  = av_samples_get_buffer_size(NULL, m_context.m_audio_params.m_channels, out_count, m_context.m_audio_params.m_fmt, 0);
 
-                if(m_swr_context != nullptr)
+                av_fast_malloc(&out_buffer, &outBufferSize, out_size);
+
+                int len2 = swr_convert(m_swr_context, out, out_count, in, frame->nb_samples);
+
+                if(len2 > 0 &&
+                    len2 != out_count)
                 {
-                    const uint8_t **in = (const uint8_t **)frame->extended_data;
-                    uint8_t* out_buffer = 0;
-                    unsigned int outBufferSize = 0;
-                    uint8_t **out = &out_buffer;
-                    int out_count = (int64_t)frame->nb_samples * m_context.m_audio_params.m_freq / frame->sample_rate + 256;
-                    int out_size  = av_samples_get_buffer_size(NULL, m_context.m_audio_params.m_channels, out_count, m_context.m_audio_params.m_fmt, 0);
-
-                    av_fast_malloc(&out_buffer, &outBufferSize, out_size);
-
-                    int len2 = swr_convert(m_swr_context, out, out_count, in, frame->nb_samples);
-
-                    if(len2 > 0 &&
-                        len2 != out_count)
-                    {
-                        int new_data_size = len2 * m_context.m_audio_params.m_channels * m_context.m_audio_params.m_fmt_size;
-                        AudioFrame audio_frame(timestamp_ms);
-                        audio_frame.m_data = QByteArray((const char*)out_buffer, new_data_size);
-                        m_queue.push(audio_frame);
-                    }
-
-                    av_freep(&out_buffer);
+                    int new_data_size = len2 * m_context.m_audio_params.m_channels * m_context.m_audio_params.m_fmt_size;
+                    AudioFrame audio_frame(timestamp_ms);
+                    audio_frame.m_data = QByteArray((const char*)out_buffer, new_data_size);
+                    audio_frame.m_decoded_at = PipelineStatistics::now();
+                    TraceSpan span("queue push");
+                    m_queue.push(audio_frame);
                 }
+
+                av_freep(&out_buffer);
             }
-            else
-                qDebug() << "Skipping due to threshold";
         }
+        else
+            qDebug() << "Skipping due to threshold";
     }
-    av_frame_unref(frame);
 }
 
 void QueuedAudioDecoder::initSwrContext(AVFrame* frame)
@@ -48,6 +48,15 @@ public:
 protected:
     virtual void processPacket(AVPacket* packet, int timestamp_ms);
 
+    virtual void drain();
+
+    virtual void fileChanged();
+
+    virtual void trackChanged();
+
+    //! Resample a decoded frame and queue it.
+    virtual void processFrame(AVFrame* frame, int timestamp_ms);
+
 private:
     //! Init resample context.
     void initSwrContext(AVFrame* frame);
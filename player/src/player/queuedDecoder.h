@@ -29,23 +29,49 @@
 #define QUEUEDDECODER_H
 
 #include "decoder.h"
-#include "syncThread.h"
+#include "decodePool.h"
 
 #include "defines.h"
 #include "queue.h"
+#include "pipelineStatistics.h"
+#include "traceRecorder.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QVector>
+
+#include <climits>
 
 template<typename T>
-class QueuedDecoder : public Decoder<T>, public SyncThread
+class QueuedDecoder : public Decoder<T>, public DecodeJob
 {
 public:
     QueuedDecoder(AVMediaType type) :
         Decoder<T>(type),
-        SyncThread(DECODE_SLEEP_TIMEOUT, QThread::HighPriority),
-        m_pause(false)
-    {}
+        m_pause(false),
+        m_next_reader(type),
+        m_next_offset(0),
+        m_next_opened(false),
+        m_time_offset(0),
+        m_file_index(0),
+        m_track_caching(true),
+        m_track_predecoding(true),
+        m_predecode_index(-1),
+        m_step_packets(DECODE_STEP_PACKETS),
+        m_pool_priority(type == AVMEDIA_TYPE_AUDIO ? DecodePool::AudioPriority : DecodePool::VideoPriority),
+        m_pool_rank(0)
+    {
+        m_queue.setBudget(&QueueBudget::instance());
+        //a full queue leaves the pool until its frames are consumed
+        m_queue.setTakenCallback([this] () { notifyReady(); });
+    }
 
     virtual ~QueuedDecoder()
-    {}
+    {
+        stop();
+        clearTrackCaches();
+    }
 
     virtual bool getNextFrame(T& decoded_frame, void* additional_data = 0)
     {
@@ -55,7 +81,15 @@ public:
 
         if(m_queue.size())
         {
+            TraceSpan span("queue pop");
             decoded_frame = m_queue.pop();
+            if(decoded_frame.m_decoded_at != 0)
+            {
+                if(Decoder<T>::m_stream_type == AVMEDIA_TYPE_VIDEO)
+                    PipelineStatistics::instance().addSince(PipelineStatistics::VideoQueueWait, decoded_frame.m_decoded_at);
+                else if(Decoder<T>::m_stream_type == AVMEDIA_TYPE_AUDIO)
+                    PipelineStatistics::instance().addSince(PipelineStatistics::AudioQueueWait, decoded_frame.m_decoded_at);
+            }
             return true;
         }
 
@@ -68,83 +102,567 @@ public:
         if (Decoder<T>::m_stream == nullptr)
             return;
 
-        SyncThread::start();
+        DecodePool::instance().add(this, m_pool_priority, m_pool_rank);
     }
     void wait(bool pause = false) {
         m_pause = pause;
         int min = pause ? 1 : MINIMUM_FRAMES_IN_QUEUE_TO_START;
+        //returns as soon as the frames are there, the decoding is checked again after the timeout
         while(isRunning() &&
-              m_queue.size() < min)
-            msleep(WAIT_TREAD);
+              m_queue.size() < min &&
+              needsFrames())
+            m_queue.waitForSize(min, WAIT_TREAD);
+    }
+
+    //! Checks if the decoding is started and did not reach the end of the file.
+    bool isRunning() const
+    {
+        DecodePool& pool = DecodePool::instance();
+        return pool.contains(this) && !pool.isFinished(this);
+    }
+
+    //! Checks if the decoding reached the end of the file.
+    bool isFinished() const
+    {
+        return DecodePool::instance().isFinished(this);
+    }
+
+    //! Set the priority class of the decoding on the DecodePool, and the rank within the class, e.g. of a mosaic tile.
+    void setPoolPriority(DecodePool::Priority priority, int rank = 0)
+    {
+        m_pool_priority = priority;
+        m_pool_rank = rank;
+        DecodePool::instance().setPriority(this, priority, rank);
+    }
+
+    //! Checks if the queue is below its minimum depth, or below the target duration while the memory budget allows.
+    bool needsFrames() const
+    {
+        if(m_queue.size() < MINIMUM_FRAMES_IN_QUEUE)
+            return true;
+        return m_queue.timeSpan() < QUEUE_TARGET_DURATION &&
+               QueueBudget::instance().isAvailable();
+    }
+
+    virtual bool needsDecoding() const
+    {
+        return needsFrames();
     }
 
+    //! Checks if the next file waits to be opened or the track switched from last to be decoded in advance.
+    virtual bool needsPrefetching() const
+    {
+        {
+            QMutexLocker locker(&m_next_mutex);
+            if(!m_next_file.isEmpty() && !m_next_opened)
+                return true;
+        }
+
+        if(m_predecode_index < 0 ||
+           m_predecode_index >= m_track_caches.size() ||
+           m_predecode_index == Decoder<T>::m_streamIndex)
+            return false;
+        const TrackCache& cache = m_track_caches[m_predecode_index];
+        return !cache.m_packets.isEmpty() &&
+               (!cache.m_predecoded ||
+                (cache.m_sent < cache.m_packets.size() && cache.m_frames.size() < TRACK_PREDECODE_FRAMES));
+    }
+
+    //! Limit the packets read by one pass of the decoding, so jobs of a DecodePool take turns.
+    void setStepPackets(int packets) { m_step_packets = packets; }
+
     virtual void stop()
     {
-        SyncThread::stop();
+        //running step may wait for new data of a followed file
+        StreamReader::interruptReading(true);
+        DecodePool::instance().remove(this);
+        StreamReader::interruptReading(false);
     }
 
     virtual void clearBuffers()
     {
         Decoder<T>::clearBuffers();
         m_queue.clear();
+        clearTrackCaches();
+    }
+
+    virtual int buffersSize() const
+    {
+        return m_queue.dataSize();
     }
 
     virtual void clear()
     {
         Decoder<T>::clear();
         m_queue.clear();
+        clearTrackCaches();
+        m_predecode_index = -1;
+        QMutexLocker locker(&m_next_mutex);
+        m_next_file.clear();
+        m_next_opened = false;
+        m_next_reader.clear();
+        m_time_offset = 0;
+        m_file_index = 0;
+    }
+
+    //! Set a file to continue with at the end of the current one, without a gap.
+    /*!
+     * The decoder opens the file as prefetch work while its queue is full and continues reading it at the end of the current file,
+     * so the queue holds frames of both files at the boundary. Times of the frames of the file are shifted by time_offset_ms.
+     * \param file_name file to continue with
+     * \param time_offset_ms offset of the file times
+     * \param file_index index the file gets, has to follow the current one
+     * \return false, if the decoder has a next file already or continued with another one meanwhile
+     */
+    bool setNextFile(const QString& file_name, int time_offset_ms, int file_index)
+    {
+        {
+            QMutexLocker locker(&m_next_mutex);
+            if(!m_next_file.isEmpty() ||
+               file_index != m_file_index + 1)
+                return false;
+            m_next_file = file_name;
+            m_next_offset = time_offset_ms;
+            m_next_opened = false;
+        }
+        //the file is opened as prefetch work, also while the queue is full
+        notifyReady();
+        return true;
+    }
+
+    //! Seek to a playing time within the current file.
+    bool seekInFile(int time_ms)
+    {
+        clearTrackCaches();
+        bool result = StreamReader::seek(time_ms - m_time_offset);
+        //decoded frames are compared with the playing time
+        StreamReader::m_lastSeekTime = time_ms;
+        return result;
+    }
+
+    //! Get count of files the decoder continued with since it was opened.
+    int getFileIndex() const { return m_file_index; }
+
+    //! Enable keeping the packets of the other tracks, needed to switch tracks without seeking.
+    void setTrackCaching(bool enabled) { m_track_caching = enabled; }
+
+    //! Enable decoding of the track switched from last in advance, so switching back shows the playing frame at once.
+    void setTrackPredecoding(bool enabled) { m_track_predecoding = enabled; }
+
+    //! Switch to another track of the file at a playing time, without seeking.
+    /*!
+     * While several tracks are read, the packets of every track are kept from its last keyframe before the playing time,
+     * and the track switched from last is decoded in advance. The track continues from its kept packets or frames,
+     * so the queue is filled from the playing time on at once. Has to be called while the decoding is stopped.
+     * \param index zero based index of the track
+     * \param time_ms playing time to continue at
+     * \return false, if no packets of the track are kept, so the decoder has to seek to the time
+     */
+    bool switchTrack(int index, int time_ms)
+    {
+        if(index < 0 ||
+           index >= StreamReader::getStreamsCount())
+            return false;
+        if(index == Decoder<T>::m_streamIndex)
+            return true;
+
+        TraceSpan span("switch track");
+        int previous = Decoder<T>::m_streamIndex;
+        m_queue.clear();
+        Decoder<T>::m_streamIndex = index;
+        Decoder<T>::m_stream = StreamReader::getStream(index);
+        trackChanged();
+        StreamReader::m_lastSeekTime = time_ms;
+
+        bool result = false;
+        if(index < m_track_caches.size() &&
+           !m_track_caches[index].m_packets.isEmpty())
+        {
+            TrackCache& cache = m_track_caches[index];
+            if(cache.m_predecoded)
+            {
+                //frames before the playing time are skipped by the seek time
+                for(auto it = cache.m_frames.begin(), end = cache.m_frames.end(); it != end; ++it)
+                    processFrame(it->first, it->second);
+            }
+            else
+            {
+                avcodec_flush_buffers(StreamReader::getCodecContext(index));
+                cache.m_sent = 0;
+            }
+            freeFrames(cache);
+
+            for(; cache.m_sent < cache.m_packets.size(); ++cache.m_sent)
+            {
+                AVPacket* packet = cache.m_packets[cache.m_sent];
+                processPacket(packet, toPlayingTime(packet->pts));
+            }
+            result = true;
+        }
+
+        //the track switched from holds the decoding state up to the last packet, it is decoded again from the keyframe
+        if(previous < m_track_caches.size())
+            m_track_caches[previous].m_predecoded = false;
+        m_predecode_index = m_track_predecoding ? previous : -1;
+        return result;
     }
 
 protected:
     //!  Process function. Decode here.
     virtual void processPacket(AVPacket* packet, int timestamp_ms) = 0;
 
+    //! Decode the frames kept by the codec at the end of a file.
+    virtual void drain() {}
+
+    //! Process a frame decoded by the codec of the played track.
+    virtual void processFrame(AVFrame* frame, int timestamp_ms) = 0;
+
+    //! Called after the decoder continued with the next file, e.g. to reset conversion contexts.
+    virtual void fileChanged() {}
+
+    //! Called after the decoder switched to another track.
+    virtual void trackChanged() {}
+
+    //! Convert time in the stream time base to ms of the playing time.
+    int toPlayingTime(int64_t pts) const
+    {
+        return toPlayingTime(pts, Decoder<T>::m_stream);
+    }
+
+    //! Convert time in the time base of a stream to ms of the playing time.
+    int toPlayingTime(int64_t pts, const AVStream* stream) const
+    {
+        return (int)((double)pts * av_q2d(stream->time_base) * 1000.0) + m_time_offset;
+    }
+
+    //! Open the next file in advance.
+    /*!
+     * \return true, if the next file is set and opened
+     */
+    bool prepareNextFile()
+    {
+        QString file_name;
+        {
+            QMutexLocker locker(&m_next_mutex);
+            if(m_next_file.isEmpty())
+                return false;
+            if(m_next_opened)
+                return true;
+            file_name = m_next_file;
+        }
+
+        //opening probes the file, so it runs without the lock the GUI thread sets the next file under
+        StreamReader reader(m_next_reader.getStreamType());
+        bool opened = false;
+        {
+            TraceSpan span("open next file");
+            opened = reader.open(file_name);
+        }
+
+        QMutexLocker locker(&m_next_mutex);
+        //the decoder was cleared or got another next file meanwhile
+        if(m_next_file != file_name || m_next_opened)
+            return m_next_opened;
+        if(opened)
+            m_next_reader.swap(reader);
+        else
+            m_next_file.clear();
+        m_next_opened = opened;
+        return m_next_opened;
+    }
+
+    //! Continue with the next file at the end of the current one.
+    /*!
+     * \return false, if there is no next file or it has no stream to decode
+     */
+    bool continueWithNextFile()
+    {
+        if(!prepareNextFile())
+            return false;
+
+        drain();
+        clearTrackCaches();
+
+        QMutexLocker locker(&m_next_mutex);
+        StreamReader::swap(m_next_reader);
+        m_next_reader.clear();
+        m_next_file.clear();
+        m_next_opened = false;
+        m_time_offset = m_next_offset;
+        ++m_file_index;
+
+        Decoder<T>::m_stream = StreamReader::getStream(Decoder<T>::m_streamIndex);
+        if(Decoder<T>::m_stream == nullptr)
+            return false;
+        fileChanged();
+        return true;
+    }
+
     /** Check whether buffer needs to be filled.
-     * Try to fill at least half the buffer.
+     * Runs on a thread of the DecodePool, reads up to the step packets.
      */
-    virtual bool threadBody()
+    virtual bool decodeStep()
     {
         //check do we need to decode some more frames
-        if (m_queue.size() < MINIMUM_FRAMES_IN_QUEUE)
+        if (needsFrames())
         {
             //read another frame
             //exit if file ended
+            bool result = true;
             AVPacket *packet = av_packet_alloc();
             // On first load only two to speed-up seek.
-            int targetSize = (m_queue.empty() && m_pause) ? 2 : m_queue.size() + MINIMUM_FRAMES_IN_QUEUE / 2;
-            while (m_queue.size() < targetSize)
+            bool first_frames = m_queue.empty() && m_pause;
+            int packets = 0;
+            while ((first_frames ? m_queue.size() < 2 : needsFrames()) &&
+                   packets++ < m_step_packets)
             {
                 auto ctx = StreamReader::getFormatContext();
-                if (ctx == 0) return false;
+                if (ctx == 0)
+                {
+                    result = false;
+                    break;
+                }
 
+                qint64 read_start = PipelineStatistics::now();
                 int read_result = av_read_frame(ctx, packet);
+                PipelineStatistics::instance().addSince(PipelineStatistics::Demux, read_start);
+                TraceRecorder::addSpan("read packet", read_start);
 
                 if(read_result == 0)
                 {
                     //packet read normally
                     if(packet->stream_index == Decoder<T>::m_stream->index)
-                    {
-                        int time = (int)((double)packet->pts * av_q2d(Decoder<T>::m_stream->time_base) * 1000.0);
-                        processPacket(packet, time);
-                    }
+                        processPacket(packet, toPlayingTime(packet->pts));
+                    cachePacket(packet);
+                    av_packet_unref(packet);
+                }
+                else if(read_result == AVERROR_EOF &&
+                        continueWithNextFile())
+                {
+                    //following file continues without a gap
+                    continue;
                 }
                 else
                 {
                     //end of file
-                    return false;
+                    drain();
+                    result = false;
+                    break;
                 }
             }
-            av_packet_unref(packet);
+            av_packet_free(&packet);
+            return result;
         }
 
+        //queue is full, so there is time to open the following file and to decode another track in advance
+        prepareNextFile();
+        predecodeTrack();
         return true;
     }
 
+private:
+    //! Packets of a track kept to switch to it at once.
+    struct TrackCache
+    {
+        TrackCache() :
+            m_sent(0),
+            m_predecoded(false)
+        {}
+
+        //! Packets in decoding order, starting with a keyframe.
+        QList<AVPacket*> m_packets;
+        //! Count of the first packets sent to the codec of the track.
+        int m_sent;
+        //! Set when the sent packets were decoded into the frames.
+        bool m_predecoded;
+        //! Frames decoded in advance with their playing times, in presentation order.
+        QList<QPair<AVFrame*, int> > m_frames;
+    };
+
+    //! Keep a packet of a track, if several tracks are read.
+    void cachePacket(AVPacket* packet)
+    {
+        if(!m_track_caching ||
+           StreamReader::getStreamsCount() < 2)
+            return;
+
+        int index = -1;
+        for(int i = 0; i < StreamReader::m_streams.size() && index == -1; ++i)
+        {
+            if(StreamReader::m_streams[i].m_index == packet->stream_index)
+                index = i;
+        }
+        //metadata tracks have no codec and need no decoding state
+        if(index == -1 ||
+           StreamReader::m_streams[index].m_codec == nullptr)
+            return;
+
+        if(m_track_caches.size() < StreamReader::getStreamsCount())
+            m_track_caches.resize(StreamReader::getStreamsCount());
+        TrackCache& cache = m_track_caches[index];
+
+        bool keyframe = (packet->flags & AV_PKT_FLAG_KEY) != 0;
+        if(keyframe)
+            trimTrackCache(index);
+        if(cache.m_packets.size() >= TRACK_CACHE_PACKETS)
+            clearTrackCache(cache);
+        //decoding starts with a keyframe
+        if(cache.m_packets.isEmpty() && !keyframe)
+            return;
+
+        cache.m_packets.append(av_packet_clone(packet));
+        //played track is decoded as read
+        if(index == Decoder<T>::m_streamIndex)
+            cache.m_sent = cache.m_packets.size();
+        else if(index == m_predecode_index)
+            predecodeTrack();
+    }
+
+    //! Drop the packets before the last keyframe and the frames before the first queued frame.
+    void trimTrackCache(int index)
+    {
+        if(m_queue.empty())
+            return;
+
+        TrackCache& cache = m_track_caches[index];
+        const AVStream* stream = StreamReader::getStream(index);
+        int time = m_queue.headTime();
+
+        int keyframe = 0;
+        for(int i = 1; i < cache.m_packets.size(); ++i)
+        {
+            const AVPacket* packet = cache.m_packets[i];
+            if((packet->flags & AV_PKT_FLAG_KEY) != 0 &&
+               toPlayingTime(packet->pts, stream) <= time)
+                keyframe = i;
+        }
+        for(int i = 0; i < keyframe; ++i)
+            av_packet_free(&cache.m_packets[i]);
+        cache.m_packets.erase(cache.m_packets.begin(), cache.m_packets.begin() + keyframe);
+        if(cache.m_sent < keyframe)
+        {
+            //decoding state does not match the kept packets any more
+            cache.m_sent = 0;
+            cache.m_predecoded = false;
+        }
+        else
+            cache.m_sent -= keyframe;
+
+        while(!cache.m_frames.isEmpty() &&
+              cache.m_frames.front().second < time)
+        {
+            av_frame_free(&cache.m_frames.front().first);
+            cache.m_frames.pop_front();
+        }
+    }
+
+    //! Decode the kept packets of the track switched from last.
+    void predecodeTrack()
+    {
+        if(m_predecode_index < 0 ||
+           m_predecode_index >= m_track_caches.size() ||
+           m_predecode_index == Decoder<T>::m_streamIndex)
+            return;
+
+        TrackCache& cache = m_track_caches[m_predecode_index];
+        AVCodecContext* codec = StreamReader::getCodecContext(m_predecode_index);
+        const AVStream* stream = StreamReader::getStream(m_predecode_index);
+        if(cache.m_packets.isEmpty() ||
+           codec == nullptr)
+            return;
+
+        if(!cache.m_predecoded)
+        {
+            avcodec_flush_buffers(codec);
+            freeFrames(cache);
+            cache.m_sent = 0;
+            cache.m_predecoded = true;
+        }
+
+        TraceSpan span("predecode track");
+        int time = m_queue.empty() ? INT_MIN : m_queue.headTime();
+        AVFrame* frame = av_frame_alloc();
+        while(cache.m_sent < cache.m_packets.size() &&
+              cache.m_frames.size() < TRACK_PREDECODE_FRAMES)
+        {
+            avcodec_send_packet(codec, cache.m_packets[cache.m_sent++]);
+            while(avcodec_receive_frame(codec, frame) == 0)
+            {
+                int frame_time = toPlayingTime(frame->best_effort_timestamp, stream);
+                if(frame_time >= time)
+                {
+                    cache.m_frames.append(qMakePair(frame, frame_time));
+                    frame = av_frame_alloc();
+                }
+                else
+                    av_frame_unref(frame);
+            }
+        }
+        av_frame_free(&frame);
+    }
+
+    //! Free the frames decoded in advance.
+    void freeFrames(TrackCache& cache)
+    {
+        for(auto it = cache.m_frames.begin(), end = cache.m_frames.end(); it != end; ++it)
+            av_frame_free(&it->first);
+        cache.m_frames.clear();
+    }
+
+    //! Drop the kept packets and frames of a track.
+    void clearTrackCache(TrackCache& cache)
+    {
+        freeFrames(cache);
+        for(auto it = cache.m_packets.begin(), end = cache.m_packets.end(); it != end; ++it)
+            av_packet_free(&(*it));
+        cache.m_packets.clear();
+        cache.m_sent = 0;
+        cache.m_predecoded = false;
+    }
+
+    //! Drop the kept packets and frames of all tracks, e.g. after a seek.
+    void clearTrackCaches()
+    {
+        for(auto it = m_track_caches.begin(), end = m_track_caches.end(); it != end; ++it)
+            clearTrackCache(*it);
+        m_track_caches.clear();
+    }
+
 public:
     //! Queue with decoded frames.
     Queue<T>        m_queue;
     //! Mode play/pause
     bool            m_pause;
+
+private:
+    //! Guards the next file.
+    mutable QMutex  m_next_mutex;
+    //! File to continue with, empty if none.
+    QString         m_next_file;
+    //! Reader of the next file, opened in advance.
+    StreamReader    m_next_reader;
+    //! Offset of the times of the next file in ms.
+    int             m_next_offset;
+    //! Is the next file opened.
+    bool            m_next_opened;
+    //! Offset of the times of the current file in ms.
+    int             m_time_offset;
+    //! Count of files continued with.
+    std::atomic<int> m_file_index;
+    //! Kept packets by track.
+    QVector<TrackCache> m_track_caches;
+    //! Are the packets of the other tracks kept.
+    bool            m_track_caching;
+    //! Is the track switched from last decoded in advance.
+    bool            m_track_predecoding;
+    //! Track decoded in advance, -1 if none.
+    int             m_predecode_index;
+    //! Maximum count of packets read by one pass of the decoding.
+    int             m_step_packets;
+    //! Priority class of the decoding on the DecodePool.
+    DecodePool::Priority m_pool_priority;
+    //! Rank of the decoding within its class.
+    int             m_pool_rank;
 };
 
 #endif // QUEUEDDECODER_H
@@ -28,6 +28,7 @@
 #ifndef QUEUEDMETADATADECODER_H
 #define QUEUEDMETADATADECODER_H
 #include <QTreeWidgetItem>
+#include <QDateTime>
 
 #include "queuedVideoDecoder.h"
 #include "videoContext.h"
@@ -37,11 +38,13 @@
 class EventItem : public QTreeWidgetItem
 {
 public:
-    EventItem(int t, size_t ha) : hash(ha) {
+    EventItem(int t, size_t ha, const QDateTime& utc_time = QDateTime()) : hash(ha), m_utc_time(utc_time) {
         m_time = t;
     }
     int m_time;
     size_t hash;
+    //! Time of the event message, used to find it in other segments.
+    QDateTime m_utc_time;
 };
 
 class MetadataDecoder : public QueuedVideoDecoder
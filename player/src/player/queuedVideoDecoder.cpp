@@ -29,14 +29,27 @@
 
 #include "ffmpeg.h"
 #include "avFrameWrapper.h"
+#include "pipelineStatistics.h"
+#include "traceRecorder.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <qdatetime.h>
 
 QueuedVideoDecoder::QueuedVideoDecoder(AVMediaType type) :
     QueuedDecoder<VideoFrame>(type),
     m_sws_context(0),
-    m_frame_RGB(0)
+    m_frame_RGB(0),
+    m_sws_format(AV_PIX_FMT_NONE),
+    m_sws_width(0),
+    m_sws_height(0),
+    m_output_width(0),
+    m_output_height(0),
+    m_keyframes_only(false),
+    m_skip_to_keyframe(false),
+    m_conversion_time(0),
+    m_converted_frames(0),
+    m_next_segment_index(-1)
 {
 
 }
@@ -49,6 +62,19 @@ void QueuedVideoDecoder::clear()
 {
     QueuedDecoder<VideoFrame>::clear();
     clearSwsContext();
+    QMutexLocker locker(&m_segment_mutex);
+    m_next_segment_index = -1;
+}
+
+bool QueuedVideoDecoder::setNextFile(const SegmentInfo& segment, int time_offset_ms, int file_index)
+{
+    //the segment is set first, as the decoder may continue with the file at once
+    {
+        QMutexLocker locker(&m_segment_mutex);
+        m_next_segment = segment;
+        m_next_segment_index = file_index;
+    }
+    return setNextFile(segment.getFileName(), time_offset_ms, file_index);
 }
 
 void QueuedVideoDecoder::setStream(int index, double fps)
@@ -63,57 +89,154 @@ void QueuedVideoDecoder::setStream(int index, double fps)
 
 void QueuedVideoDecoder::processPacket(AVPacket* packet, int timestamp_ms)
 {
+    //frames following a skipped one refer to it, so decoding of all frames continues at a keyframe
+    if((packet->flags & AV_PKT_FLAG_KEY) != 0)
+        m_skip_to_keyframe = m_keyframes_only;
+    else if(m_skip_to_keyframe || m_keyframes_only)
+    {
+        m_skip_to_keyframe = true;
+        return;
+    }
+
     AVFrame* frame = av_frame_alloc();
     auto stream = m_streams[m_streamIndex];
 
+    qint64 decode_start = PipelineStatistics::now();
     avcodec_send_packet(stream.m_codec, packet);
+    int receive_result = avcodec_receive_frame(stream.m_codec, frame);
+    PipelineStatistics::instance().addSince(PipelineStatistics::VideoDecode, decode_start);
+    TraceRecorder::addSpan("decode video", decode_start);
 
-    if (avcodec_receive_frame(stream.m_codec, frame) == 0)
+    if (receive_result == 0)
+        processFrame(frame, timestamp_ms);
+    av_frame_free(&frame);
+}
+
+void QueuedVideoDecoder::drain()
+{
+    //metadata streams have no codec
+    AVCodecContext* codec = getCodecContext(m_streamIndex);
+    if (codec == nullptr)
+        return;
+
+    AVFrame* frame = av_frame_alloc();
+    avcodec_send_packet(codec, nullptr);
+    while (avcodec_receive_frame(codec, frame) == 0)
     {
-        if (timestamp_ms >= lastSeekTime())       // Seek always seeks to I-Frame. Ignore frames before target frame.
+        processFrame(frame, toPlayingTime(frame->best_effort_timestamp));
+        av_frame_unref(frame);
+    }
+    av_frame_free(&frame);
+}
+
+void QueuedVideoDecoder::trackChanged()
+{
+    //frame rate of the previous track is kept, if the track has none
+    m_context.open(m_stream, 0.0);
+}
+
+void QueuedVideoDecoder::fileChanged()
+{
+    {
+        QMutexLocker locker(&m_segment_mutex);
+        if(m_next_segment_index == getFileIndex())
         {
-            //conver frame to RGB frame and create image
-            if(m_sws_context == nullptr)
-                initSwsContext(frame);
-
-            if(m_sws_context != nullptr)
-            {
-                //scale image
-                sws_scale(m_sws_context, (uint8_t**)frame->data, frame->linesize, 0, frame->height, m_frame_RGB->data, m_frame_RGB->linesize);
-
-                //conert to image
-                QImage image(frame->width, frame->height, QImage::Format_RGB32);
-                for(int y = 0; y < frame->height; ++y)
-                    memcpy(image.scanLine(y), m_frame_RGB->data[0] + y * m_frame_RGB->linesize[0], frame->width * 4);
-
-                //fill other fields
-                VideoFrame video_frame(timestamp_ms);
-                video_frame.m_image = image;
-
-                //put into queue
-                m_queue.push(video_frame);
-            }
+            m_file_segment = m_next_segment;
+            m_context.m_segment = &m_file_segment;
+            m_next_segment_index = -1;
         }
-        else {
-            QTime now;
-            qDebug() << "Skipping " << timestamp_ms << " due to threshold " << now.currentTime();
+    }
+
+    //times of the metadata are relative to the start of the segment, the frame rate is taken from its samples
+    double fps = m_context.m_segment != nullptr ? m_context.m_segment->getFpsFromSamples() : 0.0;
+    m_context.open(m_stream, fps);
+}
+
+void QueuedVideoDecoder::processFrame(AVFrame* frame, int timestamp_ms)
+{
+    if (timestamp_ms >= lastSeekTime())       // Seek always seeks to I-Frame. Ignore frames before target frame.
+    {
+        //frame size or format may change with the next file or track, the output size with the widget
+        int width = frame->width, height = frame->height;
+        outputSize(width, height);
+        if(m_sws_context != nullptr &&
+           (frame->width != m_sws_width || frame->height != m_sws_height || frame->format != m_sws_format ||
+            width != m_frame_RGB->width || height != m_frame_RGB->height))
+            clearSwsContext();
+
+        //conver frame to RGB frame and create image
+        if(m_sws_context == nullptr)
+            initSwsContext(frame);
+
+        if(m_sws_context != nullptr)
+        {
+            QElapsedTimer conversion_timer;
+            conversion_timer.start();
+            qint64 conversion_start = PipelineStatistics::now();
+
+            //scale image
+            sws_scale(m_sws_context, (uint8_t**)frame->data, frame->linesize, 0, frame->height, m_frame_RGB->data, m_frame_RGB->linesize);
+
+            //conert to image
+            QImage image(m_frame_RGB->width, m_frame_RGB->height, QImage::Format_RGB32);
+            for(int y = 0; y < m_frame_RGB->height; ++y)
+                memcpy(image.scanLine(y), m_frame_RGB->data[0] + y * m_frame_RGB->linesize[0], m_frame_RGB->width * 4);
+
+            qint64 conversion_time = conversion_timer.nsecsElapsed();
+            m_conversion_time += conversion_time;
+            ++m_converted_frames;
+            PipelineStatistics::instance().add(PipelineStatistics::Conversion, conversion_time);
+            TraceRecorder::addSpan("convert frame", conversion_start);
+
+            //fill other fields
+            VideoFrame video_frame(timestamp_ms);
+            video_frame.m_image = image;
+            video_frame.m_decoded_at = PipelineStatistics::now();
+
+            //put into queue
+            TraceSpan span("queue push");
+            m_queue.push(video_frame);
         }
     }
-    av_frame_unref(frame);
+    else {
+        QTime now;
+        qDebug() << "Skipping " << timestamp_ms << " due to threshold " << now.currentTime();
+    }
+}
+
+void QueuedVideoDecoder::outputSize(int& width, int& height) const
+{
+    int output_width = m_output_width, output_height = m_output_height;
+    if(output_width <= 0 || output_height <= 0 ||
+       width <= 0 || height <= 0)
+        return;
+
+    //fit into the output size, never scale up
+    double scale = qMin((double)output_width / width, (double)output_height / height);
+    if(scale >= 1.0)
+        return;
+    width = qMax(2, (int)(width * scale) & ~1);
+    height = qMax(2, (int)(height * scale) & ~1);
 }
 
 void QueuedVideoDecoder::initSwsContext(AVFrame* frame)
 {
-    //create scale context
+    int width = frame->width, height = frame->height;
+    outputSize(width, height);
+
+    //create scale context, reduced sizes are scaled faster
     m_sws_context = sws_getCachedContext(0,
                                          frame->width, frame->height, (AVPixelFormat)frame->format,
-                                         frame->width, frame->height, AV_PIX_FMT_RGB32,
-                                         SWS_BICUBIC, 0, 0, 0);
+                                         width, height, AV_PIX_FMT_RGB32,
+                                         (width == frame->width) ? SWS_BICUBIC : SWS_FAST_BILINEAR, 0, 0, 0);
+    m_sws_format = frame->format;
+    m_sws_width = frame->width;
+    m_sws_height = frame->height;
 
     //create RGB frame
     m_frame_RGB = av_frame_alloc();
-    m_frame_RGB->width = frame->width;
-    m_frame_RGB->height = frame->height;
+    m_frame_RGB->width = width;
+    m_frame_RGB->height = height;
     m_frame_RGB->format = AV_PIX_FMT_RGB32;
 
     ////allocate buffer for RGBFrame
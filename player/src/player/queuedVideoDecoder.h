@@ -29,10 +29,13 @@
 #define QUEUEDVIDEODECODER_H
 
 #include "queuedDecoder.h"
+#include "segmentInfo.h"
 #include "videoContext.h"
 
 #include "types.h"
 
+#include <atomic>
+
 class QueuedVideoDecoder : public QueuedDecoder<VideoFrame>
 {
 public:
@@ -49,10 +52,43 @@ public:
     int frameWidth() const { return m_frame_RGB ? m_frame_RGB->width : 0; }
     int frameHeight() const { return m_frame_RGB ? m_frame_RGB->height : 0; }
 
+    //! Get total time spent on converting decoded frames to images, in nanoseconds.
+    qint64 conversionTime() const { return m_conversion_time; }
+    //! Get count of frames converted to images.
+    int convertedFrames() const { return m_converted_frames; }
+    //! Reset conversion statistics.
+    void resetConversionStatistics() { m_conversion_time = 0; m_converted_frames = 0; }
+
+    //! Scale the images to fit into a size keeping the aspect ratio, an empty size keeps the frame size.
+    void setOutputSize(int width, int height) { m_output_width = width; m_output_height = height; }
+
+    //! Decode only the keyframes, to lower the decoding load. Decoding of all frames continues at the next keyframe.
+    void setKeyframesOnly(bool keyframes_only) { m_keyframes_only = keyframes_only; }
+
+    //! Get keyframes only mode.
+    bool isKeyframesOnly() const { return m_keyframes_only; }
+
+    using QueuedDecoder<VideoFrame>::setNextFile;
+
+    //! Set a file to continue with and its segment, the context switches to the segment and its frame rate with the file.
+    bool setNextFile(const SegmentInfo& segment, int time_offset_ms, int file_index);
+
 protected:
     virtual void processPacket(AVPacket* packet, int timestamp_ms);
 
+    virtual void drain();
+
+    //! Convert a decoded frame to an image and queue it.
+    virtual void processFrame(AVFrame* frame, int timestamp_ms);
+
+    virtual void trackChanged();
+
+    virtual void fileChanged();
+
 private:
+    //! Reduce a frame size to the output size.
+    void outputSize(int& width, int& height) const;
+
     //! Init scale context.
     void initSwsContext(AVFrame* frame);
 
@@ -64,6 +100,32 @@ protected:
     SwsContext* m_sws_context;
     //! RGB frame used for conversion.
     AVFrame*    m_frame_RGB;
+    //! Pixel format the scale context converts from.
+    int         m_sws_format;
+    //! Frame width the scale context converts from.
+    int         m_sws_width;
+    //! Frame height the scale context converts from.
+    int         m_sws_height;
+    //! Width of the images, 0 for the frame width.
+    std::atomic<int>    m_output_width;
+    //! Height of the images, 0 for the frame height.
+    std::atomic<int>    m_output_height;
+    //! Decode only the keyframes.
+    std::atomic<bool>   m_keyframes_only;
+    //! Set while the packets up to the next keyframe are skipped.
+    bool        m_skip_to_keyframe;
+    //! Time spent on conversion in nanoseconds.
+    std::atomic<qint64> m_conversion_time;
+    //! Count of converted frames.
+    std::atomic<int>    m_converted_frames;
+    //! Guards the segment of the next file.
+    QMutex      m_segment_mutex;
+    //! Segment of the next file.
+    SegmentInfo m_next_segment;
+    //! Index of the file the next segment belongs to, -1 if none is set.
+    int         m_next_segment_index;
+    //! Segment of the file the decoder continued with, the context points to it.
+    SegmentInfo m_file_segment;
 };
 
 #endif // QUEUEDVIDEODECODER_H
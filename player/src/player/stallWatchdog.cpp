@@ -0,0 +1,201 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "stallWatchdog.h"
+
+#include <QTimerEvent>
+#include <QtDebug>
+
+#include <algorithm>
+
+#include "defines.h"
+#include "pipelineStatistics.h"
+#include "traceRecorder.h"
+
+namespace
+{
+    //! Name of the stalls without a running operation.
+    const char * const sc_other_operation = "other";
+}
+
+StallWatchdog & StallWatchdog::instance()
+{
+    static StallWatchdog watchdog;
+    return watchdog;
+}
+
+StallWatchdog::StallWatchdog()
+    : SyncThread(STALL_WATCHDOG_INTERVAL, QThread::LowPriority)
+    , m_timer(-1)
+    , m_last_beat_ns(0)
+    , m_current_operation(nullptr)
+    , m_hang_reported(false)
+    , m_depth(0)
+    , m_gap_operation(nullptr)
+    , m_gap_operation_ns(0)
+{
+    setObjectName("Stall watchdog");
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    stopWatching();
+}
+
+void StallWatchdog::startWatching()
+{
+    if(m_timer != -1)
+        return;
+
+    m_last_beat_ns = PipelineStatistics::now();
+    m_timer = startTimer(STALL_HEARTBEAT_INTERVAL, Qt::PreciseTimer);
+    start();
+}
+
+void StallWatchdog::stopWatching()
+{
+    if(m_timer == -1)
+        return;
+
+    killTimer(m_timer);
+    m_timer = -1;
+    stop();
+}
+
+void StallWatchdog::enterOperation(const char * name)
+{
+    //only the GUI thread is watched
+    if(QThread::currentThread() != thread())
+        return;
+
+    if(m_depth++ == 0)
+        m_current_operation = name;
+}
+
+void StallWatchdog::leaveOperation(const char * name, qint64 start_ns)
+{
+    if(QThread::currentThread() != thread())
+        return;
+
+    if(--m_depth == 0)
+    {
+        m_current_operation = nullptr;
+
+        qint64 duration_ns = PipelineStatistics::now() - start_ns;
+        if(duration_ns > m_gap_operation_ns)
+        {
+            m_gap_operation = name;
+            m_gap_operation_ns = duration_ns;
+        }
+    }
+}
+
+void StallWatchdog::reset()
+{
+    m_stalls.clear();
+}
+
+QJsonObject StallWatchdog::toJson() const
+{
+    QJsonObject operations;
+    quint64 count = 0, long_count = 0;
+    for(auto it = m_stalls.begin(), end = m_stalls.end(); it != end; ++it)
+    {
+        QJsonObject operation;
+        operation["count"] = (double)it->m_count;
+        operation["long_count"] = (double)it->m_long_count;
+        operation["total_ms"] = (double)it->m_total_ms;
+        operation["max_ms"] = (double)it->m_max_ms;
+        operations[QString::fromLatin1(it.key())] = operation;
+
+        count += it->m_count;
+        long_count += it->m_long_count;
+    }
+
+    QJsonObject result;
+    result["threshold_ms"] = STALL_FRAME_THRESHOLD;
+    result["long_threshold_ms"] = STALL_LONG_THRESHOLD;
+    result["count"] = (double)count;
+    result["long_count"] = (double)long_count;
+    result["operations"] = operations;
+    return result;
+}
+
+void StallWatchdog::timerEvent(QTimerEvent * event)
+{
+    if(event->timerId() != m_timer)
+    {
+        SyncThread::timerEvent(event);
+        return;
+    }
+
+    qint64 now_ns = PipelineStatistics::now();
+    qint64 stall_ms = (now_ns - m_last_beat_ns) / 1000000 - STALL_HEARTBEAT_INTERVAL;
+    if(stall_ms >= STALL_FRAME_THRESHOLD)
+    {
+        const char * operation = (m_gap_operation != nullptr) ? m_gap_operation : sc_other_operation;
+
+        StallCounter & counter = m_stalls[QByteArray(operation)];
+        ++counter.m_count;
+        counter.m_total_ms += stall_ms;
+        counter.m_max_ms = std::max(counter.m_max_ms, stall_ms);
+        if(stall_ms >= STALL_LONG_THRESHOLD)
+        {
+            ++counter.m_long_count;
+            qWarning() << "GUI thread stalled for" << stall_ms << "ms in" << operation;
+        }
+    }
+
+    m_gap_operation = nullptr;
+    m_gap_operation_ns = 0;
+    m_hang_reported = false;
+    m_last_beat_ns = now_ns;
+}
+
+bool StallWatchdog::threadBody()
+{
+    qint64 blocked_ms = (PipelineStatistics::now() - m_last_beat_ns) / 1000000;
+    if(blocked_ms >= STALL_HANG_THRESHOLD && !m_hang_reported.exchange(true))
+    {
+        const char * operation = m_current_operation;
+        qWarning() << "GUI thread blocked for" << blocked_ms << "ms in" << ((operation != nullptr) ? operation : sc_other_operation);
+    }
+    return true;
+}
+
+StallScope::StallScope(const char * name)
+    : m_name(name)
+    , m_start_ns(PipelineStatistics::now())
+{
+    StallWatchdog::instance().enterOperation(m_name);
+}
+
+StallScope::~StallScope()
+{
+    StallWatchdog::instance().leaveOperation(m_name, m_start_ns);
+    TraceRecorder::addSpan(m_name, m_start_ns);
+}
@@ -0,0 +1,145 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include "crosscompilation_cxx11.h"
+#include "crosscompilation_inttypes.h"
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QMap>
+
+#include <atomic>
+
+#include "syncThread.h"
+
+//! Detects stalls of the GUI thread event loop and attributes them to the operations running meanwhile.
+/*!
+ * \brief A precise timer on the GUI thread beats every STALL_HEARTBEAT_INTERVAL ms, a gap between two beats longer
+ * than STALL_FRAME_THRESHOLD ms is a stall. Blocking operations of the GUI thread are marked with StallScope,
+ * a stall is attributed to the longest outermost operation that ran during the gap, or to "other".
+ * The watchdog thread reports the GUI thread blocked for STALL_HANG_THRESHOLD ms while it is still blocked,
+ * so hangs are attributed even if they never end.
+ */
+class StallWatchdog CC_CXX11_FINAL : public SyncThread
+{
+public:
+    //! Stalls attributed to an operation.
+    struct StallCounter
+    {
+        StallCounter()
+            : m_count(0)
+            , m_long_count(0)
+            , m_total_ms(0)
+            , m_max_ms(0)
+        {}
+
+        //! Count of the stalls.
+        quint64 m_count;
+        //! Count of the stalls longer than STALL_LONG_THRESHOLD.
+        quint64 m_long_count;
+        //! Sum of the stall durations.
+        qint64 m_total_ms;
+        //! Longest stall.
+        qint64 m_max_ms;
+    };
+
+public:
+    //! Returns the watchdog of the application.
+    static StallWatchdog & instance();
+
+    virtual ~StallWatchdog();
+
+public:
+    //! Starts watching the GUI thread, has to be called from it.
+    void startWatching();
+
+    //! Stops watching.
+    void stopWatching();
+
+    //! Marks the beginning of a GUI thread operation, name has to be a string literal.
+    void enterOperation(const char * name);
+
+    //! Marks the end of a GUI thread operation started at a time returned by PipelineStatistics::now().
+    void leaveOperation(const char * name, qint64 start_ns);
+
+    //! Clears the stall counters.
+    void reset();
+
+    //! Returns the stall counters by operation as JSON.
+    QJsonObject toJson() const;
+
+protected:
+    virtual void timerEvent(QTimerEvent * event) CC_CXX11_OVERRIDE;
+
+    virtual bool threadBody() CC_CXX11_OVERRIDE;
+
+private:
+    StallWatchdog();
+
+private:
+    //! Heartbeat timer.
+    int m_timer;
+    //! Time of the last heartbeat.
+    std::atomic<qint64> m_last_beat_ns;
+    //! Outermost running operation, read by the watchdog thread.
+    std::atomic<const char *> m_current_operation;
+    //! Set when the current hang was reported by the watchdog thread.
+    std::atomic<bool> m_hang_reported;
+    //! Nesting depth of the running operations.
+    int m_depth;
+    //! Longest outermost operation since the last heartbeat.
+    const char * m_gap_operation;
+    //! Duration of the longest outermost operation since the last heartbeat.
+    qint64 m_gap_operation_ns;
+    //! Stall counters by operation.
+    QMap<QByteArray, StallCounter> m_stalls;
+};
+
+//! Marks a blocking GUI thread operation lasting until the end of the scope.
+class StallScope CC_CXX11_FINAL
+{
+public:
+    //! Starts the operation, name has to be a string literal.
+    explicit StallScope(const char * name);
+
+    ~StallScope();
+
+private:
+    StallScope(const StallScope &);
+    StallScope & operator =(const StallScope &);
+
+private:
+    //! Name of the operation.
+    const char * m_name;
+    //! Start time in nanoseconds.
+    qint64 m_start_ns;
+};
+
+#endif // STALLWATCHDOG_H
@@ -29,10 +29,20 @@
 
 #include <QFile>
 
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#include "defines.h"
+#include "fileView.h"
+
 StreamReader::StreamReader(AVMediaType stream_type) :
     m_stream_type(stream_type),
     m_format_context(nullptr),
-    m_lastSeekTime(0)
+    m_lastSeekTime(0),
+    m_follow(false),
+    m_interrupt(false),
+    m_file_input(nullptr)
 {
 }
 
@@ -63,6 +73,7 @@ void StreamReader::clear()
         avformat_close_input(&m_format_context);
         m_format_context = nullptr;
     }
+    closeFileInput();
 }
 
 AVStream* StreamReader::getStream(int index) const
@@ -99,16 +110,75 @@ bool StreamReader::seek(int timestamp_ms)
     return true;
 }
 
+void StreamReader::interruptReading(bool interrupt)
+{
+    m_interrupt = interrupt;
+    //interrupted read leaves an error in the context, so following reads would fail
+    if(!interrupt &&
+       m_format_context != nullptr &&
+       m_format_context->pb != nullptr &&
+       m_format_context->pb->error == AVERROR_EXIT)
+        m_format_context->pb->error = 0;
+}
+
+void StreamReader::swap(StreamReader& other)
+{
+    std::swap(m_format_context, other.m_format_context);
+    std::swap(m_file_input, other.m_file_input);
+    m_streams.swap(other.m_streams);
+    m_lastSeekTime = other.m_lastSeekTime = 0;
+
+    //interruption is checked on the reader owning the context
+    if(m_format_context != nullptr)
+        m_format_context->interrupt_callback.opaque = this;
+    if(other.m_format_context != nullptr)
+        other.m_format_context->interrupt_callback.opaque = &other;
+}
+
+int StreamReader::interruptCallback(void* opaque)
+{
+    return static_cast<StreamReader*>(opaque)->m_interrupt ? 1 : 0;
+}
+
 bool StreamReader::init(const QString& file_name, const QSet<int>& valid_streams)
 {
     if(file_name.isEmpty() ||
        !QFile::exists(file_name))
         return false;
 
-    if(avformat_open_input(&m_format_context, file_name.toUtf8().data(), 0, 0) != 0)
+    m_format_context = avformat_alloc_context();
+    if(m_format_context == nullptr)
+        return false;
+    m_format_context->interrupt_callback.callback = &StreamReader::interruptCallback;
+    m_format_context->interrupt_callback.opaque = this;
+
+    AVDictionary* options = nullptr;
+    AVInputFormat* format = nullptr;
+    if(m_follow)
+    {
+        //wait for data appended to the file instead of reporting its end
+        av_dict_set(&options, "follow", "1", 0);
+        av_dict_set_int(&options, "rw_timeout", (int64_t)FOLLOW_READ_TIMEOUT * 1000, 0);
+        //read fragments while playing, the file does not contain all of them yet
+        m_format_context->flags |= AVFMT_FLAG_IGNIDX;
+    }
+    else if(openFileInput(file_name))
+    {
+        //the parser identified the file already, ISO files are not probed for their format
+        char header[8];
+        if(m_file_input->m_view->read(0, header, sizeof(header)) == sizeof(header) &&
+           memcmp(header + 4, "ftyp", 4) == 0)
+            format = (AVInputFormat*)av_find_input_format("mov");
+    }
+
+    int open_result = avformat_open_input(&m_format_context, file_name.toUtf8().data(), format, &options);
+    av_dict_free(&options);
+    if(open_result != 0)
         return false;
 
-    if(avformat_find_stream_info(m_format_context, 0) < 0)
+    //the sample descriptions of the container give the stream parameters mostly, probing decodes frames of every stream
+    if(!isDescribed(valid_streams) &&
+       avformat_find_stream_info(m_format_context, 0) < 0)
         return false;
 
     for(unsigned int index = 0; index < m_format_context->nb_streams; ++index)
@@ -147,6 +217,117 @@ bool StreamReader::openStream(int index, StreamInfo* si)
     return true;
 }
 
+bool StreamReader::openFileInput(const QString& file_name)
+{
+    std::shared_ptr<FileView> view = FileView::open(file_name);
+    if(!view)
+        return false;
+
+    unsigned char* buffer = (unsigned char*)av_malloc(FILE_VIEW_BLOCK_SIZE);
+    if(buffer == nullptr)
+        return false;
+
+    m_file_input = new FileInput();
+    m_file_input->m_view = view;
+    m_file_input->m_position = 0;
+    m_file_input->m_context = avio_alloc_context(buffer, FILE_VIEW_BLOCK_SIZE, 0, m_file_input,
+                                                 &StreamReader::readFileInput, nullptr, &StreamReader::seekFileInput);
+    if(m_file_input->m_context == nullptr)
+    {
+        av_free(buffer);
+        closeFileInput();
+        return false;
+    }
+
+    m_format_context->pb = m_file_input->m_context;
+    m_format_context->flags |= AVFMT_FLAG_CUSTOM_IO;
+    return true;
+}
+
+void StreamReader::closeFileInput()
+{
+    if(m_file_input == nullptr)
+        return;
+
+    //custom contexts are not freed by the format context
+    if(m_file_input->m_context != nullptr)
+    {
+        av_freep(&m_file_input->m_context->buffer);
+        avio_context_free(&m_file_input->m_context);
+    }
+    delete m_file_input;
+    m_file_input = nullptr;
+}
+
+int StreamReader::readFileInput(void* opaque, uint8_t* buffer, int size)
+{
+    FileInput* input = static_cast<FileInput*>(opaque);
+    qint64 read = input->m_view->read(input->m_position, (char*)buffer, size, &input->m_cursor);
+    if(read < 0)
+        return AVERROR(EIO);
+    if(read == 0)
+        return AVERROR_EOF;
+
+    input->m_position += read;
+    return (int)read;
+}
+
+int64_t StreamReader::seekFileInput(void* opaque, int64_t offset, int whence)
+{
+    FileInput* input = static_cast<FileInput*>(opaque);
+    int64_t position = 0;
+    switch(whence & ~AVSEEK_FORCE)
+    {
+    case AVSEEK_SIZE:
+        return input->m_view->getSize();
+    case SEEK_SET:
+        position = offset;
+        break;
+    case SEEK_CUR:
+        position = input->m_position + offset;
+        break;
+    case SEEK_END:
+        position = input->m_view->getSize() + offset;
+        break;
+    default:
+        return AVERROR(EINVAL);
+    }
+
+    if(position < 0)
+        return AVERROR(EINVAL);
+    input->m_position = position;
+    return position;
+}
+
+bool StreamReader::isDescribed(const QSet<int>& valid_streams) const
+{
+    if(m_format_context->duration == AV_NOPTS_VALUE)
+        return false;
+
+    for(unsigned int index = 0; index < m_format_context->nb_streams; ++index)
+    {
+        const AVStream* stream = m_format_context->streams[index];
+        const AVCodecParameters* parameters = stream->codecpar;
+        if(parameters->codec_type != m_stream_type ||
+           (valid_streams.size() &&
+            !valid_streams.contains(stream->id)))
+            continue;
+
+        if(m_stream_type == AVMEDIA_TYPE_VIDEO &&
+           (parameters->codec_id == AV_CODEC_ID_NONE ||
+            parameters->width <= 0 ||
+            parameters->height <= 0 ||
+            stream->avg_frame_rate.num == 0))
+            return false;
+        if(m_stream_type == AVMEDIA_TYPE_AUDIO &&
+           (parameters->codec_id == AV_CODEC_ID_NONE ||
+            parameters->sample_rate <= 0 ||
+            parameters->ch_layout.nb_channels <= 0))
+            return false;
+    }
+    return true;
+}
+
 int StreamReader::StreamInfo::timeMsToPts(int timestamp_ms) const
 {
     return (int)(((double)timestamp_ms / av_q2d(m_stream->time_base)) / 1000.0);
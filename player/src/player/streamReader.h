@@ -36,6 +36,13 @@
 #include <QSet>
 #include <QVector>
 
+#include <atomic>
+#include <memory>
+
+#include "readAhead.h"
+
+class FileView;
+
 /**
  * Class that contains main information about file in terms of ffmpeg. 
  * Each instance contains information about one type of stream (Video, Audio, Metadata).
@@ -55,6 +62,9 @@ public:
     //! Clear MainContext;
     void clear();
 
+    //! Get type of the streams read.
+    AVMediaType getStreamType() const { return m_stream_type; }
+
     AVFormatContext* getFormatContext() { return m_format_context; }
 
     //! Get streams count.
@@ -77,10 +87,60 @@ public:
      */
     int lastSeekTime() const { return m_lastSeekTime; }
 
+    //! Set follow mode for files still being written. Takes effect on the next open.
+    /*!
+     * In follow mode reading at the end of a file waits for new data up to FOLLOW_READ_TIMEOUT,
+     * and fragments are read by the demuxer as they are reached instead of being indexed on open.
+     */
+    void setFollowMode(bool follow) { m_follow = follow; }
+
+    //! Get follow mode.
+    bool isFollowMode() const { return m_follow; }
+
+    //! Make blocking reads return at once, e.g. to stop a thread waiting for new data of a followed file.
+    void interruptReading(bool interrupt);
+
+    //! Exchange the opened files with another reader of the same stream type.
+    /*!
+     * Used to continue with a file opened in advance, the seek time of both readers is reset.
+     */
+    void swap(StreamReader& other);
+
 private:
     //! Init with file.
     bool init(const QString& file_name, const QSet<int>& valid_streams = QSet<int>());
 
+    //! Callback checking if blocking reads have to be interrupted.
+    static int interruptCallback(void* opaque);
+
+    //! Open the input of the format context through the view of the file, instead of the file protocol.
+    bool openFileInput(const QString& file_name);
+
+    //! Free the input opened through the file view.
+    void closeFileInput();
+
+    //! Read callback of the file input.
+    static int readFileInput(void* opaque, uint8_t* buffer, int size);
+
+    //! Seek callback of the file input.
+    static int64_t seekFileInput(void* opaque, int64_t offset, int whence);
+
+    //! Checks if the opened streams are described completely by the container, so probing them can be skipped.
+    bool isDescribed(const QSet<int>& valid_streams) const;
+
+    //! Position of a reader in a file view.
+    struct FileInput
+    {
+        //! View of the file.
+        std::shared_ptr<FileView> m_view;
+        //! Read position.
+        int64_t m_position;
+        //! Read position for reading ahead of the demuxer.
+        ReadAhead::Cursor m_cursor;
+        //! I/O context reading the view.
+        AVIOContext* m_context;
+    };
+
 protected:
     //! Structure that describes one stream in video file.
     struct StreamInfo
@@ -119,6 +179,12 @@ protected:
     QVector<StreamInfo> m_streams;
     /// Time of last seek in ms
     int m_lastSeekTime;
+    //! Follow mode.
+    bool m_follow;
+    //! Interrupt blocking reads.
+    std::atomic<bool> m_interrupt;
+    //! Input of the format context read through a file view, nullptr if the file is read by ffmpeg.
+    FileInput*  m_file_input;
 };
 
 #endif // MAINCONTEXT_H
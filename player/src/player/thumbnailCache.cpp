@@ -0,0 +1,173 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "thumbnailCache.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include "defines.h"
+#include "parseIndex.h"
+
+#include <atomic>
+
+namespace
+{
+    //! Identifies cache files.
+    const quint32 sc_cache_magic = 0x4F505448; // 'OPTH'
+    //! Has to be increased on every change of the cache format.
+    const quint32 sc_cache_version = 1;
+}
+
+ThumbnailCache::ThumbnailCache(const QString& cache_folder) :
+    m_cache_folder(cache_folder)
+{
+}
+
+bool ThumbnailCache::load(const QString& path)
+{
+    m_thumbnails.clear();
+
+    QFile file(getCachePath(path));
+    if(!file.exists() || !file.open(QIODevice::ReadOnly))
+        return false;
+
+    QByteArray fingerprint_value = ParseIndex::fingerprint(path);
+    if(fingerprint_value.isEmpty())
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    //thumbnails of another size are made again
+    quint32 magic = 0, version = 0, width = 0;
+    QByteArray stored_fingerprint;
+    stream >> magic >> version >> stored_fingerprint >> width;
+    if(magic != sc_cache_magic ||
+       version != sc_cache_version ||
+       stored_fingerprint != fingerprint_value ||
+       width != THUMBNAIL_WIDTH)
+        return false;
+
+    quint32 count = 0;
+    stream >> count;
+    for(quint32 i = 0; (i < count) && (stream.status() == QDataStream::Ok); ++i)
+    {
+        qint32 time_ms = 0;
+        QByteArray data;
+        stream >> time_ms >> data;
+
+        QImage image;
+        if(image.loadFromData(data, "JPG"))
+            m_thumbnails.insert(time_ms, image);
+    }
+
+    if(stream.status() != QDataStream::Ok)
+    {
+        m_thumbnails.clear();
+        return false;
+    }
+
+    //the cache is kept by the pruning as long as it is used
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return true;
+}
+
+bool ThumbnailCache::save(const QString& path) const
+{
+    QByteArray fingerprint_value = ParseIndex::fingerprint(path);
+    if(fingerprint_value.isEmpty())
+        return false;
+
+    QSaveFile file(getCachePath(path));
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    stream << sc_cache_magic << sc_cache_version << fingerprint_value << quint32(THUMBNAIL_WIDTH);
+    stream << quint32(m_thumbnails.size());
+    for(auto it = m_thumbnails.begin(), end = m_thumbnails.end(); it != end; ++it)
+    {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        it.value().save(&buffer, "JPG", THUMBNAIL_CACHE_QUALITY);
+        stream << qint32(it.key()) << data;
+    }
+
+    if(stream.status() != QDataStream::Ok)
+    {
+        file.cancelWriting();
+        return false;
+    }
+    if(!file.commit())
+        return false;
+
+    //the folder is pruned once per run
+    static std::atomic<bool> pruned(false);
+    if(!pruned.exchange(true))
+        ParseIndex::prune(m_cache_folder.isEmpty() ? getCacheFolder() : m_cache_folder, "*.thumbs",
+                          qint64(THUMBNAIL_CACHE_MAX_SIZE) * 1024 * 1024, THUMBNAIL_CACHE_MAX_AGE);
+    return true;
+}
+
+void ThumbnailCache::remove(const QString& path) const
+{
+    QFile::remove(getCachePath(path));
+}
+
+QString ThumbnailCache::getCacheFolder()
+{
+    //next to the parse indexes
+    QString cache_folder = QFileInfo(ParseIndex::getIndexFolder()).path() + "/" + THUMBNAIL_CACHE_FOLDER;
+
+    //create it if needed
+    if(!QDir().exists(cache_folder))
+        QDir().mkpath(cache_folder);
+
+    return cache_folder;
+}
+
+void ThumbnailCache::insert(int time_ms, const QImage& image)
+{
+    m_thumbnails.insert(time_ms, image);
+}
+
+QString ThumbnailCache::getCachePath(const QString& path) const
+{
+    QByteArray path_hash = QCryptographicHash::hash(QFileInfo(path).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1);
+    QString cache_folder = m_cache_folder.isEmpty() ? getCacheFolder() : m_cache_folder;
+    return cache_folder + "/" + QString::fromLatin1(path_hash.toHex()) + ".thumbs";
+}
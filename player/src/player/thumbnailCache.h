@@ -0,0 +1,99 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QImage>
+#include <QMap>
+#include <QString>
+
+//! Thumbnails of a file, stored next to the application settings to show them without decoding on the next opening.
+/*!
+ * \brief The cache is bound to the file contents the same way the parse index is, any change of the file invalidates it.
+ * Thumbnails are kept by their time from the file beginning in ms and stored as JPEG images.
+ * Loading a cache marks it as used, the caches used longest ago are removed above THUMBNAIL_CACHE_MAX_SIZE
+ * or after THUMBNAIL_CACHE_MAX_AGE days, when the first cache of a run is saved, as the parse indexes are.
+ */
+class ThumbnailCache CC_CXX11_FINAL
+{
+public:
+    //! Creates a cache stored in a folder, the default one next to the parse indexes if the folder is empty.
+    explicit ThumbnailCache(const QString& cache_folder = QString());
+
+public:
+    //! Loads the thumbnails of a file.
+    /*!
+     * \return true, if the cache exists and was created for the current file contents
+     */
+    bool load(const QString& path);
+
+    //! Saves the thumbnails of a file.
+    /*!
+     * \return true, if the cache was written
+     */
+    bool save(const QString& path) const;
+
+    //! Removes the cache of a file.
+    void remove(const QString& path) const;
+
+    //! Get default folder where cache files are stored.
+    static QString getCacheFolder();
+
+public:
+    //! Add a thumbnail at a time, replacing the one at the same time.
+    void insert(int time_ms, const QImage& image);
+
+    //! Checks if there is a thumbnail at a time.
+    bool contains(int time_ms) const { return m_thumbnails.contains(time_ms); }
+
+    //! Get count of the thumbnails.
+    int size() const { return m_thumbnails.size(); }
+
+    //! Checks if there are no thumbnails.
+    bool isEmpty() const { return m_thumbnails.isEmpty(); }
+
+    //! Get thumbnails by their time.
+    const QMap<int, QImage>& getThumbnails() const { return m_thumbnails; }
+
+    //! Clear.
+    void clear() { m_thumbnails.clear(); }
+
+private:
+    //! Get path of the cache file of a file.
+    QString getCachePath(const QString& path) const;
+
+private:
+    //! Folder of the cache files, empty for the default one.
+    QString m_cache_folder;
+    //! Thumbnails by time in ms.
+    QMap<int, QImage> m_thumbnails;
+};
+
+#endif // THUMBNAILCACHE_H
@@ -0,0 +1,325 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "thumbnailExtractor.h"
+
+#include "defines.h"
+
+namespace
+{
+    //! Time base of ms.
+    const AVRational sc_ms_time_base = { 1, 1000 };
+}
+
+ThumbnailExtractor::ThumbnailExtractor() :
+    QObject()
+{
+}
+
+ThumbnailExtractor::~ThumbnailExtractor()
+{
+    cancel();
+    //the running step reports its thumbnail to the extractor
+    DecodePool::instance().wait(this);
+}
+
+void ThumbnailExtractor::start(const QStringList& file_names, const QList<SampleIndex>& sample_indexes)
+{
+    cancel();
+    if(file_names.isEmpty())
+        return;
+
+    for(int i = 0; i < file_names.size(); ++i)
+        m_runs.push_back(std::make_shared<Run>(this, file_names.at(i), sample_indexes.value(i)));
+
+    //the cached thumbnails of all files are shown before any file is decoded, then the files are decoded in parallel
+    std::vector<std::shared_ptr<Run> > runs = m_runs;
+    const void* owner = this;
+    DecodePool::instance().run([runs, owner] ()
+    {
+        for(auto it = runs.begin(), end = runs.end(); it != end; ++it)
+            (*it)->loadCache();
+
+        for(auto it = runs.begin(), end = runs.end(); it != end; ++it)
+        {
+            std::shared_ptr<Run> run = *it;
+            DecodePool::instance().runSteps([run] () { return run->step(); }, owner, DecodePool::IndexingPriority);
+        }
+    }, this, DecodePool::IndexingPriority);
+}
+
+void ThumbnailExtractor::cancel()
+{
+    DecodePool::instance().cancel(this);
+
+    //encoding and writing the caches waits for the running steps, so it is left to the pool
+    for(auto it = m_runs.begin(), end = m_runs.end(); it != end; ++it)
+    {
+        std::shared_ptr<Run> run = *it;
+        run->cancel();
+        DecodePool::instance().run([run] () { run->finish(); }, run.get(), DecodePool::IndexingPriority);
+    }
+    m_runs.clear();
+}
+
+ThumbnailExtractor::Run::Run(ThumbnailExtractor* extractor, const QString& file_name, const SampleIndex& sample_index) :
+    m_extractor(extractor),
+    m_reader(AVMEDIA_TYPE_VIDEO),
+    m_file_name(file_name),
+    m_sample_index(sample_index),
+    m_changed(false),
+    m_opened(false),
+    m_finished(false),
+    m_canceled(false),
+    m_frame(av_frame_alloc()),
+    m_packet(av_packet_alloc()),
+    m_sws_context(nullptr)
+{
+}
+
+ThumbnailExtractor::Run::~Run()
+{
+    closeFile();
+    sws_freeContext(m_sws_context);
+    av_packet_free(&m_packet);
+    av_frame_free(&m_frame);
+}
+
+void ThumbnailExtractor::Run::loadCache()
+{
+    QMutexLocker locker(&m_mutex);
+    //the tasks of a canceled extractor may outlive it
+    if(m_canceled || !m_cache.load(m_file_name))
+        return;
+
+    const QMap<int, QImage>& thumbnails = m_cache.getThumbnails();
+    for(auto it = thumbnails.begin(), end = thumbnails.end(); it != end; ++it)
+    {
+        emit m_extractor->thumbnail(m_file_name, it.key(), it.value());
+    }
+}
+
+bool ThumbnailExtractor::Run::step()
+{
+    QMutexLocker locker(&m_mutex);
+    //steps queued by the loading of the caches may start after the cancellation or the final saving
+    if(m_finished || m_canceled)
+        return false;
+
+    if(!m_opened)
+    {
+        m_opened = true;
+        if(openFile())
+            return true;
+    }
+    else if(!m_targets.isEmpty())
+    {
+        makeThumbnail(m_targets.takeFirst());
+        return true;
+    }
+
+    saveCache();
+    closeFile();
+    m_finished = true;
+    return false;
+}
+
+void ThumbnailExtractor::Run::finish()
+{
+    QMutexLocker locker(&m_mutex);
+    saveCache();
+    closeFile();
+    m_finished = true;
+}
+
+bool ThumbnailExtractor::Run::openFile()
+{
+    if(!m_reader.open(m_file_name) ||
+       m_reader.getStreamsCount() == 0)
+        return false;
+
+    m_reader.getCodecContext(0)->skip_frame = AVDISCARD_NONKEY;
+    planTargets(m_reader.getStream(0));
+    return !m_targets.isEmpty();
+}
+
+void ThumbnailExtractor::Run::planTargets(const AVStream* stream)
+{
+    m_targets.clear();
+
+    //the mov demuxer uses the track ids as stream ids
+    auto track = m_sample_index.find((uint32_t)stream->id);
+    bool is_indexed = (track != m_sample_index.end() && !track->isEmpty() && track->getTimescale() != 0);
+
+    int64_t duration_ms = 0;
+    if(is_indexed)
+        duration_ms = (int64_t)track->getDurationMs();
+    else if(stream->duration != AV_NOPTS_VALUE)
+        duration_ms = av_rescale_q(stream->duration, stream->time_base, sc_ms_time_base);
+    if(duration_ms <= 0)
+        return;
+
+    //the slots are visited in halving steps, so every pass doubles the density of the thumbnails over the whole file
+    int count = (int)qBound<int64_t>(1, duration_ms / THUMBNAIL_MIN_INTERVAL, THUMBNAIL_MAX_COUNT);
+    int first_step = 1;
+    while(first_step * 2 < count)
+        first_step *= 2;
+
+    QSet<int> keyframes;
+    for(int step = first_step; step >= 1; step /= 2)
+    {
+        for(int slot = 0; slot < count; slot += step)
+        {
+            if(step != first_step && slot % (step * 2) == 0)
+                continue;
+
+            Target target((int)(duration_ms * slot / count));
+            if(is_indexed)
+            {
+                //slots within a group of pictures share its keyframe
+                int sample = track->findSampleMs((uint64_t)target.m_time_ms);
+                int sync_sample = track->findSyncSample(sample);
+                if(sync_sample < 0)
+                    sync_sample = track->findNextSyncSample(sample);
+                if(sync_sample < 0 || keyframes.contains(sync_sample))
+                    continue;
+                keyframes.insert(sync_sample);
+
+                int64_t composition_time = track->getCompositionTime(sync_sample);
+                target.m_time_ms = (int)track->toMs(composition_time - track->getDecodeTime(0));
+                target.m_timestamp = av_rescale(composition_time, stream->time_base.den, (int64_t)track->getTimescale() * stream->time_base.num);
+            }
+
+            if(!m_cache.contains(target.m_time_ms))
+                m_targets.append(target);
+        }
+    }
+}
+
+void ThumbnailExtractor::Run::makeThumbnail(const Target& target)
+{
+    AVFormatContext* input = m_reader.getFormatContext();
+    AVStream* stream = m_reader.getStream(0);
+    int64_t start_time = (stream->start_time != AV_NOPTS_VALUE) ? stream->start_time : 0;
+    int64_t timestamp = (target.m_timestamp != AV_NOPTS_VALUE) ?
+        target.m_timestamp :
+        start_time + av_rescale_q(target.m_time_ms, sc_ms_time_base, stream->time_base);
+
+    //the demuxer goes back to the keyframe at or before the time
+    if(av_seek_frame(input, stream->index, timestamp, AVSEEK_FLAG_BACKWARD) < 0)
+        return;
+    avcodec_flush_buffers(m_reader.getCodecContext(0));
+
+    int64_t keyframe = decodeKeyframe();
+    if(keyframe == AV_NOPTS_VALUE)
+        return;
+    QImage image = toImage(m_frame);
+    av_frame_unref(m_frame);
+    if(image.isNull())
+        return;
+
+    //files without a sample index are sought by time, so several slots may end at the same keyframe
+    int time_ms = (target.m_timestamp != AV_NOPTS_VALUE) ?
+        target.m_time_ms :
+        (int)av_rescale_q(keyframe - start_time, stream->time_base, sc_ms_time_base);
+    if(m_cache.contains(time_ms))
+        return;
+
+    m_cache.insert(time_ms, image);
+    m_changed = true;
+    emit m_extractor->thumbnail(m_file_name, time_ms, image);
+}
+
+int64_t ThumbnailExtractor::Run::decodeKeyframe()
+{
+    AVFormatContext* input = m_reader.getFormatContext();
+    AVCodecContext* codec = m_reader.getCodecContext(0);
+    int stream_index = m_reader.getStream(0)->index;
+    for(int i = 0; i < THUMBNAIL_READ_PACKETS; ++i)
+    {
+        if(av_read_frame(input, m_packet) < 0)
+            return AV_NOPTS_VALUE;
+
+        if(m_packet->stream_index != stream_index ||
+           (m_packet->flags & AV_PKT_FLAG_KEY) == 0)
+        {
+            av_packet_unref(m_packet);
+            continue;
+        }
+
+        int64_t pts = (m_packet->pts != AV_NOPTS_VALUE) ? m_packet->pts : m_packet->dts;
+        int result = avcodec_send_packet(codec, m_packet);
+        av_packet_unref(m_packet);
+        if(result < 0)
+            return AV_NOPTS_VALUE;
+
+        //decoders hold frames back for reordering, draining gives out the keyframe at once
+        avcodec_send_packet(codec, nullptr);
+        result = avcodec_receive_frame(codec, m_frame);
+        avcodec_flush_buffers(codec);
+        if(result < 0)
+            return AV_NOPTS_VALUE;
+        return (m_frame->best_effort_timestamp != AV_NOPTS_VALUE) ? m_frame->best_effort_timestamp : pts;
+    }
+    return AV_NOPTS_VALUE;
+}
+
+QImage ThumbnailExtractor::Run::toImage(const AVFrame* frame)
+{
+    if(frame->width <= 0 || frame->height <= 0)
+        return QImage();
+
+    //reduced size keeps the aspect ratio of the frame
+    int width = THUMBNAIL_WIDTH;
+    int height = qMax(2, (int)((int64_t)THUMBNAIL_WIDTH * frame->height / frame->width) & ~1);
+    m_sws_context = sws_getCachedContext(m_sws_context,
+                                         frame->width, frame->height, (AVPixelFormat)frame->format,
+                                         width, height, AV_PIX_FMT_RGB32,
+                                         SWS_FAST_BILINEAR, 0, 0, 0);
+    if(m_sws_context == nullptr)
+        return QImage();
+
+    QImage image(width, height, QImage::Format_RGB32);
+    uint8_t* data[4] = { image.bits(), nullptr, nullptr, nullptr };
+    int linesize[4] = { (int)image.bytesPerLine(), 0, 0, 0 };
+    sws_scale(m_sws_context, frame->data, frame->linesize, 0, frame->height, data, linesize);
+    return image;
+}
+
+void ThumbnailExtractor::Run::saveCache()
+{
+    if(!m_changed)
+        return;
+    m_cache.save(m_file_name);
+    m_changed = false;
+}
+
+void ThumbnailExtractor::Run::closeFile()
+{
+    m_targets.clear();
+    m_reader.clear();
+}
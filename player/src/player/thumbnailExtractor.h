@@ -0,0 +1,195 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef THUMBNAILEXTRACTOR_H
+#define THUMBNAILEXTRACTOR_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "decodePool.h"
+#include "ffmpeg.h"
+#include "sampleIndex.h"
+#include "streamReader.h"
+#include "thumbnailCache.h"
+
+//! Makes the thumbnails of the files of a fileset in the background.
+/*!
+ * \brief Only keyframes are decoded, at the times spread over each file, coarse ones first, so the thumbnails
+ * fill the timeline progressively. The keyframes are located in the sample index of the parser,
+ * files without one are sought by time and the first keyframe read is taken.
+ * Thumbnails are kept in a ThumbnailCache of each file, the cached ones of all files are reported before any decoding.
+ * Each file is a separate task of steps on the DecodePool, run as indexing work, so the files are decoded in parallel
+ * on the background threads of the pool. A step makes one thumbnail.
+ * The state of the work is owned by its pool tasks, so canceling does not wait for the running step,
+ * and the caches are saved by a pool task after it.
+ */
+class ThumbnailExtractor : public QObject
+{
+private:
+    Q_OBJECT
+
+public:
+    ThumbnailExtractor();
+
+    ~ThumbnailExtractor();
+
+public:
+    //! Starts making the thumbnails of files.
+    /*!
+     * \param sample_indexes sample index of each file from the parser, they may be empty
+     */
+    void start(const QStringList& file_names, const QList<SampleIndex>& sample_indexes);
+
+    //! Stops making the thumbnails, the ones made so far are cached.
+    void cancel();
+
+signals:
+    //! Emitted for every thumbnail made or loaded from the cache.
+    /*!
+     * \param time_ms time of the keyframe from the file beginning
+     */
+    void thumbnail(QString file_name, int time_ms, QImage image);
+
+private:
+    //! Making of the thumbnails of a file, shared by its pool tasks.
+    class Run CC_CXX11_FINAL
+    {
+    public:
+        Run(ThumbnailExtractor* extractor, const QString& file_name, const SampleIndex& sample_index);
+
+        ~Run();
+
+        //! Loads the cache of the file and reports its thumbnails.
+        void loadCache();
+
+        //! Makes a thumbnail.
+        /*!
+         * \return false, if all thumbnails are made
+         */
+        bool step();
+
+        //! Stops the steps at once, the extractor is left alone by the following ones.
+        void cancel() { m_canceled = true; }
+
+        //! Saves the cache if changed and closes the file, after the running step ended.
+        void finish();
+
+    private:
+        //! Thumbnail to make.
+        struct Target
+        {
+            Target(int time_ms = 0, int64_t timestamp = AV_NOPTS_VALUE) :
+                m_time_ms(time_ms),
+                m_timestamp(timestamp)
+            {}
+
+            //! Time from the file beginning in ms.
+            int m_time_ms;
+            //! Time of the keyframe in the stream time base, AV_NOPTS_VALUE if not known from the sample index.
+            int64_t m_timestamp;
+        };
+
+    private:
+        Run(const Run&);
+        Run& operator =(const Run&);
+
+        //! Opens the file and plans its thumbnails.
+        /*!
+         * \return false, if there is nothing to make
+         */
+        bool openFile();
+
+        //! Plans the thumbnails of the opened file.
+        void planTargets(const AVStream* stream);
+
+        //! Makes the thumbnail of a target.
+        void makeThumbnail(const Target& target);
+
+        //! Decode the first keyframe read.
+        /*!
+         * \return time of the keyframe in the stream time base, or AV_NOPTS_VALUE if no frame was decoded
+         */
+        int64_t decodeKeyframe();
+
+        //! Scale a decoded frame to a thumbnail.
+        QImage toImage(const AVFrame* frame);
+
+        //! Save the cache, if thumbnails were made.
+        void saveCache();
+
+        //! Close the file.
+        void closeFile();
+
+    private:
+        //! Extractor reporting the thumbnails, it waits for the running step before it is destroyed.
+        ThumbnailExtractor* m_extractor;
+        //! Serializes the steps and the final saving.
+        QMutex              m_mutex;
+        //! Reader of the file.
+        StreamReader        m_reader;
+        //! Name of the file.
+        QString             m_file_name;
+        //! Sample index from the parser.
+        SampleIndex         m_sample_index;
+        //! Thumbnails of the file.
+        ThumbnailCache      m_cache;
+        //! Set when thumbnails were made and the cache has to be saved.
+        bool                m_changed;
+        //! Set when the file was opened.
+        bool                m_opened;
+        //! Set when the work ended.
+        bool                m_finished;
+        //! Set when the work was canceled, the steps queued meanwhile end at once.
+        std::atomic<bool>   m_canceled;
+        //! Thumbnails of the file, in the order of making.
+        QList<Target>       m_targets;
+        //! Decoded frame.
+        AVFrame*            m_frame;
+        //! Packet being read.
+        AVPacket*           m_packet;
+        //! Scaling context.
+        SwsContext*         m_sws_context;
+    };
+
+private:
+    //! Making of the files of the current fileset.
+    std::vector<std::shared_ptr<Run> > m_runs;
+};
+
+#endif // THUMBNAILEXTRACTOR_H
@@ -0,0 +1,208 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "traceRecorder.h"
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
+
+#include "defines.h"
+
+namespace
+{
+    //! Count of the oldest spans of a ring skipped by the export, as the thread may be overwriting them meanwhile.
+    const quint64 sc_read_margin = 256;
+
+    //! Releases the buffer of a thread when the thread exits.
+    struct ThreadBufferHolder
+    {
+        ThreadBufferHolder()
+            : m_buffer(nullptr)
+            , m_released(nullptr)
+        {}
+
+        ~ThreadBufferHolder()
+        {
+            if(m_released != nullptr)
+                m_released->store(true, std::memory_order_release);
+        }
+
+        //! Buffer of the thread.
+        void * m_buffer;
+        //! Released flag of the buffer.
+        std::atomic<bool> * m_released;
+    };
+
+    thread_local ThreadBufferHolder t_holder;
+
+    //! Appends a JSON string.
+    void appendString(QByteArray & json, const QByteArray & value)
+    {
+        json += '"';
+        for(auto it = value.begin(), end = value.end(); it != end; ++it)
+        {
+            if(*it == '"' || *it == '\\')
+                json += '\\';
+            json += *it;
+        }
+        json += '"';
+    }
+}
+
+std::atomic<bool> TraceRecorder::sm_enabled(false);
+
+TraceRecorder::ThreadBuffer::ThreadBuffer(quint64 thread_id, const QByteArray & thread_name)
+    : m_thread_id(thread_id)
+    , m_thread_name(thread_name)
+    , m_events(TRACE_BUFFER_SIZE)
+    , m_written(0)
+    , m_cleared(0)
+    , m_released(false)
+{
+}
+
+TraceRecorder::TraceRecorder()
+    : m_origin_ns(PipelineStatistics::now())
+{
+}
+
+TraceRecorder & TraceRecorder::instance()
+{
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+void TraceRecorder::setEnabled(bool enabled)
+{
+    if(enabled && !isEnabled())
+        clear();
+    sm_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void TraceRecorder::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    for(auto it = m_buffers.begin(), end = m_buffers.end(); it != end; ++it)
+        (*it)->m_cleared = (*it)->m_written.load(std::memory_order_acquire);
+    m_origin_ns = PipelineStatistics::now();
+}
+
+void TraceRecorder::add(const char * name, qint64 start_ns, qint64 end_ns)
+{
+    ThreadBuffer * buffer = getThreadBuffer();
+    quint64 written = buffer->m_written.load(std::memory_order_relaxed);
+
+    Event & event = buffer->m_events[written % buffer->m_events.size()];
+    event.m_name = name;
+    event.m_start_ns = start_ns;
+    event.m_duration_ns = end_ns - start_ns;
+
+    buffer->m_written.store(written + 1, std::memory_order_release);
+}
+
+TraceRecorder::ThreadBuffer * TraceRecorder::getThreadBuffer()
+{
+    if(t_holder.m_buffer != nullptr)
+        return static_cast<ThreadBuffer *>(t_holder.m_buffer);
+
+    QThread * thread = QThread::currentThread();
+    QByteArray thread_name = thread->objectName().toUtf8();
+    if(thread_name.isEmpty() && QCoreApplication::instance() != nullptr && thread == QCoreApplication::instance()->thread())
+        thread_name = "GUI";
+
+    QMutexLocker locker(&m_mutex);
+    ThreadBuffer * buffer = nullptr;
+    if(!thread_name.isEmpty())
+    {
+        //restarted threads continue in the buffer of their previous run
+        for(auto it = m_buffers.begin(), end = m_buffers.end(); it != end && buffer == nullptr; ++it)
+        {
+            bool released = true;
+            if((*it)->m_thread_name == thread_name && (*it)->m_released.compare_exchange_strong(released, false, std::memory_order_acquire))
+                buffer = it->get();
+        }
+    }
+    if(buffer == nullptr)
+    {
+        quint64 thread_id = m_buffers.size() + 1;
+        if(thread_name.isEmpty())
+            thread_name = "Thread " + QByteArray::number(thread_id);
+        m_buffers.emplace_back(new ThreadBuffer(thread_id, thread_name));
+        buffer = m_buffers.back().get();
+    }
+
+    t_holder.m_buffer = buffer;
+    t_holder.m_released = &buffer->m_released;
+    return buffer;
+}
+
+QByteArray TraceRecorder::toJson() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    qint64 origin_ns = m_origin_ns;
+
+    QByteArray json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for(auto it = m_buffers.begin(), end = m_buffers.end(); it != end; ++it)
+    {
+        const ThreadBuffer & buffer = **it;
+        QByteArray tid = QByteArray::number(buffer.m_thread_id);
+
+        if(!first)
+            json += ',';
+        first = false;
+        json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":" + tid + ",\"args\":{\"name\":";
+        appendString(json, buffer.m_thread_name);
+        json += "}}";
+
+        quint64 written = buffer.m_written.load(std::memory_order_acquire);
+        quint64 capacity = buffer.m_events.size();
+        quint64 begin = buffer.m_cleared;
+        if(written > capacity - sc_read_margin)
+            begin = std::max(begin, written - capacity + sc_read_margin);
+
+        for(quint64 i = begin; i < written; ++i)
+        {
+            const Event & event = buffer.m_events[i % capacity];
+            if(event.m_start_ns < origin_ns)
+                continue;
+
+            json += ",{\"name\":\"";
+            json += event.m_name;
+            json += "\",\"cat\":\"player\",\"ph\":\"X\",\"pid\":" + pid + ",\"tid\":" + tid;
+            json += ",\"ts\":" + QByteArray::number((event.m_start_ns - origin_ns) / 1000.0, 'f', 3);
+            json += ",\"dur\":" + QByteArray::number(event.m_duration_ns / 1000.0, 'f', 3) + "}";
+        }
+    }
+    json += "]}";
+    return json;
+}
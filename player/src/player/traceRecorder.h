@@ -0,0 +1,156 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include "crosscompilation_cxx11.h"
+#include "crosscompilation_inttypes.h"
+
+#include <QByteArray>
+#include <QMutex>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "pipelineStatistics.h"
+
+//! Timeline of the spans of work done by the player threads, exported as Chrome trace events.
+/*!
+ * \brief Recording is off by default and every span checks a single relaxed flag before reading the clock.
+ * When recording, each thread writes into its own ring buffer, so recording threads never wait for each other;
+ * the buffer keeps the latest TRACE_BUFFER_SIZE spans of the thread.
+ * Span names have to be string literals, only the pointers are kept.
+ * The export is readable by chrome://tracing and Perfetto.
+ */
+class TraceRecorder CC_CXX11_FINAL
+{
+public:
+    //! Returns the recorder of the application.
+    static TraceRecorder & instance();
+
+    //! Checks if spans are recorded.
+    static bool isEnabled() { return sm_enabled.load(std::memory_order_relaxed); }
+
+    //! Records a span started at a time returned by PipelineStatistics::now() and ending now, if recording.
+    static void addSpan(const char * name, qint64 start_ns)
+    {
+        if(isEnabled())
+            instance().add(name, start_ns, PipelineStatistics::now());
+    }
+
+public:
+    //! Starts or stops recording, starting drops the previously recorded spans.
+    void setEnabled(bool enabled);
+
+    //! Drops the recorded spans.
+    void clear();
+
+    //! Returns the recorded spans as Chrome trace event JSON.
+    QByteArray toJson() const;
+
+private:
+    //! Recorded span.
+    struct Event
+    {
+        //! Name of the span.
+        const char * m_name;
+        //! Start time in nanoseconds.
+        qint64 m_start_ns;
+        //! Duration in nanoseconds.
+        qint64 m_duration_ns;
+    };
+
+    //! Spans of a single thread.
+    struct ThreadBuffer
+    {
+        ThreadBuffer(quint64 thread_id, const QByteArray & thread_name);
+
+        //! Identifier of the thread.
+        quint64 m_thread_id;
+        //! Name of the thread.
+        QByteArray m_thread_name;
+        //! Ring of the spans, written only by the thread.
+        std::vector<Event> m_events;
+        //! Count of the spans ever written, published after the span is written.
+        std::atomic<quint64> m_written;
+        //! Count of the written spans at the last clearing, used only under the recorder mutex.
+        quint64 m_cleared;
+        //! Set when the thread exits, a later thread of the same name continues in the buffer.
+        std::atomic<bool> m_released;
+    };
+
+private:
+    TraceRecorder();
+
+    //! Adds a span to the buffer of the current thread.
+    void add(const char * name, qint64 start_ns, qint64 end_ns);
+
+    //! Returns the buffer of the current thread, taking it on the first span of the thread.
+    ThreadBuffer * getThreadBuffer();
+
+private:
+    //! Recording flag.
+    static std::atomic<bool> sm_enabled;
+
+    //! Protects the list of the buffers.
+    mutable QMutex m_mutex;
+    //! Buffers of the threads that recorded spans, kept until the application exits.
+    std::vector<std::unique_ptr<ThreadBuffer> > m_buffers;
+    //! Time the recording started at, all timestamps are relative to it.
+    std::atomic<qint64> m_origin_ns;
+};
+
+//! Records a span lasting until the end of the scope.
+class TraceSpan CC_CXX11_FINAL
+{
+public:
+    //! Starts the span, name has to be a string literal.
+    explicit TraceSpan(const char * name)
+        : m_name(TraceRecorder::isEnabled() ? name : nullptr)
+        , m_start_ns(m_name != nullptr ? PipelineStatistics::now() : 0)
+    {}
+
+    ~TraceSpan()
+    {
+        if(m_name != nullptr)
+            TraceRecorder::addSpan(m_name, m_start_ns);
+    }
+
+private:
+    TraceSpan(const TraceSpan &);
+    TraceSpan & operator =(const TraceSpan &);
+
+private:
+    //! Name of the span, nullptr if not recording.
+    const char * m_name;
+    //! Start time in nanoseconds.
+    qint64 m_start_ns;
+};
+
+#endif // TRACERECORDER_H
@@ -29,6 +29,9 @@
 
 #include <QTimerEvent>
 
+#include "pipelineStatistics.h"
+#include "traceRecorder.h"
+
 #include <QDebug>
 
 VideoPlayback::VideoPlayback() :
@@ -37,7 +40,8 @@ VideoPlayback::VideoPlayback() :
     m_video_decoder(nullptr),
     m_video_widget(nullptr),
     m_timer(-1),
-    m_current_delay(-1)
+    m_current_delay(-1),
+    m_last_present_time(0)
 {
 }
 
@@ -63,6 +67,7 @@ void VideoPlayback::start()
        m_is_playing)
         return;
 
+    m_last_present_time = 0;
     showFrame();
     m_current_delay = m_video_context->getTimerDelay();
     m_timer = startTimer(m_current_delay ,Qt::PreciseTimer);
@@ -98,6 +103,7 @@ void VideoPlayback::resume()
 
     m_current_delay = m_video_context->getTimerDelay();
     m_timer = startTimer(m_current_delay ,Qt::PreciseTimer);
+    m_last_present_time = 0;
 
     m_is_playing = true;
 }
@@ -175,6 +181,7 @@ void VideoPlayback::syncWithAudio(BasePlayback* playback)
 
     int video_time = m_current_frame.m_time;
     int delta = qAbs(video_time - audio_time);
+    PipelineStatistics::instance().setAvDrift(video_time - audio_time);
     if(delta < m_video_context->getTimerDelay())
     {
         //do nothing - video equal to audio
@@ -191,7 +198,10 @@ void VideoPlayback::syncWithAudio(BasePlayback* playback)
                 if(m_video_decoder->getNextFrame(m_current_frame, &widget_size))
                 {
                     if(m_current_frame.m_time < audio_time)
+                    {
                         qDebug() << "Skipping frame" << m_current_frame.m_time << audio_time;
+                        PipelineStatistics::instance().addDroppedFrame();
+                    }
                     else
                         //close enough
                         break;
@@ -234,6 +244,9 @@ void VideoPlayback::timerEvent(QTimerEvent* event)
 
 void VideoPlayback::showFrame(bool single_frame)
 {
+    TraceSpan span("showFrame");
+    qint64 present_start = PipelineStatistics::now();
+
     //
     // Update events
     //
@@ -291,6 +304,14 @@ void VideoPlayback::showFrame(bool single_frame)
 
         emit played(this);
 
+        PipelineStatistics::instance().addSince(PipelineStatistics::Present, present_start);
+        //frame is late, if the timer fired much later than the frame interval
+        if(!single_frame &&
+           m_last_present_time != 0 &&
+           present_start - m_last_present_time > 2 * (qint64)m_current_delay * 1000000)
+            PipelineStatistics::instance().addLateFrame();
+        m_last_present_time = single_frame ? 0 : present_start;
+
         if(!single_frame)
         {
             //maybe we must change timeout
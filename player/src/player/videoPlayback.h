@@ -107,6 +107,8 @@ private:
     int                     m_current_delay;
     //! Image with metadata overlay information
     VideoFrame              m_overlay;
+    //! Monotonic time of the last frame presentation in nanoseconds, 0 after starting or resuming.
+    qint64                  m_last_present_time;
 };
 
 #endif // VIDEOPLAYBACK_H
@@ -0,0 +1,120 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "activityBar.h"
+
+#include "defines.h"
+
+#include <QMouseEvent>
+#include <QPainter>
+
+#include <algorithm>
+
+ActivityBar::ActivityBar(QWidget* parent) :
+    QWidget(parent)
+{
+    setFixedHeight(ACTIVITY_BAR_HEIGHT);
+}
+
+ActivityBar::~ActivityBar()
+{
+
+}
+
+void ActivityBar::setFragmentsList(const SegmentTimeline& timeline)
+{
+    if(timeline.size() != m_timeline.size())
+        m_curves = QVector<ActivityCurve>(timeline.size());
+    m_timeline = timeline;
+    update();
+}
+
+void ActivityBar::setActivity(int fragment_index, const ActivityCurve& curve)
+{
+    if(fragment_index < 0 ||
+       fragment_index >= m_curves.size())
+        return;
+
+    m_curves[fragment_index] = curve;
+    update();
+}
+
+void ActivityBar::clear()
+{
+    m_timeline = SegmentTimeline();
+    m_curves.clear();
+    update();
+}
+
+void ActivityBar::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+
+    double duration = (double)m_timeline.getDuration();
+    int bar_width = width();
+    if(duration <= 0 || bar_width <= 0)
+        return;
+
+    //the strongest second of every column is shown
+    QVector<float> activity(bar_width, 0.0f);
+    QVector<bool> objects(bar_width, false);
+    for(int fragment = 0; fragment < m_curves.size(); ++fragment)
+    {
+        const ActivityCurve& curve = m_curves.at(fragment);
+        double start = (double)m_timeline.getStartOffset(fragment);
+        double fragment_duration = (double)m_timeline.at(fragment).getDuration();
+        for(int second = 0; second < curve.size() && second * 1000.0 < fragment_duration; ++second)
+        {
+            int x_begin = std::min(bar_width - 1, (int)((start + second * 1000.0) * bar_width / duration));
+            int x_end = std::min(bar_width, std::max(x_begin + 1, (int)((start + second * 1000.0 + 1000.0) * bar_width / duration)));
+            for(int x = x_begin; x < x_end; ++x)
+            {
+                activity[x] = std::max(activity[x], curve.getActivity(second));
+                objects[x] = objects[x] || curve.getObjectCount(second) > 0;
+            }
+        }
+    }
+
+    QPainter painter(this);
+    for(int x = 0; x < bar_width; ++x)
+    {
+        //from green for calm to red for busy seconds
+        if(activity[x] > 0.0f)
+            painter.fillRect(x, 0, 1, height(), QColor::fromHsvF(0.33f * (1.0f - activity[x]), 1.0f, 1.0f, 0.3f + 0.7f * activity[x]));
+        if(objects[x])
+            painter.fillRect(x, 0, 1, 2, Qt::blue);
+    }
+}
+
+void ActivityBar::mouseReleaseEvent(QMouseEvent* event)
+{
+    if(!isEnabled() || width() <= 0 || m_timeline.isEmpty())
+        return;
+
+    int value = (int)((double)m_timeline.getDuration() * (double)event->pos().x() / (double)width());
+    emit newValue(std::max(value, 0));
+}
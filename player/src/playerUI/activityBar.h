@@ -0,0 +1,79 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef ACTIVITYBAR_H
+#define ACTIVITYBAR_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QVector>
+#include <QWidget>
+
+#include "activityCurve.h"
+#include "segmentTimeline.h"
+
+//! Heatmap of the activity of the fragments under the timeline slider.
+/*!
+ * \brief The bar spans the whole timeline the same way the slider does, a click seeks to the time under the cursor.
+ * Seconds with metadata objects are marked along the top edge.
+ */
+class ActivityBar : public QWidget
+{
+private:
+    Q_OBJECT
+
+public:
+    ActivityBar(QWidget* parent = 0);
+
+    ~ActivityBar();
+
+    //! Setup fragments, the activity is kept if the fragments stay the same.
+    void setFragmentsList(const SegmentTimeline& timeline);
+
+    //! Set activity of a fragment.
+    void setActivity(int fragment_index, const ActivityCurve& curve);
+
+    //! Clear.
+    void clear();
+
+signals:
+    //! Clicked at a total time.
+    void newValue(int value);
+
+protected:
+    virtual void paintEvent(QPaintEvent* event);
+
+    virtual void mouseReleaseEvent(QMouseEvent* event);
+
+private:
+    //! Fragments timeline.
+    SegmentTimeline         m_timeline;
+    //! Activity of the fragments.
+    QVector<ActivityCurve>  m_curves;
+};
+
+#endif // ACTIVITYBAR_H
@@ -34,6 +34,8 @@
 #include <QTime>
 #include <QDateTime>
 
+#include <algorithm>
+
 ClickableSlider::ClickableSlider(QWidget* parent) :
     QSlider(parent),
     m_segment_index(-1),
@@ -47,9 +49,9 @@ ClickableSlider::~ClickableSlider()
 
 }
 
-void ClickableSlider::setFragmentsList(const SegmentList& fragments_list, int fragment_index)
+void ClickableSlider::setFragmentsList(const SegmentTimeline& timeline, int fragment_index)
 {
-    m_segments = fragments_list;
+    m_timeline = timeline;
     m_segment_index = fragment_index;
 }
 
@@ -64,8 +66,8 @@ void ClickableSlider::mouseMoveEvent(QMouseEvent* event)
 {
     int value = calcValue(event);
 
-    if(m_segments.size() &&
-       m_segments[0].getStartTime().isValid())
+    if(m_timeline.size() &&
+       m_timeline.at(0).getStartTime().isValid())
     {
         //use UTC time for tooltip
         QDateTime time;
@@ -73,30 +75,15 @@ void ClickableSlider::mouseMoveEvent(QMouseEvent* event)
         if(m_segment_index != -1)
         {
             //single fragment
-            time = m_segments[m_segment_index].getStartTime();
+            time = m_timeline.at(m_segment_index).getStartTime();
             time = time.addMSecs(value);
         }
         else
         {
             //find out in which fragment we are
-            int fragment_index = -1;
-            int ms = -1;
-            int length = 0;
-            for(int i = 0; i < m_segments.size(); ++i)
-            {
-                if(length + (int)m_segments[i].getDuration() > value)
-                {
-                    fragment_index = i;
-                    ms = value - length;
-                    break;
-                }
-                else
-                    length += (int)m_segments[i].getDuration();
-            }
-            if(fragment_index == -1)
-                fragment_index = m_segments.size() - 1;
-            time = m_segments[fragment_index].getStartTime();
-            time = time.addMSecs(ms);
+            SegmentTimeline::Position position = m_timeline.locate(uint64_t(std::max(value, 0)));
+            time = m_timeline.at(position.m_index).getStartTime();
+            time = time.addMSecs(position.m_offset);
         }
 
         if(isActiveWindow())
@@ -105,9 +92,9 @@ void ClickableSlider::mouseMoveEvent(QMouseEvent* event)
             QToolTip::showText(mapToGlobal(event->pos()), tool_tip_text, this, rect());
         }
     }
-    else if(m_segments.size() == 0 ||
-            (m_segments.size()  &&
-             !m_segments[0].getStartTime().isValid()))
+    else if(m_timeline.size() == 0 ||
+            (m_timeline.size()  &&
+             !m_timeline.at(0).getStartTime().isValid()))
     {
         //simple playing time
         QTime time;
@@ -117,6 +104,8 @@ void ClickableSlider::mouseMoveEvent(QMouseEvent* event)
             QToolTip::showText(mapToGlobal(event->pos()), time.toString(DATETIME_SHORT_CONVERSION_FORMAT), this, rect());
     }
 
+    emit hoverValue(value);
+
     QSlider::mouseMoveEvent(event);
 }
 
@@ -133,6 +122,13 @@ void ClickableSlider::mouseReleaseEvent(QMouseEvent* event)
     QSlider::mouseReleaseEvent(event);
 }
 
+void ClickableSlider::leaveEvent(QEvent* event)
+{
+    emit hoverLeft();
+
+    QSlider::leaveEvent(event);
+}
+
 int ClickableSlider::calcValue(QMouseEvent* event)
 {
     int value = 0;
@@ -32,7 +32,7 @@
 
 #include <QSlider>
 
-#include "segmentInfo.h"
+#include "segmentTimeline.h"
 
 //! Custom slider that can send signal by mose click.
 class ClickableSlider : public QSlider
@@ -45,11 +45,17 @@ public:
 
     ~ClickableSlider();
 
-    void setFragmentsList(const SegmentList& fragments_list, int fragment_index = -1);
+    void setFragmentsList(const SegmentTimeline& timeline, int fragment_index = -1);
 
 signals:
     void newValue(int value);
 
+    //! Mouse moved over the slider at a value.
+    void hoverValue(int value);
+
+    //! Mouse left the slider.
+    void hoverLeft();
+
 protected:
     virtual void mousePressEvent(QMouseEvent* event);
 
@@ -57,12 +63,14 @@ protected:
 
     virtual void mouseReleaseEvent(QMouseEvent* event);
 
+    virtual void leaveEvent(QEvent* event);
+
 private:
     int calcValue(QMouseEvent* event);
 
 private:
-    //! List of fragments - used to define tooltip message.
-    SegmentList   m_segments;
+    //! Timeline of fragments - used to define tooltip message.
+    SegmentTimeline m_timeline;
     //! Index of fragment to use to define tooltip message.
     int             m_segment_index;
     //! Was mouse pressed or not.
@@ -47,6 +47,7 @@ ControlsWidget::ControlsWidget(QWidget* parent) :
     m_mute(false),
     m_old_volume(0),
     m_fullscreen_mode(false),
+    m_preview(nullptr),
 	m_showLocalTime(true)
 {
     m_ui->setupUi(this);
@@ -74,6 +75,13 @@ ControlsWidget::ControlsWidget(QWidget* parent) :
     QObject::connect(m_ui->prev_btn, SIGNAL(clicked()), this, SIGNAL(prevFragment()));
     QObject::connect(m_ui->next_btn, SIGNAL(clicked()), this, SIGNAL(nextFragment()));
     QObject::connect(m_ui->total_position, SIGNAL(newValue(int)), this, SLOT(onTotalValue(int)));
+    QObject::connect(m_ui->activity, SIGNAL(newValue(int)), this, SLOT(onTotalValue(int)));
+    QObject::connect(m_ui->thumbnails, SIGNAL(newValue(int)), this, SLOT(onTotalValue(int)));
+    QObject::connect(m_ui->total_position, SIGNAL(hoverValue(int)), this, SLOT(onSliderHover(int)));
+    QObject::connect(m_ui->total_position, SIGNAL(hoverLeft()), this, SLOT(onSliderLeft()));
+
+    m_preview = new QLabel(this, Qt::ToolTip);
+    m_preview->hide();
     QObject::connect(m_ui->fullscreen_btn, SIGNAL(clicked()), this, SIGNAL(fullscreen()));
 
     enableUI(false);
@@ -88,10 +96,10 @@ ControlsWidget::~ControlsWidget()
 
 void ControlsWidget::setFragmentsList(const SegmentList& segments)
 {
-    m_segments = segments;
+    m_timeline = SegmentTimeline(segments);
     m_current_segment = 0;
     m_segment_position = 0;
-    if(m_segments.size() == 1)
+    if(m_timeline.size() == 1)
     {
         m_ui->prev_btn->setEnabled(false);
         m_ui->next_btn->setEnabled(false);
@@ -100,13 +108,28 @@ void ControlsWidget::setFragmentsList(const SegmentList& segments)
     {
         m_ui->prev_btn->setEnabled(false);
     }
-    m_ui->total_position->setFragmentsList(m_segments);
+    m_ui->total_position->setFragmentsList(m_timeline);
+    m_ui->activity->setFragmentsList(m_timeline);
+    m_ui->thumbnails->setFragmentsList(m_timeline);
+}
+
+void ControlsWidget::updateFragmentsList(const SegmentList& segments)
+{
+    if(segments.size() != m_timeline.size())
+    {
+        setFragmentsList(segments);
+        return;
+    }
+    m_timeline = SegmentTimeline(segments);
+    m_ui->total_position->setFragmentsList(m_timeline);
+    m_ui->activity->setFragmentsList(m_timeline);
+    m_ui->thumbnails->setFragmentsList(m_timeline);
 }
 
 void ControlsWidget::startFragment(int fragment_index)
 {
     if(fragment_index < 0 ||
-       fragment_index >= m_segments.size())
+       fragment_index >= m_timeline.size())
         return;
 
     m_current_segment = fragment_index;
@@ -116,7 +139,7 @@ void ControlsWidget::startFragment(int fragment_index)
         m_ui->prev_btn->setEnabled(false);
         m_ui->next_btn->setEnabled(true);
     }
-    else if(m_current_segment == m_segments.size() - 1)
+    else if(m_current_segment == m_timeline.size() - 1)
     {
         m_ui->prev_btn->setEnabled(true);
         m_ui->next_btn->setEnabled(false);
@@ -128,6 +151,16 @@ void ControlsWidget::startFragment(int fragment_index)
     }
 }
 
+void ControlsWidget::setActivity(int fragment_index, const ActivityCurve& curve)
+{
+    m_ui->activity->setActivity(fragment_index, curve);
+}
+
+void ControlsWidget::addThumbnail(int fragment_index, int time_ms, const QImage& image)
+{
+    m_ui->thumbnails->addThumbnail(fragment_index, time_ms, image);
+}
+
 void ControlsWidget::setPlayedTime(BasePlayback* playback)
 {
     m_segment_position = playback->getPlayingTime();
@@ -137,7 +170,10 @@ void ControlsWidget::clear()
 {
     m_player_state = Stopped;
     setPlayBtnIcon();
-    m_segments.clear();
+    m_timeline = SegmentTimeline();
+    m_ui->activity->clear();
+    m_ui->thumbnails->clear();
+    m_preview->hide();
     m_current_segment = -1;
     m_mute = false;
     setMuteBtnIcon();
@@ -169,6 +205,8 @@ void ControlsWidget::enableUI(bool enable)
     m_ui->play_btn->setEnabled(enable);
     m_ui->stop_btn->setEnabled(enable);
     m_ui->total_position->setEnabled(enable);
+    m_ui->activity->setEnabled(enable);
+    m_ui->thumbnails->setEnabled(enable);
     m_ui->mute_btn->setEnabled(enable);
     m_ui->volume->setEnabled(enable);
     m_ui->prev_btn->setEnabled(enable);
@@ -259,18 +297,15 @@ void ControlsWidget::setMuteBtnIcon()
 
 int ControlsWidget::calcTotalMaximum()
 {
-    int total_length = 0;
-    for(int i = 0; i < m_segments.size(); ++i)
-        total_length += (int)m_segments[i].getDuration();
-    return total_length;
+    return (int)m_timeline.getDuration();
 }
 
 int ControlsWidget::calcTotalCurrent()
 {
     int total_current = 0;
-    for(int i = 0; i < m_segments.size(); ++i)
-        if(i < m_current_segment)
-            total_current += (int)m_segments[i].getDuration();
+    if(m_current_segment >= 0 &&
+       m_current_segment < m_timeline.size())
+        total_current = (int)m_timeline.getStartOffset(m_current_segment);
     total_current += m_segment_position;
     return total_current;
 }
@@ -284,14 +319,14 @@ void ControlsWidget::setTimePositions()
 
 void ControlsWidget::setTimeLabels()
 {
-    if(m_segments.size() &&
-       m_segments[0].getStartTime().isValid())
+    if(m_timeline.size() &&
+       m_timeline.at(0).getStartTime().isValid())
     {
         //use UTC time
         QString current_time   = "";
-        if(m_segments.size())
+        if(m_timeline.size())
         {
-            QDateTime cur_time = m_segments[m_current_segment].getStartTime().addMSecs(m_segment_position);
+            QDateTime cur_time = m_timeline.at(m_current_segment).getStartTime().addMSecs(m_segment_position);
             if (m_showLocalTime) current_time = cur_time.toLocalTime().toString(DATETIME_CONVERSION_FORMAT);
 			else current_time = cur_time.toString("dd-MM-yyyy hh:mm:ss.zzz");
         }
@@ -359,25 +394,16 @@ void ControlsWidget::onFragmentValue(int value)
 void ControlsWidget::onTotalValue(int value)
 {
     //find out fragment index
-    int fragment_index = -1;
-    int ms = -1;
-    int length = 0;
-    for(int i = 0; i < m_segments.size(); ++i)
-    {
-        if(length + (int)m_segments[i].getDuration() > value)
-        {
-            fragment_index = i;
-            ms = value - length;
-            break;
-        }
-        else
-            length += (int)m_segments[i].getDuration();
-    }
+    SegmentTimeline::Position position = m_timeline.locate(uint64_t(value > 0 ? value : 0));
+    if(!position.isValid())
+        return;
+
+    int ms = (int)position.m_offset;
     m_segment_position = ms;
-    if(fragment_index == m_current_segment)
+    if(position.m_index == m_current_segment)
         emit fragment(ms);
     else
-        emit total(fragment_index, ms);
+        emit total(position.m_index, ms);
 }
 
 void ControlsWidget::onMute()
@@ -394,3 +420,27 @@ void ControlsWidget::onMute()
     }
     setMuteBtnIcon();
 }
+
+void ControlsWidget::onSliderHover(int value)
+{
+    QImage image = m_ui->thumbnails->getThumbnail(value);
+    if(image.isNull())
+    {
+        m_preview->hide();
+        return;
+    }
+
+    m_preview->setPixmap(QPixmap::fromImage(image));
+    m_preview->adjustSize();
+
+    //above the cursor, the time tool tip is shown below it
+    int maximum = qMax(1, m_ui->total_position->maximum());
+    int x = (int)((double)value * m_ui->total_position->width() / maximum);
+    m_preview->move(m_ui->total_position->mapToGlobal(QPoint(x - m_preview->width() / 2, -m_preview->height() - 4)));
+    m_preview->show();
+}
+
+void ControlsWidget::onSliderLeft()
+{
+    m_preview->hide();
+}
@@ -30,11 +30,14 @@
 
 #include "crosscompilation_cxx11.h"
 
+#include <QImage>
+#include <QLabel>
 #include <QWidget>
 
 #include "enums.h"
-#include "segmentInfo.h"
+#include "segmentTimeline.h"
 #include "basePlayback.h"
+#include "activityCurve.h"
 
 namespace Ui {
 class ControlsWidget;
@@ -54,9 +57,18 @@ public:
     //! Setup fragments.
     void setFragmentsList(const SegmentList& fragments_list);
 
+    //! Update fragments durations keeping the playing position, e.g. when a followed file has grown.
+    void updateFragmentsList(const SegmentList& fragments_list);
+
     //! Start playback with selected length at some total position.
     void startFragment(int fragment_index);
 
+    //! Show the activity of a fragment under the timeline.
+    void setActivity(int fragment_index, const ActivityCurve& curve);
+
+    //! Add a keyframe thumbnail of a fragment at a time from the fragment beginning.
+    void addThumbnail(int fragment_index, int time_ms, const QImage& image);
+
 	//! Setup time labels.
 	void setTimeLabels();
 
@@ -160,13 +172,19 @@ private slots:
     //! Mute button pressed.
     void onMute();
 
+    //! Mouse moved over the total slider, shows the thumbnail preview.
+    void onSliderHover(int value);
+
+    //! Mouse left the total slider.
+    void onSliderLeft();
+
 private:
     //! UI.
     Ui::ControlsWidget* m_ui;
     //! Player state.
     PlayerState         m_player_state;
-    //! Fragments list.
-    SegmentList       m_segments;
+    //! Fragments timeline.
+    SegmentTimeline     m_timeline;
     //! Currently playing fragment.
     int                 m_current_segment;
     //! Current position in fragment.
@@ -177,6 +195,8 @@ private:
     int                 m_old_volume;
     //! Is in fullscreen mode.
     bool                m_fullscreen_mode;
+    //! Thumbnail preview shown over the total slider.
+    QLabel*             m_preview;
 public:
 	bool				m_showLocalTime;
 };
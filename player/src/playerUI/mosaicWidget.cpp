@@ -0,0 +1,180 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "mosaicWidget.h"
+
+#include <QCloseEvent>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QResizeEvent>
+#include <QTime>
+
+#include "defines.h"
+#include "stallWatchdog.h"
+
+MosaicWidget::MosaicWidget(QWidget* parent) :
+    QWidget(parent),
+    m_slider(Qt::Horizontal, this),
+    m_time(0)
+{
+    setWindowTitle("Mosaic");
+    setFocusPolicy(Qt::StrongFocus);
+    resize(1280, 760);
+
+    m_slider.setFocusPolicy(Qt::NoFocus);
+    QObject::connect(&m_slider, SIGNAL(sliderReleased()), this, SLOT(onSliderReleased()));
+}
+
+MosaicWidget::~MosaicWidget()
+{
+
+}
+
+void MosaicWidget::setTileCount(int count)
+{
+    m_tiles.clear();
+    m_tiles.resize(count);
+    updateLayout();
+    update();
+}
+
+void MosaicWidget::setTile(int index, const QImage& image, const QString& name, bool primary, bool degraded)
+{
+    if(index < 0 || index >= m_tiles.size())
+        return;
+
+    TileView& tile = m_tiles[index];
+    tile.m_image = image;
+    tile.m_name = name;
+    tile.m_primary = primary;
+    tile.m_degraded = degraded;
+    update(m_layout.getTileRect(index));
+}
+
+void MosaicWidget::setTime(int time_ms, int duration_ms)
+{
+    if(m_slider.maximum() != duration_ms)
+        m_slider.setRange(0, duration_ms);
+    if(!m_slider.isSliderDown())
+        m_slider.setValue(time_ms);
+
+    //title shows whole seconds
+    if(time_ms / 1000 != m_time / 1000)
+        setWindowTitle("Mosaic - " + QTime(0, 0).addMSecs(time_ms).toString("hh:mm:ss") + " / " +
+                       QTime(0, 0).addMSecs(duration_ms).toString("hh:mm:ss"));
+    m_time = time_ms;
+}
+
+void MosaicWidget::paintEvent(QPaintEvent* event)
+{
+    StallScope scope("MosaicWidget::paintEvent");
+
+    QPainter painter(this);
+    painter.fillRect(event->rect(), Qt::black);
+    for(int i = 0; i < m_tiles.size(); ++i)
+    {
+        QRect rect = m_layout.getTileRect(i);
+        if(!rect.intersects(event->rect()))
+            continue;
+
+        const TileView& tile = m_tiles[i];
+        if(!tile.m_image.isNull())
+        {
+            //frames are decoded at the cell size, older frames may have another size
+            QSize size = tile.m_image.size().scaled(rect.size(), Qt::KeepAspectRatio);
+            QRect image_rect(rect.left() + (rect.width() - size.width()) / 2, rect.top() + (rect.height() - size.height()) / 2,
+                             size.width(), size.height());
+            painter.drawImage(image_rect, tile.m_image);
+        }
+
+        QString label = tile.m_name;
+        if(tile.m_degraded)
+            label += " (keyframes)";
+        QRect text_rect = painter.boundingRect(rect.adjusted(STATISTICS_OVERLAY_MARGIN, STATISTICS_OVERLAY_MARGIN, 0, 0),
+                                               Qt::AlignLeft | Qt::AlignTop, label);
+        painter.fillRect(text_rect, QColor(0, 0, 0, 160));
+        painter.setPen(Qt::white);
+        painter.drawText(text_rect, Qt::AlignLeft | Qt::AlignTop, label);
+
+        painter.setPen(tile.m_primary ? Qt::yellow : Qt::darkGray);
+        painter.drawRect(rect.adjusted(0, 0, -1, -1));
+    }
+}
+
+void MosaicWidget::resizeEvent(QResizeEvent* event)
+{
+    Q_UNUSED(event);
+
+    int slider_height = m_slider.sizeHint().height();
+    m_slider.setGeometry(0, height() - slider_height, width(), slider_height);
+    updateLayout();
+}
+
+void MosaicWidget::mousePressEvent(QMouseEvent* event)
+{
+    QWidget::mousePressEvent(event);
+
+    int index = m_layout.getTileAt(event->pos());
+    if(index != -1)
+        emit tileSelected(index);
+}
+
+void MosaicWidget::keyPressEvent(QKeyEvent* event)
+{
+    QWidget::keyPressEvent(event);
+
+    if(event->key() == Qt::Key_Space)
+        emit playPause();
+    else if(event->key() == Qt::Key_Left)
+        emit seek(qMax(0, m_time - MOSAIC_SEEK_STEP));
+    else if(event->key() == Qt::Key_Right)
+        emit seek(m_time + MOSAIC_SEEK_STEP);
+    else if(event->key() == Qt::Key_Escape)
+        close();
+}
+
+void MosaicWidget::closeEvent(QCloseEvent* event)
+{
+    QWidget::closeEvent(event);
+
+    emit closed();
+}
+
+void MosaicWidget::onSliderReleased()
+{
+    emit seek(m_slider.value());
+}
+
+void MosaicWidget::updateLayout()
+{
+    QRect area(0, 0, width(), height() - m_slider.height());
+    QSize old_size = m_layout.getTileSize();
+    m_layout = MosaicLayout(m_tiles.size(), area);
+    if(m_layout.getTileSize() != old_size)
+        emit tileSizeChanged(m_layout.getTileSize());
+}
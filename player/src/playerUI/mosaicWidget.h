@@ -0,0 +1,129 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef MOSAICWIDGET_H
+#define MOSAICWIDGET_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QImage>
+#include <QSlider>
+#include <QVector>
+#include <QWidget>
+
+#include "mosaicLayout.h"
+
+//! Window showing the tiles of a mosaic playback in a grid, with a slider of the mosaic timeline.
+class MosaicWidget : public QWidget
+{
+private:
+    Q_OBJECT
+
+public:
+    MosaicWidget(QWidget* parent = 0);
+
+    ~MosaicWidget();
+
+    //! Set count of the tiles, clears them.
+    void setTileCount(int count);
+
+    //! Set the frame and the state of a tile.
+    void setTile(int index, const QImage& image, const QString& name, bool primary, bool degraded);
+
+    //! Set clock time and length of the timeline.
+    void setTime(int time_ms, int duration_ms);
+
+signals:
+    //! Space pressed - pause or play.
+    void playPause();
+
+    //! Slider released or arrow pressed - seek to a time.
+    void seek(int time_ms);
+
+    //! A tile was clicked.
+    void tileSelected(int index);
+
+    //! Size of the grid cells changed.
+    void tileSizeChanged(const QSize& size);
+
+    //! Window closed.
+    void closed();
+
+protected:
+    //! Paint event.
+    virtual void paintEvent(QPaintEvent* event);
+
+    //! Resize event.
+    virtual void resizeEvent(QResizeEvent* event);
+
+    //! Mouse pressed event.
+    virtual void mousePressEvent(QMouseEvent* event);
+
+    //! Keyboard pressed event.
+    virtual void keyPressEvent(QKeyEvent* event);
+
+    //! On close event.
+    virtual void closeEvent(QCloseEvent* event);
+
+private slots:
+    //! Slider released - seek to its position.
+    void onSliderReleased();
+
+private:
+    //! Recalculate the grid for the widget size.
+    void updateLayout();
+
+private:
+    //! Presented state of a tile.
+    struct TileView
+    {
+        TileView() :
+            m_primary(false),
+            m_degraded(false)
+        {}
+
+        //! Frame of the tile.
+        QImage m_image;
+        //! Name of the tile.
+        QString m_name;
+        //! Is the tile the primary one.
+        bool m_primary;
+        //! Does the tile decode keyframes only.
+        bool m_degraded;
+    };
+
+    //! Tiles in the grid order.
+    QVector<TileView>   m_tiles;
+    //! Grid of the tiles.
+    MosaicLayout        m_layout;
+    //! Slider of the timeline.
+    QSlider             m_slider;
+    //! Clock time in ms.
+    int                 m_time;
+};
+
+#endif // MOSAICWIDGET_H
@@ -31,6 +31,7 @@
 #include <QCloseEvent>
 #include <QFileDialog>
 #include <QSettings>
+#include <QTime>
 
 #include "defines.h"
 
@@ -51,11 +52,21 @@ PlayerWidget::PlayerWidget(QWidget* parent) :
     m_ui->video_layout->addWidget(&m_video_frame);
 
     QObject::connect(m_ui->actionOpen, SIGNAL(triggered()), this, SLOT(onOpenFile()));
+    QObject::connect(m_ui->actionOpenFolder, SIGNAL(triggered()), this, SLOT(onOpenDir()));
+    QObject::connect(m_ui->actionFollowRecording, SIGNAL(triggered()), this, SLOT(onFollowFile()));
+    QObject::connect(m_ui->actionOpenMosaic, SIGNAL(triggered()), this, SLOT(onOpenMosaic()));
+    QObject::connect(m_ui->actionMarkClipStart, SIGNAL(triggered()), this, SIGNAL(markClipStart()));
+    QObject::connect(m_ui->actionMarkClipEnd, SIGNAL(triggered()), this, SIGNAL(markClipEnd()));
+    QObject::connect(m_ui->actionExportClip, SIGNAL(triggered()), this, SLOT(onExportClip()));
     QObject::connect(m_ui->actionFile_structure, SIGNAL(triggered()), this, SIGNAL(showFileStructure()));
     QObject::connect(m_ui->actionFile_signature, SIGNAL(triggered()), this, SIGNAL(verifyFileSignature()));
     QObject::connect(m_ui->actionCertificate_storage, SIGNAL(triggered()), this, SIGNAL(openCertificateStorage()));
     QObject::connect(m_ui->actionExit, SIGNAL(triggered()), this, SIGNAL(exit()));
 	QObject::connect(m_ui->actionLocalTime, SIGNAL(triggered()), this, SLOT(showLocalTime()));
+    QObject::connect(m_ui->actionStatistics, SIGNAL(triggered()), this, SLOT(showStatistics()));
+    QObject::connect(m_ui->actionSaveStatistics, SIGNAL(triggered()), this, SLOT(onSaveStatistics()));
+    QObject::connect(m_ui->actionRecordTrace, SIGNAL(triggered()), this, SLOT(recordTrace()));
+    QObject::connect(m_ui->actionSaveTrace, SIGNAL(triggered()), this, SLOT(onSaveTrace()));
 #ifdef MEMORY_INFO
     QObject::connect(m_ui->actionMemory, SIGNAL(triggered()), this, SIGNAL(memoryInfo()));
 #endif //MEMORY_INFO
@@ -79,6 +90,20 @@ void PlayerWidget::setStreamsInfo(int video_streams_count, int audio_streams_cou
     setStreamsMenu(m_ui->menuAudio_streams, audio_streams_count, false);
 }
 
+void PlayerWidget::setClipMarks(int start_ms, int end_ms)
+{
+    QString start_text = "Mark clip start";
+    if(start_ms >= 0)
+        start_text += " (" + QTime(0, 0).addMSecs(start_ms).toString("hh:mm:ss.zzz") + ")";
+    QString end_text = "Mark clip end";
+    if(end_ms >= 0)
+        end_text += " (" + QTime(0, 0).addMSecs(end_ms).toString("hh:mm:ss.zzz") + ")";
+
+    m_ui->actionMarkClipStart->setText(start_text);
+    m_ui->actionMarkClipEnd->setText(end_text);
+    m_ui->actionExportClip->setEnabled(start_ms >= 0 && end_ms > start_ms);
+}
+
 PlayerWidget::~PlayerWidget()
 {
     delete m_ui;
@@ -137,6 +162,45 @@ void PlayerWidget::onOpenFile()
     }
 }
 
+void PlayerWidget::onOpenDir()
+{
+    QString dir_name = QFileDialog::getExistingDirectory(this, "Open folder", getLastOpenedFolder());
+    if(!dir_name.isEmpty())
+    {
+        saveLastOpenedFolder(dir_name);
+        emit openDir(dir_name);
+    }
+}
+
+void PlayerWidget::onFollowFile()
+{
+    QString file_name = QFileDialog::getOpenFileName(this, "Follow recording", getLastOpenedFolder(), AVAILIBLE_EXTENTIONS);
+    if(!file_name.isEmpty())
+    {
+        QFileInfo file_info(file_name);
+        saveLastOpenedFolder(file_info.absolutePath());
+        emit followFile(file_name);
+    }
+}
+
+void PlayerWidget::onOpenMosaic()
+{
+    QStringList file_names = QFileDialog::getOpenFileNames(this, "Open mosaic", getLastOpenedFolder(), AVAILIBLE_EXTENTIONS);
+    if(!file_names.isEmpty())
+    {
+        QFileInfo file_info(file_names.front());
+        saveLastOpenedFolder(file_info.absolutePath());
+        emit openMosaic(file_names);
+    }
+}
+
+void PlayerWidget::onExportClip()
+{
+    QString file_name = QFileDialog::getSaveFileName(this, "Export clip", getLastOpenedFolder(), CLIP_FILE_FILTER);
+    if(!file_name.isEmpty())
+        emit exportClip(file_name);
+}
+
 void PlayerWidget::onVideoStreamSelected()
 {
     QAction* action = (QAction*)sender();
@@ -164,4 +228,28 @@ void PlayerWidget::onAudioStreamSelected()
 void PlayerWidget::showLocalTime()
 {
 	emit showLocalTimeChanged((bool)((QAction*)sender())->isChecked());
+}
+
+void PlayerWidget::showStatistics()
+{
+    emit showStatisticsChanged(m_ui->actionStatistics->isChecked());
+}
+
+void PlayerWidget::onSaveStatistics()
+{
+    QString file_name = QFileDialog::getSaveFileName(this, "Save statistics", getLastOpenedFolder(), STATISTICS_FILE_FILTER);
+    if(!file_name.isEmpty())
+        emit saveStatistics(file_name);
+}
+
+void PlayerWidget::recordTrace()
+{
+    emit recordTraceChanged(m_ui->actionRecordTrace->isChecked());
+}
+
+void PlayerWidget::onSaveTrace()
+{
+    QString file_name = QFileDialog::getSaveFileName(this, "Save trace", getLastOpenedFolder(), TRACE_FILE_FILTER);
+    if(!file_name.isEmpty())
+        emit saveTrace(file_name);
 }
\ No newline at end of file
@@ -64,10 +64,31 @@ public:
     //! Fill streams info
     void setStreamsInfo(int video_streams_count, int audio_streams_count);
 
+    //! Show the marks of the clip to export, -1 for a mark not set.
+    void setClipMarks(int start_ms, int end_ms);
+
 signals:
     //! Some file selected in Open File dialog.
     void openFile(const QString& fileName);
 
+    //! Some folder selected in Open Folder dialog.
+    void openDir(const QString& dirName);
+
+    //! Some file selected in Follow Recording dialog.
+    void followFile(const QString& fileName);
+
+    //! Some files selected in Open Mosaic dialog.
+    void openMosaic(const QStringList& fileNames);
+
+    //! Mark clip start menu item selected.
+    void markClipStart();
+
+    //! Mark clip end menu item selected.
+    void markClipEnd();
+
+    //! Some file selected in Export Clip dialog.
+    void exportClip(const QString& fileName);
+
     //! Verify File structure item seleceted.
     void showFileStructure();
 
@@ -92,6 +113,18 @@ signals:
 	//! Use local or utc time
 	void showLocalTimeChanged(bool on);
 
+    //! Show or hide the statistics overlay.
+    void showStatisticsChanged(bool on);
+
+    //! Some file selected in Save Statistics dialog.
+    void saveStatistics(const QString& fileName);
+
+    //! Start or stop recording the trace.
+    void recordTraceChanged(bool on);
+
+    //! Some file selected in Save Trace dialog.
+    void saveTrace(const QString& fileName);
+
 protected:
     //! On close event.
     virtual void closeEvent(QCloseEvent* event);
@@ -110,6 +143,18 @@ private slots:
     //! Process open file menu selection.
     void onOpenFile();
 
+    //! Process open folder menu selection.
+    void onOpenDir();
+
+    //! Process follow recording menu selection.
+    void onFollowFile();
+
+    //! Process open mosaic menu selection.
+    void onOpenMosaic();
+
+    //! Process export clip menu selection.
+    void onExportClip();
+
     //! Select video stream signal.
     void onVideoStreamSelected();
 
@@ -119,6 +164,18 @@ private slots:
 	//! Use local or utc time
 	void showLocalTime();
 
+    //! Process show statistics menu selection.
+    void showStatistics();
+
+    //! Process save statistics menu selection.
+    void onSaveStatistics();
+
+    //! Process record trace menu selection.
+    void recordTrace();
+
+    //! Process save trace menu selection.
+    void onSaveTrace();
+
 private:
     //! UI.
     Ui::PlayerWidget*   m_ui;
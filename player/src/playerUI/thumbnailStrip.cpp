@@ -0,0 +1,122 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "thumbnailStrip.h"
+
+#include "defines.h"
+
+#include <QMouseEvent>
+#include <QPainter>
+
+#include <algorithm>
+
+ThumbnailStrip::ThumbnailStrip(QWidget* parent) :
+    QWidget(parent)
+{
+    setFixedHeight(THUMBNAIL_STRIP_HEIGHT);
+    hide();
+}
+
+ThumbnailStrip::~ThumbnailStrip()
+{
+
+}
+
+void ThumbnailStrip::setFragmentsList(const SegmentTimeline& timeline)
+{
+    if(timeline.size() != m_timeline.size())
+        m_thumbnails = QVector<QMap<int, QImage> >(timeline.size());
+    m_timeline = timeline;
+    update();
+}
+
+void ThumbnailStrip::addThumbnail(int fragment_index, int time_ms, const QImage& image)
+{
+    if(fragment_index < 0 ||
+       fragment_index >= m_thumbnails.size())
+        return;
+
+    m_thumbnails[fragment_index].insert(time_ms, image);
+    if(isHidden())
+        show();
+    update();
+}
+
+QImage ThumbnailStrip::getThumbnail(int value) const
+{
+    SegmentTimeline::Position position = m_timeline.locate(uint64_t(std::max(value, 0)));
+    if(!position.isValid() ||
+       position.m_index >= m_thumbnails.size())
+        return QImage();
+
+    //the first thumbnail stands for the times before it
+    const QMap<int, QImage>& thumbnails = m_thumbnails.at(position.m_index);
+    if(thumbnails.isEmpty())
+        return QImage();
+    auto it = thumbnails.upperBound((int)position.m_offset);
+    if(it != thumbnails.begin())
+        --it;
+    return it.value();
+}
+
+void ThumbnailStrip::clear()
+{
+    m_timeline = SegmentTimeline();
+    m_thumbnails.clear();
+    hide();
+}
+
+void ThumbnailStrip::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+
+    double duration = (double)m_timeline.getDuration();
+    if(duration <= 0 || width() <= 0)
+        return;
+
+    //tiles of the thumbnail aspect ratio, the first one stands for all
+    QImage first = getThumbnail(0);
+    double aspect = (!first.isNull() && first.height() > 0) ? (double)first.width() / first.height() : 16.0 / 9.0;
+    int tile_width = std::max(1, (int)(height() * aspect));
+
+    QPainter painter(this);
+    for(int x = 0; x < width(); x += tile_width)
+    {
+        QImage image = getThumbnail((int)((x + tile_width / 2) * duration / width()));
+        if(!image.isNull())
+            painter.drawImage(QRect(x, 0, tile_width, height()), image);
+    }
+}
+
+void ThumbnailStrip::mouseReleaseEvent(QMouseEvent* event)
+{
+    if(!isEnabled() || width() <= 0 || m_timeline.isEmpty())
+        return;
+
+    int value = (int)((double)m_timeline.getDuration() * (double)event->pos().x() / (double)width());
+    emit newValue(std::max(value, 0));
+}
@@ -0,0 +1,84 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef THUMBNAILSTRIP_H
+#define THUMBNAILSTRIP_H
+
+#include "crosscompilation_cxx11.h"
+
+#include <QImage>
+#include <QMap>
+#include <QVector>
+#include <QWidget>
+
+#include "segmentTimeline.h"
+
+//! Strip of the keyframe thumbnails of the fragments above the timeline slider.
+/*!
+ * \brief The strip spans the whole timeline the same way the slider does, every tile shows the nearest thumbnail
+ * at or before its time, so the strip fills progressively as the thumbnails come. A click seeks to the time under the cursor.
+ * The strip is hidden until the first thumbnail comes.
+ */
+class ThumbnailStrip : public QWidget
+{
+private:
+    Q_OBJECT
+
+public:
+    ThumbnailStrip(QWidget* parent = 0);
+
+    ~ThumbnailStrip();
+
+    //! Setup fragments, the thumbnails are kept if the fragments stay the same.
+    void setFragmentsList(const SegmentTimeline& timeline);
+
+    //! Add thumbnail of a fragment at a time from the fragment beginning.
+    void addThumbnail(int fragment_index, int time_ms, const QImage& image);
+
+    //! Get the thumbnail shown for a total time, a null image if there is none.
+    QImage getThumbnail(int value) const;
+
+    //! Clear.
+    void clear();
+
+signals:
+    //! Clicked at a total time.
+    void newValue(int value);
+
+protected:
+    virtual void paintEvent(QPaintEvent* event);
+
+    virtual void mouseReleaseEvent(QMouseEvent* event);
+
+private:
+    //! Fragments timeline.
+    SegmentTimeline             m_timeline;
+    //! Thumbnails of the fragments by time.
+    QVector<QMap<int, QImage> > m_thumbnails;
+};
+
+#endif // THUMBNAILSTRIP_H
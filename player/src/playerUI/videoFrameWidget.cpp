@@ -27,10 +27,14 @@
 
 #include "videoFrameWidget.h"
 
+#include <QFontDatabase>
 #include <QPaintEvent>
 #include <QResizeEvent>
 #include <QPainter>
 
+#include "defines.h"
+#include "stallWatchdog.h"
+
 VideoFrameWidget::VideoFrameWidget(QWidget* parent) :
     QWidget(parent)
 {
@@ -44,6 +48,7 @@ VideoFrameWidget::~VideoFrameWidget()
 
 void VideoFrameWidget::setDrawImage(const QImage& image)
 {
+    StallScope scope("VideoFrameWidget::setDrawImage");
     m_source_image = image;
     if(!m_source_image.isNull())
     {
@@ -66,6 +71,15 @@ void VideoFrameWidget::clear()
     repaint();
 }
 
+void VideoFrameWidget::setStatisticsText(const QString& text)
+{
+    if(m_statistics_text == text)
+        return;
+
+    m_statistics_text = text;
+    update();
+}
+
 void VideoFrameWidget::paintEvent(QPaintEvent* event)
 {
     Q_UNUSED(event);
@@ -80,6 +94,17 @@ void VideoFrameWidget::paintEvent(QPaintEvent* event)
         int y_pos = (size().height() - m_draw_image.size().height()) / 2;
         painter.drawImage(x_pos, y_pos, m_draw_image);
     }
+    //draw statistics over the frame
+    if(!m_statistics_text.isEmpty())
+    {
+        painter.setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+        QRect text_rect = painter.boundingRect(rect().adjusted(STATISTICS_OVERLAY_MARGIN, STATISTICS_OVERLAY_MARGIN, 0, 0),
+                                               Qt::AlignLeft | Qt::AlignTop, m_statistics_text);
+        painter.fillRect(text_rect.adjusted(-STATISTICS_OVERLAY_MARGIN / 2, -STATISTICS_OVERLAY_MARGIN / 2,
+                                            STATISTICS_OVERLAY_MARGIN / 2, STATISTICS_OVERLAY_MARGIN / 2), QColor(0, 0, 0, 160));
+        painter.setPen(Qt::white);
+        painter.drawText(text_rect, Qt::AlignLeft | Qt::AlignTop, m_statistics_text);
+    }
 }
 
 void VideoFrameWidget::resizeEvent(QResizeEvent* event)
@@ -49,6 +49,9 @@ public:
     //! Clear UI.
     void clear();
 
+    //! Set text of the statistics overlay, empty text hides the overlay.
+    void setStatisticsText(const QString& text);
+
 signals:
     //! Notify that widget was double clicked.
     void doubleClick();
@@ -77,6 +80,8 @@ private:
     QImage  m_source_image;
     //! Scaled image.
     QImage  m_draw_image;
+    //! Text of the statistics overlay.
+    QString m_statistics_text;
 };
 
 #endif // VIDEOFRAMEWIDGET_H
@@ -0,0 +1,117 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "activityCurveTest.h"
+
+#include <QTemporaryDir>
+
+#include "activityCurve.h"
+#include "fileView.h"
+
+ActivityCurveTest::ActivityCurveTest()
+{
+}
+
+TrackSampleIndex ActivityCurveTest::makeVideoTrack(int seconds, int gop_size, int busy_second)
+{
+    // 90kHz timescale, starting at 10 seconds, as the seconds are counted from the first sample
+    TrackSampleIndex index;
+    index.setTimescale(90000);
+    index.setHandlerType('vide');
+    int64_t decode_time = 900000;
+    for(int i = 0; i < seconds * 25; ++i)
+    {
+        bool is_sync = (i % gop_size) == 0;
+        uint32_t size = is_sync ? 50000 : ((i / 25 == busy_second) ? 8000 : 1000);
+        index.append(decode_time, 3600, 0, size, 0, is_sync);
+        decode_time += 3600;
+    }
+    return index;
+}
+
+void ActivityCurveTest::activityTest()
+{
+    // motion in the fifth second makes its predicted frames larger, the sync sample stays as it is
+    SampleIndex sample_index;
+    sample_index.insert(1, makeVideoTrack(10, 25, 5));
+
+    ActivityCurve curve = ActivityCurve::compute(sample_index);
+    QCOMPARE(curve.size(), 11);
+    QCOMPARE(curve.getBytes(0), quint64(50000 + 24 * 1000));
+    QCOMPARE(curve.getBytes(5), quint64(50000 + 24 * 8000));
+    QCOMPARE(curve.getActivity(0), 0.0f);
+    QCOMPARE(curve.getActivity(5), 1.0f);
+    QCOMPARE(curve.getActivity(10), 0.0f);
+    QCOMPARE(curve.getObjectCount(5), 0);
+
+    QVERIFY(ActivityCurve::compute(SampleIndex()).isEmpty());
+}
+
+void ActivityCurveTest::syncOnlyTest()
+{
+    SampleIndex sample_index;
+    sample_index.insert(1, makeVideoTrack(4, 1));
+
+    ActivityCurve curve = ActivityCurve::compute(sample_index);
+    QCOMPARE(curve.size(), 5);
+    QCOMPARE(curve.getBytes(1), quint64(25 * 50000));
+    QCOMPARE(curve.getActivity(1), 0.0f);
+}
+
+void ActivityCurveTest::objectsTest()
+{
+    QByteArray first_sample = "<tt:Frame><tt:Object ObjectId=\"1\"/><tt:Object ObjectId=\"2\"/></tt:Frame>";
+    QByteArray second_sample = "<tt:Frame><tt:Object ObjectId=\"1\"/></tt:Frame>";
+
+    QTemporaryDir folder;
+    QString path = folder.filePath("metadata.bin");
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(first_sample + second_sample), qint64(first_sample.size() + second_sample.size()));
+    file.close();
+
+    // one sample in each of the first two seconds
+    TrackSampleIndex metadata;
+    metadata.setTimescale(1000);
+    metadata.setHandlerType('meta');
+    metadata.append(0, 1000, 0, first_sample.size(), 0, true);
+    metadata.append(1000, 1000, 0, second_sample.size(), first_sample.size(), true);
+
+    SampleIndex sample_index;
+    sample_index.insert(1, makeVideoTrack(2, 25));
+    sample_index.insert(2, metadata);
+
+    ActivityCurve curve = ActivityCurve::compute(sample_index, FileView::open(path));
+    QCOMPARE(curve.size(), 3);
+    QCOMPARE(curve.getObjectCount(0), 2);
+    QCOMPARE(curve.getObjectCount(1), 1);
+    QCOMPARE(curve.getObjectCount(2), 0);
+    QCOMPARE(curve.getBytes(0), quint64(50000 + 24 * 1000 + first_sample.size()));
+
+    // without the file the objects are not counted
+    QCOMPARE(ActivityCurve::compute(sample_index).getObjectCount(0), 0);
+}
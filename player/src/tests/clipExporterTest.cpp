@@ -0,0 +1,108 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "clipExporterTest.h"
+
+#include <QEventLoop>
+#include <QTemporaryDir>
+
+#include "clipExporter.h"
+#include "clipGenerator.h"
+#include "ffmpeg.h"
+
+ClipExporterTest::ClipExporterTest()
+{
+}
+
+bool ClipExporterTest::exportClip(const QString & path, const QString & clip_path, int start_ms, int end_ms)
+{
+    ClipExporter exporter;
+    QEventLoop loop;
+    bool success = false;
+    QObject::connect(&exporter, &ClipExporter::finished, &loop, [&](bool finished_successfully)
+    {
+        success = finished_successfully;
+        loop.quit();
+    });
+
+    if(!exporter.start(path, clip_path, start_ms, end_ms, SampleIndex()))
+        return false;
+    loop.exec();
+    exporter.cancel();
+    return success && exporter.getSkippedTracks() == 0;
+}
+
+void ClipExporterTest::metadataTrackTest()
+{
+    if(!ClipGenerator::isAvailable("mpeg4"))
+        QSKIP("The mpeg4 encoder is not available");
+
+    // ten seconds with a metadata sample in the middle of every second
+    QTemporaryDir folder;
+    QString path = folder.filePath("recording.mp4");
+    QString clip_path = folder.filePath("clip.mp4");
+    ClipGenerator::Options options;
+    options.m_width = 320;
+    options.m_height = 240;
+    options.m_with_metadata = true;
+    QVERIFY(ClipGenerator::generate(path, options));
+
+    QVERIFY(exportClip(path, clip_path, 2000, 6000));
+
+    AVFormatContext * clip = nullptr;
+    QCOMPARE(avformat_open_input(&clip, clip_path.toUtf8().constData(), nullptr, nullptr), 0);
+    QVERIFY(avformat_find_stream_info(clip, nullptr) >= 0);
+
+    int metadata_index = -1;
+    for(unsigned int index = 0; index < clip->nb_streams; ++index)
+    {
+        const AVCodecParameters * parameters = clip->streams[index]->codecpar;
+        if(parameters->codec_type == AVMEDIA_TYPE_DATA &&
+           parameters->codec_tag == MKTAG('m', 'e', 't', 'x'))
+            metadata_index = (int)index;
+    }
+    QVERIFY(metadata_index >= 0);
+
+    // the samples of the seconds 2 to 5 are copied as they are
+    int samples = 0;
+    bool described = true;
+    AVPacket * packet = av_packet_alloc();
+    while(av_read_frame(clip, packet) >= 0)
+    {
+        if(packet->stream_index == metadata_index)
+        {
+            ++samples;
+            described = described && QByteArray((const char *)packet->data, packet->size).contains("ObjectId=");
+        }
+        av_packet_unref(packet);
+    }
+    av_packet_free(&packet);
+    avformat_close_input(&clip);
+
+    QCOMPARE(samples, 4);
+    QVERIFY(described);
+}
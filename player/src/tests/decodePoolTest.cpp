@@ -0,0 +1,206 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "decodePoolTest.h"
+
+#include <QSemaphore>
+
+#include <atomic>
+
+#include "decodePool.h"
+
+namespace
+{
+    //! Job finishing after a count of steps.
+    class CountingJob : public DecodeJob
+    {
+    public:
+        explicit CountingJob(int steps)
+            : m_steps(steps)
+            , m_done(0)
+        {}
+
+        virtual bool needsDecoding() const { return true; }
+
+        virtual bool decodeStep() { return ++m_done < m_steps; }
+
+        int m_steps;
+        std::atomic<int> m_done;
+    };
+
+    //! Job with work while frames are requested, like a decoder filling its queue.
+    class RequestedJob : public DecodeJob
+    {
+    public:
+        RequestedJob()
+            : m_requested(0)
+            , m_done(0)
+        {}
+
+        virtual bool needsDecoding() const { return m_requested > 0; }
+
+        virtual bool decodeStep()
+        {
+            --m_requested;
+            ++m_done;
+            return true;
+        }
+
+        //! Requests a frame, as the consumer of a decoder taking one.
+        void request()
+        {
+            ++m_requested;
+            notifyReady();
+        }
+
+        std::atomic<int> m_requested;
+        std::atomic<int> m_done;
+    };
+}
+
+DecodePoolTest::DecodePoolTest()
+{
+}
+
+void DecodePoolTest::jobTest()
+{
+    DecodePool pool(2);
+    QCOMPARE(pool.getThreadCount(), 2);
+
+    CountingJob job(10);
+    pool.add(&job, DecodePool::VideoPriority);
+    QVERIFY(pool.contains(&job));
+    QTRY_VERIFY(pool.isFinished(&job));
+    QCOMPARE(job.m_done.load(), 10);
+
+    // a finished job runs again when it is added again
+    job.m_steps = 20;
+    pool.add(&job, DecodePool::VideoPriority);
+    QTRY_VERIFY(pool.isFinished(&job));
+    QCOMPARE(job.m_done.load(), 20);
+
+    pool.remove(&job);
+    QVERIFY(!pool.contains(&job));
+}
+
+void DecodePoolTest::backgroundTest()
+{
+    DecodePool pool(2);
+    QSemaphore release;
+    std::atomic<int> started(0), done(0);
+    for(int i = 0; i < 2; ++i)
+    {
+        pool.run([&] ()
+        {
+            ++started;
+            release.acquire();
+            ++done;
+        }, this);
+    }
+
+    // one thread is kept free of background work
+    QTRY_COMPARE(started.load(), 1);
+    QTest::qWait(100);
+    QCOMPARE(started.load(), 1);
+
+    CountingJob job(5);
+    pool.add(&job, DecodePool::AudioPriority);
+    QTRY_VERIFY(pool.isFinished(&job));
+    pool.remove(&job);
+
+    release.release(2);
+    QTRY_COMPARE(done.load(), 2);
+}
+
+void DecodePoolTest::cancelTest()
+{
+    DecodePool pool(2);
+    QSemaphore release;
+    std::atomic<bool> blocking(false), cancelled_run(false);
+    int blocker = 0, owner = 0;
+    pool.run([&] ()
+    {
+        blocking = true;
+        release.acquire();
+    }, &blocker);
+    QTRY_VERIFY(blocking.load());
+
+    // the task waits for the background thread held by the blocking one
+    pool.run([&] () { cancelled_run = true; }, &owner);
+    pool.cancel(&owner);
+
+    release.release();
+    pool.cancel(&blocker);
+    pool.wait(&blocker);
+    QVERIFY(!cancelled_run.load());
+}
+
+void DecodePoolTest::stepsTest()
+{
+    DecodePool pool(2);
+    std::atomic<int> steps(0);
+    int owner = 0;
+    pool.runSteps([&] () { return ++steps < 5; }, &owner, DecodePool::VideoPriority);
+    QTRY_COMPARE(steps.load(), 5);
+    QTest::qWait(50);
+    QCOMPARE(steps.load(), 5);
+
+    // canceling does not wait for the running step, but no step follows it
+    QSemaphore release;
+    std::atomic<int> blocked_steps(0);
+    pool.runSteps([&] ()
+    {
+        ++blocked_steps;
+        release.acquire();
+        return true;
+    }, &owner, DecodePool::VideoPriority);
+    QTRY_COMPARE(blocked_steps.load(), 1);
+    pool.cancel(&owner);
+    release.release();
+    pool.wait(&owner);
+    QTest::qWait(50);
+    QCOMPARE(blocked_steps.load(), 1);
+}
+
+void DecodePoolTest::notifyTest()
+{
+    DecodePool pool(2);
+    RequestedJob job;
+    pool.add(&job, DecodePool::VideoPriority);
+    QTest::qWait(50);
+    QCOMPARE(job.m_done.load(), 0);
+
+    // a job without work is not polled, it runs again when it notifies the pool
+    for(int i = 1; i <= 3; ++i)
+    {
+        job.request();
+        QTRY_COMPARE(job.m_done.load(), i);
+    }
+
+    pool.remove(&job);
+    QVERIFY(!pool.contains(&job));
+}
@@ -0,0 +1,153 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "fileViewTest.h"
+
+#include <QTemporaryDir>
+
+#include "fileView.h"
+
+namespace
+{
+    //! Writes a file of the bytes 0, 1, 2, ... and returns its path.
+    QString writeFile(const QTemporaryDir & folder, const QString & name, int size)
+    {
+        QByteArray data(size, 0);
+        for(int i = 0; i < size; ++i)
+            data[i] = char(i);
+
+        QString path = folder.filePath(name);
+        QFile file(path);
+        if(!file.open(QIODevice::WriteOnly) || file.write(data) != size)
+            return QString();
+        return path;
+    }
+}
+
+FileViewTest::FileViewTest()
+{
+}
+
+void FileViewTest::readTest()
+{
+    QTemporaryDir folder;
+    QString path = writeFile(folder, "read.bin", 1000);
+    QVERIFY(!path.isEmpty());
+
+    std::shared_ptr<FileView> view = FileView::open(path);
+    QVERIFY(view != nullptr);
+    QCOMPARE(view->getSize(), qint64(1000));
+
+    char data[16];
+    QCOMPARE(view->read(100, data, sizeof(data)), qint64(sizeof(data)));
+    QCOMPARE(data[0], char(100));
+    QCOMPARE(data[15], char(115));
+
+    // reads are cut at the end of the file
+    QCOMPARE(view->read(990, data, sizeof(data)), qint64(10));
+    QCOMPARE(data[9], char(999 % 256));
+    QCOMPARE(view->read(1000, data, sizeof(data)), qint64(0));
+    QCOMPARE(view->read(-1, data, sizeof(data)), qint64(-1));
+
+    QVERIFY(FileView::open(folder.filePath("missing.bin")) == nullptr);
+}
+
+void FileViewTest::shareTest()
+{
+    QTemporaryDir folder;
+    QString path = writeFile(folder, "share.bin", 100);
+
+    std::shared_ptr<FileView> first = FileView::open(path);
+    std::shared_ptr<FileView> second = FileView::open(path);
+    QVERIFY(first == second);
+
+    // a file changed since it was viewed gets a new view
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    QCOMPARE(file.write(QByteArray(100, 0)), qint64(100));
+    file.close();
+
+    std::shared_ptr<FileView> changed = FileView::open(path);
+    QVERIFY(changed != first);
+    QCOMPARE(first->getSize(), qint64(100));
+    QCOMPARE(changed->getSize(), qint64(200));
+
+    // so does a file rewritten with the same size
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QCOMPARE(file.write(QByteArray(200, 1)), qint64(200));
+    QVERIFY(file.flush());
+    QVERIFY(file.setFileTime(changed->getModified().addSecs(10), QFileDevice::FileModificationTime));
+    file.close();
+
+    std::shared_ptr<FileView> rewritten = FileView::open(path);
+    QVERIFY(rewritten != changed);
+    QCOMPARE(rewritten->getSize(), qint64(200));
+    char data = 0;
+    QCOMPARE(rewritten->read(0, &data, 1), qint64(1));
+    QCOMPARE(data, char(1));
+}
+
+void FileViewTest::streamTest()
+{
+    QTemporaryDir folder;
+    QString path = writeFile(folder, "stream.bin", 100000);
+
+    FileViewStream stream(FileView::open(path));
+    stream.seekg(0, std::ios_base::end);
+    QCOMPARE(qint64(stream.tellg()), qint64(100000));
+
+    char data[4];
+    stream.seekg(70000);
+    QVERIFY(stream.read(data, sizeof(data)));
+    QCOMPARE(data[0], char(70000 % 256));
+    QCOMPARE(qint64(stream.tellg()), qint64(70004));
+
+    stream.seekg(-4, std::ios_base::cur);
+    QVERIFY(stream.read(data, sizeof(data)));
+    QCOMPARE(data[3], char(70003 % 256));
+
+    // reading over the end fails
+    stream.seekg(99998);
+    QVERIFY(!stream.read(data, sizeof(data)));
+}
+
+void FileViewTest::deviceTest()
+{
+    QTemporaryDir folder;
+    QString path = writeFile(folder, "device.bin", 1000);
+
+    FileViewDevice device(FileView::open(path));
+    QVERIFY(!device.open(QIODevice::ReadWrite));
+    QVERIFY(device.open(QIODevice::ReadOnly));
+    QCOMPARE(device.size(), qint64(1000));
+
+    QVERIFY(device.seek(500));
+    QByteArray data = device.read(600);
+    QCOMPARE(data.size(), 500);
+    QCOMPARE(data[0], char(500 % 256));
+    QVERIFY(device.atEnd());
+}
@@ -0,0 +1,116 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "mosaicLayoutTest.h"
+
+#include "mosaicLayout.h"
+
+MosaicLayoutTest::MosaicLayoutTest()
+{
+}
+
+void MosaicLayoutTest::gridTest()
+{
+    QRect area(0, 0, 1600, 900);
+
+    MosaicLayout empty(0, area);
+    QCOMPARE(empty.getColumns(), 0);
+    QCOMPARE(empty.getRows(), 0);
+    QCOMPARE(empty.getTileSize(), QSize());
+
+    MosaicLayout single(1, area);
+    QCOMPARE(single.getColumns(), 1);
+    QCOMPARE(single.getRows(), 1);
+    QCOMPARE(single.getTileSize(), QSize(1600, 900));
+
+    MosaicLayout four(4, area);
+    QCOMPARE(four.getColumns(), 2);
+    QCOMPARE(four.getRows(), 2);
+
+    // square tiles
+    MosaicLayout five(5, QRect(0, 0, 1200, 800), 1.0);
+    QCOMPARE(five.getColumns(), 3);
+    QCOMPARE(five.getRows(), 2);
+    QCOMPARE(five.getTileSize(), QSize(400, 400));
+
+    MosaicLayout sixteen(16, area);
+    QCOMPARE(sixteen.getColumns(), 4);
+    QCOMPARE(sixteen.getRows(), 4);
+    QCOMPARE(sixteen.getTileSize(), QSize(400, 225));
+
+    // the grid follows the shape of the area
+    MosaicLayout wide(2, QRect(0, 0, 2000, 500));
+    QCOMPARE(wide.getColumns(), 2);
+    QCOMPARE(wide.getRows(), 1);
+
+    MosaicLayout tall(2, QRect(0, 0, 500, 1000));
+    QCOMPARE(tall.getColumns(), 1);
+    QCOMPARE(tall.getRows(), 2);
+}
+
+void MosaicLayoutTest::tileRectTest()
+{
+    QRect area(10, 20, 1001, 602);
+    MosaicLayout layout(9, area);
+    QCOMPARE(layout.getColumns(), 3);
+    QCOMPARE(layout.getRows(), 3);
+
+    // the cells cover the area without overlapping
+    int covered = 0;
+    for(int i = 0; i < layout.getCount(); ++i)
+    {
+        QRect rect = layout.getTileRect(i);
+        QVERIFY(area.contains(rect));
+        covered += rect.width() * rect.height();
+        for(int j = 0; j < i; ++j)
+            QVERIFY(!rect.intersects(layout.getTileRect(j)));
+    }
+    QCOMPARE(covered, area.width() * area.height());
+
+    QCOMPARE(layout.getTileRect(0), QRect(10, 20, 334, 201));
+    QCOMPARE(layout.getTileRect(8), QRect(10 + 334 + 334, 20 + 201 + 201, 333, 200));
+    QCOMPARE(layout.getTileRect(9), QRect());
+    QCOMPARE(layout.getTileRect(-1), QRect());
+}
+
+void MosaicLayoutTest::tileAtTest()
+{
+    MosaicLayout layout(3, QRect(0, 0, 800, 450));
+    QCOMPARE(layout.getColumns(), 2);
+    QCOMPARE(layout.getRows(), 2);
+
+    QCOMPARE(layout.getTileAt(QPoint(0, 0)), 0);
+    QCOMPARE(layout.getTileAt(QPoint(399, 224)), 0);
+    QCOMPARE(layout.getTileAt(QPoint(400, 224)), 1);
+    QCOMPARE(layout.getTileAt(QPoint(10, 225)), 2);
+    // the last cell of the grid is empty
+    QCOMPARE(layout.getTileAt(QPoint(500, 300)), -1);
+    QCOMPARE(layout.getTileAt(QPoint(800, 10)), -1);
+
+    for(int i = 0; i < layout.getCount(); ++i)
+        QCOMPARE(layout.getTileAt(layout.getTileRect(i).center()), i);
+}
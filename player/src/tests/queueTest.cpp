@@ -0,0 +1,141 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "queueTest.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <memory>
+
+#include "queue.h"
+#include "types.h"
+
+QueueTest::QueueTest()
+{
+}
+
+void QueueTest::dataSizeTest()
+{
+    Queue<AudioFrame> queue;
+    QCOMPARE(queue.dataSize(), qint64(0));
+
+    AudioFrame first(0), second(40);
+    first.m_data = QByteArray(1000, 0);
+    second.m_data = QByteArray(3000, 0);
+
+    queue.push(first);
+    queue.push(second);
+    QCOMPARE(queue.dataSize(), qint64(first.size() + second.size()));
+
+    queue.pop();
+    QCOMPARE(queue.dataSize(), qint64(second.size()));
+
+    queue.clear();
+    QCOMPARE(queue.dataSize(), qint64(0));
+
+    // pointers are accounted by their size only
+    Queue<AudioFrame*> pointer_queue;
+    pointer_queue.push(&first);
+    QCOMPARE(pointer_queue.dataSize(), qint64(sizeof(AudioFrame*)));
+}
+
+void QueueTest::budgetTest()
+{
+    QueueBudget & budget = QueueBudget::instance();
+    qint64 limit = budget.getLimit();
+    qint64 used = budget.getUsed();
+
+    AudioFrame frame(0);
+    frame.m_data = QByteArray(1024 * 1024, 0);
+
+    {
+        Queue<AudioFrame> first, second;
+        first.setBudget(&budget);
+        second.setBudget(&budget);
+
+        first.push(frame);
+        second.push(frame);
+        QCOMPARE(budget.getUsed(), used + 2 * qint64(frame.size()));
+
+        // both queues share the budget
+        budget.setLimit(used + 2 * qint64(frame.size()));
+        QVERIFY(!budget.isAvailable());
+        first.pop();
+        QVERIFY(budget.isAvailable());
+
+        // data queued before the budget is set is accounted too
+        Queue<AudioFrame> third;
+        third.push(frame);
+        third.setBudget(&budget);
+        QCOMPARE(budget.getUsed(), used + 2 * qint64(frame.size()));
+        third.setBudget(nullptr);
+        QCOMPARE(budget.getUsed(), used + qint64(frame.size()));
+    }
+
+    // destroyed queues give their data back
+    QCOMPARE(budget.getUsed(), used);
+    budget.setLimit(limit);
+}
+
+void QueueTest::timeSpanTest()
+{
+    Queue<AudioFrame> queue;
+    QCOMPARE(queue.timeSpan(), 0);
+
+    queue.push(AudioFrame(1000));
+    QCOMPARE(queue.timeSpan(), 0);
+
+    queue.push(AudioFrame(1040));
+    queue.push(AudioFrame(1080));
+    QCOMPARE(queue.timeSpan(), 80);
+
+    queue.pop();
+    QCOMPARE(queue.timeSpan(), 40);
+}
+
+void QueueTest::waitTest()
+{
+    Queue<AudioFrame> queue;
+    QVERIFY(!queue.waitForSize(1, 10));
+
+    queue.push(AudioFrame(0));
+    QVERIFY(queue.waitForSize(1, 0));
+
+    // a waiting consumer wakes up at the push, long before the timeout
+    std::unique_ptr<QThread> producer(QThread::create([&queue] ()
+    {
+        QThread::msleep(20);
+        queue.push(AudioFrame(40));
+    }));
+    QElapsedTimer timer;
+    timer.start();
+    producer->start();
+    QVERIFY(queue.waitForSize(2, 5000));
+    QVERIFY(timer.elapsed() < 5000);
+    producer->wait();
+}
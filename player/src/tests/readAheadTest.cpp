@@ -0,0 +1,239 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "readAheadTest.h"
+
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <atomic>
+
+#include "defines.h"
+#include "readAhead.h"
+
+namespace
+{
+    //! File reading slowly, like a file on a network share.
+    class ThrottledFile : public QFile
+    {
+    public:
+        ThrottledFile(const QString & path, int delay_ms)
+            : QFile(path)
+            , m_delay_ms(delay_ms)
+            , m_reads(0)
+        {}
+
+        //! Returns the count of the reads from the file.
+        int getReadCount() const { return m_reads; }
+
+    protected:
+        virtual qint64 readData(char * data, qint64 max_size) override
+        {
+            QThread::msleep(m_delay_ms);
+            ++m_reads;
+            return QFile::readData(data, max_size);
+        }
+
+    private:
+        //! Delay of each read.
+        int m_delay_ms;
+        //! Count of the reads.
+        std::atomic<int> m_reads;
+    };
+
+    //! Writes a file of the bytes i % 251 and returns its path.
+    QString writeFile(const QTemporaryDir & folder, qint64 size)
+    {
+        QByteArray data(int(size), 0);
+        for(int i = 0; i < data.size(); ++i)
+            data[i] = char(i % 251);
+
+        QString path = folder.filePath("throttled.bin");
+        QFile file(path);
+        if(!file.open(QIODevice::WriteOnly) || file.write(data) != size)
+            return QString();
+        return path;
+    }
+
+    //! Checks that data was read from a position of the file written.
+    bool isFileData(const char * data, qint64 position, qint64 size)
+    {
+        for(qint64 i = 0; i < size; ++i)
+        {
+            if(data[i] != char((position + i) % 251))
+                return false;
+        }
+        return true;
+    }
+}
+
+ReadAheadTest::ReadAheadTest()
+{
+}
+
+void ReadAheadTest::sequentialTest()
+{
+    const qint64 block_count = 12;
+    const qint64 size = block_count * READ_AHEAD_BLOCK_SIZE;
+
+    QTemporaryDir folder;
+    QString path = writeFile(folder, size);
+    QVERIFY(!path.isEmpty());
+
+    ThrottledFile file(path, 10);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+    ReadAhead read_ahead(file, size);
+    ReadAhead::Cursor cursor;
+
+    // the first block is read by the reader, the following ones ahead of it
+    QByteArray data(FILE_VIEW_BLOCK_SIZE, 0);
+    for(qint64 position = 0; position < size; position += data.size())
+    {
+        QCOMPARE(read_ahead.read(position, data.data(), data.size(), &cursor), qint64(data.size()));
+        QVERIFY(isFileData(data.constData(), position, data.size()));
+    }
+
+    ReadAhead::Statistics statistics = read_ahead.getStatistics();
+    QCOMPARE(statistics.m_misses, quint64(1));
+    QCOMPARE(statistics.m_hits + statistics.m_waits + statistics.m_misses, quint64(size / data.size()));
+    QCOMPARE(statistics.m_read_blocks, quint64(block_count));
+    QCOMPARE(statistics.m_read_bytes, quint64(size));
+    QCOMPARE(file.getReadCount(), int(block_count));
+}
+
+void ReadAheadTest::interleavedTest()
+{
+    const qint64 block_count = 8;
+    const qint64 size = 2 * block_count * READ_AHEAD_BLOCK_SIZE;
+
+    QTemporaryDir folder;
+    QString path = writeFile(folder, size);
+    QVERIFY(!path.isEmpty());
+
+    ThrottledFile file(path, 10);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+    ReadAhead read_ahead(file, size);
+
+    // two readers taking turns in the two halves of the file, like the demuxers of two tracks
+    ReadAhead::Cursor first, second;
+    QByteArray data(READ_AHEAD_BLOCK_SIZE, 0);
+    for(qint64 position = 0; position < size / 2; position += data.size())
+    {
+        QCOMPARE(read_ahead.read(position, data.data(), data.size(), &first), qint64(data.size()));
+        QVERIFY(isFileData(data.constData(), position, data.size()));
+        QCOMPARE(read_ahead.read(size / 2 + position, data.data(), data.size(), &second), qint64(data.size()));
+        QVERIFY(isFileData(data.constData(), size / 2 + position, data.size()));
+    }
+
+    // each reader is read ahead of, only the first blocks of the second reader are missed
+    ReadAhead::Statistics statistics = read_ahead.getStatistics();
+    QVERIFY2(statistics.m_misses <= 3, qPrintable(QString("%1 misses").arg(statistics.m_misses)));
+    QCOMPARE(statistics.m_hits + statistics.m_waits + statistics.m_misses, quint64(2 * block_count));
+}
+
+void ReadAheadTest::readersTest()
+{
+    const int reader_count = 3;
+    const qint64 block_count = 10;
+    const qint64 reader_distance = 2 * block_count;
+    const qint64 size = reader_count * reader_distance * READ_AHEAD_BLOCK_SIZE;
+
+    QTemporaryDir folder;
+    QString path = writeFile(folder, size);
+    QVERIFY(!path.isEmpty());
+
+    ThrottledFile file(path, 2);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+    ReadAhead read_ahead(file, size);
+
+    // more blocks are read ahead of the readers taking turns than blocks used are kept
+    ReadAhead::Cursor cursors[reader_count];
+    QByteArray data(READ_AHEAD_BLOCK_SIZE, 0);
+    for(qint64 block = 0; block < block_count; ++block)
+    {
+        for(int reader = 0; reader < reader_count; ++reader)
+        {
+            qint64 position = (reader * reader_distance + block) * READ_AHEAD_BLOCK_SIZE;
+            QCOMPARE(read_ahead.read(position, data.data(), data.size(), &cursors[reader]), qint64(data.size()));
+            QVERIFY(isFileData(data.constData(), position, data.size()));
+        }
+    }
+
+    // blocks read ahead wait for their readers, only the blocks before the read-ahead of each reader are missed
+    ReadAhead::Statistics statistics = read_ahead.getStatistics();
+    QCOMPARE(statistics.m_misses, quint64(2 * reader_count - 1));
+    QCOMPARE(statistics.m_hits + statistics.m_waits + statistics.m_misses, quint64(reader_count * block_count));
+}
+
+void ReadAheadTest::seekBackTest()
+{
+    const qint64 size = 4 * READ_AHEAD_BLOCK_SIZE;
+
+    QTemporaryDir folder;
+    QString path = writeFile(folder, size);
+
+    ThrottledFile file(path, 5);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+    ReadAhead read_ahead(file, size);
+
+    char data[100];
+    for(qint64 position = 0; position < size; position += READ_AHEAD_BLOCK_SIZE)
+        QCOMPARE(read_ahead.read(position, data, sizeof(data)), qint64(sizeof(data)));
+    ReadAhead::Statistics statistics = read_ahead.getStatistics();
+
+    // a seek back is served from the cache, a read over two blocks too
+    qint64 position = READ_AHEAD_BLOCK_SIZE + 1000;
+    QCOMPARE(read_ahead.read(position, data, sizeof(data)), qint64(sizeof(data)));
+    QVERIFY(isFileData(data, position, sizeof(data)));
+    position = 2 * READ_AHEAD_BLOCK_SIZE - 50;
+    QCOMPARE(read_ahead.read(position, data, sizeof(data)), qint64(sizeof(data)));
+    QVERIFY(isFileData(data, position, sizeof(data)));
+
+    ReadAhead::Statistics seek_statistics = read_ahead.getStatistics();
+    QCOMPARE(seek_statistics.m_misses, statistics.m_misses);
+    QCOMPARE(seek_statistics.m_hits, statistics.m_hits + 3);
+    QCOMPARE(seek_statistics.m_read_blocks, quint64(4));
+}
+
+void ReadAheadTest::endTest()
+{
+    const qint64 size = READ_AHEAD_BLOCK_SIZE + 1000;
+
+    QTemporaryDir folder;
+    QString path = writeFile(folder, size);
+
+    ThrottledFile file(path, 0);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Unbuffered));
+    ReadAhead read_ahead(file, size);
+
+    // reads are cut at the end of the file
+    char data[100];
+    QCOMPARE(read_ahead.read(size - 10, data, sizeof(data)), qint64(10));
+    QVERIFY(isFileData(data, size - 10, 10));
+    QCOMPARE(read_ahead.read(size, data, sizeof(data)), qint64(0));
+    QCOMPARE(read_ahead.read(-1, data, sizeof(data)), qint64(-1));
+}
@@ -0,0 +1,112 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "sampleIndexTest.h"
+
+SampleIndexTest::SampleIndexTest()
+{
+}
+
+TrackSampleIndex SampleIndexTest::makeIndex(int fragments, int samples_per_fragment, int gop_size)
+{
+    // 90kHz timescale, 25 frames per second, fragments starting at 10 seconds
+    TrackSampleIndex index;
+    index.setTimescale(90000);
+    int64_t decode_time = 900000;
+    uint64_t offset = 0;
+    for(int i = 0; i < fragments; ++i)
+    {
+        // every fragment has its own 'moof' header before the samples
+        offset += 100;
+        for(int j = 0; j < samples_per_fragment; ++j)
+        {
+            int position = i * samples_per_fragment + j;
+            index.append(decode_time, 3600, 0, 1000, offset, (position % gop_size) == 0);
+            decode_time += 3600;
+            offset += 1000;
+        }
+    }
+    return index;
+}
+
+void SampleIndexTest::findSampleTest()
+{
+    TrackSampleIndex index = makeIndex(4, 25, 25);
+
+    QCOMPARE(index.size(), 100);
+    QCOMPARE(index.getDurationMs(), uint64_t(4000));
+    QCOMPARE(index.findSample(0), -1);
+    QCOMPARE(index.findSample(900000), 0);
+    QCOMPARE(index.findSample(903599), 0);
+    QCOMPARE(index.findSample(903600), 1);
+    QCOMPARE(index.findSample(10000000), 99);
+
+    QCOMPARE(index.findSampleMs(0), 0);
+    QCOMPARE(index.findSampleMs(1000), 25);
+    QCOMPARE(index.findSampleMs(2999), 74);
+    QCOMPARE(index.getOffset(25), uint64_t(25 * 1000 + 2 * 100));
+
+    QCOMPARE(TrackSampleIndex().findSampleMs(0), -1);
+}
+
+void SampleIndexTest::findSyncSampleTest()
+{
+    TrackSampleIndex index = makeIndex(4, 25, 10);
+
+    QVERIFY(index.isSync(0));
+    QVERIFY(index.isSync(30));
+    QVERIFY(!index.isSync(31));
+    QCOMPARE(index.findSyncSample(0), 0);
+    QCOMPARE(index.findSyncSample(39), 30);
+    QCOMPARE(index.findSyncSample(40), 40);
+    QCOMPARE(index.findNextSyncSample(40), 50);
+    QCOMPARE(index.findNextSyncSample(95), -1);
+}
+
+void SampleIndexTest::serializationTest()
+{
+    SampleIndex sample_index;
+    sample_index.insert(1, makeIndex(2, 25, 5));
+
+    QByteArray bytes;
+    {
+        QDataStream stream(&bytes, QIODevice::WriteOnly);
+        stream << sample_index;
+    }
+
+    SampleIndex restored;
+    QDataStream stream(bytes);
+    stream >> restored;
+
+    QCOMPARE(restored.size(), 1);
+    const TrackSampleIndex & index = restored[1];
+    QCOMPARE(index.size(), 50);
+    QCOMPARE(index.getTimescale(), uint32_t(90000));
+    QCOMPARE(index.getEndTime(), sample_index[1].getEndTime());
+    QCOMPARE(index.findSyncSample(49), 45);
+    QCOMPARE(index.getOffset(49), sample_index[1].getOffset(49));
+}
@@ -0,0 +1,297 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "afIdentificationBox.hpp"
+#include "mediaHeaderBox.hpp"
+#include "movieHeaderBox.hpp"
+
+#include "segmentTimelineTest.h"
+
+SegmentTimelineTest::SegmentTimelineTest()
+{
+}
+
+SegmentInfo SegmentTimelineTest::makeSegment(const QString & file_name, const QUuid & segment, const QUuid & predecessor, const QUuid & successor, uint32_t duration_ms,
+                                             uint64_t start_time)
+{
+    std::shared_ptr<std::stringstream> stream_ptr(new std::stringstream());
+
+    StreamWriter stream_writer(*stream_ptr);
+
+    uint8_t version = 0;
+    U_UInt24 flags;
+    flags.m_value = 0;
+    uint32_t zero = 0;
+
+    // 'mvhd' with millisecond timescale
+    stream_writer.write(BoxSize(96).fullbox_size()).write(MovieHeaderBox::getFourCC())
+            .write(version).write(flags)
+            .write(zero).write(zero).write(uint32_t(1000)).write(duration_ms)
+            .write(uint32_t(0x00010000)).write(uint16_t(0x0100)).write(uint16_t(0)).write(zero).write(zero);
+    uint32_t matrix[9] = {0x00010000,0,0,0,0x00010000,0,0,0,0x40000000 };
+    for (int j=0; j < 9; ++j)
+        stream_writer.write(matrix[j]);
+    for (int j=0; j < 6; ++j)
+        stream_writer.write(zero);
+    stream_writer.write(uint32_t(2));
+
+    // 'mdhd' with 1 second timescale, so the 'sumi' duration is taken as is
+    stream_writer.write(BoxSize(20).fullbox_size()).write(MediaHeaderBox::getFourCC())
+            .write(version).write(flags)
+            .write(zero).write(zero).write(uint32_t(1)).write(duration_ms)
+            .write(uint16_t(0x1AAA)).write(uint16_t(0));
+
+    // 'sumi'
+    stream_writer.write(BoxSize(3 * uuid_size() + 2 * sizeof(uint64_t) + 2 * sizeof(uint16_t) + 2).size()).write(AFIdentificationBox::getFourCC())
+            .write(segment).write(predecessor).write(successor)
+            .write(start_time).write(uint64_t(duration_ms))
+            .write(uint16_t(0)).write(uint16_t(0))
+            .write(QString()).write(QString());
+
+    stream_ptr->seekg(0);
+
+    LimitedStreamReader stream_reader(stream_ptr);
+    FileBox file;
+    while(BoxFactory::instance().parseBox(stream_reader, &file));
+
+    SegmentInfo info(file_name);
+    if(file.getChildren().size() == 3)
+    {
+        info.readMovieHeaderBox(dynamic_cast<MovieHeaderBox*>(file.getChildren()[0]));
+        info.read(dynamic_cast<MediaHeaderBox*>(file.getChildren()[1]));
+        info.readAfIdentificationBox(dynamic_cast<AFIdentificationBox*>(file.getChildren()[2]));
+    }
+    return info;
+}
+
+SegmentList SegmentTimelineTest::makeChain(const QList<uint32_t> & durations)
+{
+    QList<QUuid> uuids;
+    for(int i = 0; i < durations.size(); ++i)
+        uuids.append(QUuid::createUuid());
+
+    SegmentList segments;
+    for(int i = 0; i < durations.size(); ++i)
+    {
+        const QUuid & predecessor = (i == 0) ? uuids[i] : uuids[i - 1];
+        const QUuid & successor = (i == durations.size() - 1) ? uuids[i] : uuids[i + 1];
+        segments.append(makeSegment(QString::number(i), uuids[i], predecessor, successor, durations[i]));
+    }
+    return segments;
+}
+
+QStringList SegmentTimelineTest::fileNames(const SegmentTimeline & timeline)
+{
+    QStringList result;
+    for(int i = 0; i < timeline.size(); ++i)
+        result.append(timeline.at(i).getFileName());
+    return result;
+}
+
+bool SegmentTimelineTest::hasIssue(const SegmentTimeline & timeline, SegmentChainIssue::Type type)
+{
+    const SegmentChainIssueList & issues = timeline.getIssues();
+    for(auto it = issues.begin(), end = issues.end(); it != end; ++it)
+    {
+        if(it->m_type == type)
+            return true;
+    }
+    return false;
+}
+
+void SegmentTimelineTest::chainingTest()
+{
+    SegmentList chain = makeChain(QList<uint32_t>() << 1000 << 1000 << 1000 << 1000 << 1000);
+    QVERIFY2(chain.front().isSurveillanceFragment(), "Segment was not created");
+
+    SegmentList shuffled;
+    shuffled << chain[3] << chain[0] << chain[4] << chain[2] << chain[1];
+
+    SegmentTimeline timeline = SegmentTimeline::chain(shuffled);
+
+    QCOMPARE(fileNames(timeline), QStringList() << "0" << "1" << "2" << "3" << "4");
+    QVERIFY(timeline.isContinuous());
+    for(int i = 0; i < timeline.size(); ++i)
+    {
+        QCOMPARE(timeline.at(i).getFragmentNumber(), uint32_t(i));
+        QCOMPARE(timeline.indexOf(chain[i].getSegmentUUID()), i);
+    }
+    QCOMPARE(timeline.indexOf(QUuid::createUuid().toString()), -1);
+}
+
+void SegmentTimelineTest::brokenChainTest()
+{
+    SegmentList chain = makeChain(QList<uint32_t>() << 1000 << 1000 << 1000 << 1000);
+
+    SegmentList broken;
+    broken << chain[3] << chain[1] << chain[0];
+
+    SegmentTimeline timeline = SegmentTimeline::chain(broken);
+
+    QCOMPARE(fileNames(timeline), QStringList() << "0" << "1" << "3");
+    QVERIFY(!timeline.isContinuous());
+    QVERIFY(hasIssue(timeline, SegmentChainIssue::Break));
+    QVERIFY(!hasIssue(timeline, SegmentChainIssue::Fork));
+    QVERIFY(!hasIssue(timeline, SegmentChainIssue::Cycle));
+}
+
+void SegmentTimelineTest::forkedChainTest()
+{
+    SegmentList chain = makeChain(QList<uint32_t>() << 1000 << 1000 << 1000);
+
+    // another segment claiming to follow the first one
+    QUuid fork_uuid = QUuid::createUuid();
+    SegmentInfo fork = makeSegment("fork", fork_uuid, QUuid(chain[0].getSegmentUUID()), fork_uuid, 1000);
+
+    SegmentList forked;
+    forked << chain[0] << chain[1] << chain[2] << fork;
+
+    SegmentTimeline timeline = SegmentTimeline::chain(forked);
+
+    QCOMPARE(timeline.size(), 4);
+    QCOMPARE(fileNames(timeline).mid(0, 3), QStringList() << "0" << "1" << "2");
+    QVERIFY(hasIssue(timeline, SegmentChainIssue::Fork));
+}
+
+void SegmentTimelineTest::cycledChainTest()
+{
+    QUuid first = QUuid::createUuid(), second = QUuid::createUuid();
+
+    SegmentList cycled;
+    cycled << makeSegment("0", first, second, second, 1000) << makeSegment("1", second, first, first, 1000);
+
+    SegmentTimeline timeline = SegmentTimeline::chain(cycled);
+
+    QCOMPARE(fileNames(timeline), QStringList() << "0" << "1");
+    QVERIFY(hasIssue(timeline, SegmentChainIssue::Cycle));
+}
+
+void SegmentTimelineTest::duplicatedChainTest()
+{
+    SegmentList chain = makeChain(QList<uint32_t>() << 1000 << 1000 << 1000);
+
+    // a copy of the first and the middle segment in other files
+    SegmentInfo first_copy = makeSegment("0 copy", QUuid(chain[0].getSegmentUUID()), QUuid(chain[0].getPredecessorUUID()), QUuid(chain[0].getSuccessorUUID()), 1000);
+    SegmentInfo middle_copy = makeSegment("1 copy", QUuid(chain[1].getSegmentUUID()), QUuid(chain[1].getPredecessorUUID()), QUuid(chain[1].getSuccessorUUID()), 1000);
+
+    SegmentList duplicated;
+    duplicated << chain[0] << chain[1] << middle_copy << chain[2] << first_copy;
+
+    SegmentTimeline timeline = SegmentTimeline::chain(duplicated);
+
+    QCOMPARE(timeline.size(), 5);
+    QCOMPARE(fileNames(timeline).mid(0, 3), QStringList() << "0" << "1" << "2");
+    QVERIFY(hasIssue(timeline, SegmentChainIssue::Duplicate));
+    QVERIFY(!hasIssue(timeline, SegmentChainIssue::Fork));
+    QVERIFY(!hasIssue(timeline, SegmentChainIssue::Break));
+}
+
+void SegmentTimelineTest::findSegmentTest()
+{
+    SegmentTimeline timeline = SegmentTimeline::chain(makeChain(QList<uint32_t>() << 1000 << 2000 << 500));
+
+    QCOMPARE(timeline.getDuration(), uint64_t(3500));
+    QCOMPARE(timeline.getStartOffset(0), uint64_t(0));
+    QCOMPARE(timeline.getStartOffset(1), uint64_t(1000));
+    QCOMPARE(timeline.getStartOffset(2), uint64_t(3000));
+
+    QCOMPARE(timeline.findSegment(0), 0);
+    QCOMPARE(timeline.findSegment(999), 0);
+    QCOMPARE(timeline.findSegment(1000), 1);
+    QCOMPARE(timeline.findSegment(2999), 1);
+    QCOMPARE(timeline.findSegment(3000), 2);
+    QCOMPARE(timeline.findSegment(10000), 2);
+
+    QCOMPARE(SegmentTimeline().findSegment(0), -1);
+}
+
+void SegmentTimelineTest::locateTest()
+{
+    SegmentTimeline timeline = SegmentTimeline::chain(makeChain(QList<uint32_t>() << 1000 << 2000 << 500));
+
+    SegmentTimeline::Position position = timeline.locate(uint64_t(1500));
+    QCOMPARE(position.m_index, 1);
+    QCOMPARE(position.m_offset, uint64_t(500));
+
+    position = timeline.locate(uint64_t(3000));
+    QCOMPARE(position.m_index, 2);
+    QCOMPARE(position.m_offset, uint64_t(0));
+
+    // beyond the end
+    position = timeline.locate(uint64_t(10000));
+    QCOMPARE(position.m_index, 2);
+    QCOMPARE(position.m_offset, uint64_t(500));
+
+    QVERIFY(!SegmentTimeline().locate(uint64_t(0)).isValid());
+}
+
+void SegmentTimelineTest::wallClockTest()
+{
+    // 10 s segment, 2 s gap, 5 s segment overlapped by 1 s by a 3 s segment
+    uint64_t start = datetime_write();
+    QList<QUuid> uuids;
+    uuids << QUuid::createUuid() << QUuid::createUuid() << QUuid::createUuid();
+    SegmentList segments;
+    segments << makeSegment("0", uuids[0], uuids[0], uuids[1], 10000, start)
+             << makeSegment("1", uuids[1], uuids[0], uuids[2], 5000, start + 12)
+             << makeSegment("2", uuids[2], uuids[1], uuids[2], 3000, start + 16);
+
+    SegmentTimeline timeline = SegmentTimeline::chain(segments);
+    QVERIFY(timeline.hasStartTimes());
+    QCOMPARE(timeline.getGap(0), int64_t(0));
+    QCOMPARE(timeline.getGap(1), int64_t(2000));
+    QCOMPARE(timeline.getGap(2), int64_t(-1000));
+
+    QDateTime origin = timeline.at(0).getStartTime();
+
+    SegmentTimeline::Position position = timeline.locate(origin.addMSecs(4000));
+    QCOMPARE(position.m_index, 0);
+    QCOMPARE(position.m_offset, uint64_t(4000));
+
+    // in the gap
+    position = timeline.locate(origin.addMSecs(11000));
+    QCOMPARE(position.m_index, 1);
+    QCOMPARE(position.m_offset, uint64_t(0));
+
+    // in the overlap
+    position = timeline.locate(origin.addMSecs(16500));
+    QCOMPARE(position.m_index, 2);
+    QCOMPARE(position.m_offset, uint64_t(500));
+
+    // before the beginning and after the end
+    position = timeline.locate(origin.addMSecs(-1000));
+    QCOMPARE(position.m_index, 0);
+    QCOMPARE(position.m_offset, uint64_t(0));
+    position = timeline.locate(origin.addMSecs(60000));
+    QCOMPARE(position.m_index, 2);
+    QCOMPARE(position.m_offset, uint64_t(3000));
+
+    // segments without ascending start times are not located by wall-clock time
+    SegmentTimeline unordered(SegmentList() << segments[1] << segments[0]);
+    QVERIFY(!unordered.hasStartTimes());
+    QVERIFY(!unordered.locate(origin).isValid());
+}
@@ -0,0 +1,64 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef SEGMENTTIMELINETEST_H
+#define SEGMENTTIMELINETEST_H
+
+#include "boxTestsCommon.h"
+
+#include "segmentTimeline.h"
+
+class SegmentTimelineTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    SegmentTimelineTest();
+
+private Q_SLOTS:
+    void chainingTest();
+    void brokenChainTest();
+    void forkedChainTest();
+    void cycledChainTest();
+    void duplicatedChainTest();
+    void findSegmentTest();
+    void locateTest();
+    void wallClockTest();
+
+private:
+    //! Creates a Surveillance segment by parsing its 'mvhd', 'mdhd' and 'sumi' boxes.
+    SegmentInfo makeSegment(const QString & file_name, const QUuid & segment, const QUuid & predecessor, const QUuid & successor, uint32_t duration_ms,
+                            uint64_t start_time = datetime_write());
+    //! Creates a chain of Surveillance segments with the given durations.
+    SegmentList makeChain(const QList<uint32_t> & durations);
+    //! Returns the file names of the segments in the timeline order.
+    QStringList fileNames(const SegmentTimeline & timeline);
+    //! Checks if the timeline reports an issue of a type.
+    bool hasIssue(const SegmentTimeline & timeline, SegmentChainIssue::Type type);
+};
+
+#endif // SEGMENTTIMELINETEST_H
@@ -0,0 +1,343 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "syntheticFileGenerator.h"
+
+#include <QDateTime>
+
+#include <vector>
+
+namespace
+{
+    //! Timescale of the movie and of the tracks.
+    const uint32_t sc_timescale = 90000;
+
+    //! trex sample flags of the samples following a sync sample: depends on others, non-sync.
+    const uint32_t sc_non_sync_sample_flags = 0x01010000;
+    //! trun first sample flags, every fragment starts with a sync sample, which does not depend on others.
+    const uint32_t sc_sync_sample_flags = 0x02000000;
+
+    //! tfhd flags: default-base-is-moof and the default sample duration are present.
+    const uint32_t sc_tfhd_flags = 0x020008;
+    //! trun flags: data offset, first sample flags and sample sizes are present.
+    const uint32_t sc_trun_flags = 0x000001 | 0x000004 | 0x000200;
+
+    //! Size of a movie fragment header box.
+    const uint32_t sc_mfhd_size = 16;
+    //! Size of a track fragment box without the sample sizes of its run.
+    const uint32_t sc_traf_size = 8 + 20 + 20 + 28;
+
+    //! Identity matrix of the movie and track headers.
+    const uint32_t sc_matrix[9] = { 0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000 };
+
+    //! Returns the current time in seconds since 1904, as stored in the Surveillance boxes.
+    uint64_t currentTime()
+    {
+        return QDateTime(QDate(1904, 1, 1), QTime(0, 0), Qt::UTC).secsTo(QDateTime::currentDateTimeUtc());
+    }
+}
+
+SyntheticFileGenerator::SyntheticFileGenerator(const Options & options)
+    : m_options(options)
+    , m_writer(m_file)
+    , m_box_count(0)
+{
+}
+
+bool SyntheticFileGenerator::generate(const QString & path)
+{
+    m_box_offsets.clear();
+    m_box_count = 0;
+
+    m_file.open(path.toLocal8Bit().constData(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!m_file.is_open())
+        return false;
+
+    writeFileType();
+    writeMovie();
+    if(m_options.m_is_surveillance || m_options.m_signature_count > 0)
+        writeSurveillanceMeta();
+    for(int fragment = 0; fragment < m_options.m_fragment_count; ++fragment)
+        writeFragment(fragment);
+
+    bool result = m_file.good();
+    m_file.close();
+    return result;
+}
+
+int SyntheticFileGenerator::getBoxCount() const
+{
+    return m_box_count;
+}
+
+uint32_t SyntheticFileGenerator::getTimescale()
+{
+    return sc_timescale;
+}
+
+void SyntheticFileGenerator::beginBox(const FourCC & four_cc)
+{
+    m_box_offsets.append(m_writer.getOffset());
+    m_writer.write(uint32_t(0)).write(four_cc);
+    ++m_box_count;
+}
+
+void SyntheticFileGenerator::beginFullBox(const FourCC & four_cc, uint8_t version, uint32_t flags)
+{
+    U_UInt24 flags_value;
+    flags_value.m_value = flags;
+    beginBox(four_cc);
+    m_writer.write(version).write(flags_value);
+}
+
+void SyntheticFileGenerator::endBox()
+{
+    uint64_t begin = m_box_offsets.takeLast();
+    uint64_t end = m_writer.getOffset();
+    m_file.seekp(begin);
+    m_writer.write(uint32_t(end - begin));
+    m_file.seekp(end);
+}
+
+void SyntheticFileGenerator::writeFileType()
+{
+    beginBox(FourCC("ftyp"));
+    m_writer.write(FourCC("isom")).write(uint32_t(0)).write(FourCC("isom")).write(FourCC("iso6"));
+    endBox();
+}
+
+void SyntheticFileGenerator::writeMovie()
+{
+    uint32_t zero = 0;
+    uint32_t duration = m_options.m_fragment_count * m_options.m_samples_per_fragment * m_options.m_sample_duration;
+
+    beginBox(FourCC("moov"));
+
+    beginFullBox(FourCC("mvhd"), 0, 0);
+    m_writer.write(zero).write(zero).write(sc_timescale).write(duration)
+            .write(uint32_t(0x00010000)).write(uint16_t(0x0100)).write(uint16_t(0)).write(zero).write(zero);
+    for(int i = 0; i < 9; ++i)
+        m_writer.write(sc_matrix[i]);
+    for(int i = 0; i < 6; ++i)
+        m_writer.write(zero);
+    m_writer.write(uint32_t(m_options.m_track_count + 1));
+    endBox();
+
+    for(int track = 0; track < m_options.m_track_count; ++track)
+        writeTrack(track + 1);
+
+    writeMovieExtends();
+
+    endBox();
+}
+
+void SyntheticFileGenerator::writeTrack(uint32_t track_id)
+{
+    uint32_t zero = 0;
+
+    beginBox(FourCC("trak"));
+
+    // track enabled, in movie, in preview
+    beginFullBox(FourCC("tkhd"), 0, 0x000007);
+    m_writer.write(zero).write(zero).write(track_id).write(zero).write(zero)
+            .write(zero).write(zero)
+            .write(uint16_t(0)).write(uint16_t(0)).write(uint16_t(0)).write(uint16_t(0));
+    for(int i = 0; i < 9; ++i)
+        m_writer.write(sc_matrix[i]);
+    m_writer.write(uint32_t(1920 << 16)).write(uint32_t(1080 << 16));
+    endBox();
+
+    beginBox(FourCC("mdia"));
+
+    beginFullBox(FourCC("mdhd"), 0, 0);
+    m_writer.write(zero).write(zero).write(sc_timescale).write(zero)
+            .write(uint16_t(0x55C4)).write(uint16_t(0));
+    endBox();
+
+    beginFullBox(FourCC("hdlr"), 0, 0);
+    m_writer.write(zero).write(FourCC("vide")).write(zero).write(zero).write(zero).write(QString("Video"));
+    endBox();
+
+    beginBox(FourCC("minf"));
+
+    beginFullBox(FourCC("vmhd"), 0, 0x000001);
+    m_writer.write(uint16_t(0)).write(uint16_t(0)).write(uint16_t(0)).write(uint16_t(0));
+    endBox();
+
+    beginBox(FourCC("dinf"));
+    beginFullBox(FourCC("dref"), 0, 0);
+    m_writer.write(uint32_t(1));
+    // media data are in the same file
+    beginFullBox(FourCC("url "), 0, 0x000001);
+    m_writer.write(QString());
+    endBox();
+    endBox();
+    endBox();
+
+    writeSampleTable();
+
+    endBox(); // minf
+    endBox(); // mdia
+    endBox(); // trak
+}
+
+void SyntheticFileGenerator::writeSampleTable()
+{
+    uint32_t zero = 0;
+
+    beginBox(FourCC("stbl"));
+
+    beginFullBox(FourCC("stsd"), 0, 0);
+    m_writer.write(zero);
+    endBox();
+
+    beginFullBox(FourCC("stts"), 0, 0);
+    m_writer.write(zero);
+    endBox();
+
+    beginFullBox(FourCC("stsc"), 0, 0);
+    m_writer.write(zero);
+    endBox();
+
+    beginFullBox(FourCC("stsz"), 0, 0);
+    m_writer.write(zero).write(uint32_t(m_options.m_sample_table_size));
+    for(int i = 0; i < m_options.m_sample_table_size; ++i)
+        m_writer.write(m_options.m_sample_size);
+    endBox();
+
+    beginFullBox(FourCC("stco"), 0, 0);
+    m_writer.write(zero);
+    endBox();
+
+    endBox();
+}
+
+void SyntheticFileGenerator::writeMovieExtends()
+{
+    beginBox(FourCC("mvex"));
+    for(int track = 0; track < m_options.m_track_count; ++track)
+    {
+        beginFullBox(FourCC("trex"), 0, 0);
+        m_writer.write(uint32_t(track + 1)).write(uint32_t(1)).write(m_options.m_sample_duration)
+                .write(m_options.m_sample_size).write(sc_non_sync_sample_flags);
+        endBox();
+    }
+    endBox();
+}
+
+void SyntheticFileGenerator::writeSurveillanceMeta()
+{
+    beginFullBox(FourCC("meta"), 0, 0);
+
+    if(m_options.m_is_surveillance)
+    {
+        uint64_t duration_ms = uint64_t(m_options.m_fragment_count) * m_options.m_samples_per_fragment * m_options.m_sample_duration * 1000 / sc_timescale;
+
+        beginBox(FourCC("sumi"));
+        m_writer.write(m_options.m_segment_UUID).write(m_options.m_predecessor_UUID).write(m_options.m_successor_UUID)
+                .write(currentTime()).write(duration_ms)
+                .write(uint16_t(0)).write(uint16_t(0))
+                .write(QString("Synthetic")).write(QString());
+        endBox();
+
+        beginFullBox(FourCC("suep"), 0, 0);
+        m_writer.write(QString("Operator")).write(QString()).write(QString())
+                .write(currentTime()).write(QString("Synthetic export"))
+                .write(uint8_t(m_options.m_track_count)).write(uint8_t(0));
+        endBox();
+    }
+
+    if(m_options.m_signature_count > 0)
+    {
+        QByteArray signature(256, '\x5A');
+        QByteArray certificate(1024, '\xA5');
+
+        beginFullBox(FourCC("ipro"), 0, 0);
+        m_writer.write(uint16_t(m_options.m_signature_count));
+        for(int i = 0; i < m_options.m_signature_count; ++i)
+        {
+            beginBox(FourCC("sinf"));
+            beginBox(FourCC("schi"));
+            beginBox(FourCC("sibo"));
+            m_writer.write(signature);
+            endBox();
+            beginBox(FourCC("cert"));
+            m_writer.write(certificate);
+            endBox();
+            endBox();
+            endBox();
+        }
+        endBox();
+    }
+
+    endBox();
+}
+
+void SyntheticFileGenerator::writeFragment(int fragment)
+{
+    const int samples = m_options.m_samples_per_fragment;
+    const uint32_t payload_size = uint32_t(samples) * m_options.m_sample_size;
+    const uint32_t moof_size = 8 + sc_mfhd_size + m_options.m_track_count * (sc_traf_size + 4 * samples);
+    const uint64_t decode_time = uint64_t(fragment) * samples * m_options.m_sample_duration;
+
+    beginBox(FourCC("moof"));
+
+    beginFullBox(FourCC("mfhd"), 0, 0);
+    m_writer.write(uint32_t(fragment + 1));
+    endBox();
+
+    for(int track = 0; track < m_options.m_track_count; ++track)
+    {
+        beginBox(FourCC("traf"));
+
+        beginFullBox(FourCC("tfhd"), 0, sc_tfhd_flags);
+        m_writer.write(uint32_t(track + 1)).write(m_options.m_sample_duration);
+        endBox();
+
+        beginFullBox(FourCC("tfdt"), 1, 0);
+        m_writer.write(decode_time);
+        endBox();
+
+        beginFullBox(FourCC("trun"), 0, sc_trun_flags);
+        m_writer.write(uint32_t(samples))
+                .write(int32_t(moof_size + 8 + track * payload_size))
+                .write(sc_sync_sample_flags);
+        for(int i = 0; i < samples; ++i)
+            m_writer.write(m_options.m_sample_size);
+        endBox();
+
+        endBox();
+    }
+
+    endBox();
+
+    beginBox(FourCC("mdat"));
+    std::vector<char> sample(m_options.m_sample_size, 0);
+    for(int i = 0; i < samples * m_options.m_track_count; ++i)
+        m_writer.write(sample.data(), sample.size());
+    endBox();
+}
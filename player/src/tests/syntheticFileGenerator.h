@@ -0,0 +1,140 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef SYNTHETICFILEGENERATOR_H
+#define SYNTHETICFILEGENERATOR_H
+
+#include "crosscompilation_cxx11.h"
+#include "crosscompilation_inttypes.h"
+
+#include <QString>
+#include <QUuid>
+#include <QVector>
+
+#include <fstream>
+
+#include "fourcc.h"
+#include "ostream.hpp"
+
+//! Writes fragmented MP4 files of a configurable size, optionally with the Surveillance and Onvif export boxes.
+/*!
+ * \brief The files follow the structure of recorded Surveillance segments: the movie box with a sample table of the
+ * configured size, a file level meta box with the segment identification, export and signature boxes, and a sequence
+ * of fragments with a single run per track starting with a sync sample.
+ * Sample data are zeros, so the files are meant for parsing only.
+ */
+class SyntheticFileGenerator CC_CXX11_FINAL
+{
+public:
+    //! Shape of the generated file.
+    struct Options
+    {
+        Options()
+            : m_fragment_count(10)
+            , m_track_count(1)
+            , m_samples_per_fragment(30)
+            , m_sample_table_size(0)
+            , m_sample_size(256)
+            , m_sample_duration(3000)
+            , m_signature_count(0)
+            , m_is_surveillance(false)
+            , m_segment_UUID(QUuid::createUuid())
+            , m_predecessor_UUID(m_segment_UUID)
+            , m_successor_UUID(m_segment_UUID)
+        {}
+
+        //! Count of the movie fragments.
+        int m_fragment_count;
+        //! Count of the video tracks.
+        int m_track_count;
+        //! Count of the samples of a track in each fragment.
+        int m_samples_per_fragment;
+        //! Count of the entries in the sample size tables of the movie box.
+        int m_sample_table_size;
+        //! Size of every sample in bytes.
+        uint32_t m_sample_size;
+        //! Duration of every sample in the 90 kHz timescale.
+        uint32_t m_sample_duration;
+        //! Count of the signature boxes.
+        int m_signature_count;
+        //! Whether the Surveillance segment identification and export boxes are written.
+        bool m_is_surveillance;
+        //! UUID of the segment.
+        QUuid m_segment_UUID;
+        //! UUID of the previous segment.
+        QUuid m_predecessor_UUID;
+        //! UUID of the next segment.
+        QUuid m_successor_UUID;
+    };
+
+public:
+    explicit SyntheticFileGenerator(const Options & options = Options());
+
+public:
+    //! Writes the file.
+    /*!
+     * \param path path of the file, which is overwritten
+     * \return true, if the file was written
+     */
+    bool generate(const QString & path);
+
+    //! Returns the count of boxes written by the last generate call.
+    int getBoxCount() const;
+
+    //! Returns the timescale of the tracks.
+    static uint32_t getTimescale();
+
+private:
+    //! Starts a box, its size is written by endBox.
+    void beginBox(const FourCC & four_cc);
+    //! Starts a full box.
+    void beginFullBox(const FourCC & four_cc, uint8_t version, uint32_t flags);
+    //! Finishes the last started box.
+    void endBox();
+
+    void writeFileType();
+    void writeMovie();
+    void writeTrack(uint32_t track_id);
+    void writeSampleTable();
+    void writeMovieExtends();
+    void writeSurveillanceMeta();
+    void writeFragment(int fragment);
+
+private:
+    //! Shape of the generated file.
+    Options m_options;
+    //! Generated file.
+    std::ofstream m_file;
+    //! Writer of the generated file.
+    StreamWriter m_writer;
+    //! Offsets of the started boxes.
+    QVector<uint64_t> m_box_offsets;
+    //! Count of the written boxes.
+    int m_box_count;
+};
+
+#endif // SYNTHETICFILEGENERATOR_H
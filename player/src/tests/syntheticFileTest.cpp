@@ -0,0 +1,243 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include <QTemporaryDir>
+
+#include "mediaParser.h"
+#include "parseIndex.h"
+#include "parseSession.h"
+
+#include "syntheticFileTest.h"
+
+SyntheticFileTest::SyntheticFileTest()
+{
+}
+
+SyntheticFileGenerator::Options SyntheticFileTest::makeOptions()
+{
+    SyntheticFileGenerator::Options options;
+    options.m_fragment_count = 5;
+    options.m_track_count = 2;
+    options.m_samples_per_fragment = 10;
+    options.m_sample_table_size = 100;
+    options.m_sample_size = 1000;
+    options.m_signature_count = 2;
+    options.m_is_surveillance = true;
+    return options;
+}
+
+int SyntheticFileTest::countBoxes(ChildrenMixin * parent)
+{
+    int count = 0;
+    BoxPtrList & children = parent->getChildren();
+    for(auto it = children.begin(), end = children.end(); it != end; ++it)
+    {
+        if((*it)->getConsistencyError() & Box::IsMandatoryBox)
+            continue;
+        ++count;
+        ChildrenMixin * children_mixin = dynamic_cast<ChildrenMixin *>(*it);
+        if(children_mixin != nullptr)
+            count += countBoxes(children_mixin);
+    }
+    return count;
+}
+
+void SyntheticFileTest::parseTest()
+{
+    QTemporaryDir folder;
+    QVERIFY(folder.isValid());
+    QString path = folder.filePath("synthetic.mp4");
+
+    SyntheticFileGenerator::Options options = makeOptions();
+    SyntheticFileGenerator generator(options);
+    QVERIFY(generator.generate(path));
+
+    ParseIndex::remove(path);
+    MediaParser parser;
+    parser.addFile(path);
+    ParseIndex::remove(path);
+
+    QVERIFY(parser.isValidISO());
+
+    FilesetInformation fileset = parser.getFilesetInformation();
+    QCOMPARE(fileset.size(), 1);
+    QCOMPARE(countBoxes(fileset.first().get()), generator.getBoxCount());
+
+    SegmentList segments = parser.getSegments();
+    QCOMPARE(segments.size(), 1);
+    QVERIFY(segments.front().isSurveillanceFragment());
+    QCOMPARE(segments.front().getSegmentUUID(), options.m_segment_UUID.toString());
+
+    QCOMPARE(parser.getSignaturesMap().value(path).getSignCount(), options.m_signature_count);
+}
+
+void SyntheticFileTest::sampleIndexTest()
+{
+    QTemporaryDir folder;
+    QVERIFY(folder.isValid());
+    QString path = folder.filePath("synthetic.mp4");
+
+    SyntheticFileGenerator::Options options = makeOptions();
+    QVERIFY(SyntheticFileGenerator(options).generate(path));
+
+    ParseIndex::remove(path);
+    MediaParser parser;
+    parser.addFile(path);
+    ParseIndex::remove(path);
+
+    SampleIndex sample_index = parser.getSampleIndex(path);
+    QCOMPARE(sample_index.size(), 2);
+
+    const TrackSampleIndex & first = sample_index[1];
+    const TrackSampleIndex & second = sample_index[2];
+    QCOMPARE(first.size(), 50);
+    QCOMPARE(first.getTimescale(), SyntheticFileGenerator::getTimescale());
+    QCOMPARE(first.getDecodeTime(10), int64_t(10 * options.m_sample_duration));
+    QVERIFY(first.isSync(0));
+    QVERIFY(first.isSync(10));
+    QVERIFY(!first.isSync(11));
+
+    // samples of the second track follow the ones of the first track in each 'mdat'
+    QCOMPARE(second.getOffset(0), first.getOffset(0) + 10 * options.m_sample_size);
+    QCOMPARE(first.getOffset(1), first.getOffset(0) + options.m_sample_size);
+}
+
+void SyntheticFileTest::parseIndexTest()
+{
+    QTemporaryDir folder;
+    QVERIFY(folder.isValid());
+    QString path = folder.filePath("synthetic.mp4");
+
+    SyntheticFileGenerator::Options options = makeOptions();
+    SyntheticFileGenerator generator(options);
+    QVERIFY(generator.generate(path));
+
+    // the parser saves the index of the file
+    ParseIndex::remove(path);
+    MediaParser parser;
+    parser.addFile(path);
+    SampleIndex sample_index = parser.getSampleIndex(path);
+
+    ParseIndex index;
+    bool loaded = index.load(path);
+    ParseIndex::remove(path);
+    QVERIFY(loaded);
+
+    QCOMPARE(index.getBoxLayout().size(), generator.getBoxCount());
+
+    QCOMPARE(index.getSegments().size(), 1);
+    QCOMPARE(index.getSegments().front().getSegmentUUID(), options.m_segment_UUID.toString());
+
+    const SampleIndex & restored = index.getSampleIndex();
+    QCOMPARE(restored.keys(), sample_index.keys());
+    for(auto it = sample_index.begin(), end = sample_index.end(); it != end; ++it)
+    {
+        TrackSampleIndex track = restored.value(it.key());
+        QCOMPARE(track.size(), it->size());
+        QCOMPARE(track.getTimescale(), it->getTimescale());
+        QCOMPARE(track.getEndTime(), it->getEndTime());
+        QCOMPARE(track.getOffset(track.size() - 1), it->getOffset(it->size() - 1));
+        QCOMPARE(track.findSyncSample(track.size() - 1), it->findSyncSample(it->size() - 1));
+    }
+}
+
+void SyntheticFileTest::fastOpenIndexTest()
+{
+    QTemporaryDir folder;
+    QVERIFY(folder.isValid());
+    QString path = folder.filePath("synthetic.mp4");
+
+    SyntheticFileGenerator::Options options = makeOptions();
+    QVERIFY(SyntheticFileGenerator(options).generate(path));
+    ParseIndex::remove(path);
+
+    // the first fast open parses the file and saves an unchecked index, the second one restores it
+    bool first_restored = true, second_restored = false, checked_restored = true, reopened_restored = false;
+    int sample_count = 0;
+    {
+        ParseSession session(path, true);
+        session.parse();
+        first_restored = session.isRestored();
+    }
+    {
+        ParseSession session(path, true);
+        session.parse();
+        second_restored = session.isRestored();
+        sample_count = session.getSampleIndexExtractor().getSampleIndex(path).value(1).size();
+    }
+    // the checks do not take the unchecked index, they replace it by a checked one, which the fast open restores as well
+    {
+        ParseSession session(path);
+        session.parse();
+        checked_restored = session.isRestored();
+    }
+    {
+        ParseSession session(path, true);
+        session.parse();
+        reopened_restored = session.isRestored();
+    }
+    ParseIndex::remove(path);
+
+    QVERIFY(!first_restored);
+    QVERIFY(second_restored);
+    QCOMPARE(sample_count, 50);
+    QVERIFY(!checked_restored);
+    QVERIFY(reopened_restored);
+}
+
+void SyntheticFileTest::pruneTest()
+{
+    QTemporaryDir folder;
+    QVERIFY(folder.isValid());
+
+    // four cache files used one day after another, and a file of another cache
+    QDateTime now = QDateTime::currentDateTime();
+    for(int i = 0; i < 4; ++i)
+    {
+        QFile file(folder.filePath(QString("%1.idx").arg(i)));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QByteArray(1000, 'x'));
+        file.flush();
+        QVERIFY(file.setFileTime(now.addDays(i - 3), QFileDevice::FileModificationTime));
+    }
+    QFile other(folder.filePath("other.thumbs"));
+    QVERIFY(other.open(QIODevice::WriteOnly));
+    other.write(QByteArray(10000, 'x'));
+    other.close();
+
+    // the files used longest ago are removed until the size limit is kept
+    QCOMPARE(ParseIndex::prune(folder.path(), "*.idx", 2500, 30), 2);
+    QVERIFY(!QFile::exists(folder.filePath("0.idx")));
+    QVERIFY(!QFile::exists(folder.filePath("1.idx")));
+    QVERIFY(QFile::exists(folder.filePath("2.idx")));
+
+    // files unused for longer than the age limit are removed below the size limit as well
+    QCOMPARE(ParseIndex::prune(folder.path(), "*.idx", 1 << 20, 1), 1);
+    QVERIFY(!QFile::exists(folder.filePath("2.idx")));
+    QVERIFY(QFile::exists(folder.filePath("3.idx")));
+    QVERIFY(QFile::exists(other.fileName()));
+}
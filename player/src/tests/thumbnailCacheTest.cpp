@@ -0,0 +1,103 @@
+/************************************************************************************
+* Copyright (c) 2013 ONVIF.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*    * Redistributions of source code must retain the above copyright
+*      notice, this list of conditions and the following disclaimer.
+*    * Redistributions in binary form must reproduce the above copyright
+*      notice, this list of conditions and the following disclaimer in the
+*      documentation and/or other materials provided with the distribution.
+*    * Neither the name of ONVIF nor the names of its contributors may be
+*      used to endorse or promote products derived from this software
+*      without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL ONVIF BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "thumbnailCacheTest.h"
+
+#include <QTemporaryDir>
+
+#include "defines.h"
+#include "thumbnailCache.h"
+
+namespace
+{
+    //! Writes a file the cache is bound to.
+    bool writeFile(const QString& path, const QByteArray& data)
+    {
+        QFile file(path);
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Append))
+            return false;
+        return file.write(data) == data.size();
+    }
+
+    //! Makes a thumbnail of a single color.
+    QImage makeImage(Qt::GlobalColor color)
+    {
+        QImage image(THUMBNAIL_WIDTH, THUMBNAIL_WIDTH * 9 / 16, QImage::Format_RGB32);
+        image.fill(color);
+        return image;
+    }
+}
+
+ThumbnailCacheTest::ThumbnailCacheTest()
+{
+}
+
+void ThumbnailCacheTest::saveLoadTest()
+{
+    QTemporaryDir folder;
+    QString path = folder.filePath("video.mp4");
+    QVERIFY(writeFile(path, QByteArray(4096, 'v')));
+
+    // the cache is kept in the temporary folder, not in the one of the application
+    ThumbnailCache cache(folder.path());
+    cache.insert(0, makeImage(Qt::red));
+    cache.insert(8000, makeImage(Qt::blue));
+    QVERIFY(cache.save(path));
+    QCOMPARE(QDir(folder.path()).entryList(QStringList() << "*.thumbs", QDir::Files).size(), 1);
+
+    ThumbnailCache loaded(folder.path());
+    QVERIFY(loaded.load(path));
+    QCOMPARE(loaded.size(), 2);
+    QVERIFY(loaded.contains(0));
+    QVERIFY(loaded.contains(8000));
+    QCOMPARE(loaded.getThumbnails()[8000].size(), makeImage(Qt::blue).size());
+
+    // JPEG is lossy, the color only has to stay close
+    QColor color = loaded.getThumbnails()[0].pixelColor(10, 10);
+    QVERIFY(color.red() > 200 && color.blue() < 50);
+
+    loaded.remove(path);
+    QVERIFY(!loaded.load(path));
+    QVERIFY(loaded.isEmpty());
+}
+
+void ThumbnailCacheTest::changedFileTest()
+{
+    QTemporaryDir folder;
+    QString path = folder.filePath("video.mp4");
+    QVERIFY(writeFile(path, QByteArray(4096, 'v')));
+
+    ThumbnailCache cache(folder.path());
+    cache.insert(2000, makeImage(Qt::green));
+    QVERIFY(cache.save(path));
+
+    // a recording that grew has new contents, its thumbnails are made again
+    QVERIFY(writeFile(path, QByteArray(1024, 'w')));
+    ThumbnailCache loaded(folder.path());
+    QVERIFY(!loaded.load(path));
+    QVERIFY(loaded.isEmpty());
+}